@@ -175,3 +175,8 @@ set(GLSLANG_LIBRARIES glslang SPIRV OSDependent)
 if (TARGET OGLCompiler)
 	set(GLSLANG_LIBRARIES ${GLSLANG_LIBRARIES} OGLCompiler)
 endif()
+
+## used by VulkanShader for the spirv optimization
+if (TARGET SPVRemapper)
+	set(GLSLANG_LIBRARIES ${GLSLANG_LIBRARIES} SPVRemapper)
+endif()
@@ -0,0 +1,58 @@
+## helpers for the spirv bundles (see include/Gaia/Shader/SpirvBundle.h)
+##
+## gaia_compile_shader_bundle(OUTPUT <bundle file> SHADERS <files...> [OPTIMIZATION none|perf|size] [ENTRY_POINT <name>] [VARIANTS "A=1;B" ...])
+##   compile the shaders at build time with GaiaShaderCompiler (GAIA_BUILD_SHADER_COMPILER must be ON)
+##
+## gaia_embed_shader_bundle(TARGET <target> BUNDLE <bundle file> NAME <c symbol>)
+##   add to the target a generated cpp with the bundle as an array :
+##   extern const unsigned char <NAME>[]; extern const size_t <NAME>_size;
+##   to load with SpirvBundle::LoadFromMemory(<NAME>, <NAME>_size)
+
+if (CMAKE_SCRIPT_MODE_FILE)
+	## script mode, called at build time : convert BUNDLE_FILE in OUTPUT_FILE with the symbol SYMBOL_NAME
+	file(READ ${BUNDLE_FILE} BUNDLE_HEX HEX)
+	string(LENGTH "${BUNDLE_HEX}" BUNDLE_HEX_LEN)
+	math(EXPR BUNDLE_SIZE "${BUNDLE_HEX_LEN} / 2")
+	string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BUNDLE_BYTES "${BUNDLE_HEX}")
+	if (BUNDLE_SIZE EQUAL 0)
+		## an empty initializer list is not valid for an array of unknown size, the size stay 0
+		set(BUNDLE_BYTES "0x00")
+	endif()
+	file(WRITE ${OUTPUT_FILE} "// generated from ${BUNDLE_FILE}, do not edit\n#include <cstddef>\nextern const unsigned char ${SYMBOL_NAME}[] = {${BUNDLE_BYTES}};\nextern const size_t ${SYMBOL_NAME}_size = ${BUNDLE_SIZE};\n")
+	return()
+endif()
+
+set(GAIA_SHADER_BUNDLE_SCRIPT ${CMAKE_CURRENT_LIST_FILE} CACHE INTERNAL "")
+
+function(gaia_compile_shader_bundle)
+	cmake_parse_arguments(ARG "" "OUTPUT;OPTIMIZATION;ENTRY_POINT" "SHADERS;VARIANTS" ${ARGN})
+	set(COMPILER_ARGS -o ${ARG_OUTPUT})
+	if (ARG_OPTIMIZATION)
+		list(APPEND COMPILER_ARGS -O ${ARG_OPTIMIZATION})
+	endif()
+	if (ARG_ENTRY_POINT)
+		list(APPEND COMPILER_ARGS -e ${ARG_ENTRY_POINT})
+	endif()
+	foreach(VARIANT ${ARG_VARIANTS})
+		list(APPEND COMPILER_ARGS -D "${VARIANT}")
+	endforeach()
+	add_custom_command(
+		OUTPUT ${ARG_OUTPUT}
+		COMMAND GaiaShaderCompiler ${COMPILER_ARGS} ${ARG_SHADERS}
+		DEPENDS GaiaShaderCompiler ${ARG_SHADERS}
+		WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
+		COMMENT "Compiling the spirv bundle ${ARG_OUTPUT}"
+		VERBATIM)
+endfunction()
+
+function(gaia_embed_shader_bundle)
+	cmake_parse_arguments(ARG "" "TARGET;BUNDLE;NAME" "" ${ARGN})
+	set(GENERATED_FILE ${CMAKE_CURRENT_BINARY_DIR}/${ARG_NAME}.cpp)
+	add_custom_command(
+		OUTPUT ${GENERATED_FILE}
+		COMMAND ${CMAKE_COMMAND} -DBUNDLE_FILE=${ARG_BUNDLE} -DOUTPUT_FILE=${GENERATED_FILE} -DSYMBOL_NAME=${ARG_NAME} -P ${GAIA_SHADER_BUNDLE_SCRIPT}
+		DEPENDS ${ARG_BUNDLE} ${GAIA_SHADER_BUNDLE_SCRIPT}
+		COMMENT "Embedding the spirv bundle ${ARG_BUNDLE}"
+		VERBATIM)
+	target_sources(${ARG_TARGET} PRIVATE ${GENERATED_FILE})
+endfunction()
@@ -107,7 +107,7 @@ public:  // contructor
     float GetOutputRatio() const override;
     ez::fvec2 GetOutputSize() const override;
 
-    bool UpdateMipMapping(const uint32_t& vBindingPoint);
+    bool UpdateMipMapping(const uint32_t& vBindingPoint, vk::CommandBuffer* vCmdBufferPtr = nullptr);
 
     void Swap();
 
@@ -86,7 +86,13 @@ protected:
     float m_OutputRatio = 1.0f;
 
     // Renderpass
-    vk::RenderPass m_RenderPass = {};
+    vk::RenderPass m_RenderPass = {};  // stay null with the dynamic rendering
+
+    // dynamic rendering (VK_KHR_dynamic_rendering), the attachments are given in Begin
+    // the pipelines declare only the formats, so a resize don't recreate the renderpass
+    bool m_UseDynamicRendering = false;
+    std::vector<vk::Format> m_ColorAttachmentFormats;
+    vk::PipelineRenderingCreateInfoKHR m_PipelineRenderingCreateInfo;
 
     // pixel format
     vk::Format m_PixelFormat = vk::Format::eR32G32B32A32Sfloat;
@@ -114,6 +120,13 @@ public:  // contructor
         const vk::RenderPass& vExternalRenderPass = nullptr);
     void Unit();
 
+    // to call before Init. ignored if the device not support the dynamic rendering
+    void SetUseDynamicRendering(const bool& vFlag);
+    bool IsUsingDynamicRendering() const;
+
+    // to chain in the pipeline create infos, nullptr without the dynamic rendering
+    const vk::PipelineRenderingCreateInfoKHR* GetPipelineRenderingCreateInfo() const;
+
     // resize
     void NeedResize(ez::ivec2* vNewSize, const uint32_t* vCountColorBuffers = nullptr);  // to call at any moment
 
@@ -144,6 +157,9 @@ public:  // contructor
     vk::RenderPass* GetRenderPass();
     void SetRenderPass(const vk::RenderPass& vExternalRenderPass);
     vk::SampleCountFlagBits GetSampleCount() const;
+    // identify the renderpasses compatible with the renderpass created here, for share the pipelines
+    // 0 if the renderpass is external
+    uint64_t GetRenderPassCompatibilityKey() const;
     uint32_t GetBuffersCount() const;
 
     // OutputSizeInterface
@@ -158,7 +174,7 @@ public:  // contructor
     void ClearAttachments();  // set clear flag for clearing at next render
     void SetClearColorValue(const ez::fvec4& vColor);
 
-    bool UpdateMipMapping(const uint32_t& vBindingPoint);
+    bool UpdateMipMapping(const uint32_t& vBindingPoint, vk::CommandBuffer* vCmdBufferPtr = nullptr);
 
     void Swap();
 
@@ -173,4 +189,8 @@ protected:
         const vk::SampleCountFlagBits& vSampleCount,
         const bool& vCreateRenderPass);
     void DestroyFrameBuffers();
+
+    // dynamic rendering
+    void BeginRendering(vk::CommandBuffer* vCmdBufferPtr);
+    void EndRendering(vk::CommandBuffer* vCmdBufferPtr);
 };
\ No newline at end of file
@@ -65,6 +65,7 @@ public:
     static void check_error(VkResult result);
     static uint32_t sApiVersion;
     static void sDdestroyVmaAllocator(VmaAllocator* VmaAllocatorPtr);
+    static constexpr uint64_t sUniformArenaFrameSize = 4ULL * 1024ULL * 1024ULL;  // 4 MiB of uniforms by frame in flight
 
 protected:
     VulkanCoreWeak m_This;
@@ -79,6 +80,13 @@ protected:
     TextureCubePtr m_EmptyTextureCubePtr = nullptr;
     vk::DescriptorBufferInfo m_EmptyDescriptorBufferInfo = vk::DescriptorBufferInfo{VK_NULL_HANDLE, 0, VK_WHOLE_SIZE};
     vk::BufferView m_EmptyBufferView = VK_NULL_HANDLE;
+    VulkanUniformArenaPtr m_UniformArenaPtr = nullptr;
+    VulkanMipGeneratorPtr m_MipGeneratorPtr = nullptr;
+    VulkanImageConverterPtr m_ImageConverterPtr = nullptr;
+    VulkanCubeFilterPtr m_CubeFilterPtr = nullptr;
+    VulkanPipelineRegistryPtr m_PipelineRegistryPtr = nullptr;
+    PipelineManifestPtr m_PipelineManifestPtr = nullptr;
+    TextureDiskCachePtr m_TextureDiskCachePtr = nullptr;
 
     std::vector<vk::CommandBuffer> m_CommandBuffers;
     std::vector<vk::Semaphore> m_ComputeCompleteSemaphores;
@@ -138,6 +146,30 @@ public:  // get / set
     vk::DescriptorBufferInfo* getEmptyDescriptorBufferInfo();
     vk::BufferView* getEmptyBufferView();
 
+    // shared per frame uniform arena, for the UNIFORM_BUFFER_DYNAMIC descriptors
+    VulkanUniformArenaWeak getUniformArena() const;
+
+    // shared compute mip generator, records the mips generation in the command buffer of the caller
+    VulkanMipGeneratorWeak getMipGenerator() const;
+
+    // shared compute converter of the packed texels of the image files to the texture formats
+    VulkanImageConverterWeak getImageConverter() const;
+
+    // shared compute generator of the cube maps from an equirectangular or a cube map, with their prefiltered mips
+    VulkanCubeFilterWeak getCubeFilter() const;
+
+    // shared shader modules, pipeline layouts and pipelines of the passes
+    VulkanPipelineRegistryWeak getPipelineRegistry() const;
+
+    // optional, the pipelines used by the passes are recorded in it and the ones of the previous session prebuilt
+    // to set before the creation of the passes
+    void setPipelineManifest(PipelineManifestPtr vPipelineManifestPtr);
+    PipelineManifestWeak getPipelineManifest() const;
+
+    // optional, the textures loaded from image files are stored in it ready for the gpu, and reloaded from it at the next launch
+    void setTextureDiskCache(TextureDiskCachePtr vTextureDiskCachePtr);
+    TextureDiskCacheWeak getTextureDiskCache() const;
+
     void SetVulkanImGuiRenderer(VulkanImGuiRendererWeak vVulkanShader);
     VulkanImGuiRendererWeak GetVulkanImGuiRenderer();
 
@@ -57,12 +57,18 @@ public:
     vk::PhysicalDeviceRayTracingPipelineFeaturesKHR m_RayTracingPipelineFeature;
     vk::PhysicalDeviceRayTracingPipelinePropertiesKHR m_RayTracingDeviceProperties;
     vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT m_DynamicStates;
+    vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT m_DynamicStates2;  // only the supported features are enabled
+    vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT m_DynamicStates3;  // only the supported features are enabled
+    vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT m_GraphicsPipelineLibraryFeature;
+    vk::PhysicalDeviceDynamicRenderingFeaturesKHR m_DynamicRenderingFeature;
+    vk::PhysicalDevicePipelineExecutablePropertiesFeaturesKHR m_PipelineExecutablePropertiesFeature;
     vk::PhysicalDeviceBufferDeviceAddressFeatures m_BufferDeviceAddress;
     vk::PhysicalDeviceFeatures m_PhysDeviceFeatures;
     vk::PhysicalDeviceFeatures2 m_PhysDeviceFeatures2;
     vk::PhysicalDevice m_PhysDevice;
     vk::Device m_LogDevice;
     uint32_t m_ApiVersion = VK_API_VERSION_1_0;
+    bool m_PipelineCreationFeedbackSupported = false;  // VK_EXT_pipeline_creation_feedback, no feature to enable
 
 private:
     bool m_Use_RTX = false;
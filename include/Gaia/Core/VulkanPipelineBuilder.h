@@ -0,0 +1,274 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <Gaia/Core/VulkanPipelineRegistry.h>
+#include <Gaia/Rendering/Base/PipelineManifest.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <future>
+#include <cstdint>
+#include <functional>
+
+/*
+pipeline builder of a pass, his pipelines are shared with the other passes by the registry (see VulkanPipelineRegistry)
+the pass give the spirv of his stages and a copy of his states (see PipelineBuildStatesStruct), so a build never read the pass
+and can be done on a worker thread. the builder own what is around the builds :
+- the parts of the graphics pipeline library, and their optimized links done on worker threads
+- the pipelines retired until no frame in flight can use them
+- the specialized pipelines (others constants or static states) and their jobs
+- the records and the misses of the pipeline manifest
+- the pipeline statistics shown in vkProfiler
+*/
+
+namespace GaiApi {
+class GAIA_API VulkanPipelineBuilder {
+public:
+    typedef std::map<vk::ShaderStageFlagBits, std::vector<unsigned int>> ShaderSpirvsContainer;  // spirv of the main entry point of the used stages
+    typedef std::map<uint32_t, uint32_t> SpecializationConstantsContainer;  // constant id => 32 bits value
+    typedef std::pair<uint64_t, SpecializationConstantsContainer> PipelineVariantKey;  // static states key, constants
+
+    struct PipelineStruct {
+        vk::PipelineLayout m_PipelineLayout = {};
+        vk::Pipeline m_Pipeline = {};
+        std::vector<vk::Pipeline> m_Libraries;  // graphics pipeline library parts linked in m_Pipeline, owned by the registry
+    };
+
+    struct DynamicStatesSupportStruct {
+        bool m_Queried = false;
+        bool m_CullMode = false;            // VK_EXT_extended_dynamic_state, cull mode and front face
+        bool m_DepthTest = false;           // VK_EXT_extended_dynamic_state, depth test and write
+        bool m_PatchControlPoints = false;  // VK_EXT_extended_dynamic_state2
+        bool m_PolygonMode = false;         // VK_EXT_extended_dynamic_state3
+        bool m_ColorBlendEnable = false;    // VK_EXT_extended_dynamic_state3
+    };
+
+    // the inputs of a pipeline build, copied on the render thread (see ShaderPass::CapturePipelineBuildStates)
+    // so a build on a worker thread never read the states changed by the render thread, and never write the pass
+    struct PipelineBuildStatesStruct {
+        vk::DescriptorSetLayout m_DescriptorSetLayout = {};
+        bool m_IsLayoutReflected = false;
+        std::vector<vk::DescriptorSetLayoutBinding> m_LayoutBindings;  // bindings of m_DescriptorSetLayout
+        std::vector<vk::PushConstantRange> m_PushConstants;
+        uint64_t m_PipelineLayoutKey = 0U;  // see ShaderPass::GetPipelineLayoutKey
+        vk::RenderPass m_RenderPass = {};
+        uint64_t m_RenderPassKey = 0U;  // see ShaderPass::GetRenderPassCompatibilityKey
+        bool m_UseRenderingInfo = false;
+        vk::PipelineRenderingCreateInfoKHR m_RenderingInfo;  // pColorAttachmentFormats is set at build time
+        std::vector<vk::Format> m_ColorAttachmentFormats;
+        std::vector<vk::VertexInputBindingDescription> m_VertexBindings;
+        std::vector<vk::VertexInputAttributeDescription> m_VertexAttributes;
+        uint64_t m_StaticStatesKey = 0U;  // see ShaderPass::GetStaticStatesKey
+        DynamicStatesSupportStruct m_DynamicStatesSupport;
+        bool m_UseGraphicsPipelineLibrary = false;  // wanted by the pass, ignored if not supported
+        bool m_Tesselated = false;
+        vk::PrimitiveTopology m_PrimitiveTopology = vk::PrimitiveTopology::eTriangleList;
+        bool m_CanDynamicallyChangePrimitiveTopology = false;
+        uint32_t m_PatchControlPoints = 3U;
+        vk::Viewport m_Viewport = {};
+        vk::Rect2D m_RenderArea = {};
+        vk::SampleCountFlagBits m_SampleCount = vk::SampleCountFlagBits::e1;
+        uint32_t m_CountColorBuffers = 0U;
+        float m_LineWidth = 1.0f;
+        vk::PolygonMode m_PolygonMode = vk::PolygonMode::eFill;
+        vk::CullModeFlagBits m_CullMode = vk::CullModeFlagBits::eNone;
+        vk::FrontFace m_FrontFaceMode = vk::FrontFace::eCounterClockwise;
+        bool m_BlendingEnabled = false;
+        bool m_DepthTestEnabled = true;
+        bool m_DepthWriteEnabled = true;
+    };
+
+    // the pipelines of the client who can be replaced by an optimized link, nullptr if not owned
+    typedef std::function<PipelineStruct*(const vk::Pipeline&)> PipelineFinder;
+
+private:
+    // optimized link of a fast linked pipeline, done on a worker thread
+    struct PipelineLinkStruct {
+        vk::Pipeline m_FastLinkedPipeline = {};  // null if destroyed before the end of the link
+        uint64_t m_PipelineKey = 0U;
+        vk::PipelineLayout m_PipelineLayout = {};  // one more reference during the link
+        std::vector<vk::Pipeline> m_Libraries;    // one more reference during the link
+        std::future<vk::Pipeline> m_OptimizedPipelineFuture;
+        vk::Pipeline m_OptimizedPipeline = {};
+    };
+
+    // a specialized pipeline prebuilt on a worker thread from the pipeline manifest
+    struct SpecializedPipelineJobStruct {
+        uint64_t m_Variant = 0U;     // shader variant of the shader codes used
+        uint64_t m_Generation = 0U;  // see ShaderPass::m_VariantsGeneration
+        std::future<PipelineStruct> m_PipelineFuture;
+    };
+
+    // a pipeline replaced at a frame boundary, destroyed when no frame in flight can use it
+    struct RetiredPipelineStruct {
+        PipelineStruct m_Pipeline;
+        uint64_t m_RetiredFrame = 0U;
+    };
+
+    // build time (VK_EXT_pipeline_creation_feedback) and statistics (VK_KHR_pipeline_executable_properties) of a built pipeline
+    struct PipelineStatisticsStruct {
+        bool m_FeedbackValid = false;
+        double m_BuildTimeInMs = 0.0;
+        bool m_CacheHit = false;                // found in the pipeline cache
+        std::vector<std::string> m_Statistics;  // "executable : statistic = value"
+    };
+
+    // chained to a pipeline create info, must live until the end of the creation
+    struct PipelineFeedbackStruct {
+        vk::PipelineCreationFeedbackEXT m_Feedback;
+        vk::PipelineCreationFeedbackCreateInfoEXT m_FeedbackInfo;
+    };
+
+private:
+    VulkanCoreWeak m_VulkanCore;
+    vk::Device m_Device;
+    vk::PipelineCache m_PipelineCache = {};
+
+private:  // graphics pipeline library
+    bool m_GraphicsPipelineLibrarySupported = false;  // VK_EXT_graphics_pipeline_library
+    std::mutex m_PipelineLinksMutex;                  // the links are started by the worker threads too
+    std::vector<PipelineLinkStruct> m_PipelineLinks;
+
+private:  // retired pipelines
+    std::vector<RetiredPipelineStruct> m_RetiredPipelines;
+    uint64_t m_FrameCounter = 0U;  // incremented at each frame boundary (BeginFrame)
+
+private:  // specialized pipelines
+    std::map<PipelineVariantKey, PipelineStruct> m_SpecializedPipelines;                   // the others variants already built
+    std::map<PipelineVariantKey, SpecializedPipelineJobStruct> m_SpecializedPipelineJobs;  // the others variants in build
+
+private:  // pipeline manifest
+    bool m_PipelineManifestRecorded = false;
+    uint64_t m_RecordedVariant = 0U;                                     // last variant recorded in the manifest
+    SpecializationConstantsContainer m_RecordedSpecializationConstants;  // last constants recorded in the manifest
+    uint64_t m_RecordedStaticStatesKey = 0U;                             // last static states recorded in the manifest
+
+private:  // pipeline statistics
+    bool m_CapturePipelineStatistics = false;
+    bool m_PipelineFeedbackSupported = false;        // VK_EXT_pipeline_creation_feedback
+    bool m_PipelineExecutableInfoSupported = false;  // VK_KHR_pipeline_executable_properties
+    mutable std::mutex m_PipelineStatisticsMutex;    // the pipelines are built by the worker threads too
+    std::map<std::string, PipelineStatisticsStruct> m_PipelineStatistics;  // last pipeline built, by kind (pixel, compute, fast link..)
+    bool m_PipelineStatisticsChanged = false;
+
+public:
+    VulkanPipelineBuilder(VulkanCoreWeak vVulkanCore);
+    ~VulkanPipelineBuilder();
+
+    // wait the jobs and the links, and destroy the specialized and retired pipelines
+    // the pipelines of the client must be destroyed before (see DestroyPipelineStruct)
+    void Unit();
+
+    // at frame boundary, destroy the retired pipelines not used by the frames in flight
+    void BeginFrame();
+
+public:  // build, can be called from a worker thread
+    bool BuildPipeline(const bool& vIsPixel,
+        const ShaderSpirvsContainer& vSpirvs,
+        const PipelineBuildStatesStruct& vStates,
+        PipelineStruct& vOutPipeline,
+        const SpecializationConstantsContainer& vConstants);
+    bool BuildComputePipeline(const ShaderSpirvsContainer& vSpirvs,
+        const PipelineBuildStatesStruct& vStates,
+        PipelineStruct& vOutPipeline,
+        const SpecializationConstantsContainer& vConstants);
+    bool BuildPixelPipeline(const ShaderSpirvsContainer& vSpirvs,
+        const PipelineBuildStatesStruct& vStates,
+        PipelineStruct& vOutPipeline,
+        const SpecializationConstantsContainer& vConstants);
+    // the build on a worker thread of a copy of the spirvs, the pipeline is empty if the build failed
+    std::future<PipelineStruct> LaunchPipelineBuild(const bool& vIsPixel,
+        const ShaderSpirvsContainer& vSpirvs,
+        const PipelineBuildStatesStruct& vStates,
+        const SpecializationConstantsContainer& vConstants);
+    static vk::SpecializationInfo GetSpecializationInfo(const SpecializationConstantsContainer& vConstants,
+        std::vector<vk::SpecializationMapEntry>& vOutEntries,
+        std::vector<uint32_t>& vOutDatas);
+    void DestroyPipelineStruct(PipelineStruct& vPipeline);
+
+    // the old pipeline can be used by the frames in flight
+    void RetirePipeline(const PipelineStruct& vPipeline);
+    void DestroyRetiredPipelines(const bool& vForce);
+
+public:  // graphics pipeline library
+    // the fast linked pipelines found by vFinder or in the specialized pipelines are replaced by their optimized link
+    void CollectOptimizedLinks(const PipelineFinder& vFinder);  // at frame boundary
+    void WaitOptimizedLinks();
+
+public:  // specialized pipelines
+    // the jobs are tagged with the shader variant and his generation, so a result built with the shaders of another variant is ignored
+    bool IsSpecializedPipelineKnown(const PipelineVariantKey& vKey) const;  // built or in build
+    void LaunchSpecializedPipelineJob(const PipelineVariantKey& vKey,
+        const bool& vIsPixel,
+        const ShaderSpirvsContainer& vSpirvs,
+        const PipelineBuildStatesStruct& vStates,
+        const uint64_t& vVariant,
+        const uint64_t& vGeneration);
+    // true if vKey is built, or in build with vVariant and vGeneration (the job is then waited)
+    // vOutPipeline is empty if the build of the job failed
+    bool TakeSpecializedPipeline(const PipelineVariantKey& vKey, const uint64_t& vVariant, const uint64_t& vGeneration, PipelineStruct& vOutPipeline);
+    void StoreSpecializedPipeline(const PipelineVariantKey& vKey, const PipelineStruct& vPipeline);
+    void CollectSpecializedPipelineJobs(const PipelineVariantKey& vBuiltKey, const uint64_t& vVariant, const uint64_t& vGeneration);
+    void WaitSpecializedPipelineJobs();
+    void DestroySpecializedPipelines(const bool& vRetire);
+
+public:  // pipeline manifest, vPassKey is the key of the pass (see ShaderPass::GetPipelineManifestKey)
+    bool GetPipelineManifestEntry(const std::string& vPassKey, PipelineManifest::PassEntry& vOutEntry) const;
+    bool IsInPipelineManifest(const std::string& vPassKey, const uint64_t& vStaticStatesKey) const;  // used in the previous session
+    void RecordInPipelineManifest(const std::string& vPassKey,
+        const uint64_t& vVariant,
+        const SpecializationConstantsContainer& vConstants,
+        const uint64_t& vStaticStatesKey);
+    void AddPipelineManifestMiss(const std::string& vPassKey, const std::string& vWhat);
+
+public:  // pipeline statistics
+    void SetCapturePipelineStatistics(const bool& vFlag);
+    std::string GetPipelineStatisticsReport() const;
+    void UpdatePipelineStatisticsInProfiler(const void* vOwnerPtr);  // at frame boundary, vOwnerPtr is the key of the zones in vkProfiler
+
+private:
+    void QueryDeviceSupport();
+    vk::PipelineLayout AcquirePipelineLayout(const PipelineBuildStatesStruct& vStates);
+    vk::ShaderModule AcquireShaderModule(const std::vector<unsigned int>& vSpirv);
+    void ReleaseShaderModule(const vk::ShaderModule& vShaderModule);
+
+private:  // graphics pipeline library
+    vk::Pipeline AcquirePipelineLibrary(VulkanPipelineRegistryPtr vRegistryPtr,
+        const uint64_t& vKey,
+        const vk::GraphicsPipelineLibraryFlagsEXT& vParts,
+        vk::GraphicsPipelineCreateInfo vCreateInfo);
+    void StartOptimizedLink(VulkanPipelineRegistryPtr vRegistryPtr,
+        const uint64_t& vPipelineKey,
+        const vk::Pipeline& vFastLinkedPipeline,
+        const vk::PipelineLayout& vPipelineLayout,
+        const std::vector<uint64_t>& vLibraryKeys);
+    PipelineStruct* FindPipelineStruct(const vk::Pipeline& vPipeline, const PipelineFinder& vFinder);
+    void ReleasePipelineLink(VulkanPipelineRegistryPtr vRegistryPtr, PipelineLinkStruct& vLink);
+
+private:  // pipeline statistics
+    const void* ChainPipelineFeedback(PipelineFeedbackStruct& vOutFeedback, const void* vNext) const;  // return the pNext to set
+    vk::PipelineCreateFlags GetPipelineStatisticsFlags() const;
+    void AddPipelineStatistics(const std::string& vKind, const PipelineFeedbackStruct& vFeedback, const vk::Pipeline& vPipeline);
+};
+}  // namespace GaiApi
@@ -0,0 +1,128 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+
+/*
+device level registry of the shader modules, pipeline layouts and pipelines
+each object is identified by a 64 bits key, the hash of his canonical description (see Hasher)
+so the passes with the same shaders and the same states share one vulkan object
+the objects are reference counted. when an object is not referenced anymore, he is kept alive during
+SWAPCHAIN_IMAGES_COUNT frames (the frames in flight can use it) and can be reacquired during this time
+the registry can be used from the worker threads of the hot reload
+*/
+
+namespace GaiApi {
+class GAIA_API VulkanPipelineRegistry {
+public:
+    static VulkanPipelineRegistryPtr Create(VulkanCoreWeak vVulkanCore);
+
+    // FNV-1a 64 bits, for build the keys
+    class GAIA_API Hasher {
+    private:
+        uint64_t m_Hash = 0xcbf29ce484222325ULL;
+
+    public:
+        Hasher& addBytes(const void* vDatas, const size_t& vSize);
+        template <typename T>
+        Hasher& add(const T& vValue) {
+            static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable types can be hashed");
+            return addBytes(&vValue, sizeof(T));
+        }
+        uint64_t get() const;
+    };
+
+    static uint64_t GetSpirvKey(const std::vector<unsigned int>& vSpirv);
+
+private:
+    template <typename T>
+    struct ObjectsContainer {
+        struct Entry {
+            T object = {};
+            uint32_t refCount = 0U;
+            uint64_t unusedSinceFrame = 0U;  // frame of the last release
+        };
+        std::unordered_map<uint64_t, Entry> entries;       // key => entry
+        std::unordered_map<uint64_t, uint64_t> keys;       // object handle => key
+    };
+
+private:
+    VulkanCoreWeak m_VulkanCore;
+    vk::Device m_Device;
+    mutable std::mutex m_Mutex;
+    uint64_t m_FrameCounter = 0U;
+    ObjectsContainer<vk::ShaderModule> m_ShaderModules;
+    ObjectsContainer<vk::PipelineLayout> m_PipelineLayouts;
+    ObjectsContainer<vk::Pipeline> m_Pipelines;
+
+public:
+    VulkanPipelineRegistry(VulkanCoreWeak vVulkanCore);
+    ~VulkanPipelineRegistry();
+
+    bool Init();
+    void Unit();
+
+    // at the start of the frame, destroy the objects not referenced since SWAPCHAIN_IMAGES_COUNT frames
+    void BeginFrame();
+
+    // the shader module of a spirv, created if needed
+    vk::ShaderModule AcquireShaderModule(const std::vector<unsigned int>& vSpirv);
+    void ReleaseShaderModule(const vk::ShaderModule& vShaderModule);
+
+    // vKey must identify the set layouts bindings and the push constant ranges of vCreateInfo
+    vk::PipelineLayout AcquirePipelineLayout(const uint64_t& vKey, const vk::PipelineLayoutCreateInfo& vCreateInfo);
+    void ReleasePipelineLayout(const vk::PipelineLayout& vPipelineLayout);
+
+    // return the pipeline of vKey with one more reference, or nullptr if not registered
+    vk::Pipeline FindPipeline(const uint64_t& vKey);
+
+    // register a pipeline created by the caller, the registry take the ownership
+    // if the key was registered in the meantime by another thread, vPipeline is destroyed and the registered one is returned
+    vk::Pipeline AddPipeline(const uint64_t& vKey, const vk::Pipeline& vPipeline);
+
+    // return false if the pipeline is not owned by the registry
+    bool ReleasePipeline(const vk::Pipeline& vPipeline);
+
+    size_t GetShaderModulesCount() const;
+    size_t GetPipelineLayoutsCount() const;
+    size_t GetPipelinesCount() const;
+
+private:
+    template <typename T>
+    static uint64_t GetHandleKey(const T& vObject);
+    template <typename T>
+    T Acquire(ObjectsContainer<T>& vContainer, const uint64_t& vKey);
+    template <typename T>
+    T Add(ObjectsContainer<T>& vContainer, const uint64_t& vKey, const T& vObject);
+    template <typename T>
+    bool Release(ObjectsContainer<T>& vContainer, const T& vObject);
+    template <typename T>
+    void DestroyUnused(ObjectsContainer<T>& vContainer, const bool& vForce);
+    void DestroyObject(const vk::ShaderModule& vObject);
+    void DestroyObject(const vk::PipelineLayout& vObject);
+    void DestroyObject(const vk::Pipeline& vObject);
+};
+}  // namespace GaiApi
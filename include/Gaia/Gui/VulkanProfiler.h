@@ -20,6 +20,7 @@ limitations under the License.
 #include <cmath>
 #include <array>
 #include <stack>
+#include <mutex>
 #include <memory>
 #include <cstdint>
 #include <vector>
@@ -190,7 +191,7 @@ private:
     uint32_t ids[2] = {0U, 0U};
     vkProfQueryZoneWeak m_This;
     bool m_IsRoot = false;
-    //const void* m_Ptr = nullptr;
+    const void* m_Ptr = nullptr;
     double m_ElapsedTime = 0.0;
     double m_StartTime = 0.0;
     double m_EndTime = 0.0;
@@ -306,6 +307,10 @@ private:
 
     std::unordered_map<std::string, CommandBufferInfos> m_CommandBuffers;
 
+    // build times and statistics of the pipelines by ptr (summary, details), set from the worker threads too
+    std::mutex m_PipelineInfosMutex;
+    std::unordered_map<const void*, std::pair<std::string, std::string>> m_PipelineInfos;
+
     std::stack<vkProfQueryZoneWeak> m_QueryStack;
 
     char m_TempBuffer[1024] = {};
@@ -354,6 +359,11 @@ public:
     CommandBufferInfos* GetCommandBufferInfosPtr(const void* vPtr, const std::string& vSection, const char* fmt, ...);
     CommandBufferInfos* GetCommandBufferInfosPtr(const void* vPtr, const std::string& vSection, const char* fmt, va_list vArgs);
 
+    // pipeline infos of vPtr, shown in the details next to the first zone of vPtr (the summary in a column, the details in a tooltip)
+    void SetPipelineInfos(const void* vPtr, const std::string& vSummary, const std::string& vDetails);
+    bool GetPipelineInfos(const void* vPtr, std::string& vOutSummary, std::string& vOutDetails);
+    void RemovePipelineInfos(const void* vPtr);
+
 private:
     void m_ClearMeasures();
     void m_AddMeasure();
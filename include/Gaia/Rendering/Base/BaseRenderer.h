@@ -111,6 +111,9 @@ public:  // contructor
     ShaderPassWeak GetGenericPass(const uint32_t& vIdx);
     void ClearGenericPasses();
 
+    // ratio of the passes without pipeline build in progress, 1.0f when all the pipelines are built
+    float GetPipelineBuildProgress() const;
+
     // during init
     virtual void ActionBeforeInit();
     virtual void ActionAfterInitSucceed();
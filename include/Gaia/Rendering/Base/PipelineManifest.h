@@ -0,0 +1,87 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <map>
+#include <set>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+manifest of the pipeline variants and specialization constants used by the passes during a session
+saved at exit and loaded at the next launch, so the passes can prebuild them on worker threads
+before the first frame who need them (no hitch when a variant is enabled for the first time)
+
+a pass is found by its key (debug name + shader names, see ShaderPass::GetPipelineManifestKey)
+the pipelines who was needed at draw time but not prebuilt are reported as misses
+
+usage : create it, LoadFromFile and give it to VulkanCore::setPipelineManifest before the creation of the passes
+then SaveToFile before VulkanCore::Unit, the misses are logged at the Unit
+
+file format (little endian) :
+- magic 'GPMF', version, count of passes
+- for each pass : key, variants (uint64_t), specialization constants sets (count, then constant id, value),
+  static states keys of the base pipeline (uint64_t)
+the strings are stored as size (uint32_t) + chars
+*/
+
+class GAIA_API PipelineManifest {
+public:
+    static constexpr uint32_t s_Magic = 0x464D5047;  // 'GPMF'
+    static constexpr uint32_t s_Version = 2U;
+
+    typedef std::map<uint32_t, uint32_t> SpecializationConstants;  // constant id => value
+
+    struct PassEntry {
+        std::set<uint64_t> variants;
+        std::set<SpecializationConstants> constants;
+        std::set<uint64_t> staticStatesKeys;  // see ShaderPass::GetStaticStatesKey
+    };
+
+public:
+    static PipelineManifestPtr Create();
+
+private:
+    mutable std::mutex m_Mutex;
+    std::map<std::string, PassEntry> m_Loaded;    // previous session, used for the prewarm
+    std::map<std::string, PassEntry> m_Recorded;  // this session, saved by SaveToFile
+    std::vector<std::string> m_Misses;
+
+public:
+    bool LoadFromFile(const std::string& vFilePathName);
+    bool LoadFromMemory(const uint8_t* vDatas, const size_t& vSize);
+    bool SaveToFile(const std::string& vFilePathName) const;
+
+    // what was used by the pass during the previous session
+    bool GetPassEntry(const std::string& vPassKey, PassEntry& vOutEntry) const;
+
+    void RecordVariant(const std::string& vPassKey, const uint64_t& vVariant);
+    void RecordConstants(const std::string& vPassKey, const SpecializationConstants& vConstants);
+    void RecordStaticStates(const std::string& vPassKey, const uint64_t& vStaticStatesKey);
+
+    // a pipeline was built synchronously at draw time
+    void AddMiss(const std::string& vPassKey, const std::string& vWhat);
+    size_t GetMissesCount() const;
+    std::string GetMissesReport() const;
+
+    void Clear();
+};
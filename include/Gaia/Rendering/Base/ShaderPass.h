@@ -21,17 +21,25 @@ limitations under the License.
 #include <set>
 #include <map>
 #include <string>
+#include <mutex>
+#include <future>
+#include <cstring>
 
 #include <Gaia/gaia.h>
 
 #include <Gaia/Rendering/Base.h>
+#include <Gaia/Shader/SpirvReflection.h>
 
 #include <Gaia/Core/VulkanCore.h>
 #include <Gaia/Core/VulkanDevice.h>
+#include <Gaia/Core/VulkanPipelineBuilder.h>
 #include <Gaia/Shader/VulkanShader.h>
+#include <Gaia/Shader/ShaderIncludeCache.h>
 #include <Gaia/Resources/Texture2D.h>
 #include <Gaia/Buffer/ComputeBuffer.h>
 #include <Gaia/Resources/VulkanRessource.h>
+#include <Gaia/Resources/UniformBlockStd140.h>
+#include <Gaia/Resources/StorageBufferStd430.h>
 #include <Gaia/Resources/VulkanFrameBuffer.h>
 #include <Gaia/Interfaces/OutputSizeInterface.h>
 #include <Gaia/Resources/VulkanComputeImageTarget.h>
@@ -65,20 +73,57 @@ protected:  // internal struct
         std::string m_FilePathName;         // file path name on disk drive
         std::string m_EntryPoint;           // entry point
         vk::ShaderModule m_ShaderModule = nullptr;
+        std::string m_ShaderName;           // shader name, for the compilation
+        std::string m_ShaderSuffix;         // shader suffix (vert, frag, comp..), for the compilation
+        ShaderIncludeCache::DependenciesContainer m_Dependencies;  // files used by the last compilation (file path name, content hash)
+        std::unordered_map<std::string, bool> m_UsedUniforms;     // used uniforms at the last compilation
+        std::set<std::string> m_UsedBindings;                      // used bindings at the last compilation
+        SpirvReflection::ReflectionDatas m_Reflection;             // reflection of m_SPIRV
         bool m_Used = false;  // say if a sahder mut be take into account
         vk::ShaderStageFlagBits m_ShaderId = vk::ShaderStageFlagBits::eVertex;
     };
+    typedef std::map<vk::ShaderStageFlagBits, std::map<ShaderEntryPoint, std::vector<ShaderCode>>> ShaderCodesContainer;
+    typedef std::set<std::pair<vk::ShaderStageFlagBits, ShaderEntryPoint>> ShaderStagesContainer;
+    typedef GaiApi::VulkanPipelineBuilder::SpecializationConstantsContainer SpecializationConstantsContainer;
+    typedef GaiApi::VulkanPipelineBuilder::PipelineVariantKey PipelineVariantKey;
+    typedef GaiApi::VulkanPipelineBuilder::PipelineStruct PipelineStruct;
+    typedef GaiApi::VulkanPipelineBuilder::PipelineBuildStatesStruct PipelineBuildStatesStruct;
+    typedef GaiApi::VulkanPipelineBuilder::DynamicStatesSupportStruct DynamicStatesSupportStruct;
+    typedef uint64_t ShaderVariantKey;  // one bit by declared shader keyword
 
     struct DescriptorSetStruct {
         vk::DescriptorSet m_DescriptorSet = {};
         vk::DescriptorSetLayout m_DescriptorSetLayout = {};
         std::vector<vk::DescriptorSetLayoutBinding> m_LayoutBindings = {};
         std::vector<vk::WriteDescriptorSet> m_WriteDescriptorSets = {};
+        std::map<uint32_t, const uint32_t*> m_DynamicOffsetPtrs = {};  // binding => dynamic offset, sorted by binding like needed by vulkan
+        std::vector<uint32_t> m_DynamicOffsets = {};                   // filled at bind time from m_DynamicOffsetPtrs
+        std::vector<vk::WriteDescriptorSet> m_UsedWriteDescriptorSets = {};  // m_WriteDescriptorSets used by the shaders, filled at update time
+        bool m_IsReflected = false;  // layout deduced from the spirv, recreated when the shaders use other bindings
     };
 
-    struct PipelineStruct {
-        vk::PipelineLayout m_PipelineLayout = {};
-        vk::Pipeline m_Pipeline = {};
+    // result of a background hot reload, filled by the worker thread
+    struct HotReloadStruct {
+        ShaderCodesContainer m_ShaderCodes;
+        std::unordered_map<std::string, bool> m_UsedUniforms;
+        std::set<std::string> m_UsedBindings;
+        SpecializationConstantsContainer m_SpecializationConstants;
+        uint64_t m_StaticStatesKey = 0U;  // see GetStaticStatesKey
+        PipelineStruct m_Pipeline;
+        ShaderVariantKey m_Variant = 0U;
+        uint64_t m_Generation = 0U;  // see m_VariantsGeneration
+        bool m_Succeed = false;
+        bool m_NeedNewLayout = false;  // the shaders use other bindings than the reflected layout, m_Pipeline is built at the swap
+    };
+
+    // a uniform block promoted to a push constant block
+    // glsl allow only one push constant block by stage, but all the stages share the same push constant area
+    // so each block have his own range, 16 bytes aligned after the internal range and the blocks promoted before him
+    struct PushConstantBlockStruct {
+        std::string m_BlockName;
+        UniformBlockStd140* m_UniformBlockPtr = nullptr;
+        vk::ShaderStageFlags m_Stages = {};
+        uint32_t m_Offset = 0U;  // offset in the push constant area, set on the first member by RewritePromotedUniformBlocks
     };
 
 private:
@@ -99,6 +144,48 @@ private:
 private:  // Tesselation
     uint32_t m_PatchControlPoints = 3U;
 
+private:  // shader variants
+    std::vector<std::string> m_ShaderKeywords;  // declared keywords, the index is the bit in the variant key
+    ShaderVariantKey m_WantedVariant = 0U;
+    ShaderVariantKey m_CurrentVariant = 0U;  // variant of m_ShaderCodes and m_Pipelines[0]
+    uint64_t m_VariantsGeneration = 0U;      // incremented when the warm variants are dropped, the running jobs are then ignored
+    std::unordered_map<ShaderVariantKey, HotReloadStruct> m_ShaderVariants;                  // warm variants, others than the current one
+    std::unordered_map<ShaderVariantKey, std::future<HotReloadStruct>> m_ShaderVariantJobs;  // variants in compilation
+
+private:  // specialization constants
+    SpecializationConstantsContainer m_SpecializationConstants;                         // wanted values
+    SpecializationConstantsContainer m_BuiltSpecializationConstants;                    // values of m_Pipelines[0]
+    bool m_LocalGroupSizeSpecialized = false;
+    ez::uvec3 m_LocalGroupSizeConstantIds = ez::uvec3(0U, 1U, 2U);
+    ez::uvec3 m_MaxComputeWorkGroupSize = 0U;   // device limits, queried once
+    ez::uvec3 m_MaxComputeWorkGroupCount = 0U;  // device limits, queried once
+
+private:  // extended dynamic states
+    DynamicStatesSupportStruct m_DynamicStatesSupport;
+    uint64_t m_BuiltStaticStatesKey = 0U;  // static states of m_Pipelines[0]
+    uint64_t m_FailedStaticStatesKey = UINT64_MAX;  // static states whose pipeline build failed, not retried at each frame
+
+private:  // pipeline build
+    // the builds, the graphics pipeline library links, the specialized pipelines, the manifest records and the statistics
+    // the retired pipelines are destroyed by him when no frame in flight can use them
+    GaiApi::VulkanPipelineBuilder m_PipelineBuilder;
+    bool m_UseGraphicsPipelineLibrary = true;
+
+private:  // pipeline manifest
+    bool m_PipelineManifestPrewarmed = false;
+
+private:  // spirv optimization
+    SpirvOptimizationMode m_SpirvOptimizationMode = SpirvOptimizationMode::SPIRV_OPTIMIZATION_DEFAULT;
+
+private:  // background hot reload
+    bool m_BackgroundHotReload = true;
+    bool m_HotReloadNeededAgain = false;  // a file was changed during a background compilation
+    std::future<HotReloadStruct> m_HotReloadFuture;
+
+private:  // asynchronous pipeline creation
+    bool m_AsyncPipelineCreation = false;
+    std::future<PipelineStruct> m_PipelineBuildFuture;
+
 protected:
     bool m_Loaded = false;
     bool m_DontUseShaderFilesOnDisk = false;
@@ -123,6 +210,7 @@ protected:
     // Framebuffer
     FrameBufferWeak m_LoanedFrameBufferWeak;  // when loaned
     FrameBufferPtr m_FrameBufferPtr = nullptr;
+    bool m_UseDynamicRendering = false;
     ComputeBufferPtr m_ComputeBufferPtr = nullptr;
     bool m_ResizingByResizeEventIsAllowed = true;
     bool m_ResizingByHandIsAllowed = true;
@@ -135,7 +223,7 @@ protected:
     float m_OutputRatio = 1.0f;
 
     std::map<vk::ShaderStageFlagBits, std::set<ShaderEntryPoint>> m_ShaderEntryPoints;
-    std::map<vk::ShaderStageFlagBits, std::map<ShaderEntryPoint, std::vector<ShaderCode>>> m_ShaderCodes;
+    ShaderCodesContainer m_ShaderCodes;
 
     bool m_IsShaderCompiled = false;
     bool m_DescriptorWasUpdated = false;
@@ -147,7 +235,6 @@ protected:
 
     // m_Pipelines[0]
     std::vector<PipelineStruct> m_Pipelines = {PipelineStruct()};  // one entry by default
-    vk::PipelineCache m_PipelineCache = {};
     std::vector<vk::PipelineShaderStageCreateInfo> m_ShaderCreateInfos;
     std::vector<vk::PipelineColorBlendAttachmentState> m_BlendAttachmentStates;
     std::vector<vk::RayTracingShaderGroupCreateInfoKHR> m_RayTracingShaderGroups;  // Shader groups
@@ -158,6 +245,7 @@ protected:
     ez::uvec4 m_CountIterations = ez::uvec4(0U, 10U, 1U, 1U);  // rendering iterations loop
 
     std::unordered_map<std::string, bool> m_UsedUniforms;  // Used Uniforms
+    std::set<std::string> m_UsedBindings;  // binding keys (see VulkanShader::GetBindingKey) and block names reached by the code
 
     GenericType m_RendererType = GenericType::NONE;  // Renderer Type
 
@@ -171,10 +259,16 @@ protected:
     vk::PolygonMode m_PolygonMode = vk::PolygonMode::eFill;
     vk::CullModeFlagBits m_CullMode = vk::CullModeFlagBits::eNone;
     vk::FrontFace m_FrontFaceMode = vk::FrontFace::eCounterClockwise;
+    bool m_DepthTestEnabled = true;   // ignored when the blending is enabled
+    bool m_DepthWriteEnabled = true;  // ignored when the blending is enabled
 
     VertexStruct::PipelineVertexInputState m_InputState;
 
     vk::PushConstantRange m_Internal_PushConstants;
+    std::vector<PushConstantBlockStruct> m_PushConstantBlocks;
+    std::vector<PushConstantBlockStruct> m_PromotableUniformBlocks;  // promoted at each compilation if they fit
+    uint32_t m_MaxPushConstantsSize = 0U;  // queried one time at the first promotion
+    std::vector<UniformBlockStd140*> m_UniformArenaBlocks;  // re-pushed at each frame, the arena is reseted by VulkanCore
 
     bool m_Tesselated = false;
     std::string m_HeaderCode;
@@ -353,6 +447,15 @@ public:
     void SetCountIterations(const uint32_t& vCountIterations);
     void SetLineWidth(const float& vLineWidth);
 
+    // fixed function states. if the device support the extended dynamic states they are set at record time
+    // else the pipeline of the new states is built at the next frame boundary, and kept for the next switchs
+    void SetCullMode(const vk::CullModeFlagBits& vCullMode);
+    void SetFrontFace(const vk::FrontFace& vFrontFace);
+    void SetPolygonMode(const vk::PolygonMode& vPolygonMode);
+    void SetBlendingEnabled(const bool& vFlag);
+    void SetDepthTestEnabled(const bool& vTest, const bool& vWrite);
+    void SetPatchControlPoints(const uint32_t& vCount);
+
     // swap and write output descriptors imageinfos, in case of multipass
     // xecuted jsut before compute()
     virtual void SwapMultiPassFrontBackDescriptors();
@@ -407,6 +510,65 @@ public:
     // shader update from file
     void UpdateShaders(const std::set<std::string>& vFiles);
 
+    // the hot reload compile and build the new pipeline on a worker thread, while the old one keep rendering
+    // the new pipeline is swapped at the next frame boundary, only for the pixel and compute 2D/3D passes
+    // the virtual CompilGLSLToSpirv is not used in this mode. enabled by default
+    void SetBackgroundHotReload(const bool& vFlag);
+    bool IsHotReloadPending() const;
+
+    // the pipeline of CreatePixelPipeline / CreateComputePipeline is built on a worker thread
+    // the pass is not rendered until his pipeline is ready, the pipeline is swapped at the next frame boundary
+    // to call before the init. disabled by default
+    void SetAsyncPipelineCreation(const bool& vFlag);
+    bool IsPipelineBuildPending() const;
+
+    // with VK_EXT_graphics_pipeline_library, the parts of the pixel pipelines (vertex input, pre rasterization, fragment shader, fragment output)
+    // are built and cached separately, then fast linked. the optimized link is done on a worker thread and swapped at a next frame boundary
+    // enabled by default when supported
+    void SetUseGraphicsPipelineLibrary(const bool& vFlag);
+
+    // the framebuffer of InitPixel is rendered with VK_KHR_dynamic_rendering, without renderpass and framebuffer objects
+    // to call before InitPixel. disabled by default, ignored if not supported
+    void SetUseDynamicRendering(const bool& vFlag);
+
+    // the build time of the pipelines (and if the pipeline cache was hit) is collected when VK_EXT_pipeline_creation_feedback is supported
+    // the statistics of the executables (registers, instructions..) need VK_KHR_pipeline_executable_properties and this flag, since
+    // the capture can slow down the build. disabled by default, to call before the pipeline creation
+    // both are shown in the details of vkProfiler next to the zones of the pass
+    void SetCapturePipelineStatistics(const bool& vFlag);
+    std::string GetPipelineStatisticsReport() const;
+
+    // optimization of the spirv of this pass, DEFAULT use the global mode of VulkanShader
+    // to call before the compilation
+    void SetSpirvOptimizationMode(const SpirvOptimizationMode& vMode);
+
+    // shader permutations : a declared keyword is inserted as #define after the #version line when enabled
+    // a variant is compiled the first time he is requested or prewarmed, on a worker thread for the pixel and compute passes
+    // the switch is done at the frame boundary, for a warm variant this is a lookup
+    bool DeclareShaderKeyword(const std::string& vKeyword);  // 64 keywords max
+    void SetShaderKeyword(const std::string& vKeyword, const bool& vEnabled);
+    void SetShaderVariant(const ShaderVariantKey& vVariant);
+    ShaderVariantKey GetShaderVariantKey(const std::set<std::string>& vKeywords) const;
+    ShaderVariantKey GetCurrentShaderVariant() const;
+    bool IsShaderVariantWarm(const ShaderVariantKey& vVariant) const;
+    void PrewarmShaderVariants(const std::vector<ShaderVariantKey>& vVariants);
+
+    // specialization constants of the pipeline, for all the stages. 32 bits values (int, uint, float, VkBool32)
+    // the pipelines are cached by values, so a change of values is a pipeline lookup at the next frame, not a recompilation
+    template <typename T>
+    void SetSpecializationConstant(const uint32_t& vConstantId, const T& vValue) {
+        static_assert(sizeof(T) == sizeof(uint32_t), "a specialization constant must be 32 bits");
+        uint32_t value = 0U;
+        memcpy(&value, &vValue, sizeof(uint32_t));
+        SetSpecializationConstantValue(vConstantId, value);
+    }
+    void SetSpecializationConstantValue(const uint32_t& vConstantId, const uint32_t& vValue);
+
+    // the local group size is given to the compute shader by the specialization constants vConstantIds
+    // the shader must declare GetLocalGroupSizeLayout() in place of local_size_x/y/z
+    void UseLocalGroupSizeSpecialization(const ez::uvec3& vConstantIds = ez::uvec3(0U, 1U, 2U));
+    std::string GetLocalGroupSizeLayout() const;
+
     void NeedToClearFBOThisFrame();
 
     void SetHeaderCode(const std::string& vHeaderCode);
@@ -424,6 +586,18 @@ public:
 
     virtual bool ReCompilCode();
 
+    // say if a uniform or a sampler is used by the compiled shaders
+    // if the usage is unknown (not compiled or no infos) all is considered as used
+    bool IsUniformUsed(const std::string& vName) const;
+
+    // say if a block is reached by the code of the compiled shaders
+    // if the usage is unknown (not compiled or no infos) all is considered as used
+    bool IsBlockUsed(const std::string& vBlockName) const;
+
+    // say if a binding is used by the compiled shaders, for skip the loading of unused textures for instance
+    // if the usage is unknown (not compiled or no infos) all is considered as used
+    bool IsBindingUsed(const uint32_t& vBindingPoint, const uint32_t& vDescriptorSetIndex = 0U) const;
+
     // Texture Use Helper
     void EnableTextureUse(const uint32_t& vBindingPoint, const uint32_t& vTextureSLot, float& vTextureUseVar);
     void DisableTextureUse(const uint32_t& vBindingPoint, const uint32_t& vTextureSLot, float& vTextureUseVar);
@@ -481,10 +655,14 @@ protected:
         const std::string& vShaderName,
         const std::string& vEntryPoint = "main");
     ShaderCode CompilShaderCode(const vk::ShaderStageFlagBits& vShaderType, const std::string& vEntryPoint = "main");
+    ShaderCode PrepareShaderCode(const vk::ShaderStageFlagBits& vShaderType, const std::string& vEntryPoint = "main");
+    void SyncShaderCodeWithFile(ShaderCode& vShaderCode);
+    void AddCompilationDependencies(ShaderCode& vShaderCode, const SpirvBundle::KeySource& vBundleKeySource);
     virtual const std::vector<unsigned int> CompilGLSLToSpirv(const std::string& vCode,
         const std::string& vShaderSuffix,
         const std::string& vOriginalFileName,
-        const ShaderEntryPoint& vEntryPoint = "main");
+        const ShaderEntryPoint& vEntryPoint = "main",
+        const SpirvBundle::KeySource* vBundleKeySource = nullptr);
     virtual bool CompilPixel();
     virtual bool CompilCompute();
     virtual bool CompilRtx();
@@ -503,6 +681,15 @@ protected:
     virtual void UploadUBO();
     virtual void DestroyUBO();
 
+    // create the block in the uniform arena of VulkanCore, the pass re-push it at each frame in UpdateRessourceDescriptor
+    bool CreateUniformArenaBlock(UniformBlockStd140& vUniformBlock);
+
+    // upload the block only if his binding is used by the shaders, else he stay dirty until he is used
+    bool UploadUniformBlockIfUsed(
+        UniformBlockStd140& vUniformBlock, const uint32_t& vBindingPoint, const uint32_t& vDescriptorSetIndex = 0U, const bool& vOnlyIfDirty = true);
+    bool UploadStorageBufferIfUsed(
+        StorageBufferStd430& vStorageBuffer, const uint32_t& vBindingPoint, const uint32_t& vDescriptorSetIndex = 0U, const bool& vOnlyIfDirty = true);
+
     // Storage Buffer Object
     virtual bool CreateSBO();
     void NeedNewSBOUpload();
@@ -514,8 +701,20 @@ protected:
     virtual bool UpdateLayoutBindingInRessourceDescriptor();
     virtual bool UpdateBufferInfoInRessourceDescriptor();
 
-    // MipMapping
-    void UpdateMipMappingIfNeeded();
+    // layout bindings of a descriptor set deduced from the spirv of all the used stages
+    // can be called from a worker thread, the dynamic buffers are only known by the writes (see GetDynamicDescriptorTypes)
+    std::vector<vk::DescriptorSetLayoutBinding> GetReflectedLayoutBindings(const ShaderCodesContainer& vShaderCodes,
+        const uint32_t& vDescriptorSetIndex,
+        const std::map<uint32_t, vk::DescriptorType>* vDynamicTypesPtr = nullptr) const;
+    std::map<uint32_t, vk::DescriptorType> GetDynamicDescriptorTypes(const uint32_t& vDescriptorSetIndex) const;
+    // recreate the reflected layouts and their descriptor sets if the bindings of vShaderCodes are not the same
+    // true if a layout was recreated, so the pipelines built with the old one must be rebuilded
+    bool UpdateReflectedDescriptorSets(const ShaderCodesContainer& vShaderCodes);
+    // false if a binding of a reflected layout have no write descriptor of his type
+    bool CheckWritesOfReflectedLayout(const uint32_t& vDescriptorSetIndex) const;
+
+    // MipMapping, recorded after the rendering
+    void UpdateMipMappingIfNeeded(vk::CommandBuffer* vCmdBufferPtr);
 
     void ClearWriteDescriptors();
     void ClearWriteDescriptors(const uint32_t& vDescriptorSetIndex);
@@ -529,6 +728,12 @@ protected:
         const vk::DescriptorBufferInfo* vBufferInfo,
         const uint32_t& vCount = 1U,
         const uint32_t& vDescriptorSetIndex = 0U);
+    // for a UNIFORM_BUFFER_DYNAMIC, like a UniformBlockStd140 in the uniform arena
+    // the value pointed by vDynamicOffsetPtr will be read at each BindDescriptorSet
+    bool AddOrSetWriteDescriptorDynamicBuffer(const uint32_t& vBindingPoint,
+        const vk::DescriptorBufferInfo* vBufferInfo,
+        const uint32_t* vDynamicOffsetPtr,
+        const uint32_t& vDescriptorSetIndex = 0U);
     bool AddOrSetWriteDescriptorBufferView(const uint32_t& vBindingPoint,
         const vk::DescriptorType& vType,
         const vk::BufferView* vBufferView,
@@ -555,13 +760,91 @@ protected:
     bool CreateRessourceDescriptor();
     void DestroyRessourceDescriptor();
 
+    // bind the descriptor set with the dynamic offsets of his dynamic buffers
+    void BindDescriptorSet(vk::CommandBuffer* vCmdBufferPtr, const vk::PipelineBindPoint& vBindPoint, const uint32_t& vDescriptorSetIndex = 0U);
+
     // push constants
     void SetPushConstantRange(const vk::PushConstantRange& vPushConstantRange);
 
+    /// <summary>
+    /// will promote a small uniform block to a push constant block if he fit in maxPushConstantsSize after the other ranges
+    /// and if his stages have no other push constant block. must be called after the vars registering
+    /// and before the shader compilation (ActionBeforeCompilation). the glsl declaration of vBlockName
+    /// will be rewritten as a push_constant block and the datas will be pushed in StartDrawPass
+    /// </summary>
+    /// <returns>true if promoted, so the block must not be added in the layout and write descriptors</returns>
+    bool PromoteUniformBlockToPushConstants(const std::string& vBlockName, UniformBlockStd140* vUniformBlockPtr, const vk::ShaderStageFlags& vStages);
+    // the block will be promoted automatically before each compilation if he fit in maxPushConstantsSize
+    // check UniformBlockStd140::IsUsingPushConstants before adding his layout and write descriptors
+    void AddPromotableUniformBlock(const std::string& vBlockName, UniformBlockStd140* vUniformBlockPtr, const vk::ShaderStageFlags& vStages);
+    void PromoteUniformBlocksIfPossible();
+    void ClearPromotedUniformBlocks();
+    void PushPromotedUniformBlocks(vk::CommandBuffer* vCmdBufferPtr);
+    std::vector<vk::PushConstantRange> GetPushConstantRanges() const;
+    std::string RewritePromotedUniformBlocks(const std::string& vCode, const vk::ShaderStageFlagBits& vShaderType) const;
+
     // Pipelines
     virtual void SetInputStateBeforePipelineCreation();  // for doing this kind of thing VertexStruct::P2_T2::GetInputState(m_InputState);
     virtual bool CreateComputePipeline();
     virtual bool CreatePixelPipeline();
     virtual bool CreateRtxPipeline();
+    // the builds are done by m_PipelineBuilder, from the spirv of the used stages (see GetShaderSpirvs)
+    bool BuildComputePipeline(const ShaderCodesContainer& vShaderCodes,
+        const PipelineBuildStatesStruct& vStates,
+        PipelineStruct& vOutPipeline,
+        const SpecializationConstantsContainer& vConstants);
+    bool BuildPixelPipeline(const ShaderCodesContainer& vShaderCodes,
+        const PipelineBuildStatesStruct& vStates,
+        PipelineStruct& vOutPipeline,
+        const SpecializationConstantsContainer& vConstants);
     void DestroyPipeline();
+    void DestroyPipelineStruct(PipelineStruct& vPipeline);
+
+private:  // pipeline registry, share the pipelines between the passes with the same shaders and states
+    PipelineBuildStatesStruct CapturePipelineBuildStates();  // on the render thread, before the launch of a build
+    static GaiApi::VulkanPipelineBuilder::ShaderSpirvsContainer GetShaderSpirvs(const ShaderCodesContainer& vShaderCodes);
+    uint64_t GetPipelineLayoutKey(const std::vector<vk::PushConstantRange>& vPushConstants) const;
+    uint64_t GetRenderPassCompatibilityKey() const;  // 0 if unknown, so the pipeline can't be shared
+    const vk::PipelineRenderingCreateInfoKHR* GetPipelineRenderingCreateInfo() const;  // nullptr if not dynamic rendering
+
+private:  // graphics pipeline library
+    PipelineStruct* FindPipelineStruct(const vk::Pipeline& vPipeline);  // the pipelines of the pass who can be optimized linked
+
+private:  // background hot reload
+    bool StartBackgroundReCompil(const ShaderStagesContainer& vStagesToCompile);
+    ShaderStagesContainer GetOutdatedStages();  // the used stages who depends on a changed file
+    void SwapHotReloadedPipelineIfReady();  // at frame boundary
+    bool PrepareLayoutForSwap(HotReloadStruct& vHotReload);  // false if the needed pipeline rebuild failed
+    bool StartPipelineBuild(const bool& vIsPixel);
+    void CollectPipelineBuild();  // at frame boundary
+    void WaitPipelineBuild();
+    void WaitBackgroundReCompil();
+
+private:  // shader variants
+    std::future<HotReloadStruct> LaunchPipelineJob(const ShaderStagesContainer& vStagesToCompile, const ShaderVariantKey& vVariant);
+    std::string ApplyShaderVariant(const std::string& vCode, const ShaderVariantKey& vVariant) const;
+    // the key of the spirv bundle is computed from the code before ApplyShaderVariant and RewritePromotedUniformBlocks
+    SpirvBundle::KeySource GetBundleKeySource(const std::string& vCode, const ShaderVariantKey& vVariant, const vk::ShaderStageFlagBits& vShaderType) const;
+    bool IsBackgroundCompilationPossible() const;
+    void UpdateShaderVariant();  // at frame boundary
+    void CollectShaderVariantJobs();
+    void WaitShaderVariantJobs();
+    void DestroyShaderVariants(const bool& vRetire);
+
+private:  // specialization constants
+    void UpdateSpecializedPipeline();  // at frame boundary
+    void LaunchSpecializedPipelineJob(const SpecializationConstantsContainer& vConstants);
+    void DestroySpecializedPipelines(const bool& vRetire);
+    void QueryComputeLimits();
+
+private:  // pipeline manifest
+    std::string GetPipelineManifestKey() const;  // debug name + shader names, stable between the sessions
+    void PrewarmFromPipelineManifest();           // at frame boundary, once
+    bool IsBasePipelineInManifest() const;        // the base pipeline with the current static states was used in the previous session
+    void RecordInPipelineManifest();              // at frame boundary
+
+private:  // extended dynamic states
+    void QueryDynamicStatesSupport();
+    uint64_t GetStaticStatesKey() const;  // hash of the fixed function states not dynamic on this device
+    void SetDynamicStates(vk::CommandBuffer* vCmdBufferPtr);
 };
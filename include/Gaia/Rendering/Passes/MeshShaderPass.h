@@ -80,8 +80,7 @@ void MeshShaderPass<T_VertexType>::DrawModel(vk::CommandBuffer* vCmdBufferPtr, c
     if (vCmdBufferPtr && m_Vertices.m_Count) {
         vCmdBufferPtr->bindPipeline(vk::PipelineBindPoint::eGraphics, m_Pipelines[0].m_Pipeline);
 
-        vCmdBufferPtr->bindDescriptorSets(
-            vk::PipelineBindPoint::eGraphics, m_Pipelines[0].m_PipelineLayout, 0, m_DescriptorSets[0].m_DescriptorSet, nullptr);
+        BindDescriptorSet(vCmdBufferPtr, vk::PipelineBindPoint::eGraphics);
 
         vk::DeviceSize offsets = 0;
         vCmdBufferPtr->bindVertexBuffers(0, m_Vertices.m_Buffer->buffer, offsets);
@@ -0,0 +1,110 @@
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+reorder the members of a std140 / std430 block for minimize the padding
+the alignement rules are the same as UniformBlockStd140 and StorageBufferStd430 : min(pow2(size), 16)
+the members are placed one by one, at each step the member who need the less padding at the current offset is choosen
+(the largest alignement first in case of equality), so a float can fill the hole after a vec3
+the glsl block declaration matching the cpu layout can be generated for the shader header
+the arrays (RegisterVar with a size greater than the type) and the matrices are placed with their stride :
+- an array element or a matrix column is padded to his base alignement (a vec3 take 16 bytes)
+- in std140, the array stride and the matrix columns are rounded to 16 bytes (a float[4] take 64 bytes, a mat3 48)
+the cpu datas are tightly packed (ex : float[4], glm::mat3), they are spread on the stride by WriteValue
+*/
+
+// the glsl type name of a cpu type, for the block declaration
+// can be specialized for custom types (ex : ez::ivec3 => "ivec3")
+// when the name is nullptr, the glsl type is deduced from the size (float, vec2, vec3, vec4, mat4)
+template <typename T>
+struct GlslTypeTraits {
+    static constexpr const char* name = nullptr;
+};
+template <>
+struct GlslTypeTraits<float> {
+    static constexpr const char* name = "float";
+};
+template <>
+struct GlslTypeTraits<double> {
+    static constexpr const char* name = "double";
+};
+template <>
+struct GlslTypeTraits<int32_t> {
+    static constexpr const char* name = "int";
+};
+template <>
+struct GlslTypeTraits<uint32_t> {
+    static constexpr const char* name = "uint";
+};
+
+class GAIA_API BufferLayoutOptimizer {
+public:
+    enum class LayoutStandard { STD140 = 0, STD430 };
+
+    struct Member {
+        std::string key;
+        std::string glslType;        // empty if unknown, type of an element for an array
+        uint32_t arrayCount = 0U;    // 0 if not an array
+        uint32_t size = 0U;          // size in bytes in the block
+        uint32_t align = 0U;         // base alignement
+        uint32_t offset = 0U;        // offset after Optimize
+        uint32_t chunkSize = 0U;     // array element or matrix column : size in the cpu datas
+        uint32_t chunkStride = 0U;   // and stride in the block. 0 if the cpu datas are copied as is
+        std::vector<uint8_t> value;  // initial value, in the block layout
+    };
+
+private:
+    LayoutStandard standard = LayoutStandard::STD140;
+    std::vector<Member> members;  // in registering order
+    std::unordered_map<std::string, size_t> chunkedMembers;  // members placed by Optimize with a stride => index in members
+    uint32_t declarationOrderSize = 0U;
+    uint32_t optimizedSize = 0U;
+
+public:
+    static uint32_t GetBaseAlignement(uint32_t vSize);
+    static std::string GetGlslTypeFromSize(uint32_t vSize);
+    // mat2, mat3x4, dmat4, ... false if not a matrix
+    static bool GetMatrixSize(const std::string& vGlslType, uint32_t& vOutColumns, uint32_t& vOutRows, uint32_t& vOutScalarSize);
+
+public:
+    explicit BufferLayoutOptimizer(LayoutStandard vStandard = LayoutStandard::STD140);
+
+    void Clear();
+    bool IsEmpty() const;
+
+    // add a member, vGlslType can be nullptr
+    // with vElementSize lower than vSizeInBytes, the member is an array of vElementSize elements and vGlslType is the element type
+    bool AddMember(const std::string& vKey, const char* vGlslType, const void* vValue, uint32_t vSizeInBytes, uint32_t vElementSize = 0U);
+
+    // compute the offsets of the members starting at vStartOffset
+    // return the members sorted by offset. with vReorder false, the registering order is kept
+    std::vector<Member> Optimize(uint32_t vStartOffset, bool vReorder);
+
+    // size of the members from vStartOffset in registering order and after optimization, for report the savings
+    uint32_t GetDeclarationOrderSize() const;
+    uint32_t GetOptimizedSize() const;
+
+    // copy the cpu datas of a member placed by Optimize in vDst (the block datas at his offset) on the array or matrix stride
+    // return the size written in the block, 0 if the member have no stride (the datas can then be copied as is)
+    uint32_t WriteValue(const std::string& vKey, const void* vValue, uint32_t vSizeInBytes, uint8_t* vDst) const;
+    // the reverse of WriteValue, vSrc is the block datas at the offset of the member
+    bool ReadValue(const std::string& vKey, const uint8_t* vSrc, void* vValue, uint32_t vSizeInBytes) const;
+
+    // ex : GetGlslBlockDeclaration("std140, binding = 1", "UBO_Frag", "ubo", offsets)
+    // the members are declared in the order of vOffsets, the members not in vOffsets are ignored
+    std::string GetGlslBlockDeclaration(const std::string& vLayoutQualifiers,
+        const std::string& vBlockName,
+        const std::string& vInstanceName,
+        const std::unordered_map<std::string, uint32_t>& vOffsets) const;
+
+private:
+    static uint32_t AlignOffset(uint32_t vOffset, uint32_t vAlign);
+    static void CopyChunks(const uint8_t* vSrc, uint32_t vSrcStride, uint8_t* vDst, uint32_t vDstStride, uint32_t vChunkSize, uint32_t vChunksCount);
+};
@@ -19,9 +19,11 @@ limitations under the License.
 
 #include <vulkan/vulkan.hpp>
 #include <Gaia/Resources/VulkanRessource.h>
+#include <Gaia/Resources/BufferLayoutOptimizer.h>
 #include <ezlibs/ezLog.hpp>
 
 #include <map>
+#include <array>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -30,6 +32,9 @@ limitations under the License.
 
 /*
 manage in auto the alignement of Buffer for the standard std430 only
+a cpu to gpu sbo is persistently mapped and only the modified ranges are uploaded
+with useFrameSlots, the sbo contain one slot per frame in flight (only for a sbo not written by the gpu)
+the first upload of a frame write in the next slot, and the next uploads of the frame write again in this slot
 */
 
 class GAIA_API StorageBufferStd430 {
@@ -48,6 +53,20 @@ private:
     // if new var as added, need recreation, because there is a new size
     bool needRecreation = false;
 
+private:  // frame slots
+    static constexpr uint32_t sFrameSlotsCount = GaiApi::VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT;
+    // ranges modified since the last upload in each slot (only the first is used without useFrameSlots)
+    std::array<VulkanDirtyRanges, sFrameSlotsCount> frameDirtyRanges;
+    uint32_t frameSlotSize = 0U;     // size of datas aligned on minStorageBufferOffsetAlignment
+    uint32_t currentFrameSlot = 0U;  // slot pointed by descriptorBufferInfo
+    uint64_t currentFrameSlotFrame = UINT64_MAX;  // arena frame of the last write in currentFrameSlot
+
+private:  // layout optimizer
+    bool useLayoutOptimizer = false;
+    bool layoutWasOptimized = false;
+    std::string layoutBlockName;
+    BufferLayoutOptimizer layoutOptimizer{BufferLayoutOptimizer::LayoutStandard::STD430};  // vars registered with RegisterVar, for the glsl declaration
+
 private:  // custom Buffer Info
     bool customBufferInfo = false;
 
@@ -55,6 +74,7 @@ public:  // vulkan object to share
     VulkanBufferObjectPtr bufferObjectPtr = nullptr;
     vk::DescriptorBufferInfo descriptorBufferInfo = {VK_NULL_HANDLE, 0, VK_WHOLE_SIZE};
     VmaMemoryUsage memoryUsage = VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY;
+    bool useFrameSlots = false;  // must be set before CreateSBO, for VMA_MEMORY_USAGE_CPU_TO_GPU only
 
 public:
     StorageBufferStd430() = default;
@@ -80,6 +100,16 @@ public:
     void DestroySBO();
     bool RecreateSBO(GaiApi::VulkanCoreWeak vVulkanCore);
 
+    // layout optimizer, must be called before the vars registering
+    // the vars registered with RegisterVar will be reordered for minimize the padding and placed at Build (or CreateSBO)
+    // so GetVar / SetVar can be used only after Build
+    void UseLayoutOptimizer(const std::string& vBlockName);
+    uint32_t GetLayoutSavedBytes() const;  // padding saved by the layout optimizer
+
+    // the glsl declaration matching the cpu layout of the vars registered with RegisterVar
+    // ex : GetGlslBlockDeclaration("std430, binding = 1", "UBO_Frag", "ubo")
+    std::string GetGlslBlockDeclaration(const std::string& vLayoutQualifiers, const std::string& vBlockName, const std::string& vInstanceName = "");
+
     // add size to uniform block, return startOffset
     bool RegisterByteSize(const std::string& vKey, uint32_t vSizeInBytes, uint32_t* vStartOffset = 0);
 
@@ -104,6 +134,12 @@ private:
     bool OffsetExist(const std::string& vKey);
     uint32_t GetGoodAlignement(uint32_t vSize);
     void AddOffsetForKey(const std::string& vKey, uint32_t vOffset);
+    uint32_t GetFrameSlotsCount();
+    // slot written by the current frame, the frames are the ones of the uniform arena
+    uint32_t GetFrameSlot(GaiApi::VulkanCoreWeak vVulkanCore);
+
+    // mark a range as modified for all frame slots
+    void SetDirtyRange(uint32_t vOffset, uint32_t vSizeInBytes);
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -112,10 +148,21 @@ private:
 
 template <typename T>
 void StorageBufferStd430::RegisterVar(const std::string& vKey, T* vValue, uint32_t vSizeInBytes) {
+    const char* glslType = (sizeof(T) == vSizeInBytes) ? GlslTypeTraits<T>::name : nullptr;
+    if (useLayoutOptimizer && !layoutWasOptimized) {
+        // will be placed at Build, a size greater than the type is an array, placed with his stride
+        const bool isArray = (sizeof(T) < vSizeInBytes) && !(sizeof(T) % 4U);
+        if (OffsetExist(vKey) ||
+            !layoutOptimizer.AddMember(vKey, isArray ? GlslTypeTraits<T>::name : glslType, vValue, vSizeInBytes, isArray ? (uint32_t)sizeof(T) : 0U)) {
+            LogVarDebugWarning("Debug : key %s is already defined in StorageBufferStd430. RegisterVar fail.", vKey.c_str());
+        }
+        return;
+    }
     uint32_t startOffset;
     if (RegisterByteSize(vKey, vSizeInBytes, &startOffset)) {
         // on copy de "startOffset" � "startOffset + vSizeInBytes"
         memcpy(datas.data() + startOffset, vValue, vSizeInBytes);
+        layoutOptimizer.AddMember(vKey, glslType, vValue, vSizeInBytes);
     }
 }
 
@@ -129,7 +176,9 @@ bool StorageBufferStd430::GetVar(const std::string& vKey, T& vValue) {
     if (OffsetExist(vKey)) {
         uint32_t offset = offsets[vKey];
         uint32_t size = sizeof(vValue);
-        memcpy(&vValue, datas.data() + offset, size);
+        if (!layoutOptimizer.ReadValue(vKey, datas.data() + offset, &vValue, size)) {
+            memcpy(&vValue, datas.data() + offset, size);
+        }
         return true;
     }
     LogVarDebugInfo("key %s not exist in UniformBlockStd140. GetVar fail.", vKey.c_str());
@@ -141,8 +190,14 @@ bool StorageBufferStd430::SetVar(const std::string& vKey, T* vValue, uint32_t vS
     if (OffsetExist(vKey) && vSizeInBytes > 0) {
         uint32_t newSize = vSizeInBytes;
         uint32_t offset = offsets[vKey];
-        memcpy(datas.data() + offset, vValue, newSize);
-        isDirty = true;
+        // the arrays and matrices placed by the layout optimizer are spread on their stride
+        const uint32_t layoutSize = layoutOptimizer.WriteValue(vKey, vValue, vSizeInBytes, datas.data() + offset);
+        if (layoutSize) {
+            newSize = layoutSize;
+        } else {
+            memcpy(datas.data() + offset, vValue, newSize);
+        }
+        SetDirtyRange(offset, newSize);
         return true;
     }
     LogVarDebugInfo("key %s not exist in UniformBlockStd140. SetVar fail.", vKey.c_str());
@@ -29,11 +29,21 @@ public:
     // static bool loadPNG(const std::string& inFile, std::vector<uint8_t>& outBuffer, uint32_t& outWidth, uint32_t& outHeight);
     static bool loadImage(const std::string& inFile, std::vector<uint8_t>& outBuffer, uint32_t& outWidth, uint32_t& outHeight, uint32_t& outChannels);
     static bool loadImageWithMaxH(const std::string& inFile, const uint32_t& maxHeight, uint32_t& outWidth, std::vector<uint8_t>& outBuffer);
+    // the texels are kept in the layout of the file : 1 to 4 channels, 8 bits, 16 bits (stbi_load_16) or float (stbi_loadf for the hdr)
+    static bool loadImageNative(const std::string& inFile,
+        std::vector<uint8_t>& outBuffer,
+        uint32_t& outWidth,
+        uint32_t& outHeight,
+        uint32_t& outChannels,
+        uint32_t& outBytesPerComponent);
     // static vk::DescriptorImageInfo GetImageInfoFromMemory(GaiApi::VulkanCoreWeak vVulkanCore, uint8_t* buffer, const uint32_t& width, const
     // uint32_t& height, const uint32_t& channels);
 
 public:
-    static Texture2DPtr CreateFromFile(GaiApi::VulkanCoreWeak vVulkanCore, std::string vFilePathName, const uint32_t& vMaxHeight = 0U);
+    static Texture2DPtr CreateFromFile(GaiApi::VulkanCoreWeak vVulkanCore,
+        std::string vFilePathName,
+        const uint32_t& vMaxHeight = 0U,
+        const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm);
     static Texture2DPtr CreateFromMemory(
         GaiApi::VulkanCoreWeak vVulkanCore, uint8_t* buffer, const uint32_t& width, const uint32_t& height, const uint32_t& channels);
     static Texture2DPtr CreateEmptyTexture(GaiApi::VulkanCoreWeak vVulkanCore, ez::uvec2 vSize, vk::Format vFormat);
@@ -58,6 +68,10 @@ public:
     Texture2D(GaiApi::VulkanCoreWeak vVulkanCore);
     ~Texture2D();
 
+    // the file is converted, expanded and resized on the gpu when possible, else on the cpu in rgba8
+    // with vFormat eUndefined, the format is deduced from the file : rgba8 unorm, rgba16 unorm or rgba32 float
+    // the KTX2 and DDS files are loaded with LoadContainerFile, the other params are ignored
+    // with a TextureDiskCache set in VulkanCore, the result is stored in it and loaded from it at the next call
     bool LoadFile(const std::string& vFilePathName,
         const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm,
         const uint32_t& vMipLevelCount = 1u,
@@ -68,6 +82,18 @@ public:
         const uint32_t& channels,
         const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm,
         const uint32_t& vMipLevelCount = 1u);
+    // the packed texels (1 to 4 channels of 8/16 bits unorm or 32 bits float) are converted to vFormat and resized to vSize on the gpu
+    // return false if the gpu conversion is not possible
+    bool LoadPackedMemory(const void* vBuffer,
+        const uint32_t& vWidth,
+        const uint32_t& vHeight,
+        const uint32_t& vChannels,
+        const uint32_t& vBytesPerComponent,
+        const ez::uvec2& vSize,
+        const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm,
+        const uint32_t& vMipLevelCount = 1u);
+    // KTX2 or DDS file, uploaded in the format of the file (block compressed or not) with its prebuilt mips
+    bool LoadContainerFile(const std::string& vFilePathName);
     bool LoadEmptyTexture(const ez::uvec2& vSize = 1, const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm);
     bool LoadEmptyImage(const ez::uvec2& vSize = 1, const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm);
     void Destroy();
@@ -79,5 +105,12 @@ public:
     bool SaveToHdr(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ez::uvec2& vNewSize);
     bool SaveToTga(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ez::uvec2& vNewSize);
 
-    bool UpdateMipMapping();
+    // recorded in vCmdBufferPtr if not null, else in a single time command
+    bool UpdateMipMapping(vk::CommandBuffer* vCmdBufferPtr = nullptr);
+
+private:
+    bool LoadFileOnGpu(const std::string& vFilePathName, const vk::Format& vFormat, const uint32_t& vMipLevelCount, const uint32_t& vMaxHeight);
+    bool LoadContainer(TextureContainer& vContainer);
+    void StoreInDiskCache(const std::string& vCacheKey);
+    void CreateViewAndSampler(const vk::Format& vFormat);
 };
\ No newline at end of file
@@ -27,6 +27,8 @@ limitations under the License.
 class GAIA_API Texture3D {
 public:
     static Texture3DPtr CreateEmptyTexture(GaiApi::VulkanCoreWeak vVulkanCore, ez::uvec3 vSize, vk::Format vFormat);
+    // KTX2 or DDS volume texture
+    static Texture3DPtr CreateFromFile(GaiApi::VulkanCoreWeak vVulkanCore, const std::string& vFilePathName);
 
 public:
     std::shared_ptr<VulkanImageObject> m_Texture3D = nullptr;
@@ -34,6 +36,7 @@ public:
     vk::Sampler m_Sampler = {};
     vk::DescriptorImageInfo m_DescriptorImageInfo = {};
     vk::Format m_ImageFormat = vk::Format::eR8G8B8A8Unorm;
+    uint32_t m_MipLevelCount = 1U;
     uint32_t m_Width = 1U;
     uint32_t m_Height = 1U;
     uint32_t m_Depth = 1U;
@@ -47,5 +50,7 @@ public:
     ~Texture3D();
 
     bool InitEmptyTexture(const ez::uvec3& vSize = 1, const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm);
+    // KTX2 or DDS file with a depth, uploaded in the format of the file (block compressed or not) with its prebuilt mips
+    bool LoadContainerFile(const std::string& vFilePathName);
     void Destroy();
 };
\ No newline at end of file
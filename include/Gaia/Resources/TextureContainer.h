@@ -0,0 +1,106 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+texture container files (KTX2 and DDS) with their prebuilt mips, array layers and cube faces
+the texels are kept as stored in the file, so the block compressed formats (BC1-7, ETC2, ASTC) are uploaded directly
+the datas are reordered level by level, and in a level layer by layer then face by face (the KTX2 order)
+so one vk::BufferImageCopy by level can copy all the layers and faces
+the KTX2 files with a supercompression (basis, zstd) are not supported
+when the device cant sample the format, BC1 to BC5 can be decompressed on the cpu to rgba8
+*/
+
+class GAIA_API TextureContainer {
+public:
+    struct Level {
+        uint64_t offset = 0U;  // offset of the level in the datas, 16 bytes aligned
+        uint64_t size = 0U;    // size of all the layers and faces of the level
+        uint32_t width = 1U;
+        uint32_t height = 1U;
+        uint32_t depth = 1U;
+    };
+
+    struct FormatInfos {
+        uint32_t blockWidth = 1U;
+        uint32_t blockHeight = 1U;
+        uint32_t bytesPerBlock = 0U;  // 0 if the format is unknown
+    };
+
+public:
+    // check the magic of the file
+    static bool IsContainerFile(const std::string& vFilePathName);
+    static FormatInfos GetFormatInfos(const vk::Format& vFormat);
+    static bool IsBlockCompressed(const vk::Format& vFormat);
+    // floor(log2(max(w,h,d))) + 1
+    static uint32_t GetMaxLevelsCount(const uint32_t& vWidth, const uint32_t& vHeight, const uint32_t& vDepth);
+
+private:
+    vk::Format m_Format = vk::Format::eUndefined;
+    uint32_t m_Width = 0U;
+    uint32_t m_Height = 0U;
+    uint32_t m_Depth = 1U;
+    uint32_t m_LayersCount = 1U;
+    uint32_t m_FacesCount = 1U;  // 6 for a cube map
+    std::vector<Level> m_Levels;
+    std::vector<uint8_t> m_Datas;
+
+public:
+    bool LoadFile(const std::string& vFilePathName);
+    bool LoadKtx2FromMemory(const uint8_t* vDatas, const size_t& vSize);
+    bool LoadDdsFromMemory(const uint8_t* vDatas, const size_t& vSize);
+    // prepare the levels and the datas for fill them (readback of an image, disk cache)
+    // fail without allocate if the datas size would be greater than vMaxDatasSize
+    bool Allocate(const vk::Format& vFormat,
+        const uint32_t& vWidth,
+        const uint32_t& vHeight,
+        const uint32_t& vDepth,
+        const uint32_t& vLayersCount,
+        const uint32_t& vFacesCount,
+        const uint32_t& vLevelsCount,
+        const uint64_t& vMaxDatasSize = UINT64_MAX);
+    void Clear();
+
+    // decompress BC1 to BC5 to rgba8 (srgb kept for BC1-3), return false for the other formats
+    bool DecompressToRgba8();
+
+    bool IsLoaded() const;
+    vk::Format GetFormat() const;
+    uint32_t GetWidth() const;
+    uint32_t GetHeight() const;
+    uint32_t GetDepth() const;
+    uint32_t GetLayersCount() const;
+    uint32_t GetFacesCount() const;
+    uint32_t GetLevelsCount() const;
+    const std::vector<Level>& GetLevels() const;
+    const std::vector<uint8_t>& GetDatas() const;
+    uint8_t* GetWritableDatas();
+
+private:
+    uint64_t GetImageSize(const uint32_t& vWidth, const uint32_t& vHeight, const uint32_t& vDepth) const;
+    // UINT64_MAX if the size overflow
+    uint64_t GetDatasSize(const uint32_t& vLevelsCount) const;
+    // check the datas size against vMaxDatasSize before allocate it
+    bool PrepareLevels(const uint32_t& vLevelsCount, const uint64_t& vMaxDatasSize);
+};
@@ -22,6 +22,7 @@ limitations under the License.
 #include <vulkan/vulkan.hpp>
 #include <Gaia/Core/VulkanCore.h>
 #include <Gaia/Resources/VulkanRessource.h>
+#include <Gaia/Resources/VulkanCubeFilter.h>
 #include <Gaia/gaia.h>
 
 class GAIA_API TextureCube {
@@ -32,7 +33,15 @@ public:
     // width, const uint32_t& height, const uint32_t& channels);
 
 public:
-    static TextureCubePtr CreateFromFiles(GaiApi::VulkanCoreWeak vVulkanCore, std::array<std::string, 6U> vFilePathNames);
+    // the mip level count is clamped to the full chain, so by default all the mips are generated
+    static TextureCubePtr CreateFromFiles(
+        GaiApi::VulkanCoreWeak vVulkanCore, std::array<std::string, 6U> vFilePathNames, const uint32_t& vMipLevelCount = UINT32_MAX);
+    // KTX2 or DDS cube map
+    static TextureCubePtr CreateFromFile(GaiApi::VulkanCoreWeak vVulkanCore, const std::string& vFilePathName);
+    // equirectangular image projected in a rgba16f cube with all its mips, in a single time command
+    // with vConvolve, the mips are prefiltered for the specular ibl (roughness mip / (mips count - 1))
+    static TextureCubePtr CreateFromEquirectangularFile(
+        GaiApi::VulkanCoreWeak vVulkanCore, const std::string& vFilePathName, const uint32_t& vFaceSize, const bool& vConvolve = false);
     // static TextureCubePtr CreateFromMemory(GaiApi::VulkanCoreWeak vVulkanCore, std::array<uint8_t*, 6U> vBuffers, const uint32_t& width, const
     // uint32_t& height, const uint32_t& channels);
     static TextureCubePtr CreateEmptyTexture(GaiApi::VulkanCoreWeak vVulkanCore, ez::uvec2 vSize, vk::Format vFormat);
@@ -44,6 +53,7 @@ public:
     vk::ImageView m_TextureView = {};
     vk::Sampler m_Sampler = {};
     vk::DescriptorImageInfo m_DescriptorImageInfo = {};
+    vk::Format m_ImageFormat = vk::Format::eR8G8B8A8Unorm;
     uint32_t m_MipLevelCount = 1u;
     uint32_t m_Width = 0u;
     uint32_t m_Height = 0u;
@@ -56,6 +66,7 @@ private:
 public:
     TextureCube(GaiApi::VulkanCoreWeak vVulkanCore);
     ~TextureCube();
+    // the 6 files are decoded in parallel, they must have the same size
     bool LoadFiles(const std::array<std::string, 6U>& vFilePathName,
         const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm,
         const uint32_t& vMipLevelCount = 1u);
@@ -65,6 +76,17 @@ public:
         const uint32_t& channels,
         const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm,
         const uint32_t& vMipLevelCount = 1u);
+    // KTX2 or DDS file with 6 faces, uploaded in the format of the file (block compressed or not) with its prebuilt mips
+    bool LoadContainerFile(const std::string& vFilePathName);
+    // create a cube of vFaceSize with all its mips and record in vCmd its generation from vSource by the VulkanCubeFilter of VulkanCore
+    // the source (equirectangular or cube) must be alive until the end of the execution of vCmd
+    bool LoadFiltered(vk::CommandBuffer vCmd,
+        const vk::DescriptorImageInfo& vSource,
+        const GaiApi::VulkanCubeFilter::SourceType& vSourceType,
+        const uint32_t& vSourceSize,
+        const uint32_t& vFaceSize,
+        const vk::Format& vFormat = vk::Format::eR16G16B16A16Sfloat,
+        const bool& vConvolve = false);
     bool LoadEmptyTexture(const ez::uvec2& vSize = 1, const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm);
     // bool LoadEmptyImage(const ez::uvec2& vSize = 1, const vk::Format& vFormat = vk::Format::eR8G8B8A8Unorm);
     void Destroy();
@@ -75,4 +97,7 @@ public:
     // bool SaveToJpg(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const int& vQualityFrom0To100, const
     // ez::uvec2& vNewSize); bool SaveToHdr(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ez::uvec2&
     // vNewSize); bool SaveToTga(const std::string& vFilePathName, const bool& vFlipY, const int& vSubSamplesCount, const ez::uvec2& vNewSize);
+
+private:
+    void CreateViewAndSampler(const vk::Format& vFormat);
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+
+/*
+persistent cache of the textures loaded from image files (png, jpg, hdr..), in the final format of the gpu with all the mips
+so the next launches skip the decoding, the conversion, the resize and the mips generation
+
+an entry is found by a key made of the path of the source file, its modification time, its size and the load options
+a source file modified give a new key, the old entry is just not used anymore (see Clear)
+
+usage : create it with the cache directory and give it to VulkanCore::setTextureDiskCache
+
+file format (little endian), one file by entry :
+- magic 'GTXC', version, key (size (uint32_t) + chars)
+- format (vk::Format), width, height, depth, layers, faces, levels count, datas size (uint64_t)
+- padding up to a multiple of 16, then the datas of TextureContainer (level by level, each level 16 bytes aligned)
+so the datas can be read or mapped directly from the file
+*/
+
+class TextureContainer;
+class GAIA_API TextureDiskCache {
+public:
+    static constexpr uint32_t s_Magic = 0x43585447;  // 'GTXC'
+    static constexpr uint32_t s_Version = 1U;
+
+public:
+    static TextureDiskCachePtr Create(const std::string& vDirectory);
+
+private:
+    std::string m_Directory;
+    // Load and Store are called by Texture2D::LoadFile on his calling thread, so many loading threads can use the cache
+    std::atomic<uint32_t> m_HitsCount = {0U};
+    std::atomic<uint32_t> m_MissesCount = {0U};
+
+public:
+    // create the directory if needed
+    bool Init(const std::string& vDirectory);
+
+    // empty if the source file cant be found
+    std::string GetKey(const std::string& vSourceFilePathName, const std::string& vLoadOptions) const;
+
+    bool Load(const std::string& vKey, TextureContainer& vOutContainer);
+    bool Store(const std::string& vKey, const TextureContainer& vContainer) const;
+
+    // remove all the entries of the directory
+    void Clear() const;
+
+    uint32_t GetHitsCount() const;
+    uint32_t GetMissesCount() const;
+
+private:
+    std::string GetEntryFilePathName(const std::string& vKey) const;
+};
@@ -3,8 +3,10 @@
 
 #include <vulkan/vulkan.hpp>
 #include <Gaia/Resources/VulkanRessource.h>
+#include <Gaia/Resources/BufferLayoutOptimizer.h>
 #include <ezlibs/ezLog.hpp>
 
+#include <array>
 #include <string>
 #include <vector>
 #include <map>
@@ -14,6 +16,15 @@
 
 /*
 manage in auto the alignement of Uniform Buffer for the standard std140 only
+the ubo is persistently mapped and contain one slot per frame in flight
+only the modified ranges are copied at upload, the first upload of a frame write in the next slot
+so the cpu never write in a slot the gpu can still read, and the next uploads of the frame write again in this slot
+with UseUniformArena, the block have no buffer but is pushed each frame in the shared uniform arena of VulkanCore
+and must be binded as a UNIFORM_BUFFER_DYNAMIC descriptor with dynamicOffset
+(see ShaderPass::CreateUniformArenaBlock, the pass call Upload at each frame even if the block is not dirty)
+(a frame where the arena is full, the block is written in his own buffer and descriptorBufferInfo point on it)
+with UsePushConstants, the block have no buffer at all, his datas are pushed at record time by the ShaderPass
+who have promoted it (see ShaderPass::PromoteUniformBlockToPushConstants)
 */
 
 class GAIA_API UniformBlockStd140 {
@@ -27,12 +38,35 @@ private:
     // dirty at first for init in gpu memory
     bool isDirty = true;
 
+private:  // frame slots
+    static constexpr uint32_t sFrameSlotsCount = GaiApi::VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT;
+    // ranges modified since the last upload in each slot
+    std::array<VulkanDirtyRanges, sFrameSlotsCount> frameDirtyRanges;
+    uint32_t frameSlotSize = 0U;     // size of datas aligned on minUniformBufferOffsetAlignment
+    uint32_t currentFrameSlot = 0U;  // slot pointed by descriptorBufferInfo
+    uint64_t currentFrameSlotFrame = UINT64_MAX;  // arena frame of the last write in currentFrameSlot
+
+private:  // uniform arena
+    bool useUniformArena = false;
+    GaiApi::VulkanUniformArenaWeak uniformArena;
+    uint64_t uniformArenaFrameCounter = UINT64_MAX;  // arena frame of the last push
+
+private:  // push constants
+    bool usePushConstants = false;
+
+private:  // layout optimizer
+    bool useLayoutOptimizer = false;
+    bool layoutWasOptimized = false;
+    std::string layoutBlockName;
+    BufferLayoutOptimizer layoutOptimizer;  // vars registered with RegisterVar, for the glsl declaration
+
 private:  // custom Buffer Info
     bool customBufferInfo = false;
 
 public:  // vulkan object to share
     std::shared_ptr<VulkanBufferObject> bufferObjectPtr = nullptr;
     vk::DescriptorBufferInfo descriptorBufferInfo = {VK_NULL_HANDLE, 0, VK_WHOLE_SIZE};
+    uint32_t dynamicOffset = 0U;  // offset in the uniform arena, to use at bind time with a UNIFORM_BUFFER_DYNAMIC descriptor
 
 public:
     ~UniformBlockStd140();
@@ -47,6 +81,18 @@ public:
     void UseCustomBufferInfo();
     void SetCustomBufferInfo(vk::DescriptorBufferInfo* vBufferObjectInfo);
 
+    // uniform arena, must be called before CreateUBO
+    void UseUniformArena();
+    bool IsUsingUniformArena() const;
+
+    // push constants, must be called before CreateUBO
+    void UsePushConstants();
+    bool IsUsingPushConstants() const;
+
+    // raw std140 datas, for push them in a command buffer
+    const uint8_t* GetDatas() const;
+    uint32_t GetDatasSize() const;
+
     // upload to gpu memory
     void Upload(GaiApi::VulkanCoreWeak vVulkanCore, bool vOnlyIfDirty);
 
@@ -55,6 +101,16 @@ public:
     void DestroyUBO();
     bool RecreateUBO(GaiApi::VulkanCoreWeak vVulkanCore);
 
+    // layout optimizer, must be called before the vars registering
+    // the vars registered with RegisterVar will be reordered for minimize the padding and placed at Build (or CreateUBO)
+    // so GetVar / SetVar can be used only after Build
+    void UseLayoutOptimizer(const std::string& vBlockName);
+    uint32_t GetLayoutSavedBytes() const;  // padding saved by the layout optimizer
+
+    // the glsl declaration matching the cpu layout of the vars registered with RegisterVar
+    // ex : GetGlslBlockDeclaration("std140, binding = 1", "UBO_Frag", "ubo")
+    std::string GetGlslBlockDeclaration(const std::string& vLayoutQualifiers, const std::string& vBlockName, const std::string& vInstanceName = "");
+
     // add size to uniform block, return startOffset
     bool RegisterByteSize(const std::string& vKey, uint32_t vSizeInBytes, uint32_t* vStartOffset = 0);
 
@@ -81,6 +137,15 @@ private:
     uint32_t GetGoodAlignement(uint32_t vSize);
 
     void AddOffsetForKey(const std::string& vKey, uint32_t vOffset);
+
+    // mark a range as modified for all frame slots
+    void SetDirtyRange(uint32_t vOffset, uint32_t vSizeInBytes);
+
+    // when the uniform arena is full, the datas are written in a buffer of the block with one slot by frame in flight
+    bool UploadInArenaFallbackBuffer(GaiApi::VulkanCoreWeak vVulkanCore);
+
+    // slot written by the current frame, the frames are the ones of the uniform arena
+    uint32_t GetFrameSlot(GaiApi::VulkanCoreWeak vVulkanCore);
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -89,10 +154,21 @@ private:
 
 template <typename T>
 void UniformBlockStd140::RegisterVar(const std::string& vKey, T* vValue, uint32_t vSizeInBytes) {
+    const char* glslType = (sizeof(T) == vSizeInBytes) ? GlslTypeTraits<T>::name : nullptr;
+    if (useLayoutOptimizer && !layoutWasOptimized) {
+        // will be placed at Build, a size greater than the type is an array, placed with his stride
+        const bool isArray = (sizeof(T) < vSizeInBytes) && !(sizeof(T) % 4U);
+        if (OffsetExist(vKey) ||
+            !layoutOptimizer.AddMember(vKey, isArray ? GlslTypeTraits<T>::name : glslType, vValue, vSizeInBytes, isArray ? (uint32_t)sizeof(T) : 0U)) {
+            LogVarDebugWarning("Debug : key %s is already defined in UniformBlockStd140. RegisterVar fail.", vKey.c_str());
+        }
+        return;
+    }
     uint32_t startOffset;
     if (RegisterByteSize(vKey, vSizeInBytes, &startOffset)) {
         // on copy de "startOffset" a "startOffset + vSizeInBytes"
         memcpy(datas.data() + startOffset, vValue, vSizeInBytes);
+        layoutOptimizer.AddMember(vKey, glslType, vValue, vSizeInBytes);
     }
 }
 
@@ -106,7 +182,9 @@ bool UniformBlockStd140::GetVar(const std::string& vKey, T& vValue) {
     if (OffsetExist(vKey)) {
         uint32_t offset = offsets[vKey];
         uint32_t size = sizeof(vValue);
-        memcpy(&vValue, datas.data() + offset, size);
+        if (!layoutOptimizer.ReadValue(vKey, datas.data() + offset, &vValue, size)) {
+            memcpy(&vValue, datas.data() + offset, size);
+        }
         return true;
     }
     LogVarDebugInfo("Debug : key %s not exist in UniformBlockStd140. GetVar fail.", vKey.c_str());
@@ -118,8 +196,14 @@ bool UniformBlockStd140::SetVar(const std::string& vKey, T* vValue, uint32_t vSi
     if (OffsetExist(vKey) && vSizeInBytes > 0) {
         uint32_t newSize = vSizeInBytes;
         uint32_t offset = offsets[vKey];
-        memcpy(datas.data() + offset, vValue, newSize);
-        isDirty = true;
+        // the arrays and matrices placed by the layout optimizer are spread on their stride
+        const uint32_t layoutSize = layoutOptimizer.WriteValue(vKey, vValue, vSizeInBytes, datas.data() + offset);
+        if (layoutSize) {
+            newSize = layoutSize;
+        } else {
+            memcpy(datas.data() + offset, vValue, newSize);
+        }
+        SetDirtyRange(offset, newSize);
         return true;
     }
     LogVarDebugInfo("Debug : key %s not exist in UniformBlockStd140. SetVar fail.", vKey.c_str());
@@ -0,0 +1,118 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+#include <Gaia/Core/VulkanSwapChain.h>
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+generation of a cube map from an equirectangular image or from an other cube map, with a compute shader
+recorded in the command buffer of the caller. one dispatch by mip, the six faces are the z of the dispatch
+the mip 0 is the projection of the source, the next mips are either :
+- a 2x2 box filter of the previous mip, for a simple mip chain
+- a convolution of the source with the ggx lobe of the roughness mip / (mips count - 1), for the specular ibl
+  the source is importance sampled, and each sample read a mip of the source according to its solid angle
+  (filtered importance sampling), so the noise is low with few samples if the source have its mips
+  the convolved mips dont depend on each others, so there is no barrier between their dispatchs
+the source is read with its sampler, the cube is written as a storage image, so it must be created with the storage usage
+and must not be the source. one pipeline by format and by kind of shader, compiled at the first use
+the per mip image views and descriptor sets are transients, they are recycled by frame slot like VulkanMipGenerator
+*/
+
+namespace GaiApi {
+class GAIA_API VulkanCubeFilter {
+public:
+    enum class SourceType { Equirectangular = 0, Cube };
+
+public:
+    static VulkanCubeFilterPtr Create(VulkanCoreWeak vVulkanCore);
+
+private:
+    static constexpr uint32_t s_DescriptorSetsByPool = 256U;  // a pool is added to the frame slot when he is full
+
+    enum class ShaderKind { ProjectEquirectangular = 0, ProjectCube, Downsample };
+
+    struct PushConstants {
+        int32_t dstSize;
+        int32_t srcSize;  // width of the equirectangular, face size of the cube, or size of the previous mip
+        float roughness;  // 0 for a simple projection
+        int32_t samplesCount;
+    };
+
+    struct FrameSlotStruct {
+        std::vector<vk::DescriptorPool> descriptorPools;  // more than one only when used out of the frames (loads at the startup)
+        std::vector<vk::ImageView> imageViews;
+        uint32_t dispatchsCount = 0U;  // descriptor sets allocated in the last pool
+    };
+
+private:
+    VulkanCoreWeak m_VulkanCore;
+    vk::Device m_Device;
+    vk::DescriptorSetLayout m_DescriptorSetLayout = nullptr;
+    vk::PipelineLayout m_PipelineLayout = nullptr;
+    std::map<std::pair<vk::Format, ShaderKind>, vk::Pipeline> m_Pipelines;  // nullptr if the compilation was failed
+    std::array<FrameSlotStruct, VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT> m_FrameSlots;
+    uint32_t m_FrameSlot = 0U;
+    bool m_ExtendedFormatsSupported = false;
+
+public:
+    VulkanCubeFilter(VulkanCoreWeak vVulkanCore);
+    ~VulkanCubeFilter();
+
+    bool Init();
+    void Unit();
+
+    // to call when the gpu has finished to use the transients of vFrameSlot (after the wait of the frame fence)
+    void BeginFrame(const uint32_t& vFrameSlot);
+
+    // the format can be a storage image written with float texels
+    bool IsFormatSupported(const vk::Format& vFormat) const;
+
+    // record in vCmd the generation of the vMipLevelsCount mips of the 6 faces of vCube from vSource
+    // vSource is the sampler, the view and the layout of the source, who must be readable by the compute shaders
+    // vSourceSize is the width of the equirectangular or the face size of the source cube
+    // with vConvolve, the mip m is the source convolved with the roughness m / (vMipLevelsCount - 1), else a box filter of the mip m - 1
+    // all the mips of vCube are in vOldLayout before and in vNewLayout after
+    bool RecordCubeMap(vk::CommandBuffer vCmd,
+        const vk::DescriptorImageInfo& vSource,
+        const SourceType& vSourceType,
+        const uint32_t& vSourceSize,
+        vk::Image vCube,
+        const vk::Format& vFormat,
+        const uint32_t& vFaceSize,
+        const uint32_t& vMipLevelsCount,
+        const bool& vConvolve,
+        const vk::ImageLayout& vOldLayout,
+        const vk::ImageLayout& vNewLayout,
+        const uint32_t& vSamplesCount = 64U);
+
+private:
+    vk::Pipeline GetPipeline(const vk::Format& vFormat, const ShaderKind& vShaderKind);
+    std::string GetProjectShaderCode(const vk::Format& vFormat, const SourceType& vSourceType) const;
+    std::string GetDownsampleShaderCode(const vk::Format& vFormat) const;
+    vk::ImageView CreateTransientMipView(vk::Image vImage, const vk::Format& vFormat, const uint32_t& vMipLevel);
+    vk::DescriptorPool CreateDescriptorPool() const;
+    vk::DescriptorSet AllocateTransientDescriptorSet();
+};
+}  // namespace GaiApi
@@ -35,7 +35,9 @@ public:
     uint32_t height = 0u;
     vk::Format format = vk::Format::eR32G32B32A32Sfloat;
     float ratio = 0.0f;
-    vk::Framebuffer framebuffer = nullptr;
+    vk::Framebuffer framebuffer = nullptr;  // null with the dynamic rendering
+    bool dynamicRendering = false;
+    bool layoutsInitialized = false;  // with the dynamic rendering, the attachments are in undefined layout before the first rendering
     bool neverCleared = true;
     bool needToClear = false;
     vk::SampleCountFlagBits sampleCount = vk::SampleCountFlagBits::e1;
@@ -58,7 +60,8 @@ public:
         bool vNeedToClear = false,
         ez::fvec4 vClearColor = 0.0f,
         vk::Format vFormat = vk::Format::eR32G32B32A32Sfloat,
-        vk::SampleCountFlagBits vSampleCount = vk::SampleCountFlagBits::e1);
+        vk::SampleCountFlagBits vSampleCount = vk::SampleCountFlagBits::e1,
+        bool vUseDynamicRendering = false);  // no renderpass and no framebuffer, the attachments are given at record time
     void Unit();
 
     VulkanFrameBufferAttachment* GetDepthAttachment();
@@ -54,6 +54,7 @@ public:
     bool InitDepth(GaiApi::VulkanCoreWeak vVulkanCore, ez::uvec2 vSize, vk::Format vFormat, vk::SampleCountFlagBits vSampleCount);
     void Unit();
 
-    bool UpdateMipMapping();
+    // recorded in vCmdBufferPtr if not null, else in a single time command
+    bool UpdateMipMapping(vk::CommandBuffer* vCmdBufferPtr = nullptr);
 };
 }  // namespace GaiApi
\ No newline at end of file
@@ -0,0 +1,114 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+#include <Gaia/Core/VulkanSwapChain.h>
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+/*
+conversion on the gpu of the packed texels of an image file to the format of a texture
+the texels are uploaded in their native layout (1 to 4 channels, 8/16 bits unorm or 32 bits float) in a storage buffer
+and a compute shader expand the channels (grey => rgb, no alpha => opaque), convert and resize them in a storage image
+so the cpu dont need to expand / convert / resize the texels, and the staging is smaller
+one pipeline by destination format and component size, compiled at the first use
+the descriptor sets and the image views are transients, they are recycled by frame slot like VulkanMipGenerator
+*/
+
+namespace GaiApi {
+class GAIA_API VulkanImageConverter {
+public:
+    static VulkanImageConverterPtr Create(VulkanCoreWeak vVulkanCore);
+
+    // layout of the packed texels in the source buffer, the rows are not padded
+    struct SourceLayout {
+        uint32_t width = 0U;
+        uint32_t height = 0U;
+        uint32_t channels = 4U;           // 1 : grey, 2 : grey alpha, 3 : rgb, 4 : rgba
+        uint32_t bytesPerComponent = 1U;  // 1 and 2 : unorm, 4 : float
+    };
+
+    // size of the source buffer for a layout, rounded to 4 bytes since the shader read it by uint
+    static uint64_t GetSourceBufferSize(const SourceLayout& vLayout);
+
+private:
+    static constexpr uint32_t s_DescriptorSetsByPool = 64U;  // a pool is added to the frame slot when he is full
+
+    struct PushConstants {
+        int32_t srcSize[2];
+        int32_t dstSize[2];
+        int32_t channels;
+        int32_t pad[3];
+    };
+
+    struct FrameSlotStruct {
+        std::vector<vk::DescriptorPool> descriptorPools;  // more than one only when used out of the frames (loads at the startup)
+        std::vector<vk::ImageView> imageViews;
+        uint32_t dispatchsCount = 0U;  // descriptor sets allocated in the last pool
+    };
+
+private:
+    VulkanCoreWeak m_VulkanCore;
+    vk::Device m_Device;
+    vk::DescriptorSetLayout m_DescriptorSetLayout = nullptr;
+    vk::PipelineLayout m_PipelineLayout = nullptr;
+    std::map<std::pair<vk::Format, uint32_t>, vk::Pipeline> m_Pipelines;  // format, bytes per component => nullptr if failed
+    std::array<FrameSlotStruct, VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT> m_FrameSlots;
+    uint32_t m_FrameSlot = 0U;
+    uint64_t m_MaxStorageBufferRange = 0U;
+    bool m_ExtendedFormatsSupported = false;
+
+public:
+    VulkanImageConverter(VulkanCoreWeak vVulkanCore);
+    ~VulkanImageConverter();
+
+    bool Init();
+    void Unit();
+
+    // to call when the gpu has finished to use the transients of vFrameSlot (after the wait of the frame fence)
+    void BeginFrame(const uint32_t& vFrameSlot);
+
+    // the format can be a storage image and is not an integer format
+    bool IsFormatSupported(const vk::Format& vFormat) const;
+
+    // the source layout can be read by the shader and his buffer is not too big for a storage buffer binding
+    bool CanConvert(const SourceLayout& vSrcLayout, const vk::Format& vDstFormat) const;
+
+    // record in vCmd the conversion of the source buffer in the mip 0 of vDstImage, resized to vDstWidth x vDstHeight
+    // the mip 0 must be in the general layout, the writes are not synchronized with the next commands
+    bool RecordConversion(vk::CommandBuffer vCmd,
+        vk::Buffer vSrcBuffer,
+        const SourceLayout& vSrcLayout,
+        vk::Image vDstImage,
+        const vk::Format& vDstFormat,
+        const uint32_t& vDstWidth,
+        const uint32_t& vDstHeight);
+
+private:
+    vk::Pipeline GetPipeline(const vk::Format& vFormat, const uint32_t& vBytesPerComponent);
+    std::string GetShaderCode(const vk::Format& vFormat, const uint32_t& vBytesPerComponent) const;
+    vk::DescriptorPool CreateDescriptorPool() const;
+    vk::DescriptorSet AllocateTransientDescriptorSet();
+};
+}  // namespace GaiApi
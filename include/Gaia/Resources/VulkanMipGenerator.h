@@ -0,0 +1,107 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+#include <Gaia/Core/VulkanSwapChain.h>
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+generation of the mips of a 2d image with a compute shader, recorded in the command buffer of the caller
+each dispatch produce two mips from the previous one, the first with a 2x2 box filter of the source
+and the second with a 2x2 box filter of the first kept in shared memory, so the n - 1 mips of an image need n / 2 dispatchs
+the mips are read and written as storage images, so the linear filtering is not needed (float32 formats, integer formats)
+but the image must be created with the storage usage. one pipeline by format, compiled at the first use
+the per mip image views and descriptor sets are transients, they are recycled by frame slot like VulkanUniformArena
+out of the frames (loads at the startup), a full slot get one more descriptor pool until his next BeginFrame
+*/
+
+namespace GaiApi {
+class GAIA_API VulkanMipGenerator {
+public:
+    static VulkanMipGeneratorPtr Create(VulkanCoreWeak vVulkanCore);
+
+    // the glsl image format qualifier of a vulkan format (ex : rgba32f), empty if not known
+    // vIsExtended is true if the format need the feature shaderStorageImageExtendedFormats
+    static std::string GetGlslImageFormat(const vk::Format& vFormat, bool* vIsExtended = nullptr);
+
+private:
+    static constexpr uint32_t s_DescriptorSetsByPool = 256U;  // a pool is added to the frame slot when he is full
+
+    struct PushConstants {
+        int32_t srcSize[2];
+        int32_t dst0Size[2];
+        int32_t dst1Size[2];
+        int32_t levelsCount;  // 1 or 2
+        int32_t pad;
+    };
+
+    struct FrameSlotStruct {
+        std::vector<vk::DescriptorPool> descriptorPools;  // more than one only when used out of the frames (loads at the startup)
+        std::vector<vk::ImageView> imageViews;
+        uint32_t dispatchsCount = 0U;  // descriptor sets allocated in the last pool
+    };
+
+private:
+    VulkanCoreWeak m_VulkanCore;
+    vk::Device m_Device;
+    vk::DescriptorSetLayout m_DescriptorSetLayout = nullptr;
+    vk::PipelineLayout m_PipelineLayout = nullptr;
+    std::map<vk::Format, vk::Pipeline> m_Pipelines;  // nullptr if the compilation of the format was failed
+    std::array<FrameSlotStruct, VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT> m_FrameSlots;
+    uint32_t m_FrameSlot = 0U;
+    bool m_ExtendedFormatsSupported = false;
+
+public:
+    VulkanMipGenerator(VulkanCoreWeak vVulkanCore);
+    ~VulkanMipGenerator();
+
+    bool Init();
+    void Unit();
+
+    // to call when the gpu has finished to use the transients of vFrameSlot (after the wait of the frame fence)
+    void BeginFrame(const uint32_t& vFrameSlot);
+
+    // the format can be a storage image and have a glsl format qualifier
+    bool IsFormatSupported(const vk::Format& vFormat) const;
+
+    // record in vCmd the generation of the mips [1, vMipLevelsCount[ from the mip 0
+    // all the mips are in vOldLayout before and in vNewLayout after
+    // the writes done before on the mip 0 are waited, the next reads of the mips by the shaders wait the generation
+    bool RecordMipmaps(vk::CommandBuffer vCmd,
+        vk::Image vImage,
+        const vk::Format& vFormat,
+        const uint32_t& vWidth,
+        const uint32_t& vHeight,
+        const uint32_t& vMipLevelsCount,
+        const vk::ImageLayout& vOldLayout,
+        const vk::ImageLayout& vNewLayout);
+
+private:
+    vk::Pipeline GetPipeline(const vk::Format& vFormat);
+    std::string GetShaderCode(const vk::Format& vFormat) const;
+    vk::ImageView CreateTransientMipView(vk::Image vImage, const vk::Format& vFormat, const uint32_t& vMipLevel);
+    vk::DescriptorPool CreateDescriptorPool() const;
+    vk::DescriptorSet AllocateTransientDescriptorSet();
+};
+}  // namespace GaiApi
@@ -25,6 +25,8 @@ limitations under the License.
 #include <vector>
 #include <string>
 
+class TextureContainer;
+
 struct GAIA_API VulkanAccelStructObject {
     vk::AccelerationStructureKHR handle = nullptr;
     vk::Buffer buffer = nullptr;
@@ -38,6 +40,7 @@ typedef std::shared_ptr<VulkanAccelStructObject> VulkanAccelStructObjectPtr;
 struct GAIA_API VulkanImageObject {
     vk::Image image = nullptr;
     VmaAllocation alloc_meta = nullptr;
+    vk::ImageUsageFlags image_usage;  // for choose the mips generation path
 };
 typedef std::shared_ptr<VulkanImageObject> VulkanImageObjectPtr;
 
@@ -49,6 +52,7 @@ public:
     vk::BufferUsageFlags buffer_usage;
     uint64_t device_address = 0U;
     vk::BufferView bufferView = VK_NULL_HANDLE;
+    void* mapped_data = nullptr;  // not null if the buffer is persistently mapped (VMA_ALLOCATION_CREATE_MAPPED_BIT)
 
 public:
     bool MapMemory(void* vMappedMemory);
@@ -56,6 +60,27 @@ public:
 };
 typedef std::shared_ptr<VulkanBufferObject> VulkanBufferObjectPtr;
 
+/*
+list of byte ranges modified on cpu side and waiting for an upload
+the ranges are sorted and merged before use, for have the less memcpy/flush possible
+*/
+struct GAIA_API VulkanBufferRange {
+    size_t offset = 0U;
+    size_t size = 0U;
+};
+
+class GAIA_API VulkanDirtyRanges {
+private:
+    std::vector<VulkanBufferRange> m_Ranges;
+    bool m_IsCoalesced = true;
+
+public:
+    void Add(size_t vOffset, size_t vSize);
+    void Clear();
+    bool IsEmpty() const;
+    const std::vector<VulkanBufferRange>& GetCoalescedRanges();  // sort and merge overlapping/contiguous ranges
+};
+
 namespace GaiApi {
 class GAIA_API VulkanRessource {
 public:
@@ -97,6 +122,20 @@ public:  // image
         vk::Format format,
         void* hostdata_ptr,
         const char* vDebugLabel);
+    // hostdata_ptr contain the packed texels of an image file (1 to 4 channels of 8/16 bits unorm or 32 bits float)
+    // they are converted, expanded and resized on the gpu to the format and the size of the texture, then the mips are generated
+    // return nullptr if the image converter cant do it, the caller must fallback on createTextureImage2D
+    static VulkanImageObjectPtr createTextureImage2DFromPacked(VulkanCoreWeak vVulkanCore,
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipLevelCount,
+        vk::Format format,
+        const void* hostdata_ptr,
+        uint32_t srcWidth,
+        uint32_t srcHeight,
+        uint32_t srcChannels,
+        uint32_t srcBytesPerComponent,
+        const char* vDebugLabel);
     static VulkanImageObjectPtr createTextureImage3D(VulkanCoreWeak vVulkanCore,
         uint32_t width,
         uint32_t height,
@@ -109,8 +148,12 @@ public:  // image
         uint32_t height,
         uint32_t mipLevelCount,
         vk::Format format,
-        std::array<std::vector<uint8_t>, 6U> hostdatas,
+        const std::array<std::vector<uint8_t>, 6U>& hostdatas,
         const char* vDebugLabel);
+    // upload all the levels, layers and faces of a KTX2/DDS container as they are stored (block compressed or not)
+    // the image is 3D if the depth is > 1, cube compatible if there is 6 faces, and have layers * faces array layers
+    // if the device cant sample the format, vContainer is decompressed in place to rgba8 when possible, else nullptr is returned
+    static VulkanImageObjectPtr createTextureImageFromContainer(VulkanCoreWeak vVulkanCore, TextureContainer& vContainer, const char* vDebugLabel);
     static VulkanImageObjectPtr createColorAttachment2D(VulkanCoreWeak vVulkanCore,
         uint32_t width,
         uint32_t height,
@@ -125,6 +168,12 @@ public:  // image
         vk::Format format,
         vk::SampleCountFlagBits vSampleCount,
         const char* vDebugLabel);
+    // cube compatible image of 6 layers, writable by the compute shaders (ex : VulkanCubeFilter), left in the undefined layout
+    static VulkanImageObjectPtr createStorageTextureCube(VulkanCoreWeak vVulkanCore,
+        uint32_t faceSize,
+        uint32_t mipLevelCount,
+        vk::Format format,
+        const char* vDebugLabel);
     static VulkanImageObjectPtr createDepthAttachment(VulkanCoreWeak vVulkanCore,
         uint32_t width,
         uint32_t height,
@@ -132,8 +181,33 @@ public:  // image
         vk::SampleCountFlagBits vSampleCount,
         const char* vDebugLabel);
 
-    static void GenerateMipmaps(
-        VulkanCoreWeak vVulkanCore, vk::Image image, vk::Format imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels);
+    // generate the mips in a single time command, for the loading of the textures
+    // all the mips are in vOldLayout before and in vNewLayout after
+    static bool GenerateMipmaps(VulkanCoreWeak vVulkanCore,
+        const VulkanImageObjectPtr& vImagePtr,
+        vk::Format imageFormat,
+        int32_t texWidth,
+        int32_t texHeight,
+        uint32_t mipLevels,
+        vk::ImageLayout vOldLayout = vk::ImageLayout::eTransferDstOptimal,
+        vk::ImageLayout vNewLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+        uint32_t vLayersCount = 1U);
+
+    // record the generation of the mips in vCmd, without wait of the device
+    // with the compute mip generator if the image have the storage usage and the format is supported
+    // else with a blit chain if the image have the transfer usages and the format support the linear filtering
+    // else nothing is recorded and false is returned
+    // with many layers (ex : the 6 faces of a cube), all the layers are done together by the blit chain
+    static bool RecordMipmaps(VulkanCoreWeak vVulkanCore,
+        vk::CommandBuffer vCmd,
+        const VulkanImageObjectPtr& vImagePtr,
+        vk::Format imageFormat,
+        int32_t texWidth,
+        int32_t texHeight,
+        uint32_t mipLevels,
+        vk::ImageLayout vOldLayout,
+        vk::ImageLayout vNewLayout,
+        uint32_t vLayersCount = 1U);
 
     static void transitionImageLayout(VulkanCoreWeak vVulkanCore,
         vk::Image image,
@@ -158,22 +232,33 @@ public:  // image
         std::shared_ptr<VulkanImageObject> vImage,
         void* vDatas,
         uint32_t* vSize);
+    // copy all the levels, layers and faces of the image in vContainer, who must be allocated with the format and the size of the image
+    // the image must be in eShaderReadOnlyOptimal, and is in this layout after
+    static bool getDatasFromTextureImage(VulkanCoreWeak vVulkanCore, const VulkanImageObjectPtr& vImagePtr, TextureContainer& vContainer);
 
 public:  // buffers
     static void copy(VulkanCoreWeak vVulkanCore, vk::Buffer dst, vk::Buffer src, const vk::BufferCopy& region, vk::CommandPool* vCommandPool = 0);
     static void copy(
         VulkanCoreWeak vVulkanCore, vk::Buffer dst, vk::Buffer src, const std::vector<vk::BufferCopy>& regions, vk::CommandPool* vCommandPool = 0);
     static bool upload(VulkanCoreWeak vVulkanCore, VulkanBufferObjectPtr dstHostVisiblePtr, void* src_host, size_t size_bytes, size_t dst_offset = 0);
+    // will copy only the dirty ranges of src_host, and flush them in one call. the ranges are relative to src_host and dst_offset
+    static bool uploadRanges(VulkanCoreWeak vVulkanCore,
+        VulkanBufferObjectPtr dstHostVisiblePtr,
+        const uint8_t* src_host,
+        VulkanDirtyRanges& vRanges,
+        size_t dst_offset = 0);
     static bool download(GaiApi::VulkanCoreWeak vVulkanCore, VulkanBufferObjectPtr srcHostVisiblePtr, void* dst_host, size_t size_bytes);
 
     // will set deveic adress of buffer in vVulkanBufferObjectPtr
     static void SetDeviceAddress(const vk::Device& vDevice, VulkanBufferObjectPtr vVulkanBufferObjectPtr);
     static VulkanBufferObjectPtr createSharedBufferObject(
         VulkanCoreWeak vVulkanCore, const vk::BufferCreateInfo& bufferinfo, const VmaAllocationCreateInfo& alloc_info, const char* vDebugLabel);
+    // the uniform buffer is persistently mapped, see VulkanBufferObject::mapped_data
     static VulkanBufferObjectPtr createUniformBufferObject(VulkanCoreWeak vVulkanCore, uint64_t vSize, const char* vDebugLabel);
     static VulkanBufferObjectPtr createStagingBufferObject(VulkanCoreWeak vVulkanCore, uint64_t vSize, const char* vDebugLabel);
     static VulkanBufferObjectPtr createStorageBufferObject(
         VulkanCoreWeak vVulkanCore, uint64_t vSize, vk::BufferUsageFlags vBufferUsageFlags, VmaMemoryUsage vMemoryUsage, const char* vDebugLabel);
+    // the storage buffer is persistently mapped when vMemoryUsage is VMA_MEMORY_USAGE_CPU_TO_GPU
     static VulkanBufferObjectPtr createStorageBufferObject(
         VulkanCoreWeak vVulkanCore, uint64_t vSize, VmaMemoryUsage vMemoryUsage, const char* vDebugLabel);
     static VulkanBufferObjectPtr createGPUOnlyStorageBufferObject(VulkanCoreWeak vVulkanCore, void* vData, uint64_t vSize, const char* vDebugLabel);
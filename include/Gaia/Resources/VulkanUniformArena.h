@@ -0,0 +1,72 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+#include <Gaia/Resources/VulkanRessource.h>
+
+#include <cstdint>
+
+/*
+one big persistently mapped uniform buffer shared by all the uniform blocks
+the buffer is splitted in one region per frame in flight, and each region is a linear allocator
+reseted at the start of the frame (when the fence of the frame was waited)
+the blocks are binded with UNIFORM_BUFFER_DYNAMIC descriptors, the buffer and the range never change
+only the dynamic offset given at bind time change
+*/
+
+namespace GaiApi {
+class GAIA_API VulkanUniformArena {
+public:
+    static VulkanUniformArenaPtr Create(VulkanCoreWeak vVulkanCore, const uint64_t& vFrameSizeInBytes);
+
+private:
+    VulkanCoreWeak m_VulkanCore;
+    VulkanBufferObjectPtr m_BufferObjectPtr = nullptr;
+    uint64_t m_FrameSize = 0U;       // size of the region of one frame
+    uint64_t m_Alignment = 256U;     // minUniformBufferOffsetAlignment
+    uint32_t m_FrameSlot = 0U;       // current frame region
+    uint64_t m_FrameCounter = 0U;    // incremented at each BeginFrame, used by the blocks to know if they was pushed this frame
+    uint64_t m_Head = 0U;            // next free byte in the current region
+    uint64_t m_FlushedHead = 0U;     // bytes before this offset are already flushed
+    uint64_t m_PeakUsedSize = 0U;    // max bytes used in a frame, for tune the frame size
+    bool m_OverflowWasLogged = false;
+
+public:
+    VulkanUniformArena(VulkanCoreWeak vVulkanCore);
+    ~VulkanUniformArena();
+
+    bool Init(const uint64_t& vFrameSizeInBytes);
+    void Unit();
+
+    // to call when the gpu has finished to use the region of vFrameSlot (after the wait of the frame fence)
+    void BeginFrame(const uint32_t& vFrameSlot);
+
+    // copy vDatas in the current region and return the dynamic offset to use at bind time
+    bool Push(const void* vDatas, const uint32_t& vSizeInBytes, uint32_t& vOutDynamicOffset);
+
+    // flush all pushed bytes not flushed, in one call. done by VulkanSubmitter before each submit
+    void Flush();
+
+    vk::Buffer GetBuffer() const;
+    uint64_t GetFrameCounter() const;
+    uint64_t GetUsedSize() const;
+    uint64_t GetPeakUsedSize() const;
+    uint64_t GetFrameSize() const;
+};
+}  // namespace GaiApi
@@ -22,6 +22,7 @@ limitations under the License.
 #include <Gaia/gaia.h>
 
 #include <unordered_map>
+#include <set>
 #include <string>
 
 // on va parser le shader
@@ -31,12 +32,17 @@ limitations under the License.
 
 class TIRUniformsLocator : public glslang::TIntermTraverser {
 public:
-    std::unordered_map<std::string, bool> usedUniforms;
+    std::unordered_map<std::string, bool> usedUniforms;  // members, samplers (the declared ones included)
+    std::set<std::string> usedBindings;                  // binding keys (see VulkanShader::GetBindingKey) and block names reached by the code
+
+private:
+    bool inLinkerObjects = false;  // the linker objects contain all the declared globals, used or not
 
 public:
     TIRUniformsLocator();
 
     virtual bool visitBinary(glslang::TVisit, glslang::TIntermBinary* vNode);
+    virtual bool visitAggregate(glslang::TVisit, glslang::TIntermAggregate* vNode);
     virtual void visitSymbol(glslang::TIntermSymbol* vNode);
 
 protected:
@@ -0,0 +1,71 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <set>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/*
+in memory cache of the shader files (stage files and includes)
+a file is read from disk only the first time, or when UpdateFiles say he was changed
+each compilation (shader name + suffix + defines + options, see GetCompileKey) keep his include closure with the content hash of each file
+so two variants of a unit compiled at the same time don't overwrite their closures
+so a stage is outdated only if one of his files have a new hash
+*/
+
+class GAIA_API ShaderIncludeCache {
+public:
+    typedef std::map<std::string, size_t> DependenciesContainer;  // file path name => content hash
+
+private:
+    struct FileStruct {
+        std::string content;
+        size_t hash = 0U;
+    };
+
+private:
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::string, FileStruct> m_Files;                    // file path name => content
+    std::unordered_map<std::string, DependenciesContainer> m_Dependencies;  // compile key => included files
+
+public:
+    static std::string NormalizePath(const std::string& vFilePathName);
+    static std::string GetUnitName(const std::string& vShaderName, const std::string& vShaderSuffix);
+    static std::string GetCompileKey(const std::string& vUnitName, const std::string& vDefines, const std::string& vOptions);
+
+    // get the content of a file, read from disk only if not in the cache
+    bool GetFileContent(const std::string& vFilePathName, std::string& vOutContent, size_t* vOutHash = nullptr);
+    void SetFileContent(const std::string& vFilePathName, const std::string& vContent);
+
+    // reread from disk the cached files of vFilePathNames, return the files with a new content
+    std::set<std::string> UpdateFiles(const std::set<std::string>& vFilePathNames);
+
+    // include closure of a compilation
+    void SetDependencies(const std::string& vCompileKey, const DependenciesContainer& vDependencies);
+    DependenciesContainer GetDependencies(const std::string& vCompileKey) const;
+
+    // say if one of the files have changed since the dependencies was recorded
+    bool IsOutdated(const DependenciesContainer& vDependencies) const;
+
+    void Clear();
+};
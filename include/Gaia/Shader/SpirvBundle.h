@@ -0,0 +1,84 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <Gaia/gaia.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+/*
+bundle of precompiled spirv, produced offline by the GaiaShaderCompiler tool (or recorded at runtime)
+loaded at startup from a file or from an array embedded at build time (see cmake/shaderbundle.cmake)
+
+an entry is found by the hash of the glsl source, the defines, the options, the stage, the entry point and the optimization mode
+the source is the code of the file before the insertion of the defines, so the offline compiler and the runtime get the same key
+an edited shader is not found and is compiled with glslang as usual
+the includes are checked with the hash of their content
+
+file format (little endian) :
+- magic 'GSPV', version, count of entries
+- for each entry : key, spirv words, used uniforms (name, used), used bindings (name), includes (file path name, content hash)
+the strings are stored as size (uint32_t) + chars
+*/
+
+class GAIA_API SpirvBundle {
+public:
+    static constexpr uint32_t s_Magic = 0x56505347;  // 'GSPV'
+    static constexpr uint32_t s_Version = 3U;
+
+    struct Entry {
+        std::vector<unsigned int> spirv;
+        std::unordered_map<std::string, bool> usedUniforms;
+        std::set<std::string> usedBindings;  // see TIRUniformsLocator::usedBindings
+        std::map<std::string, uint64_t> includes;  // file path name => content hash (see HashString)
+    };
+
+    struct KeySource {
+        std::string source;   // glsl code of the file, before the insertion of the defines
+        std::string defines;  // "NAME=VALUE;NAME2", inserted after the #version line. the order is not used
+        std::string options;  // other rewrites of the code before the compilation (ex : promoted uniform blocks)
+    };
+
+public:
+    static SpirvBundlePtr Create();
+
+    // stable hash (fnv-1a 64), the bundle can be produced by another build
+    static uint64_t HashString(const std::string& vString);
+    static std::string NormalizeDefines(const std::string& vDefines);  // sorted, without the empty items
+    static std::string GetKey(const KeySource& vKeySource, const std::string& vShaderSuffix, const std::string& vEntryPoint, const uint8_t& vOptimizationMode);
+
+private:
+    mutable std::mutex m_Mutex;
+    std::unordered_map<std::string, Entry> m_Entries;
+
+public:
+    bool LoadFromFile(const std::string& vFilePathName);
+    bool LoadFromMemory(const uint8_t* vDatas, const size_t& vSize);
+    bool SaveToFile(const std::string& vFilePathName) const;
+
+    void AddEntry(const std::string& vKey, const Entry& vEntry);
+    bool GetEntry(const std::string& vKey, Entry& vOutEntry) const;
+    size_t GetEntriesCount() const;
+    void Clear();
+};
@@ -0,0 +1,84 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+#pragma warning(disable : 4251)
+
+#include <vulkan/vulkan.hpp>
+
+#include <Gaia/gaia.h>
+
+#include <map>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+/*
+reflection of a spirv binary, in one pass on the words, without glslang
+give the descriptor sets, the bindings, their types and the block members offsets,
+the push constants ranges, the specialization constants ids and the local size of the compute shaders
+a binding is used if he is in the interface of the entry point (spirv 1.4+), else all the bindings are seen as used
+*/
+
+class GAIA_API SpirvReflection {
+public:
+    struct MemberInfo {
+        std::string name;
+        uint32_t offset = 0U;
+        uint32_t size = 0U;
+    };
+
+    struct BindingInfo {
+        uint32_t set = 0U;
+        uint32_t binding = 0U;
+        std::string name;      // variable name
+        std::string typeName;  // block name for the buffers
+        vk::DescriptorType type = vk::DescriptorType::eUniformBuffer;
+        uint32_t count = 1U;  // 0 for a runtime array
+        vk::ShaderStageFlags stages;
+        bool used = true;
+        uint32_t blockSize = 0U;  // for the buffers
+        std::vector<MemberInfo> members;
+    };
+
+    struct PushConstantInfo {
+        std::string name;
+        vk::ShaderStageFlags stages;
+        uint32_t size = 0U;
+        std::vector<MemberInfo> members;
+    };
+
+    struct ReflectionDatas {
+        bool valid = false;
+        vk::ShaderStageFlags stages;
+        std::vector<BindingInfo> bindings;
+        std::vector<PushConstantInfo> pushConstants;
+        std::map<uint32_t, std::string> specializationConstants;  // spec id => name
+        std::array<uint32_t, 3> localSize = {0U, 0U, 0U};         // compute, LocalSize
+        std::array<uint32_t, 3> localSizeIds = {0U, 0U, 0U};      // compute, LocalSizeId (spec constants ids)
+        bool localSizeFromIds = false;
+    };
+
+public:
+    static bool Reflect(const std::vector<unsigned int>& vSpirv, ReflectionDatas& vOutDatas);
+
+    // merge the bindings of many stages (the stage flags are cumulated), for build a descriptor set layout
+    // the spirv dont know if a buffer is dynamic, so a buffer binding of vDynamicTypesPtr take his dynamic type (binding => type)
+    static std::vector<vk::DescriptorSetLayoutBinding> GetLayoutBindings(const std::vector<const ReflectionDatas*>& vStages,
+        const uint32_t& vSetIndex,
+        const std::map<uint32_t, vk::DescriptorType>* vDynamicTypesPtr = nullptr);
+};
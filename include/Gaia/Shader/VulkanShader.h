@@ -23,6 +23,8 @@ limitations under the License.
 #include <glm/glm.hpp>
 
 #include <Gaia/gaia.h>
+#include <Gaia/Shader/SpirvBundle.h>
+#include <Gaia/Shader/ShaderIncludeCache.h>
 
 #include <unordered_map>
 #include <string>
@@ -32,6 +34,8 @@ limitations under the License.
 #include <set>
 #include <list>
 #include <array>
+#include <mutex>
+#include <tuple>
 
 /*
 todo : to Refactor and Convert for use of Vulkan.hpp
@@ -39,6 +43,16 @@ todo : to Refactor and Convert for use of Vulkan.hpp
 
 typedef std::string ShaderEntryPoint;
 
+// optimization of the spirv after the linking
+// DEFAULT is for the passes, the global mode of VulkanShader is used
+enum class SpirvOptimizationMode : uint8_t {
+    SPIRV_OPTIMIZATION_DEFAULT = 0,
+    SPIRV_OPTIMIZATION_NONE,         // raw glslang output
+    SPIRV_OPTIMIZATION_DCE,          // dead code elimination and load/store optimization of the glslang remapper, debug infos kept
+    SPIRV_OPTIMIZATION_SIZE,         // same as DCE + strip of the source and line debug infos (names kept for the reflection)
+    SPIRV_OPTIMIZATION_Count
+};
+
 class GAIA_API VulkanShader {
 public:
     static VulkanShaderPtr Create();
@@ -51,6 +65,19 @@ public:  // errors
     std::unordered_map<EShLanguage, std::vector<std::string>> m_Error;
     std::unordered_map<EShLanguage, std::vector<std::string>> m_Warnings;
 
+private:
+    std::mutex m_CompilationMutex;  // the compilation can be done from a worker thread (hot reload)
+    ShaderIncludeCache m_IncludeCache;  // shader files and include closures of the compiled units
+    SpirvOptimizationMode m_OptimizationMode = SpirvOptimizationMode::SPIRV_OPTIMIZATION_NONE;  // global mode
+    struct OptimizedSpirvStruct {
+        std::vector<unsigned int> raw;  // compared at lookup, two raw spirv can have the same hash
+        std::vector<unsigned int> optimized;
+    };
+    // optimized spirv by raw spirv hash, size and mode, so an unchanged stage is not optimized again at recompilation
+    std::map<std::tuple<size_t, size_t, SpirvOptimizationMode>, OptimizedSpirvStruct> m_OptimizedSpirvs;
+    SpirvBundlePtr m_SpirvBundlePtr = nullptr;  // precompiled spirv
+    bool m_SpirvBundleRecording = false;        // the compiled spirv are added to the bundle (offline compiler)
+
 public:
     const std::vector<unsigned int> CompileGLSLFile(const std::string& filename,
         const ShaderEntryPoint& vEntryPoint = "main",
@@ -63,7 +90,10 @@ public:
         const ShaderEntryPoint& vEntryPoint = "main",
         ShaderMessagingFunction vMessagingFunction = nullptr,
         std::string* vShaderCode = nullptr,
-        std::unordered_map<std::string, bool>* vUsedUniforms = nullptr);
+        std::unordered_map<std::string, bool>* vUsedUniforms = nullptr,
+        SpirvOptimizationMode vOptimizationMode = SpirvOptimizationMode::SPIRV_OPTIMIZATION_DEFAULT,
+        const SpirvBundle::KeySource* vBundleKeySource = nullptr,  // if null, vCode is the source, without defines and options
+        std::set<std::string>* vUsedBindings = nullptr);            // binding keys and block names reached by the code
     void ParseGLSLString(const std::string& vCode,
         const std::string& vShaderSuffix,
         const std::string& vOriginalFileName,
@@ -72,12 +102,42 @@ public:
         TraverserFunction vTraverser);
     vk::ShaderModule CreateShaderModule(vk::Device vLogicalDevice, std::vector<unsigned int> vSPIRVCode);
     void DestroyShaderModule(vk::Device vLogicalDevice, vk::ShaderModule vShaderModule);
-    std::unordered_map<std::string, bool> CollectUniformInfosFromIR(const glslang::TIntermediate& intermediate);
+    std::unordered_map<std::string, bool> CollectUniformInfosFromIR(const glslang::TIntermediate& intermediate, std::set<std::string>* vOutUsedBindings = nullptr);
+    // the files are read through this cache, the file watcher must call UpdateFiles on it
+    ShaderIncludeCache& GetIncludeCache();
+    // key of the dependencies of a compilation in the include cache, same vBundleKeySource as CompileGLSLString
+    static std::string GetCompileKey(const std::string& vOriginalFileName, const std::string& vShaderSuffix, const SpirvBundle::KeySource* vBundleKeySource);
+
+    void SetOptimizationMode(const SpirvOptimizationMode& vMode);
+    SpirvOptimizationMode GetOptimizationMode() const;
+
+    // with a bundle, glslang is only used for the shaders not found in the bundle (edited by the user)
+    // in recording mode, the bundle is never read, each compiled shader is added to it
+    void SetSpirvBundle(SpirvBundlePtr vSpirvBundlePtr, const bool& vRecording = false);
+    SpirvBundlePtr GetSpirvBundle() const;
+
+    // key of a binding in the used uniforms, not a valid glsl identifier so no collision with the uniform names
+    static std::string GetBindingKey(const uint32_t& vDescriptorSetIndex, const uint32_t& vBindingPoint);
 
 public:
     bool Init();
     void Unit();
 
+private:
+    // must be called with m_CompilationMutex locked
+    std::vector<unsigned int> OptimizeSpirv(const std::vector<unsigned int>& vRawSpirv, const SpirvOptimizationMode& vMode);
+    static void StripSourceDebugInfos(std::vector<std::uint32_t>& vSpirv);
+    bool LoadFromSpirvBundle(const std::string& vKey,
+        const std::string& vCompileKey,
+        std::unordered_map<std::string, bool>* vUsedUniforms,
+        std::set<std::string>* vUsedBindings,
+        std::vector<unsigned int>& vOutSpirv);
+    void AddToSpirvBundle(const std::string& vKey,
+        const std::vector<unsigned int>& vSpirv,
+        const std::unordered_map<std::string, bool>& vUsedUniforms,
+        const std::set<std::string>& vUsedBindings,
+        const ShaderIncludeCache::DependenciesContainer& vDependencies);
+
 public:
     VulkanShader();                       // Prevent construction
     VulkanShader(const VulkanShader&){};  // Prevent construction by copying
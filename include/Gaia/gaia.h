@@ -139,6 +139,18 @@ class VulkanShader;
 typedef std::shared_ptr<VulkanShader> VulkanShaderPtr;
 typedef std::weak_ptr<VulkanShader> VulkanShaderWeak;
 
+class SpirvBundle;
+typedef std::shared_ptr<SpirvBundle> SpirvBundlePtr;
+typedef std::weak_ptr<SpirvBundle> SpirvBundleWeak;
+
+class PipelineManifest;
+typedef std::shared_ptr<PipelineManifest> PipelineManifestPtr;
+typedef std::weak_ptr<PipelineManifest> PipelineManifestWeak;
+
+class TextureDiskCache;
+typedef std::shared_ptr<TextureDiskCache> TextureDiskCachePtr;
+typedef std::weak_ptr<TextureDiskCache> TextureDiskCacheWeak;
+
 namespace GaiApi {
     class VulkanSwapChain;
     typedef std::shared_ptr<VulkanSwapChain> VulkanSwapChainPtr;
@@ -155,6 +167,26 @@ namespace GaiApi {
     class VulkanDevice;
     typedef std::shared_ptr<VulkanDevice> VulkanDevicePtr;
     typedef std::weak_ptr<VulkanDevice> VulkanDeviceWeak;
+
+    class VulkanUniformArena;
+    typedef std::shared_ptr<VulkanUniformArena> VulkanUniformArenaPtr;
+    typedef std::weak_ptr<VulkanUniformArena> VulkanUniformArenaWeak;
+
+    class VulkanMipGenerator;
+    typedef std::shared_ptr<VulkanMipGenerator> VulkanMipGeneratorPtr;
+    typedef std::weak_ptr<VulkanMipGenerator> VulkanMipGeneratorWeak;
+
+    class VulkanImageConverter;
+    typedef std::shared_ptr<VulkanImageConverter> VulkanImageConverterPtr;
+    typedef std::weak_ptr<VulkanImageConverter> VulkanImageConverterWeak;
+
+    class VulkanCubeFilter;
+    typedef std::shared_ptr<VulkanCubeFilter> VulkanCubeFilterPtr;
+    typedef std::weak_ptr<VulkanCubeFilter> VulkanCubeFilterWeak;
+
+    class VulkanPipelineRegistry;
+    typedef std::shared_ptr<VulkanPipelineRegistry> VulkanPipelineRegistryPtr;
+    typedef std::weak_ptr<VulkanPipelineRegistry> VulkanPipelineRegistryWeak;
 }  // namespace GaiApi
 
 typedef void* GaiaUserDatas;
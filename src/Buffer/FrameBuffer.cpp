@@ -26,6 +26,7 @@ limitations under the License.
 #include <ezlibs/ezFile.hpp>
 #include <ImWidgets.h>
 #include <Gaia/Core/VulkanSubmitter.h>
+#include <Gaia/Core/VulkanPipelineRegistry.h>
 
 #ifdef PROFILER_INCLUDE
 #include <vulkan/vulkan.hpp>
@@ -98,6 +99,14 @@ bool FrameBuffer::Init(const ez::uvec2& vSize,
 
             m_CreateRenderPass = vCreateRenderPass;
 
+            if (m_UseDynamicRendering) {
+                auto devicePtr = corePtr->getFrameworkDevice().lock();
+                if (!devicePtr || !devicePtr->m_DynamicRenderingFeature.dynamicRendering) {
+                    LogVarDebugWarning("Debug : the dynamic rendering is not supported by the device, a renderpass is used");
+                    m_UseDynamicRendering = false;
+                }
+            }
+
             SetRenderPass(vExternalRenderPass);  // can only be set if m_CreateRenderPass is false
 
             m_TemporarySize = ez::ivec2(size.x, size.y);
@@ -135,6 +144,23 @@ void FrameBuffer::Unit() {
     DestroyFrameBuffers();
 }
 
+void FrameBuffer::SetUseDynamicRendering(const bool& vFlag) {
+    ZoneScoped;
+    m_UseDynamicRendering = vFlag;
+}
+
+bool FrameBuffer::IsUsingDynamicRendering() const {
+    return m_UseDynamicRendering;
+}
+
+const vk::PipelineRenderingCreateInfoKHR* FrameBuffer::GetPipelineRenderingCreateInfo() const {
+    ZoneScoped;
+    if (m_UseDynamicRendering) {
+        return &m_PipelineRenderingCreateInfo;
+    }
+    return nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// PUBLIC / RESIZE ///////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -207,7 +233,9 @@ void FrameBuffer::End(vk::CommandBuffer* vCmdBufferPtr) {
 
 void FrameBuffer::BeginRenderPass(vk::CommandBuffer* vCmdBufferPtr) {
     ZoneScoped;
-    if (vCmdBufferPtr) {
+    if (vCmdBufferPtr && m_UseDynamicRendering) {
+        BeginRendering(vCmdBufferPtr);
+    } else if (vCmdBufferPtr) {
         auto fbo = GetFrontFbo();
 
         vCmdBufferPtr->beginRenderPass(vk::RenderPassBeginInfo(m_RenderPass, fbo->framebuffer, m_RenderArea,
@@ -233,7 +261,9 @@ void FrameBuffer::ClearAttachmentsIfNeeded(vk::CommandBuffer* vCmdBufferPtr, con
 
 void FrameBuffer::EndRenderPass(vk::CommandBuffer* vCmdBufferPtr) {
     ZoneScoped;
-    if (vCmdBufferPtr) {
+    if (vCmdBufferPtr && m_UseDynamicRendering) {
+        EndRendering(vCmdBufferPtr);
+    } else if (vCmdBufferPtr) {
         vCmdBufferPtr->endRenderPass();
     }
 }
@@ -304,6 +334,19 @@ vk::SampleCountFlagBits FrameBuffer::GetSampleCount() const {
     return m_SampleCount;
 }
 
+// the load/store ops and the clear values are not part of the renderpass compatibility
+// with the dynamic rendering, the pipelines are compatible if the formats are the same
+uint64_t FrameBuffer::GetRenderPassCompatibilityKey() const {
+    ZoneScoped;
+    if (m_UseDynamicRendering) {
+        return VulkanPipelineRegistry::Hasher().add(m_UseDynamicRendering).add(m_CountBuffers).add(m_PixelFormat).add(m_SampleCount).add(m_UseDepth).get();
+    }
+    if (m_IsRenderPassExternal || !m_CreateRenderPass) {
+        return 0U;
+    }
+    return VulkanPipelineRegistry::Hasher().add(m_CountBuffers).add(m_PixelFormat).add(m_SampleCount).add(m_UseDepth).get();
+}
+
 ez::fvec2 FrameBuffer::GetOutputSize() const {
     ZoneScoped;
     return ez::fvec2((float)m_OutputSize.x, (float)m_OutputSize.y);
@@ -481,7 +524,7 @@ DescriptorImageInfoVector* FrameBuffer::GetBackDescriptorImageInfos(fvec2Vector*
     return &m_BackDescriptors;
 }
 
-bool FrameBuffer::UpdateMipMapping(const uint32_t& vBindingPoint) {
+bool FrameBuffer::UpdateMipMapping(const uint32_t& vBindingPoint, vk::CommandBuffer* vCmdBufferPtr) {
     uint32_t maxBuffers = 0U;
     auto fbos = GetBackBufferAttachments(&maxBuffers);
     if (fbos) {
@@ -494,7 +537,7 @@ bool FrameBuffer::UpdateMipMapping(const uint32_t& vBindingPoint) {
             }
         }
         if (att->sampleCount == vk::SampleCountFlagBits::e1) {
-            return att->UpdateMipMapping();
+            return att->UpdateMipMapping(vCmdBufferPtr);
         }
     }
     return false;
@@ -545,12 +588,22 @@ bool FrameBuffer::CreateFrameBuffers(const ez::uvec2& vSize,
             res = true;
 
             m_FrameBuffers.resize(m_PingPongBufferMode ? 2U : 1U);
-            res &= m_FrameBuffers[0U].Init(
-                m_VulkanCore, size, m_CountBuffers, m_RenderPass, vCreateRenderPass, vUseDepth, vNeedToClear, vClearColor, vFormat, vSampleCount);
+            res &= m_FrameBuffers[0U].Init(m_VulkanCore, size, m_CountBuffers, m_RenderPass, vCreateRenderPass && !m_UseDynamicRendering, vUseDepth,
+                vNeedToClear, vClearColor, vFormat, vSampleCount, m_UseDynamicRendering);
             if (m_PingPongBufferMode) {
                 res &= m_FrameBuffers[1U].Init(m_VulkanCore, size, m_CountBuffers, m_RenderPass,
                     false,  // this one will re use the same Renderpass as first one
-                    vUseDepth, vNeedToClear, vClearColor, vFormat, vSampleCount);
+                    vUseDepth, vNeedToClear, vClearColor, vFormat, vSampleCount, m_UseDynamicRendering);
+            }
+
+            m_ColorAttachmentFormats.assign(m_CountBuffers, vFormat);
+            m_PipelineRenderingCreateInfo = vk::PipelineRenderingCreateInfoKHR();
+            m_PipelineRenderingCreateInfo.colorAttachmentCount = static_cast<uint32_t>(m_ColorAttachmentFormats.size());
+            m_PipelineRenderingCreateInfo.pColorAttachmentFormats = m_ColorAttachmentFormats.data();
+            if (vUseDepth) {
+                // same format as VulkanFrameBuffer::Init
+                m_PipelineRenderingCreateInfo.depthAttachmentFormat = vk::Format::eD32SfloatS8Uint;
+                m_PipelineRenderingCreateInfo.stencilAttachmentFormat = vk::Format::eD32SfloatS8Uint;
             }
 
             if (vNeedToClear) {
@@ -578,3 +631,95 @@ void FrameBuffer::DestroyFrameBuffers() {
         m_RenderPass = vk::RenderPass{};
     }
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE / DYNAMIC RENDERING ///////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the barriers do the job of the subpass dependencies and of the layout transitions of the renderpass
+void FrameBuffer::BeginRendering(vk::CommandBuffer* vCmdBufferPtr) {
+    ZoneScoped;
+    auto fbo = GetFrontFbo();
+    const bool useMultiSampling = (m_SampleCount != vk::SampleCountFlagBits::e1);
+
+    std::vector<vk::ImageMemoryBarrier> barriers;
+    for (size_t idx = 0U; idx < fbo->attachments.size(); ++idx) {
+        const auto& att = fbo->attachments[idx];
+        const bool isDepth = m_UseDepth && idx == fbo->depthAttIndex;
+        const auto layout = isDepth ? vk::ImageLayout::eDepthStencilAttachmentOptimal : vk::ImageLayout::eAttachmentOptimal;
+        vk::ImageMemoryBarrier barrier;
+        barrier.srcAccessMask = isDepth ? vk::AccessFlagBits::eDepthStencilAttachmentWrite
+                                        : (vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eColorAttachmentWrite);
+        barrier.dstAccessMask = isDepth ? (vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite)
+                                        : (vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite);
+        barrier.oldLayout = fbo->layoutsInitialized ? layout : vk::ImageLayout::eUndefined;
+        barrier.newLayout = layout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = att.attachmentPtr->image;
+        barrier.subresourceRange = vk::ImageSubresourceRange(
+            isDepth ? (vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil) : vk::ImageAspectFlagBits::eColor, 0, att.mipLevelCount, 0,
+            1);
+        barriers.push_back(barrier);
+    }
+    vCmdBufferPtr->pipelineBarrier(
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests,
+        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests |
+            vk::PipelineStageFlagBits::eLateFragmentTests,
+        vk::DependencyFlags(), 0, nullptr, 0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data());
+    fbo->layoutsInitialized = true;
+
+    std::vector<vk::RenderingAttachmentInfoKHR> colorAttachments;
+    for (uint32_t idx = 0U; idx < m_CountBuffers; ++idx) {
+        const auto& att = fbo->attachments[idx];
+        vk::RenderingAttachmentInfoKHR colorAttachment;
+        colorAttachment.imageView = att.attachmentView;
+        colorAttachment.imageLayout = vk::ImageLayout::eAttachmentOptimal;
+        colorAttachment.loadOp = att.attachmentDescription.loadOp;
+        colorAttachment.storeOp = att.attachmentDescription.storeOp;
+        if (idx < m_ClearColorValues.size()) {
+            colorAttachment.clearValue = m_ClearColorValues[idx];
+        }
+        if (useMultiSampling) {
+            colorAttachment.resolveMode = vk::ResolveModeFlagBits::eAverage;
+            colorAttachment.resolveImageView = fbo->attachments[idx + m_CountBuffers].attachmentView;
+            colorAttachment.resolveImageLayout = vk::ImageLayout::eAttachmentOptimal;
+        }
+        colorAttachments.push_back(colorAttachment);
+    }
+
+    vk::RenderingInfoKHR renderingInfo;
+    renderingInfo.renderArea = m_RenderArea;
+    renderingInfo.layerCount = 1U;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(colorAttachments.size());
+    renderingInfo.pColorAttachments = colorAttachments.data();
+
+    vk::RenderingAttachmentInfoKHR depthAttachment;
+    vk::RenderingAttachmentInfoKHR stencilAttachment;
+    if (m_UseDepth) {
+        const auto& att = fbo->attachments[fbo->depthAttIndex];
+        depthAttachment.imageView = att.attachmentView;
+        depthAttachment.imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
+        depthAttachment.loadOp = att.attachmentDescription.loadOp;
+        depthAttachment.storeOp = att.attachmentDescription.storeOp;
+        depthAttachment.clearValue = vk::ClearDepthStencilValue(1.0f, 0u);
+        stencilAttachment = depthAttachment;
+        stencilAttachment.loadOp = att.attachmentDescription.stencilLoadOp;
+        stencilAttachment.storeOp = att.attachmentDescription.stencilStoreOp;
+        renderingInfo.pDepthAttachment = &depthAttachment;
+        renderingInfo.pStencilAttachment = &stencilAttachment;
+    }
+
+    vCmdBufferPtr->beginRenderingKHR(renderingInfo);
+}
+
+void FrameBuffer::EndRendering(vk::CommandBuffer* vCmdBufferPtr) {
+    ZoneScoped;
+    vCmdBufferPtr->endRenderingKHR();
+
+    // the attachments can be sampled by the next passes, at any texel so not by region
+    const auto barrier = vk::MemoryBarrier(
+        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite, vk::AccessFlagBits::eShaderRead);
+    vCmdBufferPtr->pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eLateFragmentTests,
+        vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags(), 1, &barrier, 0, nullptr, 0, nullptr);
+}
@@ -26,6 +26,12 @@ limitations under the License.
 #include <Gaia/Resources/Texture2D.h>
 #include <Gaia/Resources/Texture3D.h>
 #include <Gaia/Resources/TextureCube.h>
+#include <Gaia/Resources/VulkanUniformArena.h>
+#include <Gaia/Resources/VulkanMipGenerator.h>
+#include <Gaia/Resources/VulkanImageConverter.h>
+#include <Gaia/Resources/VulkanCubeFilter.h>
+#include <Gaia/Core/VulkanPipelineRegistry.h>
+#include <Gaia/Rendering/Base/PipelineManifest.h>
 #include <Gaia/Shader/VulkanShader.h>
 #include <Gaia/Gui/VulkanProfiler.h>
 
@@ -189,6 +195,12 @@ bool VulkanCore::Init(VulkanWindowWeak vVulkanWindow,
         setupDescriptorPool();
         setupProfiler();
 
+        m_UniformArenaPtr = VulkanUniformArena::Create(m_This, sUniformArenaFrameSize);
+        m_MipGeneratorPtr = VulkanMipGenerator::Create(m_This);
+        m_ImageConverterPtr = VulkanImageConverter::Create(m_This);
+        m_CubeFilterPtr = VulkanCubeFilter::Create(m_This);
+        m_PipelineRegistryPtr = VulkanPipelineRegistry::Create(m_This);
+
         m_EmptyTexture2DPtr = Texture2D::CreateEmptyTexture(m_This.lock(), ez::uvec2(1, 1), vk::Format::eR8G8B8A8Unorm);
         m_EmptyTexture3DPtr = Texture3D::CreateEmptyTexture(m_This.lock(), ez::uvec3(1, 1, 1), vk::Format::eR8G8B8A8Unorm);
         m_EmptyTextureCubePtr = TextureCube::CreateEmptyTexture(m_This.lock(), ez::uvec2(1, 1), vk::Format::eR8G8B8A8Unorm);
@@ -208,6 +220,17 @@ void VulkanCore::Unit() {
     m_EmptyTexture3DPtr.reset();
     m_EmptyTextureCubePtr.reset();
 
+    m_UniformArenaPtr.reset();
+    m_MipGeneratorPtr.reset();
+    m_ImageConverterPtr.reset();
+    m_CubeFilterPtr.reset();
+    m_PipelineRegistryPtr.reset();
+    if (m_PipelineManifestPtr && m_PipelineManifestPtr->GetMissesCount()) {
+        LogVarLightInfo("%s", m_PipelineManifestPtr->GetMissesReport().c_str());
+    }
+    m_PipelineManifestPtr.reset();
+    m_TextureDiskCachePtr.reset();
+
     destroyProfiler();
 
     destroyDescriptorPool();
@@ -288,6 +311,37 @@ vk::DescriptorBufferInfo* VulkanCore::getEmptyDescriptorBufferInfo() {
 vk::BufferView* VulkanCore::getEmptyBufferView() {
     return &m_EmptyBufferView;
 }
+VulkanUniformArenaWeak VulkanCore::getUniformArena() const {
+    return m_UniformArenaPtr;
+}
+
+VulkanMipGeneratorWeak VulkanCore::getMipGenerator() const {
+    return m_MipGeneratorPtr;
+}
+
+VulkanImageConverterWeak VulkanCore::getImageConverter() const {
+    return m_ImageConverterPtr;
+}
+
+VulkanCubeFilterWeak VulkanCore::getCubeFilter() const {
+    return m_CubeFilterPtr;
+}
+
+VulkanPipelineRegistryWeak VulkanCore::getPipelineRegistry() const {
+    return m_PipelineRegistryPtr;
+}
+void VulkanCore::setPipelineManifest(PipelineManifestPtr vPipelineManifestPtr) {
+    m_PipelineManifestPtr = vPipelineManifestPtr;
+}
+PipelineManifestWeak VulkanCore::getPipelineManifest() const {
+    return m_PipelineManifestPtr;
+}
+void VulkanCore::setTextureDiskCache(TextureDiskCachePtr vTextureDiskCachePtr) {
+    m_TextureDiskCachePtr = vTextureDiskCachePtr;
+}
+TextureDiskCacheWeak VulkanCore::getTextureDiskCache() const {
+    return m_TextureDiskCachePtr;
+}
 
 vk::Instance VulkanCore::getInstance() const {
     return m_VulkanDevicePtr->m_Instance;
@@ -405,6 +459,23 @@ bool VulkanCore::frameBegin() {
                 1, &m_VulkanSwapChainPtr->m_WaitFences[m_VulkanSwapChainPtr->m_FrameIndex], VK_TRUE, UINT64_MAX) == vk::Result::eSuccess) {
             if (m_VulkanDevicePtr->m_LogDevice.resetFences(1, &m_VulkanSwapChainPtr->m_WaitFences[m_VulkanSwapChainPtr->m_FrameIndex]) ==
                 vk::Result::eSuccess) {
+                // the gpu has finished with this frame, so his uniform arena region can be reused
+                if (m_UniformArenaPtr) {
+                    m_UniformArenaPtr->BeginFrame(m_VulkanSwapChainPtr->m_FrameIndex);
+                }
+                if (m_MipGeneratorPtr) {
+                    m_MipGeneratorPtr->BeginFrame(m_VulkanSwapChainPtr->m_FrameIndex);
+                }
+                if (m_ImageConverterPtr) {
+                    m_ImageConverterPtr->BeginFrame(m_VulkanSwapChainPtr->m_FrameIndex);
+                }
+                if (m_CubeFilterPtr) {
+                    m_CubeFilterPtr->BeginFrame(m_VulkanSwapChainPtr->m_FrameIndex);
+                }
+                if (m_PipelineRegistryPtr) {
+                    m_PipelineRegistryPtr->BeginFrame();
+                }
+
                 // todo : reset pool instead ?
                 // m_CommandBuffers[m_VulkanSwapChainPtr->m_FrameIndex].reset(vk::CommandBufferResetFlagBits::eReleaseResources);
 
@@ -604,7 +675,7 @@ void VulkanCore::setupDescriptorPool() {
         vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, 1000), vk::DescriptorPoolSize(vk::DescriptorType::eUniformTexelBuffer, 1000),
         vk::DescriptorPoolSize(vk::DescriptorType::eStorageTexelBuffer, 1000), vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, 1000),
         vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 1000),
-        // vk::DescriptorPoolSize(vk::DescriptorType::eUniformBufferDynamic, 1000),
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBufferDynamic, 1000),
         // vk::DescriptorPoolSize(vk::DescriptorType::eStorageBufferDynamic, 1000),
         // vk::DescriptorPoolSize(vk::DescriptorType::eInputAttachment, 1000)
     };
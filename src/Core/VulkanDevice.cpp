@@ -730,6 +730,19 @@ bool VulkanDevice::CreateLogicalDevice() {
 
     if (m_ApiVersion != VK_API_VERSION_1_0) {
         wantedDeviceExtensions.emplace_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+        // the supported features need vkGetPhysicalDeviceFeatures2 for be known
+        wantedDeviceExtensions.emplace_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+        wantedDeviceExtensions.emplace_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+        // the pipeline parts built separately and linked by the passes
+        wantedDeviceExtensions.emplace_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        wantedDeviceExtensions.emplace_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        // the rendering without renderpass and framebuffer objects, see FrameBuffer::SetUseDynamicRendering
+        wantedDeviceExtensions.emplace_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+        wantedDeviceExtensions.emplace_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+        wantedDeviceExtensions.emplace_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+        // the build times and the statistics of the pipelines, shown by vkProfiler
+        wantedDeviceExtensions.emplace_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+        wantedDeviceExtensions.emplace_back(VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME);
     }
 
     // RTX
@@ -800,6 +813,13 @@ bool VulkanDevice::CreateLogicalDevice() {
         m_PhysDeviceFeatures.setShaderInt64(true);
     }
 
+    if (features.shaderStorageImageExtendedFormats) {
+        // for the storage images in rg32f, r16f, rgba16, r11f_g11f_b10f, etc..
+        // used by the compute mip generator
+        LogVarLightInfo("Feature vk 1.0 : storage image extended formats");
+        m_PhysDeviceFeatures.setShaderStorageImageExtendedFormats(true);
+    }
+
     m_PhysDeviceFeatures2.setFeatures(m_PhysDeviceFeatures);
 
     // we reproduce the start of each feature structure
@@ -823,6 +843,60 @@ bool VulkanDevice::CreateLogicalDevice() {
         chains.push_back((pNextDatas*)&m_DynamicStates);
     }
 
+    if (deviceExtensions.exist(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME)) {
+        const auto supported = m_PhysDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>()
+                                   .get<vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>();
+        LogVarLightInfo("Feature vk 1.1 : Dynamic States 2");
+        m_DynamicStates2.setExtendedDynamicState2(supported.extendedDynamicState2);
+        m_DynamicStates2.setExtendedDynamicState2PatchControlPoints(supported.extendedDynamicState2PatchControlPoints);
+        chains.push_back((pNextDatas*)&m_DynamicStates2);
+    }
+
+    if (deviceExtensions.exist(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME)) {
+        const auto supported = m_PhysDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT>()
+                                   .get<vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT>();
+        LogVarLightInfo("Feature vk 1.1 : Dynamic States 3");
+        m_DynamicStates3.setExtendedDynamicState3PolygonMode(supported.extendedDynamicState3PolygonMode);
+        m_DynamicStates3.setExtendedDynamicState3ColorBlendEnable(supported.extendedDynamicState3ColorBlendEnable);
+        chains.push_back((pNextDatas*)&m_DynamicStates3);
+    }
+
+    if (deviceExtensions.exist(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) &&  //
+        deviceExtensions.exist(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+        const auto supported = m_PhysDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>()
+                                   .get<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+        if (supported.graphicsPipelineLibrary) {
+            LogVarLightInfo("Feature vk 1.1 : Graphics Pipeline Library");
+            m_GraphicsPipelineLibraryFeature.setGraphicsPipelineLibrary(true);
+            chains.push_back((pNextDatas*)&m_GraphicsPipelineLibraryFeature);
+        }
+    }
+
+    if (deviceExtensions.exist(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME)) {
+        const auto supported = m_PhysDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDynamicRenderingFeaturesKHR>()
+                                   .get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+        if (supported.dynamicRendering) {
+            LogVarLightInfo("Feature vk 1.1 : Dynamic Rendering");
+            m_DynamicRenderingFeature.setDynamicRendering(true);
+            chains.push_back((pNextDatas*)&m_DynamicRenderingFeature);
+        }
+    }
+
+    if (deviceExtensions.exist(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME)) {
+        LogVarLightInfo("Feature vk 1.1 : Pipeline Creation Feedback");
+        m_PipelineCreationFeedbackSupported = true;
+    }
+
+    if (deviceExtensions.exist(VK_KHR_PIPELINE_EXECUTABLE_PROPERTIES_EXTENSION_NAME)) {
+        const auto supported = m_PhysDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDevicePipelineExecutablePropertiesFeaturesKHR>()
+                                   .get<vk::PhysicalDevicePipelineExecutablePropertiesFeaturesKHR>();
+        if (supported.pipelineExecutableInfo) {
+            LogVarLightInfo("Feature vk 1.1 : Pipeline Executable Properties");
+            m_PipelineExecutablePropertiesFeature.setPipelineExecutableInfo(true);
+            chains.push_back((pNextDatas*)&m_PipelineExecutablePropertiesFeature);
+        }
+    }
+
     if (deviceExtensions.exist(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
         LogVarLightInfo("Feature vk 1.1 : synchronisation 2");
         m_Synchronization2Feature.setSynchronization2(true);
@@ -0,0 +1,1022 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Core/VulkanPipelineBuilder.h>
+#include <Gaia/Core/VulkanCore.h>
+#include <Gaia/Core/VulkanDevice.h>
+#include <Gaia/Shader/VulkanShader.h>
+#include <Gaia/Gui/VulkanProfiler.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <algorithm>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace GaiApi {
+
+// the spirv of a used stage, nullptr if the stage is not used
+static const std::vector<unsigned int>* GetStageSpirv(const VulkanPipelineBuilder::ShaderSpirvsContainer& vSpirvs, const vk::ShaderStageFlagBits& vStage) {
+    auto it = vSpirvs.find(vStage);
+    if (it == vSpirvs.end() || it->second.empty()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTOR /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanPipelineBuilder::VulkanPipelineBuilder(VulkanCoreWeak vVulkanCore) : m_VulkanCore(vVulkanCore) {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    m_Device = corePtr->getDevice();
+    QueryDeviceSupport();
+}
+
+VulkanPipelineBuilder::~VulkanPipelineBuilder() {
+    ZoneScoped;
+    Unit();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// INIT / UNIT /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanPipelineBuilder::Unit() {
+    ZoneScoped;
+    WaitSpecializedPipelineJobs();
+    DestroySpecializedPipelines(false);
+    DestroyRetiredPipelines(true);
+    WaitOptimizedLinks();  // after the jobs, who can start links
+    if (m_PipelineCache) {
+        m_Device.destroyPipelineCache(m_PipelineCache);
+    }
+    m_PipelineCache = vk::PipelineCache{};
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// FRAME ///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanPipelineBuilder::BeginFrame() {
+    ZoneScoped;
+    ++m_FrameCounter;
+    DestroyRetiredPipelines(false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// BUILD ///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanPipelineBuilder::BuildPipeline(const bool& vIsPixel,
+    const ShaderSpirvsContainer& vSpirvs,
+    const PipelineBuildStatesStruct& vStates,
+    PipelineStruct& vOutPipeline,
+    const SpecializationConstantsContainer& vConstants) {
+    ZoneScoped;
+    if (vIsPixel) {
+        return BuildPixelPipeline(vSpirvs, vStates, vOutPipeline, vConstants);
+    }
+    return BuildComputePipeline(vSpirvs, vStates, vOutPipeline, vConstants);
+}
+
+// can be called from a worker thread, for the background hot reload
+// the pass states are read only from vStates, see ShaderPass::CapturePipelineBuildStates
+bool VulkanPipelineBuilder::BuildComputePipeline(const ShaderSpirvsContainer& vSpirvs,
+    const PipelineBuildStatesStruct& vStates,
+    PipelineStruct& vOutPipeline,
+    const SpecializationConstantsContainer& vConstants) {
+    ZoneScoped;
+
+    const auto* spirvPtr = GetStageSpirv(vSpirvs, vk::ShaderStageFlagBits::eCompute);
+    if (!spirvPtr)
+        return false;
+
+    const uint64_t layoutKey = vStates.m_PipelineLayoutKey;
+    vOutPipeline.m_PipelineLayout = AcquirePipelineLayout(vStates);
+
+    const auto& spirv = *spirvPtr;
+
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto registryPtr = corePtr->getPipelineRegistry().lock();
+    VulkanPipelineRegistry::Hasher hasher;
+    hasher.add(layoutKey).add(vk::ShaderStageFlagBits::eCompute).add(VulkanPipelineRegistry::GetSpirvKey(spirv));
+    for (const auto& constant : vConstants) {
+        hasher.add(constant.first).add(constant.second);
+    }
+    const auto pipelineKey = hasher.get();
+    if (registryPtr) {
+        vOutPipeline.m_Pipeline = registryPtr->FindPipeline(pipelineKey);
+        if (vOutPipeline.m_Pipeline) {
+            return true;
+        }
+    }
+
+    auto cs = AcquireShaderModule(spirv);
+
+    std::vector<vk::PipelineShaderStageCreateInfo> shaderCreateInfos = {
+        vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eCompute, cs, "main")};
+
+    std::vector<vk::SpecializationMapEntry> specializationEntries;
+    std::vector<uint32_t> specializationDatas;
+    const auto specializationInfo = GetSpecializationInfo(vConstants, specializationEntries, specializationDatas);
+    if (!vConstants.empty()) {
+        shaderCreateInfos[0].setPSpecializationInfo(&specializationInfo);
+    }
+
+    PipelineFeedbackStruct feedback;
+    vk::ComputePipelineCreateInfo computePipeInfo = vk::ComputePipelineCreateInfo()
+                                                        .setFlags(GetPipelineStatisticsFlags())
+                                                        .setStage(shaderCreateInfos[0])
+                                                        .setLayout(vOutPipeline.m_PipelineLayout);
+    computePipeInfo.setPNext(ChainPipelineFeedback(feedback, nullptr));
+    vOutPipeline.m_Pipeline = m_Device.createComputePipeline(nullptr, computePipeInfo).value;
+    AddPipelineStatistics("compute", feedback, vOutPipeline.m_Pipeline);
+    if (registryPtr) {
+        vOutPipeline.m_Pipeline = registryPtr->AddPipeline(pipelineKey, vOutPipeline.m_Pipeline);
+    }
+
+    ReleaseShaderModule(cs);
+
+    return true;
+}
+
+// can be called from a worker thread, for the background hot reload
+// the pass states are read only from vStates, see ShaderPass::CapturePipelineBuildStates
+bool VulkanPipelineBuilder::BuildPixelPipeline(const ShaderSpirvsContainer& vSpirvs,
+    const PipelineBuildStatesStruct& vStates,
+    PipelineStruct& vOutPipeline,
+    const SpecializationConstantsContainer& vConstants) {
+    ZoneScoped;
+
+    if (!vStates.m_RenderPass && !vStates.m_UseRenderingInfo)
+        return false;
+    const auto* vertexSpirvPtr = GetStageSpirv(vSpirvs, vk::ShaderStageFlagBits::eVertex);
+    const auto* fragmentSpirvPtr = GetStageSpirv(vSpirvs, vk::ShaderStageFlagBits::eFragment);
+    if (!vertexSpirvPtr || !fragmentSpirvPtr)
+        return false;
+
+    const std::vector<unsigned int>* tessControlSpirvPtr = nullptr;
+    const std::vector<unsigned int>* tessEvalSpirvPtr = nullptr;
+    if (vStates.m_Tesselated) {
+        tessControlSpirvPtr = GetStageSpirv(vSpirvs, vk::ShaderStageFlagBits::eTessellationControl);
+        tessEvalSpirvPtr = GetStageSpirv(vSpirvs, vk::ShaderStageFlagBits::eTessellationEvaluation);
+        if (!tessControlSpirvPtr || !tessEvalSpirvPtr)
+            return false;
+    }
+
+    const uint64_t layoutKey = vStates.m_PipelineLayoutKey;
+    vOutPipeline.m_PipelineLayout = AcquirePipelineLayout(vStates);
+
+    const auto inputState = vk::PipelineVertexInputStateCreateInfo(vk::PipelineVertexInputStateCreateFlags(),
+        static_cast<uint32_t>(vStates.m_VertexBindings.size()),
+        vStates.m_VertexBindings.data(),
+        static_cast<uint32_t>(vStates.m_VertexAttributes.size()),
+        vStates.m_VertexAttributes.data());
+
+    // the canonical description of the pipeline. the viewport and the scissor are dynamic, so not in the key
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    const auto renderPassKey = vStates.m_RenderPassKey;
+    auto registryPtr = renderPassKey ? corePtr->getPipelineRegistry().lock() : nullptr;
+    uint64_t pipelineKey = 0U;
+    uint64_t statesKey = 0U;  // all but the shaders and the renderpass
+    if (registryPtr) {
+        VulkanPipelineRegistry::Hasher hasher;
+        hasher.add(layoutKey);
+        for (const auto& constant : vConstants) {
+            hasher.add(constant.first).add(constant.second);
+        }
+        hasher.add(vStates.m_Tesselated).add(vStates.m_PrimitiveTopology).add(vStates.m_CanDynamicallyChangePrimitiveTopology);
+        hasher.add(vStates.m_StaticStatesKey).add(vStates.m_DynamicStatesSupport.m_CullMode).add(vStates.m_DynamicStatesSupport.m_DepthTest);
+        const auto& dynamicStates = vStates.m_DynamicStatesSupport;
+        hasher.add(dynamicStates.m_PatchControlPoints).add(dynamicStates.m_PolygonMode).add(dynamicStates.m_ColorBlendEnable);
+        hasher.add(vStates.m_SampleCount).add(vStates.m_CountColorBuffers);
+        for (const auto& binding : vStates.m_VertexBindings) {
+            hasher.add(binding.binding).add(binding.stride).add(binding.inputRate);
+        }
+        for (const auto& attribute : vStates.m_VertexAttributes) {
+            hasher.add(attribute.location).add(attribute.binding).add(attribute.format).add(attribute.offset);
+        }
+        statesKey = hasher.get();
+        hasher.add(renderPassKey);
+        for (const auto& stage : vSpirvs) {
+            hasher.add(stage.first).add(VulkanPipelineRegistry::GetSpirvKey(stage.second));
+        }
+        pipelineKey = hasher.get();
+        vOutPipeline.m_Pipeline = registryPtr->FindPipeline(pipelineKey);
+        if (vOutPipeline.m_Pipeline) {
+            return true;
+        }
+    }
+
+    auto vs = AcquireShaderModule(*vertexSpirvPtr);
+    auto fs = AcquireShaderModule(*fragmentSpirvPtr);
+    std::vector<vk::PipelineShaderStageCreateInfo> shaderCreateInfos = {
+        vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eVertex, vs, "main"),
+        vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eFragment, fs, "main")};
+
+    vk::ShaderModule tc, te;
+    if (vStates.m_Tesselated) {
+        tc = AcquireShaderModule(*tessControlSpirvPtr);
+        te = AcquireShaderModule(*tessEvalSpirvPtr);
+        shaderCreateInfos.push_back(
+            vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eTessellationControl, tc, "main"));
+        shaderCreateInfos.push_back(
+            vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eTessellationEvaluation, te, "main"));
+    }
+
+    std::vector<vk::SpecializationMapEntry> specializationEntries;
+    std::vector<uint32_t> specializationDatas;
+    const auto specializationInfo = GetSpecializationInfo(vConstants, specializationEntries, specializationDatas);
+    if (!vConstants.empty()) {
+        for (auto& shaderCreateInfo : shaderCreateInfos) {
+            shaderCreateInfo.setPSpecializationInfo(&specializationInfo);
+        }
+    }
+
+    auto assemblyState = vk::PipelineInputAssemblyStateCreateInfo(vk::PipelineInputAssemblyStateCreateFlags(), vStates.m_PrimitiveTopology);
+
+    vk::PipelineTessellationStateCreateInfo* tesselationStatePtr = nullptr;
+    auto tesselationState = vk::PipelineTessellationStateCreateInfo(vk::PipelineTessellationStateCreateFlags(), vStates.m_PatchControlPoints);
+    if (vStates.m_Tesselated) {
+        tesselationStatePtr = &tesselationState;
+    }
+
+    auto viewportState = vk::PipelineViewportStateCreateInfo(vk::PipelineViewportStateCreateFlags(), 1, &vStates.m_Viewport, 1, &vStates.m_RenderArea);
+
+    auto rasterState = vk::PipelineRasterizationStateCreateInfo(vk::PipelineRasterizationStateCreateFlags(), VK_FALSE, VK_FALSE, vStates.m_PolygonMode,
+        vStates.m_CullMode, vStates.m_FrontFaceMode, VK_FALSE, 0, 0, 0, vStates.m_LineWidth);
+
+    auto multisampleState = vk::PipelineMultisampleStateCreateInfo(vk::PipelineMultisampleStateCreateFlags());
+    multisampleState.rasterizationSamples = vStates.m_SampleCount;
+    // multisampleState.sampleShadingEnable = VK_TRUE;
+    // multisampleState.minSampleShading = 0.2f;
+
+    // with a dynamic color blend enable, the blend factors of the blending are always needed
+    const bool useBlendFactors = vStates.m_BlendingEnabled || vStates.m_DynamicStatesSupport.m_ColorBlendEnable;
+    std::vector<vk::PipelineColorBlendAttachmentState> blendAttachmentStates;
+    for (uint32_t i = 0; i < vStates.m_CountColorBuffers; ++i) {
+        if (useBlendFactors) {
+            blendAttachmentStates.emplace_back(vStates.m_BlendingEnabled ? VK_TRUE : VK_FALSE, vk::BlendFactor::eOne, vk::BlendFactor::eOne,
+                vk::BlendOp::eAdd, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eDstAlpha, vk::BlendOp::eAdd,
+                vk::ColorComponentFlags(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB |
+                                        vk::ColorComponentFlagBits::eA));
+        } else {
+            blendAttachmentStates.emplace_back(VK_FALSE, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::BlendFactor::eOne,
+                vk::BlendFactor::eZero, vk::BlendOp::eAdd,
+                vk::ColorComponentFlags(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB |
+                                        vk::ColorComponentFlagBits::eA));
+        }
+    }
+
+    auto colorBlendState = vk::PipelineColorBlendStateCreateInfo(vk::PipelineColorBlendStateCreateFlags(), VK_FALSE, vk::LogicOp::eCopy,
+        static_cast<uint32_t>(blendAttachmentStates.size()), blendAttachmentStates.data());
+
+    // the compare op is not used when the depth test is disabled (blending), so the same for all
+    const bool depthTest = vStates.m_DepthTestEnabled && !vStates.m_BlendingEnabled;
+    const bool depthWrite = vStates.m_DepthWriteEnabled && !vStates.m_BlendingEnabled;
+    auto depthStencilState = vk::PipelineDepthStencilStateCreateInfo(vk::PipelineDepthStencilStateCreateFlags(), depthTest ? VK_TRUE : VK_FALSE,
+        depthWrite ? VK_TRUE : VK_FALSE, vk::CompareOp::eLessOrEqual, VK_FALSE, VK_FALSE, vk::StencilOpState(), vk::StencilOpState(), 0.0f, 0.0f);
+
+    auto dynamicStateList = std::vector<vk::DynamicState>{vk::DynamicState::eViewport, vk::DynamicState::eScissor, vk::DynamicState::eLineWidth};
+
+    if (!vStates.m_Tesselated &&  // tesselated so no other topology than patch_list can be used
+        vStates.m_CanDynamicallyChangePrimitiveTopology) {
+        dynamicStateList.push_back(vk::DynamicState::ePrimitiveTopologyEXT);
+    }
+
+    // set at record time, see ShaderPass::SetDynamicStates
+    if (vStates.m_DynamicStatesSupport.m_CullMode) {
+        dynamicStateList.push_back(vk::DynamicState::eCullModeEXT);
+        dynamicStateList.push_back(vk::DynamicState::eFrontFaceEXT);
+    }
+    if (vStates.m_DynamicStatesSupport.m_DepthTest) {
+        dynamicStateList.push_back(vk::DynamicState::eDepthTestEnableEXT);
+        dynamicStateList.push_back(vk::DynamicState::eDepthWriteEnableEXT);
+    }
+    if (vStates.m_Tesselated && vStates.m_DynamicStatesSupport.m_PatchControlPoints) {
+        dynamicStateList.push_back(vk::DynamicState::ePatchControlPointsEXT);
+    }
+    if (vStates.m_DynamicStatesSupport.m_PolygonMode) {
+        dynamicStateList.push_back(vk::DynamicState::ePolygonModeEXT);
+    }
+    if (vStates.m_DynamicStatesSupport.m_ColorBlendEnable && vStates.m_CountColorBuffers) {
+        dynamicStateList.push_back(vk::DynamicState::eColorBlendEnableEXT);
+    }
+
+    auto dynamicState = vk::PipelineDynamicStateCreateInfo(
+        vk::PipelineDynamicStateCreateFlags(), static_cast<uint32_t>(dynamicStateList.size()), dynamicStateList.data());
+
+    // with the dynamic rendering the renderpass is null, the pipeline declare only the formats of the attachments
+    auto renderingInfo = vStates.m_RenderingInfo;
+    renderingInfo.pColorAttachmentFormats = vStates.m_ColorAttachmentFormats.data();
+    const auto* renderingInfoPtr = vStates.m_UseRenderingInfo ? &renderingInfo : nullptr;
+
+    // the four parts are built and cached separately in the registry, so a fragment shader edit only build the fragment shader part
+    // the parts are fast linked here, and the optimized link is done on a worker thread
+    if (registryPtr && vStates.m_UseGraphicsPipelineLibrary && m_GraphicsPipelineLibrarySupported) {
+        std::vector<vk::PipelineShaderStageCreateInfo> preRasterStages;
+        std::vector<vk::PipelineShaderStageCreateInfo> fragmentStages;
+        VulkanPipelineRegistry::Hasher preRasterHasher, fragmentHasher, vertexInputHasher, outputHasher;
+        vertexInputHasher.add(vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface).add(statesKey);
+        preRasterHasher.add(vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders).add(statesKey).add(renderPassKey);
+        fragmentHasher.add(vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader).add(statesKey).add(renderPassKey);
+        outputHasher.add(vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface).add(statesKey).add(renderPassKey);
+        for (const auto& shaderCreateInfo : shaderCreateInfos) {
+            const auto spirvKey = VulkanPipelineRegistry::GetSpirvKey(vSpirvs.at(shaderCreateInfo.stage));
+            if (shaderCreateInfo.stage == vk::ShaderStageFlagBits::eFragment) {
+                fragmentStages.push_back(shaderCreateInfo);
+                fragmentHasher.add(shaderCreateInfo.stage).add(spirvKey);
+            } else {
+                preRasterStages.push_back(shaderCreateInfo);
+                preRasterHasher.add(shaderCreateInfo.stage).add(spirvKey);
+            }
+        }
+
+        const std::vector<uint64_t> libraryKeys = {vertexInputHasher.get(), preRasterHasher.get(), fragmentHasher.get(), outputHasher.get()};
+        std::vector<vk::Pipeline> libraries;
+        libraries.push_back(AcquirePipelineLibrary(registryPtr, libraryKeys[0], vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface,
+            vk::GraphicsPipelineCreateInfo()  //
+                .setPVertexInputState(&inputState)
+                .setPInputAssemblyState(&assemblyState)
+                .setPDynamicState(&dynamicState)));
+        libraries.push_back(AcquirePipelineLibrary(registryPtr, libraryKeys[1], vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders,
+            vk::GraphicsPipelineCreateInfo()  //
+                .setStageCount(static_cast<uint32_t>(preRasterStages.size()))
+                .setPStages(preRasterStages.data())
+                .setPTessellationState(tesselationStatePtr)
+                .setPViewportState(&viewportState)
+                .setPRasterizationState(&rasterState)
+                .setPDynamicState(&dynamicState)
+                .setLayout(vOutPipeline.m_PipelineLayout)
+                .setRenderPass(vStates.m_RenderPass)
+                .setPNext(renderingInfoPtr)));
+        libraries.push_back(AcquirePipelineLibrary(registryPtr, libraryKeys[2], vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader,
+            vk::GraphicsPipelineCreateInfo()  //
+                .setStageCount(static_cast<uint32_t>(fragmentStages.size()))
+                .setPStages(fragmentStages.data())
+                .setPMultisampleState(&multisampleState)
+                .setPDepthStencilState(&depthStencilState)
+                .setPDynamicState(&dynamicState)
+                .setLayout(vOutPipeline.m_PipelineLayout)
+                .setRenderPass(vStates.m_RenderPass)
+                .setPNext(renderingInfoPtr)));
+        libraries.push_back(AcquirePipelineLibrary(registryPtr, libraryKeys[3], vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface,
+            vk::GraphicsPipelineCreateInfo()  //
+                .setPMultisampleState(&multisampleState)
+                .setPColorBlendState(&colorBlendState)
+                .setPDynamicState(&dynamicState)
+                .setLayout(vOutPipeline.m_PipelineLayout)
+                .setRenderPass(vStates.m_RenderPass)
+                .setPNext(renderingInfoPtr)));
+
+        vk::Pipeline fastLinkedPipeline;
+        if (std::find(libraries.begin(), libraries.end(), vk::Pipeline{}) == libraries.end()) {
+            auto libraryInfo = vk::PipelineLibraryCreateInfoKHR(static_cast<uint32_t>(libraries.size()), libraries.data());
+            PipelineFeedbackStruct feedback;
+            fastLinkedPipeline = m_Device
+                                     .createGraphicsPipeline(m_PipelineCache,
+                                         vk::GraphicsPipelineCreateInfo()  //
+                                             .setFlags(GetPipelineStatisticsFlags())
+                                             .setPNext(ChainPipelineFeedback(feedback, &libraryInfo))
+                                             .setLayout(vOutPipeline.m_PipelineLayout))
+                                     .value;
+            AddPipelineStatistics("fast link", feedback, fastLinkedPipeline);
+        }
+
+        if (fastLinkedPipeline) {
+            // the fast linked pipeline is not shared, the optimized one will be
+            vOutPipeline.m_Pipeline = fastLinkedPipeline;
+            vOutPipeline.m_Libraries = libraries;
+            StartOptimizedLink(registryPtr, pipelineKey, fastLinkedPipeline, AcquirePipelineLayout(vStates), libraryKeys);
+            ReleaseShaderModule(vs);
+            ReleaseShaderModule(fs);
+            if (vStates.m_Tesselated) {
+                ReleaseShaderModule(tc);
+                ReleaseShaderModule(te);
+            }
+            return true;
+        }
+
+        // fallback on the monolithic pipeline
+        LogVarDebugWarning("Debug : fail to link the pipeline libraries, a monolithic pipeline is built");
+        for (const auto& library : libraries) {
+            if (library) {
+                registryPtr->ReleasePipeline(library);
+            }
+        }
+    }
+
+    PipelineFeedbackStruct feedback;
+    vOutPipeline.                                                                  //
+        m_Pipeline = m_Device                                                        //
+                         .createGraphicsPipeline(                                    //
+                             m_PipelineCache,                                        //
+                             vk::GraphicsPipelineCreateInfo(                         //
+                                 GetPipelineStatisticsFlags(),                       //
+                                 static_cast<uint32_t>(shaderCreateInfos.size()),  //
+                                 shaderCreateInfos.data(),                         //
+                                 &inputState,                                //
+                                 &assemblyState,                                     //
+                                 tesselationStatePtr,                                //
+                                 &viewportState,                                     //
+                                 &rasterState,                                       //
+                                 &multisampleState,                                  //
+                                 &depthStencilState,                                 //
+                                 &colorBlendState,                                   //
+                                 &dynamicState,                                      //
+                                 vOutPipeline.m_PipelineLayout,                    //
+                                 vStates.m_RenderPass,                                   //
+                                 0                                                   //
+                                 )                                                   //
+                                 .setPNext(ChainPipelineFeedback(feedback, renderingInfoPtr))  //
+                             )                                                       //
+                         .value;
+    AddPipelineStatistics("pixel", feedback, vOutPipeline.m_Pipeline);
+    if (registryPtr) {
+        vOutPipeline.m_Pipeline = registryPtr->AddPipeline(pipelineKey, vOutPipeline.m_Pipeline);
+    }
+
+    ReleaseShaderModule(vs);
+    ReleaseShaderModule(fs);
+
+    if (vStates.m_Tesselated) {
+        ReleaseShaderModule(tc);
+        ReleaseShaderModule(te);
+    }
+
+    return true;
+}
+
+// the spirvs and the states are copied, so the worker thread don't touch the pass
+std::future<VulkanPipelineBuilder::PipelineStruct> VulkanPipelineBuilder::LaunchPipelineBuild(const bool& vIsPixel,
+    const ShaderSpirvsContainer& vSpirvs,
+    const PipelineBuildStatesStruct& vStates,
+    const SpecializationConstantsContainer& vConstants) {
+    ZoneScoped;
+    return std::async(std::launch::async, [this, vIsPixel, vSpirvs, vStates, vConstants]() {
+        PipelineStruct res;
+        if (!BuildPipeline(vIsPixel, vSpirvs, vStates, res, vConstants)) {
+            DestroyPipelineStruct(res);
+        }
+        return res;
+    });
+}
+
+// the constant ids not used by a stage are ignored by the driver, so the same infos are given to all the stages
+vk::SpecializationInfo VulkanPipelineBuilder::GetSpecializationInfo(const SpecializationConstantsContainer& vConstants,
+    std::vector<vk::SpecializationMapEntry>& vOutEntries,
+    std::vector<uint32_t>& vOutDatas) {
+    ZoneScoped;
+    vOutEntries.clear();
+    vOutDatas.clear();
+    for (const auto& constant : vConstants) {
+        vOutEntries.emplace_back(constant.first, (uint32_t)(vOutDatas.size() * sizeof(uint32_t)), sizeof(uint32_t));
+        vOutDatas.push_back(constant.second);
+    }
+    return vk::SpecializationInfo((uint32_t)vOutEntries.size(), vOutEntries.data(), vOutDatas.size() * sizeof(uint32_t), vOutDatas.data());
+}
+
+// the pipelines and the layouts of the registry are released, the registry destroy them when not used anymore
+void VulkanPipelineBuilder::DestroyPipelineStruct(PipelineStruct& vPipeline) {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    auto registryPtr = corePtr ? corePtr->getPipelineRegistry().lock() : nullptr;
+    if (vPipeline.m_Pipeline) {
+        // a fast linked pipeline destroyed before the end of his optimized link
+        std::lock_guard<std::mutex> lock(m_PipelineLinksMutex);
+        for (auto& link : m_PipelineLinks) {
+            if (link.m_FastLinkedPipeline == vPipeline.m_Pipeline) {
+                link.m_FastLinkedPipeline = vk::Pipeline{};
+            }
+        }
+    }
+    if (vPipeline.m_Pipeline && !(registryPtr && registryPtr->ReleasePipeline(vPipeline.m_Pipeline)))
+        m_Device.destroyPipeline(vPipeline.m_Pipeline);
+    vPipeline.m_Pipeline = vk::Pipeline{};
+    for (const auto& library : vPipeline.m_Libraries) {
+        if (registryPtr)
+            registryPtr->ReleasePipeline(library);
+    }
+    vPipeline.m_Libraries.clear();
+    if (vPipeline.m_PipelineLayout) {
+        if (registryPtr)
+            registryPtr->ReleasePipelineLayout(vPipeline.m_PipelineLayout);
+        else
+            m_Device.destroyPipelineLayout(vPipeline.m_PipelineLayout);
+    }
+    vPipeline.m_PipelineLayout = vk::PipelineLayout{};
+}
+
+void VulkanPipelineBuilder::RetirePipeline(const PipelineStruct& vPipeline) {
+    ZoneScoped;
+    RetiredPipelineStruct retired;
+    retired.m_Pipeline = vPipeline;
+    retired.m_RetiredFrame = m_FrameCounter;
+    m_RetiredPipelines.push_back(retired);
+}
+
+void VulkanPipelineBuilder::DestroyRetiredPipelines(const bool& vForce) {
+    ZoneScoped;
+    auto it = m_RetiredPipelines.begin();
+    while (it != m_RetiredPipelines.end()) {
+        if (vForce || m_FrameCounter > it->m_RetiredFrame + VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT) {
+            DestroyPipelineStruct(it->m_Pipeline);
+            it = m_RetiredPipelines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// can be called from a worker thread, the layout inputs are copied in vStates
+vk::PipelineLayout VulkanPipelineBuilder::AcquirePipelineLayout(const PipelineBuildStatesStruct& vStates) {
+    ZoneScoped;
+    const auto createInfo = vk::PipelineLayoutCreateInfo(vk::PipelineLayoutCreateFlags(),
+        1,
+        &vStates.m_DescriptorSetLayout,
+        (uint32_t)vStates.m_PushConstants.size(),
+        vStates.m_PushConstants.data());
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto registryPtr = corePtr->getPipelineRegistry().lock();
+    if (registryPtr) {
+        return registryPtr->AcquirePipelineLayout(vStates.m_PipelineLayoutKey, createInfo);
+    }
+    return m_Device.createPipelineLayout(createInfo);
+}
+
+vk::ShaderModule VulkanPipelineBuilder::AcquireShaderModule(const std::vector<unsigned int>& vSpirv) {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto registryPtr = corePtr->getPipelineRegistry().lock();
+    if (registryPtr) {
+        return registryPtr->AcquireShaderModule(vSpirv);
+    }
+    return VulkanCore::sVulkanShader->CreateShaderModule((VkDevice)m_Device, vSpirv);
+}
+
+void VulkanPipelineBuilder::ReleaseShaderModule(const vk::ShaderModule& vShaderModule) {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto registryPtr = corePtr->getPipelineRegistry().lock();
+    if (registryPtr) {
+        registryPtr->ReleaseShaderModule(vShaderModule);
+    } else {
+        VulkanCore::sVulkanShader->DestroyShaderModule((VkDevice)m_Device, vShaderModule);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// GRAPHICS PIPELINE LIBRARY ///////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// return the part of vKey with one more reference, built if not in the registry
+vk::Pipeline VulkanPipelineBuilder::AcquirePipelineLibrary(VulkanPipelineRegistryPtr vRegistryPtr,
+    const uint64_t& vKey,
+    const vk::GraphicsPipelineLibraryFlagsEXT& vParts,
+    vk::GraphicsPipelineCreateInfo vCreateInfo) {
+    ZoneScoped;
+    auto res = vRegistryPtr->FindPipeline(vKey);
+    if (!res) {
+        auto libraryInfo = vk::GraphicsPipelineLibraryCreateInfoEXT(vParts);
+        libraryInfo.setPNext(vCreateInfo.pNext);  // the rendering infos of the dynamic rendering
+        PipelineFeedbackStruct feedback;
+        vCreateInfo.setFlags(vk::PipelineCreateFlagBits::eLibraryKHR | vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT |
+                             GetPipelineStatisticsFlags());
+        vCreateInfo.setPNext(ChainPipelineFeedback(feedback, &libraryInfo));
+        res = m_Device.createGraphicsPipeline(m_PipelineCache, vCreateInfo).value;
+        std::string kind = "fragment output library";
+        if (vParts == vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface) {
+            kind = "vertex input library";
+        } else if (vParts == vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders) {
+            kind = "pre rasterization library";
+        } else if (vParts == vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader) {
+            kind = "fragment shader library";
+        }
+        AddPipelineStatistics(kind, feedback, res);
+        if (res) {
+            res = vRegistryPtr->AddPipeline(vKey, res);
+        }
+    }
+    return res;
+}
+
+// vPipelineLayout must be given with one more reference, released at the end of the link
+void VulkanPipelineBuilder::StartOptimizedLink(VulkanPipelineRegistryPtr vRegistryPtr,
+    const uint64_t& vPipelineKey,
+    const vk::Pipeline& vFastLinkedPipeline,
+    const vk::PipelineLayout& vPipelineLayout,
+    const std::vector<uint64_t>& vLibraryKeys) {
+    ZoneScoped;
+    PipelineLinkStruct link;
+    link.m_FastLinkedPipeline = vFastLinkedPipeline;
+    link.m_PipelineKey = vPipelineKey;
+    link.m_PipelineLayout = vPipelineLayout;
+    for (const auto& key : vLibraryKeys) {
+        link.m_Libraries.push_back(vRegistryPtr->FindPipeline(key));
+    }
+    link.m_OptimizedPipelineFuture = std::async(std::launch::async, [this, vPipelineLayout, libraries = link.m_Libraries]() {
+        auto libraryInfo = vk::PipelineLibraryCreateInfoKHR(static_cast<uint32_t>(libraries.size()), libraries.data());
+        PipelineFeedbackStruct feedback;
+        const auto res = m_Device
+                             .createGraphicsPipeline(m_PipelineCache,
+                                 vk::GraphicsPipelineCreateInfo()  //
+                                     .setFlags(vk::PipelineCreateFlagBits::eLinkTimeOptimizationEXT | GetPipelineStatisticsFlags())
+                                     .setPNext(ChainPipelineFeedback(feedback, &libraryInfo))
+                                     .setLayout(vPipelineLayout))
+                             .value;
+        AddPipelineStatistics("optimized link", feedback, res);
+        return res;
+    });
+    std::lock_guard<std::mutex> lock(m_PipelineLinksMutex);
+    m_PipelineLinks.push_back(std::move(link));
+}
+
+// the specialized pipelines are owned by the builder, the others by the client
+VulkanPipelineBuilder::PipelineStruct* VulkanPipelineBuilder::FindPipelineStruct(const vk::Pipeline& vPipeline, const PipelineFinder& vFinder) {
+    ZoneScoped;
+    for (auto& specialized : m_SpecializedPipelines) {
+        if (specialized.second.m_Pipeline == vPipeline) {
+            return &specialized.second;
+        }
+    }
+    if (vFinder) {
+        return vFinder(vPipeline);
+    }
+    return nullptr;
+}
+
+// the fast linked pipeline is replaced by the optimized one, and retired
+// a fast linked pipeline not found yet is in a result not collected (hot reload, variant), so retried at the next frame
+void VulkanPipelineBuilder::CollectOptimizedLinks(const PipelineFinder& vFinder) {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto registryPtr = corePtr->getPipelineRegistry().lock();
+    std::lock_guard<std::mutex> lock(m_PipelineLinksMutex);
+    auto it = m_PipelineLinks.begin();
+    while (it != m_PipelineLinks.end()) {
+        if (it->m_OptimizedPipelineFuture.valid()) {
+            if (it->m_OptimizedPipelineFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                ++it;
+                continue;
+            }
+            it->m_OptimizedPipeline = it->m_OptimizedPipelineFuture.get();
+        }
+        bool done = true;
+        if (it->m_OptimizedPipeline && it->m_FastLinkedPipeline && registryPtr) {
+            auto* pipelinePtr = FindPipelineStruct(it->m_FastLinkedPipeline, vFinder);
+            if (pipelinePtr) {
+                // the old pipeline can be used by the frames in flight
+                PipelineStruct retired;
+                retired.m_Pipeline = it->m_FastLinkedPipeline;
+                RetirePipeline(retired);
+                pipelinePtr->m_Pipeline = registryPtr->AddPipeline(it->m_PipelineKey, it->m_OptimizedPipeline);
+                it->m_OptimizedPipeline = vk::Pipeline{};
+            } else {
+                done = false;
+            }
+        }
+        if (done) {
+            ReleasePipelineLink(registryPtr, *it);
+            it = m_PipelineLinks.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void VulkanPipelineBuilder::WaitOptimizedLinks() {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    auto registryPtr = corePtr ? corePtr->getPipelineRegistry().lock() : nullptr;
+    std::lock_guard<std::mutex> lock(m_PipelineLinksMutex);
+    for (auto& link : m_PipelineLinks) {
+        if (link.m_OptimizedPipelineFuture.valid()) {
+            link.m_OptimizedPipeline = link.m_OptimizedPipelineFuture.get();
+        }
+        ReleasePipelineLink(registryPtr, link);
+    }
+    m_PipelineLinks.clear();
+}
+
+// release the references of the link, and destroy the optimized pipeline if not used
+void VulkanPipelineBuilder::ReleasePipelineLink(VulkanPipelineRegistryPtr vRegistryPtr, PipelineLinkStruct& vLink) {
+    ZoneScoped;
+    if (vLink.m_OptimizedPipeline) {
+        m_Device.destroyPipeline(vLink.m_OptimizedPipeline);
+        vLink.m_OptimizedPipeline = vk::Pipeline{};
+    }
+    if (vRegistryPtr) {
+        for (const auto& library : vLink.m_Libraries) {
+            if (library) {
+                vRegistryPtr->ReleasePipeline(library);
+            }
+        }
+        if (vLink.m_PipelineLayout) {
+            vRegistryPtr->ReleasePipelineLayout(vLink.m_PipelineLayout);
+        }
+    }
+    vLink.m_Libraries.clear();
+    vLink.m_PipelineLayout = vk::PipelineLayout{};
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// SPECIALIZED PIPELINES ///////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanPipelineBuilder::IsSpecializedPipelineKnown(const PipelineVariantKey& vKey) const {
+    return (m_SpecializedPipelines.find(vKey) != m_SpecializedPipelines.end() || m_SpecializedPipelineJobs.find(vKey) != m_SpecializedPipelineJobs.end());
+}
+
+void VulkanPipelineBuilder::LaunchSpecializedPipelineJob(const PipelineVariantKey& vKey,
+    const bool& vIsPixel,
+    const ShaderSpirvsContainer& vSpirvs,
+    const PipelineBuildStatesStruct& vStates,
+    const uint64_t& vVariant,
+    const uint64_t& vGeneration) {
+    ZoneScoped;
+    if (IsSpecializedPipelineKnown(vKey)) {
+        return;
+    }
+    auto& job = m_SpecializedPipelineJobs[vKey];
+    job.m_Variant = vVariant;
+    job.m_Generation = vGeneration;
+    job.m_PipelineFuture = LaunchPipelineBuild(vIsPixel, vSpirvs, vStates, vKey.second);
+}
+
+bool VulkanPipelineBuilder::TakeSpecializedPipeline(
+    const PipelineVariantKey& vKey, const uint64_t& vVariant, const uint64_t& vGeneration, PipelineStruct& vOutPipeline) {
+    ZoneScoped;
+    auto it = m_SpecializedPipelines.find(vKey);
+    if (it != m_SpecializedPipelines.end()) {
+        vOutPipeline = it->second;
+        m_SpecializedPipelines.erase(it);
+        return true;
+    }
+    auto itJob = m_SpecializedPipelineJobs.find(vKey);
+    if (itJob != m_SpecializedPipelineJobs.end() && itJob->second.m_Variant == vVariant && itJob->second.m_Generation == vGeneration) {
+        // prebuilt but not finished, waited rather than built twice
+        vOutPipeline = itJob->second.m_PipelineFuture.get();
+        m_SpecializedPipelineJobs.erase(itJob);
+        return true;
+    }
+    return false;
+}
+
+void VulkanPipelineBuilder::StoreSpecializedPipeline(const PipelineVariantKey& vKey, const PipelineStruct& vPipeline) {
+    ZoneScoped;
+    m_SpecializedPipelines[vKey] = vPipeline;
+}
+
+void VulkanPipelineBuilder::CollectSpecializedPipelineJobs(const PipelineVariantKey& vBuiltKey, const uint64_t& vVariant, const uint64_t& vGeneration) {
+    ZoneScoped;
+    auto it = m_SpecializedPipelineJobs.begin();
+    while (it != m_SpecializedPipelineJobs.end()) {
+        if (it->second.m_PipelineFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            auto res = it->second.m_PipelineFuture.get();
+            const bool isCurrent = (it->first == vBuiltKey);
+            if (res.m_Pipeline && it->second.m_Variant == vVariant && it->second.m_Generation == vGeneration && !isCurrent &&
+                m_SpecializedPipelines.find(it->first) == m_SpecializedPipelines.end()) {
+                m_SpecializedPipelines[it->first] = res;
+            } else {
+                DestroyPipelineStruct(res);  // never used
+            }
+            it = m_SpecializedPipelineJobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void VulkanPipelineBuilder::WaitSpecializedPipelineJobs() {
+    ZoneScoped;
+    for (auto& job : m_SpecializedPipelineJobs) {
+        auto res = job.second.m_PipelineFuture.get();
+        DestroyPipelineStruct(res);
+    }
+    m_SpecializedPipelineJobs.clear();
+}
+
+void VulkanPipelineBuilder::DestroySpecializedPipelines(const bool& vRetire) {
+    ZoneScoped;
+    for (auto& variant : m_SpecializedPipelines) {
+        if (vRetire) {
+            RetirePipeline(variant.second);
+        } else {
+            DestroyPipelineStruct(variant.second);
+        }
+    }
+    m_SpecializedPipelines.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PIPELINE MANIFEST ///////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanPipelineBuilder::GetPipelineManifestEntry(const std::string& vPassKey, PipelineManifest::PassEntry& vOutEntry) const {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto manifestPtr = corePtr->getPipelineManifest().lock();
+    return (manifestPtr && manifestPtr->GetPassEntry(vPassKey, vOutEntry));
+}
+
+bool VulkanPipelineBuilder::IsInPipelineManifest(const std::string& vPassKey, const uint64_t& vStaticStatesKey) const {
+    ZoneScoped;
+    PipelineManifest::PassEntry entry;
+    if (!GetPipelineManifestEntry(vPassKey, entry)) {
+        return false;
+    }
+    return (entry.staticStatesKeys.find(vStaticStatesKey) != entry.staticStatesKeys.end());
+}
+
+void VulkanPipelineBuilder::RecordInPipelineManifest(const std::string& vPassKey,
+    const uint64_t& vVariant,
+    const SpecializationConstantsContainer& vConstants,
+    const uint64_t& vStaticStatesKey) {
+    ZoneScoped;
+    if (m_PipelineManifestRecorded && m_RecordedVariant == vVariant && m_RecordedSpecializationConstants == vConstants &&
+        m_RecordedStaticStatesKey == vStaticStatesKey) {
+        return;
+    }
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto manifestPtr = corePtr->getPipelineManifest().lock();
+    if (manifestPtr) {
+        manifestPtr->RecordVariant(vPassKey, vVariant);
+        manifestPtr->RecordConstants(vPassKey, vConstants);
+        manifestPtr->RecordStaticStates(vPassKey, vStaticStatesKey);
+    }
+    m_PipelineManifestRecorded = true;
+    m_RecordedVariant = vVariant;
+    m_RecordedSpecializationConstants = vConstants;
+    m_RecordedStaticStatesKey = vStaticStatesKey;
+}
+
+void VulkanPipelineBuilder::AddPipelineManifestMiss(const std::string& vPassKey, const std::string& vWhat) {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto manifestPtr = corePtr->getPipelineManifest().lock();
+    if (manifestPtr) {
+        manifestPtr->AddMiss(vPassKey, vWhat);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PIPELINE STATISTICS /////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanPipelineBuilder::SetCapturePipelineStatistics(const bool& vFlag) {
+    ZoneScoped;
+    m_CapturePipelineStatistics = vFlag;
+}
+
+std::string VulkanPipelineBuilder::GetPipelineStatisticsReport() const {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_PipelineStatisticsMutex);
+    std::stringstream res;
+    for (const auto& stats : m_PipelineStatistics) {
+        res << stats.first;
+        if (stats.second.m_FeedbackValid) {
+            res << " : " << stats.second.m_BuildTimeInMs << " ms" << (stats.second.m_CacheHit ? " (cache hit)" : " (cache miss)");
+        }
+        res << "\n";
+        for (const auto& statistic : stats.second.m_Statistics) {
+            res << "\t" << statistic << "\n";
+        }
+    }
+    return res.str();
+}
+
+// the summary is the build time of the last pipelines built, the details are the full report
+void VulkanPipelineBuilder::UpdatePipelineStatisticsInProfiler(const void* vOwnerPtr) {
+    ZoneScoped;
+    double buildTimeInMs = 0.0;
+    uint32_t cacheHits = 0U;
+    uint32_t count = 0U;
+    {
+        std::lock_guard<std::mutex> lock(m_PipelineStatisticsMutex);
+        if (!m_PipelineStatisticsChanged) {
+            return;
+        }
+        m_PipelineStatisticsChanged = false;
+        for (const auto& stats : m_PipelineStatistics) {
+            if (stats.second.m_FeedbackValid) {
+                buildTimeInMs += stats.second.m_BuildTimeInMs;
+                cacheHits += stats.second.m_CacheHit ? 1U : 0U;
+                ++count;
+            }
+        }
+    }
+    char buffer[128];
+    snprintf(buffer, sizeof(buffer), "%.3f ms (%u/%u cache hits)", buildTimeInMs, cacheHits, count);
+    vkProfiler::Instance()->SetPipelineInfos(vOwnerPtr, count ? buffer : "stats", GetPipelineStatisticsReport());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the device features are queried once, the builds on the worker threads only read them
+void VulkanPipelineBuilder::QueryDeviceSupport() {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto devicePtr = corePtr->getFrameworkDevice().lock();
+    m_GraphicsPipelineLibrarySupported = devicePtr && devicePtr->m_GraphicsPipelineLibraryFeature.graphicsPipelineLibrary;
+    m_PipelineFeedbackSupported = devicePtr && devicePtr->m_PipelineCreationFeedbackSupported;
+    m_PipelineExecutableInfoSupported = devicePtr && devicePtr->m_PipelineExecutablePropertiesFeature.pipelineExecutableInfo;
+}
+
+const void* VulkanPipelineBuilder::ChainPipelineFeedback(PipelineFeedbackStruct& vOutFeedback, const void* vNext) const {
+    ZoneScoped;
+    if (!m_PipelineFeedbackSupported) {
+        return vNext;
+    }
+    // only the feedback of the whole pipeline, not by stage
+    vOutFeedback.m_FeedbackInfo = vk::PipelineCreationFeedbackCreateInfoEXT(&vOutFeedback.m_Feedback, 0U, nullptr);
+    vOutFeedback.m_FeedbackInfo.setPNext(vNext);
+    return &vOutFeedback.m_FeedbackInfo;
+}
+
+vk::PipelineCreateFlags VulkanPipelineBuilder::GetPipelineStatisticsFlags() const {
+    if (m_CapturePipelineStatistics && m_PipelineExecutableInfoSupported) {
+        return vk::PipelineCreateFlagBits::eCaptureStatisticsKHR;
+    }
+    return vk::PipelineCreateFlags();
+}
+
+// can be called from a worker thread
+void VulkanPipelineBuilder::AddPipelineStatistics(const std::string& vKind, const PipelineFeedbackStruct& vFeedback, const vk::Pipeline& vPipeline) {
+    ZoneScoped;
+    if (!vPipeline) {
+        return;
+    }
+    PipelineStatisticsStruct res;
+    if (m_PipelineFeedbackSupported && (vFeedback.m_Feedback.flags & vk::PipelineCreationFeedbackFlagBitsEXT::eValid)) {
+        res.m_FeedbackValid = true;
+        res.m_BuildTimeInMs = (double)vFeedback.m_Feedback.duration * 1e-6;  // ns to ms
+        res.m_CacheHit = static_cast<bool>(vFeedback.m_Feedback.flags & vk::PipelineCreationFeedbackFlagBitsEXT::eApplicationPipelineCacheHit);
+    }
+    if (GetPipelineStatisticsFlags()) {
+        const auto executables = m_Device.getPipelineExecutablePropertiesKHR(vk::PipelineInfoKHR(vPipeline));
+        for (uint32_t idx = 0U; idx < (uint32_t)executables.size(); ++idx) {
+            const std::string executableName = executables[idx].name.data();
+            const auto statistics = m_Device.getPipelineExecutableStatisticsKHR(vk::PipelineExecutableInfoKHR(vPipeline, idx));
+            for (const auto& statistic : statistics) {
+                std::stringstream str;
+                str << executableName << " : " << statistic.name.data() << " = ";
+                switch (statistic.format) {
+                    case vk::PipelineExecutableStatisticFormatKHR::eBool32: str << (statistic.value.b32 ? "true" : "false"); break;
+                    case vk::PipelineExecutableStatisticFormatKHR::eInt64: str << statistic.value.i64; break;
+                    case vk::PipelineExecutableStatisticFormatKHR::eUint64: str << statistic.value.u64; break;
+                    case vk::PipelineExecutableStatisticFormatKHR::eFloat64: str << statistic.value.f64; break;
+                    default: break;
+                }
+                res.m_Statistics.push_back(str.str());
+            }
+        }
+    }
+    if (res.m_FeedbackValid || !res.m_Statistics.empty()) {
+        std::lock_guard<std::mutex> lock(m_PipelineStatisticsMutex);
+        m_PipelineStatistics[vKind] = res;
+        m_PipelineStatisticsChanged = true;
+    }
+}
+
+}  // namespace GaiApi
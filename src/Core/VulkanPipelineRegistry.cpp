@@ -0,0 +1,316 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Core/VulkanPipelineRegistry.h>
+#include <Gaia/Core/VulkanCore.h>
+#include <ezlibs/ezLog.hpp>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace GaiApi {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// HASHER //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanPipelineRegistry::Hasher& VulkanPipelineRegistry::Hasher::addBytes(const void* vDatas, const size_t& vSize) {
+    const auto* bytes = static_cast<const uint8_t*>(vDatas);
+    for (size_t idx = 0U; idx < vSize; ++idx) {
+        m_Hash ^= bytes[idx];
+        m_Hash *= 0x100000001b3ULL;
+    }
+    return *this;
+}
+
+uint64_t VulkanPipelineRegistry::Hasher::get() const {
+    return m_Hash;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanPipelineRegistryPtr VulkanPipelineRegistry::Create(VulkanCoreWeak vVulkanCore) {
+    ZoneScoped;
+    auto res = std::make_shared<VulkanPipelineRegistry>(vVulkanCore);
+    if (!res->Init()) {
+        res.reset();
+    }
+    return res;
+}
+
+uint64_t VulkanPipelineRegistry::GetSpirvKey(const std::vector<unsigned int>& vSpirv) {
+    ZoneScoped;
+    Hasher hasher;
+    hasher.add(vSpirv.size());
+    if (!vSpirv.empty()) {
+        hasher.addBytes(vSpirv.data(), vSpirv.size() * sizeof(unsigned int));
+    }
+    return hasher.get();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTOR /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanPipelineRegistry::VulkanPipelineRegistry(VulkanCoreWeak vVulkanCore) : m_VulkanCore(vVulkanCore) {
+    ZoneScoped;
+}
+
+VulkanPipelineRegistry::~VulkanPipelineRegistry() {
+    ZoneScoped;
+    Unit();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// INIT / UNIT /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanPipelineRegistry::Init() {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    m_Device = corePtr->getDevice();
+    return (bool)m_Device;
+}
+
+// the objects still referenced are destroyed too, the device must be idle
+void VulkanPipelineRegistry::Unit() {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    DestroyUnused(m_Pipelines, true);
+    DestroyUnused(m_PipelineLayouts, true);
+    DestroyUnused(m_ShaderModules, true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// FRAME ///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanPipelineRegistry::BeginFrame() {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    ++m_FrameCounter;
+    DestroyUnused(m_Pipelines, false);
+    DestroyUnused(m_PipelineLayouts, false);
+    DestroyUnused(m_ShaderModules, false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// SHADER MODULES //////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+vk::ShaderModule VulkanPipelineRegistry::AcquireShaderModule(const std::vector<unsigned int>& vSpirv) {
+    ZoneScoped;
+    if (vSpirv.empty()) {
+        return {};
+    }
+    const auto key = GetSpirvKey(vSpirv);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto res = Acquire(m_ShaderModules, key);
+        if (res) {
+            return res;
+        }
+    }
+    vk::ShaderModule shaderModule;
+    const auto createInfo = vk::ShaderModuleCreateInfo(vk::ShaderModuleCreateFlags(), vSpirv.size() * sizeof(unsigned int), vSpirv.data());
+    if (m_Device.createShaderModule(&createInfo, nullptr, &shaderModule) != vk::Result::eSuccess) {
+        LogVarError("Debug : fail to create shader module !");
+        return {};
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return Add(m_ShaderModules, key, shaderModule);
+}
+
+void VulkanPipelineRegistry::ReleaseShaderModule(const vk::ShaderModule& vShaderModule) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Release(m_ShaderModules, vShaderModule);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PIPELINE LAYOUTS ////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+vk::PipelineLayout VulkanPipelineRegistry::AcquirePipelineLayout(const uint64_t& vKey, const vk::PipelineLayoutCreateInfo& vCreateInfo) {
+    ZoneScoped;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto res = Acquire(m_PipelineLayouts, vKey);
+        if (res) {
+            return res;
+        }
+    }
+    // a layout created with the set layouts of a pass stay valid when the pass destroy them
+    // and can be used with the sets of all the passes having the same set layouts definitions
+    const auto pipelineLayout = m_Device.createPipelineLayout(vCreateInfo);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return Add(m_PipelineLayouts, vKey, pipelineLayout);
+}
+
+void VulkanPipelineRegistry::ReleasePipelineLayout(const vk::PipelineLayout& vPipelineLayout) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Release(m_PipelineLayouts, vPipelineLayout);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PIPELINES ///////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+vk::Pipeline VulkanPipelineRegistry::FindPipeline(const uint64_t& vKey) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return Acquire(m_Pipelines, vKey);
+}
+
+vk::Pipeline VulkanPipelineRegistry::AddPipeline(const uint64_t& vKey, const vk::Pipeline& vPipeline) {
+    ZoneScoped;
+    if (!vPipeline) {
+        return {};
+    }
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return Add(m_Pipelines, vKey, vPipeline);
+}
+
+bool VulkanPipelineRegistry::ReleasePipeline(const vk::Pipeline& vPipeline) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return Release(m_Pipelines, vPipeline);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// GETTERS /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t VulkanPipelineRegistry::GetShaderModulesCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_ShaderModules.entries.size();
+}
+
+size_t VulkanPipelineRegistry::GetPipelineLayoutsCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_PipelineLayouts.entries.size();
+}
+
+size_t VulkanPipelineRegistry::GetPipelinesCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Pipelines.entries.size();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the containers are only accessed with m_Mutex locked
+
+template <typename T>
+uint64_t VulkanPipelineRegistry::GetHandleKey(const T& vObject) {
+    return (uint64_t)(typename T::CType)vObject;
+}
+
+template <typename T>
+T VulkanPipelineRegistry::Acquire(ObjectsContainer<T>& vContainer, const uint64_t& vKey) {
+    auto it = vContainer.entries.find(vKey);
+    if (it != vContainer.entries.end()) {
+        ++it->second.refCount;
+        return it->second.object;
+    }
+    return {};
+}
+
+template <typename T>
+T VulkanPipelineRegistry::Add(ObjectsContainer<T>& vContainer, const uint64_t& vKey, const T& vObject) {
+    if (!vObject) {
+        return {};
+    }
+    auto it = vContainer.entries.find(vKey);
+    if (it != vContainer.entries.end()) {
+        // created twice at the same time by two threads, the first one is kept
+        DestroyObject(vObject);
+        ++it->second.refCount;
+        return it->second.object;
+    }
+    auto& entry = vContainer.entries[vKey];
+    entry.object = vObject;
+    entry.refCount = 1U;
+    vContainer.keys[GetHandleKey(vObject)] = vKey;
+    return vObject;
+}
+
+template <typename T>
+bool VulkanPipelineRegistry::Release(ObjectsContainer<T>& vContainer, const T& vObject) {
+    if (!vObject) {
+        return false;
+    }
+    auto itKey = vContainer.keys.find(GetHandleKey(vObject));
+    if (itKey == vContainer.keys.end()) {
+        return false;
+    }
+    auto& entry = vContainer.entries.at(itKey->second);
+    if (entry.refCount) {
+        --entry.refCount;
+        if (!entry.refCount) {
+            entry.unusedSinceFrame = m_FrameCounter;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void VulkanPipelineRegistry::DestroyUnused(ObjectsContainer<T>& vContainer, const bool& vForce) {
+    auto it = vContainer.entries.begin();
+    while (it != vContainer.entries.end()) {
+        if (vForce || (!it->second.refCount && m_FrameCounter > it->second.unusedSinceFrame + VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT)) {
+            vContainer.keys.erase(GetHandleKey(it->second.object));
+            DestroyObject(it->second.object);
+            it = vContainer.entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void VulkanPipelineRegistry::DestroyObject(const vk::ShaderModule& vObject) {
+    if (m_Device && vObject) {
+        m_Device.destroyShaderModule(vObject);
+    }
+}
+
+void VulkanPipelineRegistry::DestroyObject(const vk::PipelineLayout& vObject) {
+    if (m_Device && vObject) {
+        m_Device.destroyPipelineLayout(vObject);
+    }
+}
+
+void VulkanPipelineRegistry::DestroyObject(const vk::Pipeline& vObject) {
+    if (m_Device && vObject) {
+        m_Device.destroyPipeline(vObject);
+    }
+}
+
+}  // namespace GaiApi
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <Gaia/Core/VulkanSubmitter.h>
 #include <Gaia/Core/VulkanCore.h>
+#include <Gaia/Resources/VulkanUniformArena.h>
 #include <ezlibs/ezLog.hpp>
 
 #ifdef PROFILER_INCLUDE
@@ -35,6 +36,12 @@ bool VulkanSubmitter::Submit(GaiApi::VulkanCoreWeak vVulkanCore, vk::QueueFlagBi
 
     auto corePtr = vVulkanCore.lock();
     if (corePtr != nullptr) {
+        // the uniforms pushed in the arena must be visible by the gpu before the submit
+        auto arenaPtr = corePtr->getUniformArena().lock();
+        if (arenaPtr) {
+            arenaPtr->Flush();
+        }
+
         std::unique_lock<std::mutex> lck(VulkanSubmitter::criticalSectionMutex, std::defer_lock);
         lck.lock();
         auto result = corePtr->getQueue(vQueueType).vkQueue.submit(1, &vSubmitInfo, vWaitFence);
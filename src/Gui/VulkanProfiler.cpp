@@ -116,7 +116,7 @@ vkProfQueryZonePtr vkProfQueryZone::create(
 vkProfQueryZone::circularSettings vkProfQueryZone::sCircularSettings;
 
 vkProfQueryZone::vkProfQueryZone(void* vThreadPtr, const void* vPtr, const std::string& vName, const std::string& vSectionName, const bool& vIsRoot)
-    : name(vName), m_IsRoot(vIsRoot), m_SectionName(vSectionName)/*, m_Ptr(vPtr), m_ThreadPtr(vThreadPtr)*/ {
+    : name(vName), m_IsRoot(vIsRoot), m_Ptr(vPtr), m_SectionName(vSectionName)/*, m_ThreadPtr(vThreadPtr)*/ {
     Clear();
     depth = vkProfQueryZone::sCurrentDepth;
     imGuiLabel = vName + "##vkProfQueryZone_" + std::to_string((intptr_t)this);
@@ -279,6 +279,16 @@ void vkProfQueryZone::DrawDetails() {
         } else {
             ImGui::Text("%s", "Infinite");
         }
+        ImGui::TableNextColumn();  // Pipeline
+        if (m_Ptr != nullptr && (parentPtr == nullptr || parentPtr->m_Ptr != m_Ptr)) {
+            std::string summary, details;
+            if (vkProfiler::Instance()->GetPipelineInfos(m_Ptr, summary, details)) {
+                ImGui::Text("%s", summary.c_str());
+                if (ImGui::IsItemHovered() && !details.empty()) {
+                    ImGui::SetTooltip("%s", details.c_str());
+                }
+            }
+        }
 #ifdef vkProf_DEV_MODE
         ImGui::TableNextColumn();  // start time
         ImGui::Text("%.5f ms", m_StartTime);
@@ -1122,6 +1132,27 @@ vkProfiler::CommandBufferInfos* vkProfiler::GetCommandBufferInfosPtr(const void*
     return nullptr;
 }
 
+void vkProfiler::SetPipelineInfos(const void* vPtr, const std::string& vSummary, const std::string& vDetails) {
+    std::lock_guard<std::mutex> lock(m_PipelineInfosMutex);
+    m_PipelineInfos[vPtr] = std::make_pair(vSummary, vDetails);
+}
+
+bool vkProfiler::GetPipelineInfos(const void* vPtr, std::string& vOutSummary, std::string& vOutDetails) {
+    std::lock_guard<std::mutex> lock(m_PipelineInfosMutex);
+    auto it = m_PipelineInfos.find(vPtr);
+    if (it != m_PipelineInfos.end()) {
+        vOutSummary = it->second.first;
+        vOutDetails = it->second.second;
+        return true;
+    }
+    return false;
+}
+
+void vkProfiler::RemovePipelineInfos(const void* vPtr) {
+    std::lock_guard<std::mutex> lock(m_PipelineInfosMutex);
+    m_PipelineInfos.erase(vPtr);
+}
+
 void vkProfiler::m_ClearMeasures() {
     m_QueryHead = 0U;  // will cause new id creation
     m_QueryCount = 0U;
@@ -1206,15 +1237,15 @@ void vkProfiler::DrawDetailsNoWin() {
     if (m_RootZone != nullptr) {
 #ifdef vkProf_DEV_MODE
 #ifdef vkProf_SHOW_COUNT
-        int32_t count_tables = 6;
+        int32_t count_tables = 7;
 #else
-        int32_t count_tables = 5;
+        int32_t count_tables = 6;
 #endif
 #else
 #ifdef vkProf_SHOW_COUNT
-        int32_t count_tables = 4;
+        int32_t count_tables = 5;
 #else
-        int32_t count_tables = 3;
+        int32_t count_tables = 4;
 #endif
 #endif
         static ImGuiTableFlags flags =        //
@@ -1232,6 +1263,7 @@ void vkProfiler::DrawDetailsNoWin() {
 #endif
             ImGui::TableSetupColumn("Elapsed time");
             ImGui::TableSetupColumn("Max fps");
+            ImGui::TableSetupColumn("Pipeline");
 #ifdef vkProf_DEV_MODE
             ImGui::TableSetupColumn("Start time");
             ImGui::TableSetupColumn("End time");
@@ -103,6 +103,22 @@ void BaseRenderer::ClearGenericPasses() {
     m_ShaderPasses.clear();
 }
 
+float BaseRenderer::GetPipelineBuildProgress() const {
+    ZoneScoped;
+    uint32_t count = 0U;
+    uint32_t builtCount = 0U;
+    for (auto pass : m_ShaderPasses) {
+        auto pass_ptr = pass.lock();
+        if (pass_ptr) {
+            ++count;
+            if (!pass_ptr->IsPipelineBuildPending()) {
+                ++builtCount;
+            }
+        }
+    }
+    return count ? (float)builtCount / (float)count : 1.0f;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// PUBLIC / DURING INIT //////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
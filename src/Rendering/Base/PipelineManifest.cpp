@@ -0,0 +1,305 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Rendering/Base/PipelineManifest.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <cstring>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////
+//// SERIALIZATION ///////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+class ManifestWriter {
+public:
+    std::vector<uint8_t> datas;
+
+public:
+    void writeU32(const uint32_t& vValue) {
+        writeBytes(&vValue, sizeof(vValue));
+    }
+    void writeU64(const uint64_t& vValue) {
+        writeBytes(&vValue, sizeof(vValue));
+    }
+    void writeString(const std::string& vString) {
+        writeU32((uint32_t)vString.size());
+        writeBytes(vString.data(), vString.size());
+    }
+    void writeBytes(const void* vDatas, const size_t& vSize) {
+        const auto* ptr = (const uint8_t*)vDatas;
+        datas.insert(datas.end(), ptr, ptr + vSize);
+    }
+};
+
+// all the reads are checked, a truncated or corrupted manifest is rejected
+class ManifestReader {
+private:
+    const uint8_t* m_Datas = nullptr;
+    size_t m_Size = 0U;
+    size_t m_Pos = 0U;
+
+public:
+    ManifestReader(const uint8_t* vDatas, const size_t& vSize) : m_Datas(vDatas), m_Size(vSize) {}
+    bool readU32(uint32_t& vOutValue) {
+        return readBytes(&vOutValue, sizeof(vOutValue));
+    }
+    bool readU64(uint64_t& vOutValue) {
+        return readBytes(&vOutValue, sizeof(vOutValue));
+    }
+    bool readString(std::string& vOutString) {
+        uint32_t len = 0U;
+        if (!readU32(len) || len > m_Size - m_Pos) {
+            return false;
+        }
+        vOutString.assign((const char*)m_Datas + m_Pos, len);
+        m_Pos += len;
+        return true;
+    }
+    bool readBytes(void* vOutDatas, const size_t& vSize) {
+        if (vSize > m_Size - m_Pos) {
+            return false;
+        }
+        memcpy(vOutDatas, m_Datas + m_Pos, vSize);
+        m_Pos += vSize;
+        return true;
+    }
+};
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+PipelineManifestPtr PipelineManifest::Create() {
+    ZoneScoped;
+    return std::make_shared<PipelineManifest>();
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//// LOAD / SAVE /////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+bool PipelineManifest::LoadFromFile(const std::string& vFilePathName) {
+    ZoneScoped;
+    std::ifstream file(vFilePathName, std::ios::binary);
+    if (!file.is_open()) {
+        // no manifest at the first launch
+        LogVarLightInfo("No pipeline manifest at %s", vFilePathName.c_str());
+        return false;
+    }
+    const std::vector<uint8_t> datas((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!LoadFromMemory(datas.data(), datas.size())) {
+        LogVarError("The pipeline manifest %s is invalid", vFilePathName.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PipelineManifest::LoadFromMemory(const uint8_t* vDatas, const size_t& vSize) {
+    ZoneScoped;
+    if (vDatas == nullptr || !vSize) {
+        return false;
+    }
+    ManifestReader reader(vDatas, vSize);
+    uint32_t magic = 0U, version = 0U, count = 0U;
+    if (!reader.readU32(magic) || magic != s_Magic) {
+        return false;
+    }
+    if (!reader.readU32(version) || version != s_Version) {
+        LogVarError("the pipeline manifest version %u is not supported (%u expected)", version, s_Version);
+        return false;
+    }
+    if (!reader.readU32(count)) {
+        return false;
+    }
+
+    // the passes are added only if all the manifest is valid
+    std::map<std::string, PassEntry> passes;
+    for (uint32_t idx = 0U; idx < count; ++idx) {
+        std::string key;
+        PassEntry entry;
+        uint32_t variantsCount = 0U;
+        if (!reader.readString(key) || !reader.readU32(variantsCount)) {
+            return false;
+        }
+        for (uint32_t v = 0U; v < variantsCount; ++v) {
+            uint64_t variant = 0U;
+            if (!reader.readU64(variant)) {
+                return false;
+            }
+            entry.variants.emplace(variant);
+        }
+        uint32_t constantsSetsCount = 0U;
+        if (!reader.readU32(constantsSetsCount)) {
+            return false;
+        }
+        for (uint32_t s = 0U; s < constantsSetsCount; ++s) {
+            uint32_t constantsCount = 0U;
+            if (!reader.readU32(constantsCount)) {
+                return false;
+            }
+            SpecializationConstants constants;
+            for (uint32_t c = 0U; c < constantsCount; ++c) {
+                uint32_t id = 0U, value = 0U;
+                if (!reader.readU32(id) || !reader.readU32(value)) {
+                    return false;
+                }
+                constants[id] = value;
+            }
+            entry.constants.emplace(constants);
+        }
+        uint32_t staticStatesCount = 0U;
+        if (!reader.readU32(staticStatesCount)) {
+            return false;
+        }
+        for (uint32_t s = 0U; s < staticStatesCount; ++s) {
+            uint64_t staticStatesKey = 0U;
+            if (!reader.readU64(staticStatesKey)) {
+                return false;
+            }
+            entry.staticStatesKeys.emplace(staticStatesKey);
+        }
+        passes[key] = entry;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto& pass : passes) {
+        m_Loaded[pass.first] = std::move(pass.second);
+    }
+    return true;
+}
+
+bool PipelineManifest::SaveToFile(const std::string& vFilePathName) const {
+    ZoneScoped;
+    ManifestWriter writer;
+    {
+        // only what was used this session, the variants not used anymore are dropped
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        writer.writeU32(s_Magic);
+        writer.writeU32(s_Version);
+        writer.writeU32((uint32_t)m_Recorded.size());
+        for (const auto& pass : m_Recorded) {
+            writer.writeString(pass.first);
+            writer.writeU32((uint32_t)pass.second.variants.size());
+            for (const auto& variant : pass.second.variants) {
+                writer.writeU64(variant);
+            }
+            writer.writeU32((uint32_t)pass.second.constants.size());
+            for (const auto& constants : pass.second.constants) {
+                writer.writeU32((uint32_t)constants.size());
+                for (const auto& constant : constants) {
+                    writer.writeU32(constant.first);
+                    writer.writeU32(constant.second);
+                }
+            }
+            writer.writeU32((uint32_t)pass.second.staticStatesKeys.size());
+            for (const auto& staticStatesKey : pass.second.staticStatesKeys) {
+                writer.writeU64(staticStatesKey);
+            }
+        }
+    }
+    std::ofstream file(vFilePathName, std::ios::binary);
+    if (!file.is_open()) {
+        LogVarError("Fail to write the pipeline manifest %s", vFilePathName.c_str());
+        return false;
+    }
+    file.write((const char*)writer.datas.data(), writer.datas.size());
+    return file.good();
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//// ENTRIES /////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+bool PipelineManifest::GetPassEntry(const std::string& vPassKey, PassEntry& vOutEntry) const {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Loaded.find(vPassKey);
+    if (it != m_Loaded.end()) {
+        vOutEntry = it->second;
+        return true;
+    }
+    return false;
+}
+
+void PipelineManifest::RecordVariant(const std::string& vPassKey, const uint64_t& vVariant) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Recorded[vPassKey].variants.emplace(vVariant);
+}
+
+void PipelineManifest::RecordConstants(const std::string& vPassKey, const SpecializationConstants& vConstants) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Recorded[vPassKey].constants.emplace(vConstants);
+}
+
+void PipelineManifest::RecordStaticStates(const std::string& vPassKey, const uint64_t& vStaticStatesKey) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Recorded[vPassKey].staticStatesKeys.emplace(vStaticStatesKey);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//// MISSES //////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+void PipelineManifest::AddMiss(const std::string& vPassKey, const std::string& vWhat) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Misses.push_back(vPassKey + " : " + vWhat);
+}
+
+size_t PipelineManifest::GetMissesCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Misses.size();
+}
+
+std::string PipelineManifest::GetMissesReport() const {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    std::stringstream res;
+    res << m_Misses.size() << " pipeline(s) built at draw time\n";
+    for (const auto& miss : m_Misses) {
+        res << "\t" << miss << "\n";
+    }
+    return res.str();
+}
+
+void PipelineManifest::Clear() {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Loaded.clear();
+    m_Recorded.clear();
+    m_Misses.clear();
+}
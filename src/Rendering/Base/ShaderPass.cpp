@@ -19,6 +19,11 @@ limitations under the License.
 
 #include <Gaia/Rendering/Base/ShaderPass.h>
 
+#include <regex>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <algorithm>
 #include <functional>
 
 #include <Gaia/gaia.h>
@@ -28,6 +33,8 @@ limitations under the License.
 #include <glm/gtc/type_ptr.hpp>
 
 #include <Gaia/Core/VulkanSubmitter.h>
+#include <Gaia/Core/VulkanPipelineRegistry.h>
+#include <Gaia/Rendering/Base/PipelineManifest.h>
 #include <Gaia/Buffer/FrameBuffer.h>
 #include <Gaia/Utils/LoggingUtils.h>
 
@@ -50,7 +57,7 @@ using namespace GaiApi;
 //// PUBLIC / CONSTRUCTOR //////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore) {
+ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore) : m_PipelineBuilder(vVulkanCore) {
     ZoneScoped;
 
     m_RendererType = GenericType::NONE;
@@ -60,7 +67,7 @@ ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore) {
     m_Device = corePtr->getDevice();
 }
 
-ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore, const GenericType& vRendererTypeEnum) {
+ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore, const GenericType& vRendererTypeEnum) : m_PipelineBuilder(vVulkanCore) {
     ZoneScoped;
 
     m_RendererType = vRendererTypeEnum;
@@ -70,7 +77,7 @@ ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore, const GenericType& vR
     m_Device = corePtr->getDevice();
 }
 
-ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore, vk::CommandPool* vCommandPool, vk::DescriptorPool* vDescriptorPool) {
+ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore, vk::CommandPool* vCommandPool, vk::DescriptorPool* vDescriptorPool) : m_PipelineBuilder(vVulkanCore) {
     ZoneScoped;
 
     m_RendererType = GenericType::NONE;
@@ -83,7 +90,8 @@ ShaderPass::ShaderPass(GaiApi::VulkanCoreWeak vVulkanCore, vk::CommandPool* vCom
 }
 
 ShaderPass::ShaderPass(
-    GaiApi::VulkanCoreWeak vVulkanCore, const GenericType& vRendererTypeEnum, vk::CommandPool* vCommandPool, vk::DescriptorPool* vDescriptorPool) {
+    GaiApi::VulkanCoreWeak vVulkanCore, const GenericType& vRendererTypeEnum, vk::CommandPool* vCommandPool, vk::DescriptorPool* vDescriptorPool)
+    : m_PipelineBuilder(vVulkanCore) {
     ZoneScoped;
 
     m_RendererType = vRendererTypeEnum;
@@ -231,6 +239,9 @@ bool ShaderPass::InitPixel(const ez::uvec2& vSize,
     CompilPixel();
 
     m_FrameBufferPtr = FrameBuffer::Create(m_VulkanCore);
+    if (m_FrameBufferPtr) {
+        m_FrameBufferPtr->SetUseDynamicRendering(m_UseDynamicRendering);
+    }
     if (m_FrameBufferPtr &&
         m_FrameBufferPtr->Init(vSize, vCountColorBuffers, vUseDepth, vNeedToClear, vClearColor, vPingPongBufferMode, vFormat, vSampleCount)) {
         // must be set one time only by the direct parent of this pass
@@ -479,8 +490,10 @@ void ShaderPass::Unit() {
 
     m_Device.waitIdle();
     DestroyPipeline();
+    GaiApi::vkProfiler::Instance()->RemovePipelineInfos(this);
     DestroyRessourceDescriptor();
     DestroyUBO();
+    m_UniformArenaBlocks.clear();
     DestroySBO();
     DestroyModel(true);
     m_FrameBufferPtr.reset();
@@ -718,6 +731,11 @@ bool ShaderPass::StartDrawPass(vk::CommandBuffer* vCmdBufferPtr) {
                 vCmdBufferPtr->setLineWidth(m_LineWidth.w);
             }
         }
+        if (IsPixelRenderer()) {
+            SetDynamicStates(vCmdBufferPtr);
+        }
+        // here and not at the descriptor binding, since all the passes dont bind with BindDescriptorSet
+        PushPromotedUniformBlocks(vCmdBufferPtr);
         return true;
     }
     return false;
@@ -793,6 +811,7 @@ void ShaderPass::DrawPass(vk::CommandBuffer* vCmdBufferPtr, const int& vIteratio
             TraceRays(vCmdBufferPtr, vIterationNumber);
             ActionAfterDrawInCommandBuffer(vCmdBufferPtr);
         }
+        UpdateMipMappingIfNeeded(vCmdBufferPtr);
         EndDrawPass(vCmdBufferPtr);
     }
 }
@@ -943,6 +962,25 @@ void ShaderPass::UpdateModel(const bool& vLoaded) {
     }
 }
 
+bool ShaderPass::IsUniformUsed(const std::string& vName) const {
+    ZoneScoped;
+    if (m_UsedUniforms.empty()) {
+        return true;
+    }
+    const auto it = m_UsedUniforms.find(vName);
+    return (it != m_UsedUniforms.end() && it->second);
+}
+
+bool ShaderPass::IsBlockUsed(const std::string& vBlockName) const {
+    ZoneScoped;
+    return m_UsedBindings.empty() || m_UsedBindings.find(vBlockName) != m_UsedBindings.end();
+}
+
+bool ShaderPass::IsBindingUsed(const uint32_t& vBindingPoint, const uint32_t& vDescriptorSetIndex) const {
+    ZoneScoped;
+    return m_UsedBindings.empty() || m_UsedBindings.find(VulkanShader::GetBindingKey(vDescriptorSetIndex, vBindingPoint)) != m_UsedBindings.end();
+}
+
 void ShaderPass::EnableTextureUse(const uint32_t& vBindingPoint, const uint32_t& vTextureSLot, float& vTextureUseVar) {
     ZoneScoped;
     if (vBindingPoint == vTextureSLot && vTextureUseVar < 0.5f) {
@@ -1012,12 +1050,34 @@ GaiApi::VulkanComputeImageTarget* ShaderPass::GetFrontTarget(uint32_t /*vIndex*/
 void ShaderPass::SetLocalGroupSize(const ez::uvec3& vLocalGroupSize) {
     ZoneScoped;
 
-    auto corePtr = m_VulkanCore.lock();
-    assert(corePtr != nullptr);
-    auto max_group = corePtr->getPhysicalDevice().getProperties().limits.maxComputeWorkGroupSize;
+    QueryComputeLimits();
     ez::uvec3 min = 1U;
-    ez::uvec3 max = ez::uvec3(max_group[0], max_group[1], max_group[2]);
-    m_LocalGroupSize = ez::clamp(vLocalGroupSize, min, max);
+    m_LocalGroupSize = ez::clamp(vLocalGroupSize, min, m_MaxComputeWorkGroupSize);
+
+    if (m_LocalGroupSizeSpecialized) {
+        SetSpecializationConstantValue(m_LocalGroupSizeConstantIds.x, m_LocalGroupSize.x);
+        SetSpecializationConstantValue(m_LocalGroupSizeConstantIds.y, m_LocalGroupSize.y);
+        SetSpecializationConstantValue(m_LocalGroupSizeConstantIds.z, m_LocalGroupSize.z);
+    }
+}
+
+void ShaderPass::UseLocalGroupSizeSpecialization(const ez::uvec3& vConstantIds) {
+    ZoneScoped;
+    m_LocalGroupSizeSpecialized = true;
+    m_LocalGroupSizeConstantIds = vConstantIds;
+    SetLocalGroupSize(m_LocalGroupSize);
+}
+
+std::string ShaderPass::GetLocalGroupSizeLayout() const {
+    ZoneScoped;
+    if (m_LocalGroupSizeSpecialized) {
+        return "layout(local_size_x_id = " + std::to_string(m_LocalGroupSizeConstantIds.x) +  //
+               ", local_size_y_id = " + std::to_string(m_LocalGroupSizeConstantIds.y) +  //
+               ", local_size_z_id = " + std::to_string(m_LocalGroupSizeConstantIds.z) + ") in;\n";
+    }
+    return "layout(local_size_x = " + std::to_string(m_LocalGroupSize.x) +  //
+           ", local_size_y = " + std::to_string(m_LocalGroupSize.y) +  //
+           ", local_size_z = " + std::to_string(m_LocalGroupSize.z) + ") in;\n";
 }
 
 void ShaderPass::SetDispatchSize1D(const uint32_t& vDispatchSize) {
@@ -1037,12 +1097,9 @@ void ShaderPass::SetDispatchSize3D(const ez::uvec3& vDispatchSize) {
 
     m_DispatchSize = vDispatchSize / m_LocalGroupSize;
 
-    auto corePtr = m_VulkanCore.lock();
-    assert(corePtr != nullptr);
-    auto max_dispatch = corePtr->getPhysicalDevice().getProperties().limits.maxComputeWorkGroupCount;
+    QueryComputeLimits();
     ez::uvec3 min = 1U;
-    ez::uvec3 max = ez::uvec3(max_dispatch[0], max_dispatch[1], max_dispatch[2]);
-    m_DispatchSize = ez::clamp(m_DispatchSize, min, max);
+    m_DispatchSize = ez::clamp(m_DispatchSize, min, m_MaxComputeWorkGroupCount);
 }
 
 const ez::uvec3& ShaderPass::GetDispatchSize() {
@@ -1090,6 +1147,37 @@ void ShaderPass::SetLineWidth(const float& vLineWidth) {
     m_LineWidth.w = vLineWidth;
 }
 
+void ShaderPass::SetCullMode(const vk::CullModeFlagBits& vCullMode) {
+    ZoneScoped;
+    m_CullMode = vCullMode;
+}
+
+void ShaderPass::SetFrontFace(const vk::FrontFace& vFrontFace) {
+    ZoneScoped;
+    m_FrontFaceMode = vFrontFace;
+}
+
+void ShaderPass::SetPolygonMode(const vk::PolygonMode& vPolygonMode) {
+    ZoneScoped;
+    m_PolygonMode = vPolygonMode;
+}
+
+void ShaderPass::SetBlendingEnabled(const bool& vFlag) {
+    ZoneScoped;
+    m_BlendingEnabled = vFlag;
+}
+
+void ShaderPass::SetDepthTestEnabled(const bool& vTest, const bool& vWrite) {
+    ZoneScoped;
+    m_DepthTestEnabled = vTest;
+    m_DepthWriteEnabled = vWrite;
+}
+
+void ShaderPass::SetPatchControlPoints(const uint32_t& vCount) {
+    ZoneScoped;
+    m_PatchControlPoints = vCount;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// PUBLIC / SHADER ///////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1227,10 +1315,14 @@ void ShaderPass::UpdateFBOColorBuffersCount(const uint32_t& vNewColorBufferCount
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 const std::vector<unsigned int> ShaderPass::CompilGLSLToSpirv(
-    const std::string& vCode, const std::string& vShaderSuffix, const std::string& vOriginalFileName, const ShaderEntryPoint& vEntryPoint) {
+    const std::string& vCode,
+    const std::string& vShaderSuffix,
+    const std::string& vOriginalFileName,
+    const ShaderEntryPoint& vEntryPoint,
+    const SpirvBundle::KeySource* vBundleKeySource) {
     if (GaiApi::VulkanCore::sVulkanShader) {
         return GaiApi::VulkanCore::sVulkanShader->CompileGLSLString(
-            vCode, vShaderSuffix, vOriginalFileName, vEntryPoint, nullptr, nullptr, &m_UsedUniforms);
+            vCode, vShaderSuffix, vOriginalFileName, vEntryPoint, nullptr, nullptr, &m_UsedUniforms, m_SpirvOptimizationMode, vBundleKeySource, &m_UsedBindings);
     }
     return {};
 }
@@ -1259,20 +1351,19 @@ ShaderPass::ShaderCode ShaderPass::CompilShaderCode(
     }
     assert(!shader_name.empty());
 
+    shaderCode.m_ShaderName = shader_name;
+    shaderCode.m_ShaderSuffix = ext;
+    shaderCode.m_EntryPoint = vEntryPoint;
     shaderCode.m_Used = !shaderCode.m_Code.empty();
     if (shaderCode.m_Used) {
-        if (!m_DontUseShaderFilesOnDisk) {
-            shaderCode.m_FilePathName = "debug/shaders/" + shader_name + "." + ext;
-            auto shader_path =  shaderCode.m_FilePathName;
-            if (ez::file::isFileExist(shader_path)) {
-                shaderCode.m_Code = ez::file::loadFileToString(shader_path);
-            } else {
-                ez::file::saveStringToFile(shaderCode.m_Code, shader_path);
-            }
-        }
+        SyncShaderCodeWithFile(shaderCode);
 
         if (GaiApi::VulkanCore::sVulkanShader) {
-            shaderCode.m_SPIRV = CompilGLSLToSpirv(shaderCode.m_Code, ext, shader_name, vEntryPoint);
+            const auto keySource = GetBundleKeySource(shaderCode.m_Code, m_WantedVariant, vShaderType);
+            shaderCode.m_SPIRV = CompilGLSLToSpirv(RewritePromotedUniformBlocks(ApplyShaderVariant(shaderCode.m_Code, m_WantedVariant), vShaderType), ext,
+                shader_name, vEntryPoint, &keySource);
+            SpirvReflection::Reflect(shaderCode.m_SPIRV, shaderCode.m_Reflection);
+            AddCompilationDependencies(shaderCode, keySource);
         }
     }
 
@@ -1280,6 +1371,61 @@ ShaderPass::ShaderCode ShaderPass::CompilShaderCode(
 }
 
 ShaderPass::ShaderCode ShaderPass::CompilShaderCode(const vk::ShaderStageFlagBits& vShaderType, const std::string& vEntryPoint) {
+    ZoneScoped;
+    auto shaderCode = PrepareShaderCode(vShaderType, vEntryPoint);
+    if (shaderCode.m_Used && GaiApi::VulkanCore::sVulkanShader) {
+        const auto keySource = GetBundleKeySource(shaderCode.m_Code, m_WantedVariant, vShaderType);
+        shaderCode.m_SPIRV = CompilGLSLToSpirv(RewritePromotedUniformBlocks(ApplyShaderVariant(shaderCode.m_Code, m_WantedVariant), vShaderType),
+            shaderCode.m_ShaderSuffix, shaderCode.m_ShaderName, vEntryPoint, &keySource);
+        SpirvReflection::Reflect(shaderCode.m_SPIRV, shaderCode.m_Reflection);
+        AddCompilationDependencies(shaderCode, keySource);
+    }
+    return shaderCode;
+}
+
+// the file in debug/shaders is the editable version of the code
+// the file is read through the include cache, so a file is only read from the disk once and when the file watcher say it was changed
+void ShaderPass::SyncShaderCodeWithFile(ShaderCode& vShaderCode) {
+    ZoneScoped;
+    if (m_DontUseShaderFilesOnDisk) {
+        return;
+    }
+    vShaderCode.m_FilePathName = "debug/shaders/" + vShaderCode.m_ShaderName + "." + vShaderCode.m_ShaderSuffix;
+    const auto& shader_path = vShaderCode.m_FilePathName;
+    if (GaiApi::VulkanCore::sVulkanShader) {
+        auto& cache = GaiApi::VulkanCore::sVulkanShader->GetIncludeCache();
+        std::string content;
+        size_t hash = 0U;
+        if (cache.GetFileContent(shader_path, content, &hash)) {
+            vShaderCode.m_Code = content;
+        } else {
+            ez::file::saveStringToFile(vShaderCode.m_Code, shader_path);
+            cache.SetFileContent(shader_path, vShaderCode.m_Code);
+            cache.GetFileContent(shader_path, content, &hash);
+        }
+        vShaderCode.m_Dependencies[ShaderIncludeCache::NormalizePath(shader_path)] = hash;
+    } else if (ez::file::isFileExist(shader_path)) {
+        vShaderCode.m_Code = ez::file::loadFileToString(shader_path);
+    } else {
+        ez::file::saveStringToFile(vShaderCode.m_Code, shader_path);
+    }
+}
+
+// add the files included during the last compilation of the shader code, with the same key source as the compilation
+// the used uniforms are the cumulated ones of the pass, so a stage reused without compilation keep all of them
+void ShaderPass::AddCompilationDependencies(ShaderCode& vShaderCode, const SpirvBundle::KeySource& vBundleKeySource) {
+    ZoneScoped;
+    if (GaiApi::VulkanCore::sVulkanShader) {
+        const auto& cache = GaiApi::VulkanCore::sVulkanShader->GetIncludeCache();
+        const auto deps = cache.GetDependencies(VulkanShader::GetCompileKey(vShaderCode.m_ShaderName, vShaderCode.m_ShaderSuffix, &vBundleKeySource));
+        vShaderCode.m_Dependencies.insert(deps.begin(), deps.end());
+    }
+    vShaderCode.m_UsedUniforms = m_UsedUniforms;
+    vShaderCode.m_UsedBindings = m_UsedBindings;
+}
+
+// get the code of the stage, without compilation, can be called from the main thread before a background compilation
+ShaderPass::ShaderCode ShaderPass::PrepareShaderCode(const vk::ShaderStageFlagBits& vShaderType, const std::string& vEntryPoint) {
     ZoneScoped;
     ShaderCode shaderCode;
     shaderCode.m_ShaderId = vShaderType;
@@ -1335,22 +1481,12 @@ ShaderPass::ShaderCode ShaderPass::CompilShaderCode(const vk::ShaderStageFlagBit
     }
     assert(!shader_name.empty());
 
+    shaderCode.m_ShaderName = shader_name;
+    shaderCode.m_ShaderSuffix = ext;
     shaderCode.m_Used = !shaderCode.m_Code.empty();
 
     if (shaderCode.m_Used) {
-        if (!m_DontUseShaderFilesOnDisk) {
-            shaderCode.m_FilePathName = "debug/shaders/" + shader_name + "." + ext;
-            auto shader_path =  shaderCode.m_FilePathName;
-            if (ez::file::isFileExist(shader_path)) {
-                shaderCode.m_Code = ez::file::loadFileToString(shader_path);
-            } else {
-                ez::file::saveStringToFile(shaderCode.m_Code, shader_path);
-            }
-        }
-
-        if (GaiApi::VulkanCore::sVulkanShader) {
-            shaderCode.m_SPIRV = CompilGLSLToSpirv(shaderCode.m_Code, ext, shader_name, vEntryPoint);
-        }
+        SyncShaderCodeWithFile(shaderCode);
     }
 
     return shaderCode;
@@ -1369,8 +1505,10 @@ bool ShaderPass::CompilPixel() {
     bool res = false;
 
     ActionBeforeCompilation();
+    PromoteUniformBlocksIfPossible();
 
     m_UsedUniforms.clear();
+    m_UsedBindings.clear();
     m_ShaderCodes.clear();
 
     m_IsShaderCompiled = true;
@@ -1392,6 +1530,7 @@ bool ShaderPass::CompilPixel() {
             } else if (m_IsShaderCompiled) {
                 m_Device.waitIdle();
                 DestroyPipeline();
+                UpdateReflectedDescriptorSets(m_ShaderCodes);  // the new shaders can use other bindings
                 // DestroyRessourceDescriptor();
                 // DestroyUBO();
                 // DestroySBO();
@@ -1415,8 +1554,10 @@ bool ShaderPass::CompilCompute() {
     bool res = false;
 
     ActionBeforeCompilation();
+    PromoteUniformBlocksIfPossible();
 
     m_UsedUniforms.clear();
+    m_UsedBindings.clear();
     m_ShaderCodes.clear();
 
     m_IsShaderCompiled = true;
@@ -1438,6 +1579,7 @@ bool ShaderPass::CompilCompute() {
             } else if (m_IsShaderCompiled) {
                 m_Device.waitIdle();
                 DestroyPipeline();
+                UpdateReflectedDescriptorSets(m_ShaderCodes);  // the new shaders can use other bindings
                 // DestroyRessourceDescriptor();
                 // DestroyUBO();
                 // DestroySBO();
@@ -1461,10 +1603,12 @@ bool ShaderPass::CompilRtx() {
     bool res = false;
 
     m_UsedUniforms.clear();
+    m_UsedBindings.clear();
     m_ShaderCodes.clear();
     m_IsShaderCompiled = true;
 
     ActionBeforeCompilation();
+    PromoteUniformBlocksIfPossible();
 
     for (const auto& shaders : m_ShaderCodes) {
         for (auto& shaderEntryPoint : shaders.second) {
@@ -1538,6 +1682,38 @@ void ShaderPass::UploadUBO() {
     ZoneScoped;
 }
 
+bool ShaderPass::CreateUniformArenaBlock(UniformBlockStd140& vUniformBlock) {
+    ZoneScoped;
+    vUniformBlock.UseUniformArena();
+    if (!vUniformBlock.CreateUBO(m_VulkanCore)) {
+        return false;
+    }
+    if (std::find(m_UniformArenaBlocks.begin(), m_UniformArenaBlocks.end(), &vUniformBlock) == m_UniformArenaBlocks.end()) {
+        m_UniformArenaBlocks.push_back(&vUniformBlock);
+    }
+    return true;
+}
+
+bool ShaderPass::UploadUniformBlockIfUsed(
+    UniformBlockStd140& vUniformBlock, const uint32_t& vBindingPoint, const uint32_t& vDescriptorSetIndex, const bool& vOnlyIfDirty) {
+    ZoneScoped;
+    if (IsBindingUsed(vBindingPoint, vDescriptorSetIndex)) {
+        vUniformBlock.Upload(m_VulkanCore, vOnlyIfDirty);
+        return true;
+    }
+    return false;
+}
+
+bool ShaderPass::UploadStorageBufferIfUsed(
+    StorageBufferStd430& vStorageBuffer, const uint32_t& vBindingPoint, const uint32_t& vDescriptorSetIndex, const bool& vOnlyIfDirty) {
+    ZoneScoped;
+    if (IsBindingUsed(vBindingPoint, vDescriptorSetIndex)) {
+        vStorageBuffer.Upload(m_VulkanCore, vOnlyIfDirty);
+        return true;
+    }
+    return false;
+}
+
 void ShaderPass::DestroyUBO() {
     ZoneScoped;
 }
@@ -1582,6 +1758,7 @@ bool ShaderPass::UpdateBufferInfoInRessourceDescriptor() {
 
     for (auto& descriptor : m_DescriptorSets) {
         descriptor.m_WriteDescriptorSets.clear();
+        descriptor.m_DynamicOffsetPtrs.clear();
     }
 
     return res;
@@ -1599,17 +1776,81 @@ bool ShaderPass::UpdateLayoutBindingInRessourceDescriptor() {
     return res;
 }
 
+std::vector<vk::DescriptorSetLayoutBinding> ShaderPass::GetReflectedLayoutBindings(const ShaderCodesContainer& vShaderCodes,
+    const uint32_t& vDescriptorSetIndex,
+    const std::map<uint32_t, vk::DescriptorType>* vDynamicTypesPtr) const {
+    ZoneScoped;
+    std::vector<const SpirvReflection::ReflectionDatas*> stages;
+    for (const auto& shaders : vShaderCodes) {
+        for (const auto& entryPoint : shaders.second) {
+            for (const auto& code : entryPoint.second) {
+                if (code.m_Used && code.m_Reflection.valid) {
+                    stages.push_back(&code.m_Reflection);
+                }
+            }
+        }
+    }
+    return SpirvReflection::GetLayoutBindings(stages, vDescriptorSetIndex, vDynamicTypesPtr);
+}
+
+std::map<uint32_t, vk::DescriptorType> ShaderPass::GetDynamicDescriptorTypes(const uint32_t& vDescriptorSetIndex) const {
+    ZoneScoped;
+    std::map<uint32_t, vk::DescriptorType> res;
+    if (vDescriptorSetIndex < (uint32_t)m_DescriptorSets.size()) {
+        for (const auto& write : m_DescriptorSets[vDescriptorSetIndex].m_WriteDescriptorSets) {
+            if (write.descriptorType == vk::DescriptorType::eUniformBufferDynamic || write.descriptorType == vk::DescriptorType::eStorageBufferDynamic) {
+                res[write.dstBinding] = write.descriptorType;
+            }
+        }
+    }
+    return res;
+}
+
+// a hot reload or a variant can use a binding not used by the shaders of the first compilation
+bool ShaderPass::UpdateReflectedDescriptorSets(const ShaderCodesContainer& vShaderCodes) {
+    ZoneScoped;
+    bool res = false;
+    for (uint32_t setIndex = 0U; setIndex < (uint32_t)m_DescriptorSets.size(); ++setIndex) {
+        auto& descriptor = m_DescriptorSets[setIndex];
+        if (!descriptor.m_IsReflected || !descriptor.m_DescriptorSetLayout) {
+            continue;
+        }
+        const auto dynamicTypes = GetDynamicDescriptorTypes(setIndex);
+        const auto bindings = GetReflectedLayoutBindings(vShaderCodes, setIndex, &dynamicTypes);
+        if (bindings == descriptor.m_LayoutBindings) {
+            continue;
+        }
+        m_Device.waitIdle();  // the descriptor set can be used by the frames in flight
+        if (m_DescriptorPool && descriptor.m_DescriptorSet) {
+            m_Device.freeDescriptorSets(m_DescriptorPool, descriptor.m_DescriptorSet);
+        }
+        m_Device.destroyDescriptorSetLayout(descriptor.m_DescriptorSetLayout);
+        descriptor.m_LayoutBindings = bindings;
+        descriptor.m_DescriptorSetLayout = m_Device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo(
+            vk::DescriptorSetLayoutCreateFlags(), static_cast<uint32_t>(descriptor.m_LayoutBindings.size()), descriptor.m_LayoutBindings.data()));
+        descriptor.m_DescriptorSet =
+            m_Device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(m_DescriptorPool, 1, &descriptor.m_DescriptorSetLayout))[0];
+        for (auto& write : descriptor.m_WriteDescriptorSets) {
+            write.dstSet = descriptor.m_DescriptorSet;
+        }
+        descriptor.m_UsedWriteDescriptorSets.clear();
+        CheckWritesOfReflectedLayout(setIndex);  // only logged, a binding without write stay undefined
+        res = true;
+    }
+    return res;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //// PRIVATE / MIP MAPPING /////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void ShaderPass::UpdateMipMappingIfNeeded() {
-    if (m_CanUpdateMipMapping) {
-        vkProfScopedPtrNoCmd(this, m_RenderDocDebugName, "%s", "MipMapping");
+void ShaderPass::UpdateMipMappingIfNeeded(vk::CommandBuffer* vCmdBufferPtr) {
+    if (m_CanUpdateMipMapping && vCmdBufferPtr) {
+        vkProfScopedPtr(*vCmdBufferPtr, this, m_RenderDocDebugName, "%s : MipMapping", m_RenderDocDebugName);
         if (m_ComputeBufferPtr != nullptr) {
-            m_ComputeBufferPtr->UpdateMipMapping(0);
+            m_ComputeBufferPtr->UpdateMipMapping(0, vCmdBufferPtr);
         } else if (m_FrameBufferPtr != nullptr) {
-            m_ComputeBufferPtr->UpdateMipMapping(0);
+            m_FrameBufferPtr->UpdateMipMapping(0, vCmdBufferPtr);
         }
     }
 }
@@ -1629,6 +1870,7 @@ void ShaderPass::ClearWriteDescriptors(const uint32_t& vDescriptorSetIndex) {
     ZoneScoped;
     if (vDescriptorSetIndex < (uint32_t)m_DescriptorSets.size()) {
         m_DescriptorSets[vDescriptorSetIndex].m_WriteDescriptorSets.clear();
+        m_DescriptorSets[vDescriptorSetIndex].m_DynamicOffsetPtrs.clear();
     }
 }
 
@@ -1728,6 +1970,18 @@ bool ShaderPass::AddOrSetWriteDescriptorBuffer(const uint32_t& vBindingPoint,
     return false;
 }
 
+bool ShaderPass::AddOrSetWriteDescriptorDynamicBuffer(const uint32_t& vBindingPoint,
+    const vk::DescriptorBufferInfo* vBufferInfo,
+    const uint32_t* vDynamicOffsetPtr,
+    const uint32_t& vDescriptorSetIndex) {
+    ZoneScoped;
+    if (AddOrSetWriteDescriptorBuffer(vBindingPoint, vk::DescriptorType::eUniformBufferDynamic, vBufferInfo, 1U, vDescriptorSetIndex)) {
+        m_DescriptorSets[vDescriptorSetIndex].m_DynamicOffsetPtrs[vBindingPoint] = vDynamicOffsetPtr;
+        return true;
+    }
+    return false;
+}
+
 bool ShaderPass::AddOrSetWriteDescriptorBufferView(const uint32_t& vBindingPoint,
     const vk::DescriptorType& vType,
     const vk::BufferView* vBufferView,
@@ -1938,7 +2192,15 @@ bool ShaderPass::CreateRessourceDescriptor() {
     ZoneScoped;
 
     if (UpdateLayoutBindingInRessourceDescriptor()) {
-        for (auto& descriptor : m_DescriptorSets) {
+        std::vector<uint32_t> reflectedSets;
+        for (uint32_t setIndex = 0U; setIndex < (uint32_t)m_DescriptorSets.size(); ++setIndex) {
+            auto& descriptor = m_DescriptorSets[setIndex];
+            // a set not declared by the pass is deduced from the spirv of the shaders
+            descriptor.m_IsReflected = descriptor.m_LayoutBindings.empty();
+            if (descriptor.m_IsReflected) {
+                descriptor.m_LayoutBindings = GetReflectedLayoutBindings(m_ShaderCodes, setIndex);
+                reflectedSets.push_back(setIndex);
+            }
             descriptor.m_DescriptorSetLayout = m_Device.createDescriptorSetLayout(vk::DescriptorSetLayoutCreateInfo(
                 vk::DescriptorSetLayoutCreateFlags(), static_cast<uint32_t>(descriptor.m_LayoutBindings.size()), descriptor.m_LayoutBindings.data()));
             descriptor.m_DescriptorSet =
@@ -1946,6 +2208,16 @@ bool ShaderPass::CreateRessourceDescriptor() {
         }
 
         if (UpdateBufferInfoInRessourceDescriptor()) {
+            // the dynamic buffers are only known now by the writes, so the reflected layouts are recreated if they have one
+            UpdateReflectedDescriptorSets(m_ShaderCodes);
+            // the pass have not declared these layouts, so nothing say he write all the bindings of the shaders
+            bool allWritten = true;
+            for (const auto& setIndex : reflectedSets) {
+                allWritten &= CheckWritesOfReflectedLayout(setIndex);
+            }
+            if (!allWritten) {
+                return false;
+            }
             UpdateRessourceDescriptor();
             return true;
         }
@@ -1954,6 +2226,29 @@ bool ShaderPass::CreateRessourceDescriptor() {
     return false;
 }
 
+bool ShaderPass::CheckWritesOfReflectedLayout(const uint32_t& vDescriptorSetIndex) const {
+    ZoneScoped;
+    bool res = true;
+    if (vDescriptorSetIndex < (uint32_t)m_DescriptorSets.size()) {
+        const auto& descriptor = m_DescriptorSets[vDescriptorSetIndex];
+        for (const auto& binding : descriptor.m_LayoutBindings) {
+            const auto it = std::find_if(descriptor.m_WriteDescriptorSets.begin(), descriptor.m_WriteDescriptorSets.end(),  //
+                [&binding](const vk::WriteDescriptorSet& vWrite) { return vWrite.dstBinding == binding.binding; });
+            if (it == descriptor.m_WriteDescriptorSets.end()) {
+                LogVarError("%s : the binding %u of the set %u is used by the shaders but have no write descriptor", m_RenderDocDebugName,
+                    binding.binding, vDescriptorSetIndex);
+                res = false;
+            } else if (it->descriptorType != binding.descriptorType) {
+                LogVarError("%s : the binding %u of the set %u is a %s in the shaders but a %s in the write descriptors", m_RenderDocDebugName,
+                    binding.binding, vDescriptorSetIndex, LoggingUtils::DescriptorTypeToString(binding.descriptorType),
+                    LoggingUtils::DescriptorTypeToString(it->descriptorType));
+                res = false;
+            }
+        }
+    }
+    return res;
+}
+
 bool ShaderPass::CanUpdateDescriptors() {
     ZoneScoped;
     return true;
@@ -1962,6 +2257,16 @@ bool ShaderPass::CanUpdateDescriptors() {
 void ShaderPass::UpdateRessourceDescriptor() {
     ZoneScoped;
 
+    m_PipelineBuilder.BeginFrame();
+    CollectPipelineBuild();
+    SwapHotReloadedPipelineIfReady();
+    UpdateShaderVariant();
+    UpdateSpecializedPipeline();
+    PrewarmFromPipelineManifest();
+    RecordInPipelineManifest();
+    m_PipelineBuilder.CollectOptimizedLinks([this](const vk::Pipeline& vPipeline) { return FindPipelineStruct(vPipeline); });
+    m_PipelineBuilder.UpdatePipelineStatisticsInProfiler(this);
+
     m_Device.waitIdle();
 
     vkProfScopedPtrNoCmd(this, m_RenderDocDebugName, "%s", "UpdateRessourceDescriptor");
@@ -1975,6 +2280,12 @@ void ShaderPass::UpdateRessourceDescriptor() {
         m_NeedNewUBOUpload = false;
     }
 
+    // the arena is reseted at each frame, so a block not changed since the last frame must be pushed again
+    // else his dynamic offset point in a region reused by other blocks
+    for (auto* blockPtr : m_UniformArenaBlocks) {
+        blockPtr->Upload(m_VulkanCore, true);
+    }
+
     if (m_NeedNewSBOUpload) {
         UploadSBO();
         m_NeedNewSBOUpload = false;
@@ -1987,8 +2298,18 @@ void ShaderPass::UpdateRessourceDescriptor() {
     m_DescriptorWasUpdated = false;
     if (CanUpdateDescriptors()) {
         // update descriptor
-        for (auto& descriptor : m_DescriptorSets) {
-            m_Device.updateDescriptorSets(descriptor.m_WriteDescriptorSets, nullptr);
+        for (uint32_t setIndex = 0U; setIndex < (uint32_t)m_DescriptorSets.size(); ++setIndex) {
+            auto& descriptor = m_DescriptorSets[setIndex];
+            // the descriptors not used by the shaders can stay undefined
+            descriptor.m_UsedWriteDescriptorSets.clear();
+            for (const auto& write : descriptor.m_WriteDescriptorSets) {
+                if (IsBindingUsed(write.dstBinding, setIndex)) {
+                    descriptor.m_UsedWriteDescriptorSets.push_back(write);
+                }
+            }
+            if (!descriptor.m_UsedWriteDescriptorSets.empty()) {
+                m_Device.updateDescriptorSets(descriptor.m_UsedWriteDescriptorSets, nullptr);
+            }
         }
         m_DescriptorWasUpdated = true;
     }
@@ -1999,6 +2320,19 @@ void ShaderPass::UpdateRessourceDescriptor() {
     // m_UniformWidgets.SetFrame(m_Frame);
 }
 
+void ShaderPass::BindDescriptorSet(vk::CommandBuffer* vCmdBufferPtr, const vk::PipelineBindPoint& vBindPoint, const uint32_t& vDescriptorSetIndex) {
+    ZoneScoped;
+    if (vCmdBufferPtr && vDescriptorSetIndex < (uint32_t)m_DescriptorSets.size()) {
+        auto& descriptor = m_DescriptorSets[vDescriptorSetIndex];
+        descriptor.m_DynamicOffsets.clear();
+        for (const auto& offset : descriptor.m_DynamicOffsetPtrs) {
+            descriptor.m_DynamicOffsets.push_back(offset.second ? *offset.second : 0U);
+        }
+        vCmdBufferPtr->bindDescriptorSets(
+            vBindPoint, m_Pipelines[0].m_PipelineLayout, vDescriptorSetIndex, descriptor.m_DescriptorSet, descriptor.m_DynamicOffsets);
+    }
+}
+
 void ShaderPass::DestroyRessourceDescriptor() {
     ZoneScoped;
 
@@ -2023,109 +2357,795 @@ void ShaderPass::DestroyRessourceDescriptor() {
 
 void ShaderPass::UpdateShaders(const std::set<std::string>& vFiles) {
     ZoneScoped;
-    bool needReCompil = false;
+    if (!GaiApi::VulkanCore::sVulkanShader) {
+        return;
+    }
 
-    // tofix : c'est nimp cette fonction
+    // only the cached files are reread, the unchanged includes are not read again
+    GaiApi::VulkanCore::sVulkanShader->GetIncludeCache().UpdateFiles(vFiles);
 
-    for (const auto& shaderCodes : m_ShaderCodes) {
-        for (const auto& shaderEntryPoint : shaderCodes.second) {
-            for (const auto& shader : shaderEntryPoint.second) {
-                if (shader.m_Used && !shader.m_FilePathName.empty()) {
-                    for (auto filePathNameToUpdate : vFiles) {
-                        if (filePathNameToUpdate == shader.m_FilePathName) {
-                            needReCompil |= ez::file::isFileExist(shader.m_FilePathName);
-                        }
+    // only the stages who depends on a changed file are recompiled
+    const auto outdatedStages = GetOutdatedStages();
+    if (!outdatedStages.empty()) {
+        if (m_BackgroundHotReload && IsBackgroundCompilationPossible()) {
+            StartBackgroundReCompil(outdatedStages);
+        } else {
+            ReCompilCode();
+        }
+    }
+}
+
+ShaderPass::ShaderStagesContainer ShaderPass::GetOutdatedStages() {
+    ZoneScoped;
+    ShaderStagesContainer res;
+    if (GaiApi::VulkanCore::sVulkanShader) {
+        const auto& cache = GaiApi::VulkanCore::sVulkanShader->GetIncludeCache();
+        for (const auto& shaderCodes : m_ShaderCodes) {
+            for (const auto& shaderEntryPoint : shaderCodes.second) {
+                for (const auto& shader : shaderEntryPoint.second) {
+                    if (shader.m_Used && cache.IsOutdated(shader.m_Dependencies)) {
+                        res.emplace(shaderCodes.first, shaderEntryPoint.first);
                     }
                 }
             }
         }
     }
+    return res;
+}
 
-    if (needReCompil) {
-        ReCompilCode();
-    }
+void ShaderPass::SetBackgroundHotReload(const bool& vFlag) {
+    ZoneScoped;
+    m_BackgroundHotReload = vFlag;
 }
 
-/////////////////////////////////////////////////////////////////////
-//// SHADER CODE ////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////
+bool ShaderPass::IsHotReloadPending() const {
+    return m_HotReloadFuture.valid();
+}
 
-void ShaderPass::SetHeaderCode(const std::string& vHeaderCode) {
+void ShaderPass::SetAsyncPipelineCreation(const bool& vFlag) {
     ZoneScoped;
-    m_HeaderCode = vHeaderCode;
+    m_AsyncPipelineCreation = vFlag;
 }
 
-void ShaderPass::SetVertexShaderCode(const std::string& vShaderCode) {
+bool ShaderPass::IsPipelineBuildPending() const {
+    return m_PipelineBuildFuture.valid();
+}
+
+void ShaderPass::SetUseGraphicsPipelineLibrary(const bool& vFlag) {
     ZoneScoped;
-    m_VertexCode = vShaderCode;
+    m_UseGraphicsPipelineLibrary = vFlag;
 }
 
-void ShaderPass::SetFragmentShaderCode(const std::string& vShaderCode) {
+void ShaderPass::SetUseDynamicRendering(const bool& vFlag) {
     ZoneScoped;
-    m_FragmentCode = vShaderCode;
+    m_UseDynamicRendering = vFlag;
 }
 
-void ShaderPass::SetGeometryShaderCode(const std::string& vShaderCode) {
+void ShaderPass::SetCapturePipelineStatistics(const bool& vFlag) {
     ZoneScoped;
-    m_GeometryCode = vShaderCode;
+    m_PipelineBuilder.SetCapturePipelineStatistics(vFlag);
 }
 
-void ShaderPass::SetTesselationEvaluationShaderCode(const std::string& vShaderCode) {
+std::string ShaderPass::GetPipelineStatisticsReport() const {
     ZoneScoped;
-    m_TesselationEvaluationCode = vShaderCode;
+    return m_PipelineBuilder.GetPipelineStatisticsReport();
 }
 
-void ShaderPass::SetTesselationControlShaderCode(const std::string& vShaderCode) {
+void ShaderPass::SetSpirvOptimizationMode(const SpirvOptimizationMode& vMode) {
     ZoneScoped;
-    m_TesselationControlCode = vShaderCode;
+    m_SpirvOptimizationMode = vMode;
 }
 
-void ShaderPass::SetComputeShaderCode(const std::string& vShaderCode) {
+bool ShaderPass::StartBackgroundReCompil(const ShaderStagesContainer& vStagesToCompile) {
     ZoneScoped;
-    m_ComputeCode = vShaderCode;
+    if (!GaiApi::VulkanCore::sVulkanShader) {
+        return false;
+    }
+    if (m_HotReloadFuture.valid()) {
+        // a compilation is running, a new one will be started after the swap
+        m_HotReloadNeededAgain = true;
+        return true;
+    }
+    m_HotReloadNeededAgain = false;
+
+    ActionBeforeCompilation();
+    PromoteUniformBlocksIfPossible();
+
+    m_HotReloadFuture = LaunchPipelineJob(vStagesToCompile, m_CurrentVariant);
+
+    return true;
 }
 
-void ShaderPass::SetRayGenerationShaderCode(const std::string& vShaderCode) {
+// compile the shaders of vVariant and build his pipeline on a worker thread
+// the codes are get on the main thread, since the getters are virtuals and the files can be edited
+// the stages not in vStagesToCompile reuse their last spirv (empty vStagesToCompile => all the stages are compiled)
+std::future<ShaderPass::HotReloadStruct> ShaderPass::LaunchPipelineJob(const ShaderStagesContainer& vStagesToCompile, const ShaderVariantKey& vVariant) {
     ZoneScoped;
-    m_RayGenerationCode = vShaderCode;
+    struct CompilJob {
+        ShaderCode m_ShaderCode;
+        std::string m_CodeToCompile;
+        SpirvBundle::KeySource m_BundleKeySource;
+        bool m_NeedCompil = true;
+    };
+    std::vector<CompilJob> jobs;
+    for (const auto& shader : m_ShaderEntryPoints) {
+        for (const auto& entryPoint : shader.second) {
+            const auto key = std::make_pair(shader.first, entryPoint);
+            if (!vStagesToCompile.empty() && vStagesToCompile.find(key) == vStagesToCompile.end()) {
+                auto itStage = m_ShaderCodes.find(shader.first);
+                if (itStage != m_ShaderCodes.end()) {
+                    auto itEntry = itStage->second.find(entryPoint);
+                    if (itEntry != itStage->second.end() && !itEntry->second.empty()) {
+                        for (const auto& code : itEntry->second) {
+                            CompilJob job;
+                            job.m_ShaderCode = code;
+                            job.m_ShaderCode.m_ShaderModule = nullptr;
+                            job.m_NeedCompil = false;
+                            jobs.push_back(job);
+                        }
+                        continue;
+                    }
+                }
+            }
+            CompilJob job;
+            job.m_ShaderCode = PrepareShaderCode(shader.first, entryPoint);
+            job.m_CodeToCompile = RewritePromotedUniformBlocks(ApplyShaderVariant(job.m_ShaderCode.m_Code, vVariant), shader.first);
+            job.m_BundleKeySource = GetBundleKeySource(job.m_ShaderCode.m_Code, vVariant, shader.first);
+            jobs.push_back(job);
+        }
+    }
+
+    const bool isPixel = IsPixelRenderer();
+    const auto optimizationMode = m_SpirvOptimizationMode;
+    const auto specializationConstants = m_SpecializationConstants;
+    const auto states = CapturePipelineBuildStates();
+    const auto generation = m_VariantsGeneration;
+    return std::async(std::launch::async, [this, isPixel, optimizationMode, specializationConstants, states, vVariant, generation, jobs]() {
+        HotReloadStruct res;
+        res.m_SpecializationConstants = specializationConstants;
+        res.m_StaticStatesKey = states.m_StaticStatesKey;
+        res.m_Variant = vVariant;
+        res.m_Generation = generation;
+        res.m_Succeed = true;
+        for (const auto& job : jobs) {
+            auto code = job.m_ShaderCode;
+            if (code.m_Used && job.m_NeedCompil) {
+                code.m_UsedUniforms.clear();
+                code.m_UsedBindings.clear();
+                code.m_SPIRV = GaiApi::VulkanCore::sVulkanShader->CompileGLSLString(job.m_CodeToCompile, code.m_ShaderSuffix, code.m_ShaderName,
+                    code.m_EntryPoint, nullptr, nullptr, &code.m_UsedUniforms, optimizationMode, &job.m_BundleKeySource, &code.m_UsedBindings);
+                SpirvReflection::Reflect(code.m_SPIRV, code.m_Reflection);
+                const auto deps = GaiApi::VulkanCore::sVulkanShader->GetIncludeCache().GetDependencies(
+                    VulkanShader::GetCompileKey(code.m_ShaderName, code.m_ShaderSuffix, &job.m_BundleKeySource));
+                code.m_Dependencies.insert(deps.begin(), deps.end());
+            }
+            if (code.m_Code.empty() || (code.m_Used && code.m_SPIRV.empty())) {
+                res.m_Succeed = false;
+            }
+            for (const auto& used : code.m_UsedUniforms) {
+                res.m_UsedUniforms[used.first] |= used.second;
+            }
+            res.m_UsedBindings.insert(code.m_UsedBindings.begin(), code.m_UsedBindings.end());
+            res.m_ShaderCodes[code.m_ShaderId][code.m_EntryPoint].push_back(code);
+        }
+        if (res.m_Succeed && states.m_IsLayoutReflected) {
+            // a pipeline cant be built with a layout without a binding used by his shaders
+            // so the layout is recreated and the pipeline is built on the render thread at the swap (see PrepareLayoutForSwap)
+            std::map<uint32_t, vk::DescriptorType> dynamicTypes;
+            for (const auto& binding : states.m_LayoutBindings) {
+                dynamicTypes[binding.binding] = binding.descriptorType;
+            }
+            res.m_NeedNewLayout = (GetReflectedLayoutBindings(res.m_ShaderCodes, 0U, &dynamicTypes) != states.m_LayoutBindings);
+        }
+        if (res.m_Succeed && !res.m_NeedNewLayout) {
+            if (isPixel) {
+                res.m_Succeed = BuildPixelPipeline(res.m_ShaderCodes, states, res.m_Pipeline, res.m_SpecializationConstants);
+            } else {
+                res.m_Succeed = BuildComputePipeline(res.m_ShaderCodes, states, res.m_Pipeline, res.m_SpecializationConstants);
+            }
+        }
+        return res;
+    });
 }
 
-void ShaderPass::SetRayIntersectionShaderCode(const std::string& vShaderCode) {
+void ShaderPass::SwapHotReloadedPipelineIfReady() {
     ZoneScoped;
-    m_RayIntersectionCode = vShaderCode;
+    if (m_HotReloadFuture.valid() && m_HotReloadFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        auto res = m_HotReloadFuture.get();
+        if (res.m_Succeed && !PrepareLayoutForSwap(res)) {
+            res.m_Succeed = false;
+        }
+        if (res.m_Succeed) {
+            m_PipelineBuilder.RetirePipeline(m_Pipelines[0]);
+            m_Pipelines[0] = res.m_Pipeline;
+            m_BuiltSpecializationConstants = res.m_SpecializationConstants;
+            m_BuiltStaticStatesKey = res.m_StaticStatesKey;
+            m_CurrentVariant = res.m_Variant;
+            DestroySpecializedPipelines(true);  // built with the old shaders
+            DestroyShaderVariants(true);        // built with the old shaders
+            m_ShaderCodes = std::move(res.m_ShaderCodes);
+            m_UsedUniforms = std::move(res.m_UsedUniforms);
+            m_UsedBindings = std::move(res.m_UsedBindings);
+            m_IsShaderCompiled = true;
+        } else {
+            DestroyPipelineStruct(res.m_Pipeline);
+            LogVarError("The hot reload compilation failed, the previous pipeline is kept");
+        }
+        ActionAfterCompilation();
+        if (m_HotReloadNeededAgain) {
+            m_HotReloadNeededAgain = false;
+            const auto outdatedStages = GetOutdatedStages();
+            if (!outdatedStages.empty()) {
+                StartBackgroundReCompil(outdatedStages);
+            }
+        }
+    }
 }
 
-void ShaderPass::SetRayMissShaderCode(const std::string& vShaderCode) {
+// the layout is recreated if the shaders of vHotReload use other bindings, and his pipeline is rebuilded with it
+// on failure, the layout is put back on the bindings of the current shaders
+bool ShaderPass::PrepareLayoutForSwap(HotReloadStruct& vHotReload) {
     ZoneScoped;
-    m_RayMissCode = vShaderCode;
+    if (!UpdateReflectedDescriptorSets(vHotReload.m_ShaderCodes) && !vHotReload.m_NeedNewLayout) {
+        return true;
+    }
+    DestroyPipelineStruct(vHotReload.m_Pipeline);  // built with the old layout, or not built
+    vHotReload.m_NeedNewLayout = false;
+    const auto states = CapturePipelineBuildStates();
+    vHotReload.m_StaticStatesKey = states.m_StaticStatesKey;
+    const bool built = IsPixelRenderer() ? BuildPixelPipeline(vHotReload.m_ShaderCodes, states, vHotReload.m_Pipeline, vHotReload.m_SpecializationConstants)
+                                         : BuildComputePipeline(vHotReload.m_ShaderCodes, states, vHotReload.m_Pipeline, vHotReload.m_SpecializationConstants);
+    if (!built) {
+        DestroyPipelineStruct(vHotReload.m_Pipeline);
+        UpdateReflectedDescriptorSets(m_ShaderCodes);
+    }
+    return built;
 }
 
-void ShaderPass::SetRayAnyHitShaderCode(const std::string& vShaderCode) {
+// the spirvs and the states are copied, so the worker thread don't touch the pass
+bool ShaderPass::StartPipelineBuild(const bool& vIsPixel) {
     ZoneScoped;
-    m_RayAnyHitCode = vShaderCode;
+    WaitPipelineBuild();
+    m_PipelineBuildFuture =
+        m_PipelineBuilder.LaunchPipelineBuild(vIsPixel, GetShaderSpirvs(m_ShaderCodes), CapturePipelineBuildStates(), m_SpecializationConstants);
+    return true;
 }
 
-void ShaderPass::SetRayClosestHitShaderCode(const std::string& vShaderCode) {
+void ShaderPass::CollectPipelineBuild() {
     ZoneScoped;
-    m_RayClosestHitCode = vShaderCode;
+    if (m_PipelineBuildFuture.valid() && m_PipelineBuildFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        auto res = m_PipelineBuildFuture.get();
+        if (!res.m_Pipeline) {
+            LogVarError("The pipeline build failed, the pass will not be rendered");
+        } else if (m_Pipelines[0].m_Pipeline) {
+            // a hot reload was swapped during the build, so this pipeline is older
+            DestroyPipelineStruct(res);
+        } else {
+            DestroyPipelineStruct(m_Pipelines[0]);
+            m_Pipelines[0] = res;
+        }
+    }
 }
 
-/////////////////////////////////////////////////////////////////////
-//// FBO CLEARING ///////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////
+void ShaderPass::WaitPipelineBuild() {
+    ZoneScoped;
+    if (m_PipelineBuildFuture.valid()) {
+        auto res = m_PipelineBuildFuture.get();
+        DestroyPipelineStruct(res);
+    }
+}
 
-void ShaderPass::NeedToClearFBOThisFrame() {
+void ShaderPass::WaitBackgroundReCompil() {
     ZoneScoped;
-    m_ForceFBOClearing = true;
+    if (m_HotReloadFuture.valid()) {
+        auto res = m_HotReloadFuture.get();
+        DestroyPipelineStruct(res.m_Pipeline);
+    }
+    m_HotReloadNeededAgain = false;
 }
 
 /////////////////////////////////////////////////////////////////////
-//// RESIZING ///////////////////////////////////////////////////////
+//// SHADER VARIANTS ////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////
 
-bool ShaderPass::DrawResizeWidget() {
+bool ShaderPass::DeclareShaderKeyword(const std::string& vKeyword) {
     ZoneScoped;
-    bool resize = false;
+    if (vKeyword.empty()) {
+        return false;
+    }
+    if (std::find(m_ShaderKeywords.begin(), m_ShaderKeywords.end(), vKeyword) != m_ShaderKeywords.end()) {
+        return true;
+    }
+    if (m_ShaderKeywords.size() >= 64U) {
+        LogVarError("Cant declare the shader keyword %s, 64 keywords max by pass", vKeyword.c_str());
+        return false;
+    }
+    m_ShaderKeywords.push_back(vKeyword);
+    return true;
+}
+
+void ShaderPass::SetShaderKeyword(const std::string& vKeyword, const bool& vEnabled) {
+    ZoneScoped;
+    const auto key = GetShaderVariantKey({vKeyword});
+    if (!key) {
+        LogVarDebugWarning("Debug : the shader keyword %s is not declared", vKeyword.c_str());
+        return;
+    }
+    SetShaderVariant(vEnabled ? (m_WantedVariant | key) : (m_WantedVariant & ~key));
+}
+
+void ShaderPass::SetShaderVariant(const ShaderVariantKey& vVariant) {
+    ZoneScoped;
+    m_WantedVariant = vVariant;
+}
+
+ShaderPass::ShaderVariantKey ShaderPass::GetShaderVariantKey(const std::set<std::string>& vKeywords) const {
+    ZoneScoped;
+    ShaderVariantKey res = 0U;
+    for (size_t idx = 0U; idx < m_ShaderKeywords.size(); ++idx) {
+        if (vKeywords.find(m_ShaderKeywords[idx]) != vKeywords.end()) {
+            res |= (1ULL << idx);
+        }
+    }
+    return res;
+}
+
+ShaderPass::ShaderVariantKey ShaderPass::GetCurrentShaderVariant() const {
+    return m_CurrentVariant;
+}
+
+bool ShaderPass::IsShaderVariantWarm(const ShaderVariantKey& vVariant) const {
+    return (vVariant == m_CurrentVariant) || (m_ShaderVariants.find(vVariant) != m_ShaderVariants.end());
+}
+
+void ShaderPass::PrewarmShaderVariants(const std::vector<ShaderVariantKey>& vVariants) {
+    ZoneScoped;
+    if (!IsBackgroundCompilationPossible() || !GaiApi::VulkanCore::sVulkanShader) {
+        return;
+    }
+    for (const auto& variant : vVariants) {
+        if (!IsShaderVariantWarm(variant) && m_ShaderVariantJobs.find(variant) == m_ShaderVariantJobs.end()) {
+            m_ShaderVariantJobs[variant] = LaunchPipelineJob({}, variant);
+        }
+    }
+}
+
+// the enabled keywords are inserted as #define after the #version line
+std::string ShaderPass::ApplyShaderVariant(const std::string& vCode, const ShaderVariantKey& vVariant) const {
+    ZoneScoped;
+    if (!vVariant || vCode.empty()) {
+        return vCode;
+    }
+    std::string defines;
+    for (size_t idx = 0U; idx < m_ShaderKeywords.size(); ++idx) {
+        if (vVariant & (1ULL << idx)) {
+            defines += "#define " + m_ShaderKeywords[idx] + "\n";
+        }
+    }
+    size_t insertPos = 0U;
+    const size_t versionPos = vCode.find("#version");
+    if (versionPos != std::string::npos) {
+        const size_t eol = vCode.find('\n', versionPos);
+        insertPos = (eol == std::string::npos) ? vCode.size() : eol + 1U;
+    }
+    auto res = vCode;
+    res.insert(insertPos, defines);
+    return res;
+}
+
+// same defines as ApplyShaderVariant, the offline compiler must be called with -D "KEYWORD1;KEYWORD2" for this variant
+// the promoted blocks are in the options, so a rewritten code is never found in a bundle compiled without rewrite
+SpirvBundle::KeySource ShaderPass::GetBundleKeySource(const std::string& vCode, const ShaderVariantKey& vVariant, const vk::ShaderStageFlagBits& vShaderType) const {
+    ZoneScoped;
+    SpirvBundle::KeySource res;
+    res.source = vCode;
+    for (size_t idx = 0U; idx < m_ShaderKeywords.size(); ++idx) {
+        if (vVariant & (1ULL << idx)) {
+            res.defines += m_ShaderKeywords[idx] + ";";
+        }
+    }
+    for (const auto& block : m_PushConstantBlocks) {
+        if ((block.m_Stages & vShaderType) && vCode.find(block.m_BlockName) != std::string::npos) {
+            res.options += "push_constant:" + block.m_BlockName + "@" + std::to_string(block.m_Offset) + ";";
+        }
+    }
+    return res;
+}
+
+bool ShaderPass::IsBackgroundCompilationPossible() const {
+    return m_Loaded && (m_RendererType == GenericType::PIXEL || m_RendererType == GenericType::COMPUTE_2D || m_RendererType == GenericType::COMPUTE_3D);
+}
+
+// at frame boundary : a warm variant is swapped with the current one, a cold one is compiled
+void ShaderPass::UpdateShaderVariant() {
+    ZoneScoped;
+    CollectShaderVariantJobs();
+    if (m_WantedVariant == m_CurrentVariant || !m_IsShaderCompiled || !m_Pipelines[0].m_Pipeline) {
+        return;
+    }
+    if (m_HotReloadFuture.valid()) {
+        return;  // the current variant is rebuilded, the swap will be done after
+    }
+    auto it = m_ShaderVariants.find(m_WantedVariant);
+    if (it != m_ShaderVariants.end()) {
+        HotReloadStruct wanted = std::move(it->second);
+        m_ShaderVariants.erase(it);
+
+        // the variant can use bindings not in the current layout, the set layout is recreated before the swap
+        if (!PrepareLayoutForSwap(wanted)) {
+            LogVarError("The pipeline of the shader variant 0x%llx cant be built with his layout", (unsigned long long)m_WantedVariant);
+            m_WantedVariant = m_CurrentVariant;  // no retry at each frame
+            return;
+        }
+
+        // the current variant stay warm
+        HotReloadStruct current;
+        current.m_ShaderCodes = std::move(m_ShaderCodes);
+        current.m_UsedUniforms = std::move(m_UsedUniforms);
+        current.m_UsedBindings = std::move(m_UsedBindings);
+        current.m_SpecializationConstants = m_BuiltSpecializationConstants;
+        current.m_StaticStatesKey = m_BuiltStaticStatesKey;
+        current.m_Pipeline = m_Pipelines[0];
+        current.m_Variant = m_CurrentVariant;
+        current.m_Generation = m_VariantsGeneration;
+        current.m_Succeed = true;
+        m_ShaderVariants[m_CurrentVariant] = std::move(current);
+
+        m_ShaderCodes = std::move(wanted.m_ShaderCodes);
+        m_UsedUniforms = std::move(wanted.m_UsedUniforms);
+        m_UsedBindings = std::move(wanted.m_UsedBindings);
+        m_BuiltSpecializationConstants = wanted.m_SpecializationConstants;
+        m_BuiltStaticStatesKey = wanted.m_StaticStatesKey;
+        m_Pipelines[0] = wanted.m_Pipeline;
+        m_CurrentVariant = m_WantedVariant;
+        DestroySpecializedPipelines(true);  // built with the shaders of the other variant
+    } else if (m_ShaderVariantJobs.find(m_WantedVariant) == m_ShaderVariantJobs.end()) {
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), "shader variant 0x%llx", (unsigned long long)m_WantedVariant);
+        m_PipelineBuilder.AddPipelineManifestMiss(GetPipelineManifestKey(), buffer);
+        if (IsBackgroundCompilationPossible() && GaiApi::VulkanCore::sVulkanShader) {
+            m_ShaderVariantJobs[m_WantedVariant] = LaunchPipelineJob({}, m_WantedVariant);
+        } else {
+            ReCompilCode();
+            if (m_CurrentVariant != m_WantedVariant) {
+                LogVarError("The compilation of the shader variant 0x%llx failed", (unsigned long long)m_WantedVariant);
+                m_WantedVariant = m_CurrentVariant;  // no retry at each frame
+            }
+        }
+    }
+}
+
+void ShaderPass::CollectShaderVariantJobs() {
+    ZoneScoped;
+    auto it = m_ShaderVariantJobs.begin();
+    while (it != m_ShaderVariantJobs.end()) {
+        if (it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            auto res = it->second.get();
+            if (res.m_Succeed && res.m_Generation == m_VariantsGeneration && res.m_Variant != m_CurrentVariant) {
+                m_ShaderVariants[res.m_Variant] = std::move(res);
+            } else {
+                DestroyPipelineStruct(res.m_Pipeline);  // never used
+                if (!res.m_Succeed) {
+                    LogVarError("The compilation of the shader variant 0x%llx failed", (unsigned long long)res.m_Variant);
+                    if (m_WantedVariant == res.m_Variant) {
+                        m_WantedVariant = m_CurrentVariant;  // no retry at each frame
+                    }
+                }
+            }
+            it = m_ShaderVariantJobs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ShaderPass::WaitShaderVariantJobs() {
+    ZoneScoped;
+    for (auto& job : m_ShaderVariantJobs) {
+        auto res = job.second.get();
+        DestroyPipelineStruct(res.m_Pipeline);
+    }
+    m_ShaderVariantJobs.clear();
+}
+
+void ShaderPass::DestroyShaderVariants(const bool& vRetire) {
+    ZoneScoped;
+    ++m_VariantsGeneration;  // the running jobs are outdated
+    for (auto& variant : m_ShaderVariants) {
+        if (vRetire) {
+            m_PipelineBuilder.RetirePipeline(variant.second.m_Pipeline);
+        } else {
+            DestroyPipelineStruct(variant.second.m_Pipeline);
+        }
+    }
+    m_ShaderVariants.clear();
+}
+
+/////////////////////////////////////////////////////////////////////
+//// SPECIALIZATION CONSTANTS ///////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+void ShaderPass::SetSpecializationConstantValue(const uint32_t& vConstantId, const uint32_t& vValue) {
+    ZoneScoped;
+    m_SpecializationConstants[vConstantId] = vValue;
+}
+
+// switch m_Pipelines[0] to the variant of the wanted constants values
+// the current variant is kept in the cache of the builder, so a switch back is only a lookup
+void ShaderPass::UpdateSpecializedPipeline() {
+    ZoneScoped;
+    m_PipelineBuilder.CollectSpecializedPipelineJobs(
+        std::make_pair(m_BuiltStaticStatesKey, m_BuiltSpecializationConstants), m_CurrentVariant, m_VariantsGeneration);
+    const auto staticStatesKey = GetStaticStatesKey();
+    const bool statesBuiltOrFailed = (staticStatesKey == m_BuiltStaticStatesKey || staticStatesKey == m_FailedStaticStatesKey);
+    if ((m_SpecializationConstants == m_BuiltSpecializationConstants && statesBuiltOrFailed) || !m_IsShaderCompiled || !m_Pipelines[0].m_Pipeline) {
+        return;
+    }
+    if (!IsPixelRenderer() && !IsCompute2DRenderer() && !IsCompute3DRenderer()) {
+        return;
+    }
+    PipelineStruct pipeline;
+    const auto key = std::make_pair(staticStatesKey, m_SpecializationConstants);
+    bool built = m_PipelineBuilder.TakeSpecializedPipeline(key, m_CurrentVariant, m_VariantsGeneration, pipeline);
+    if (!built) {
+        m_PipelineBuilder.AddPipelineManifestMiss(GetPipelineManifestKey(), "specialization constants or states");
+        built = m_PipelineBuilder.BuildPipeline(IsPixelRenderer(), GetShaderSpirvs(m_ShaderCodes), CapturePipelineBuildStates(), pipeline, m_SpecializationConstants);
+    }
+    if (!built || !pipeline.m_Pipeline) {
+        DestroyPipelineStruct(pipeline);
+        LogVarError("Fail to build the pipeline variant for the new specialization constants or states, the previous one is kept");
+        m_SpecializationConstants = m_BuiltSpecializationConstants;
+        m_FailedStaticStatesKey = staticStatesKey;  // no retry at each frame
+        return;
+    }
+    m_PipelineBuilder.StoreSpecializedPipeline(std::make_pair(m_BuiltStaticStatesKey, m_BuiltSpecializationConstants), m_Pipelines[0]);
+    m_Pipelines[0] = pipeline;
+    m_BuiltSpecializationConstants = m_SpecializationConstants;
+    m_BuiltStaticStatesKey = staticStatesKey;
+}
+
+// the spirvs and the states are copied, like for StartPipelineBuild
+// the job is tagged with the current variant, so a result built with the shaders of another variant is ignored
+void ShaderPass::LaunchSpecializedPipelineJob(const SpecializationConstantsContainer& vConstants) {
+    ZoneScoped;
+    const auto key = std::make_pair(GetStaticStatesKey(), vConstants);
+    if (key.first == m_BuiltStaticStatesKey && vConstants == m_BuiltSpecializationConstants) {
+        return;
+    }
+    if (m_PipelineBuilder.IsSpecializedPipelineKnown(key)) {
+        return;
+    }
+    m_PipelineBuilder.LaunchSpecializedPipelineJob(
+        key, IsPixelRenderer(), GetShaderSpirvs(m_ShaderCodes), CapturePipelineBuildStates(), m_CurrentVariant, m_VariantsGeneration);
+}
+
+void ShaderPass::DestroySpecializedPipelines(const bool& vRetire) {
+    ZoneScoped;
+    m_PipelineBuilder.DestroySpecializedPipelines(vRetire);
+    m_FailedStaticStatesKey = UINT64_MAX;  // the new shaders can be built with these states
+}
+
+void ShaderPass::QueryComputeLimits() {
+    ZoneScoped;
+    if (m_MaxComputeWorkGroupSize.x == 0U) {
+        auto corePtr = m_VulkanCore.lock();
+        assert(corePtr != nullptr);
+        const auto& limits = corePtr->getPhysicalDevice().getProperties().limits;
+        m_MaxComputeWorkGroupSize =
+            ez::uvec3(limits.maxComputeWorkGroupSize[0], limits.maxComputeWorkGroupSize[1], limits.maxComputeWorkGroupSize[2]);
+        m_MaxComputeWorkGroupCount =
+            ez::uvec3(limits.maxComputeWorkGroupCount[0], limits.maxComputeWorkGroupCount[1], limits.maxComputeWorkGroupCount[2]);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+//// PIPELINE MANIFEST //////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+std::string ShaderPass::GetPipelineManifestKey() const {
+    ZoneScoped;
+    std::string res = m_RenderDocDebugName ? m_RenderDocDebugName : "";
+    for (const auto& stage : m_ShaderCodes) {
+        for (const auto& entryPoint : stage.second) {
+            for (const auto& code : entryPoint.second) {
+                if (!code.m_ShaderName.empty()) {
+                    res += ":" + code.m_ShaderName + "." + code.m_ShaderSuffix + "@" + code.m_EntryPoint;
+                }
+            }
+        }
+    }
+    return res;
+}
+
+// the variants and the specialization constants used by this pass during the previous session are prebuilt on worker threads
+// the static states are not in the manifest (only their hash is known), so the constants are prebuilt with the current states
+// the base pipeline is not needed, he can be still in build (see IsBasePipelineInManifest)
+void ShaderPass::PrewarmFromPipelineManifest() {
+    ZoneScoped;
+    if (m_PipelineManifestPrewarmed || !m_IsShaderCompiled || !IsBackgroundCompilationPossible()) {
+        return;
+    }
+    m_PipelineManifestPrewarmed = true;
+    PipelineManifest::PassEntry entry;
+    if (!m_PipelineBuilder.GetPipelineManifestEntry(GetPipelineManifestKey(), entry)) {
+        return;
+    }
+    std::vector<ShaderVariantKey> variants;
+    for (const auto& variant : entry.variants) {
+        if (m_ShaderKeywords.size() < 64U && (variant >> m_ShaderKeywords.size())) {
+            continue;  // a keyword not declared anymore
+        }
+        variants.push_back(variant);
+    }
+    PrewarmShaderVariants(variants);
+    for (const auto& constants : entry.constants) {
+        LaunchSpecializedPipelineJob(constants);
+    }
+}
+
+bool ShaderPass::IsBasePipelineInManifest() const {
+    ZoneScoped;
+    return m_PipelineBuilder.IsInPipelineManifest(GetPipelineManifestKey(), m_BuiltStaticStatesKey);
+}
+
+void ShaderPass::RecordInPipelineManifest() {
+    ZoneScoped;
+    if (!m_IsShaderCompiled || !m_Pipelines[0].m_Pipeline || !IsBackgroundCompilationPossible()) {
+        return;
+    }
+    m_PipelineBuilder.RecordInPipelineManifest(GetPipelineManifestKey(), m_CurrentVariant, m_BuiltSpecializationConstants, m_BuiltStaticStatesKey);
+}
+
+/////////////////////////////////////////////////////////////////////
+//// EXTENDED DYNAMIC STATES ////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+void ShaderPass::QueryDynamicStatesSupport() {
+    ZoneScoped;
+    if (!m_DynamicStatesSupport.m_Queried) {
+        auto corePtr = m_VulkanCore.lock();
+        assert(corePtr != nullptr);
+        auto devicePtr = corePtr->getFrameworkDevice().lock();
+        if (devicePtr) {
+            m_DynamicStatesSupport.m_CullMode = devicePtr->m_DynamicStates.extendedDynamicState;
+            m_DynamicStatesSupport.m_DepthTest = devicePtr->m_DynamicStates.extendedDynamicState;
+            m_DynamicStatesSupport.m_PatchControlPoints = devicePtr->m_DynamicStates2.extendedDynamicState2PatchControlPoints;
+            m_DynamicStatesSupport.m_PolygonMode = devicePtr->m_DynamicStates3.extendedDynamicState3PolygonMode;
+            m_DynamicStatesSupport.m_ColorBlendEnable = devicePtr->m_DynamicStates3.extendedDynamicState3ColorBlendEnable;
+        }
+        m_DynamicStatesSupport.m_Queried = true;
+    }
+}
+
+// the states dynamic on this device are not in the key, a change of them never need another pipeline
+uint64_t ShaderPass::GetStaticStatesKey() const {
+    ZoneScoped;
+    if (m_RendererType != GenericType::PIXEL) {
+        return 0U;
+    }
+    GaiApi::VulkanPipelineRegistry::Hasher hasher;
+    if (!m_DynamicStatesSupport.m_CullMode) {
+        hasher.add(m_CullMode).add(m_FrontFaceMode);
+    }
+    if (!m_DynamicStatesSupport.m_DepthTest) {
+        hasher.add(m_DepthTestEnabled && !m_BlendingEnabled).add(m_DepthWriteEnabled && !m_BlendingEnabled);
+    }
+    if (!m_DynamicStatesSupport.m_PatchControlPoints) {
+        hasher.add(m_PatchControlPoints);
+    }
+    if (!m_DynamicStatesSupport.m_PolygonMode) {
+        hasher.add(m_PolygonMode);
+    }
+    // when the color blend enable is dynamic, the blend factors are always set (see BuildPixelPipeline)
+    // and the blending effect on the depth states is already in the key above
+    if (!m_DynamicStatesSupport.m_ColorBlendEnable) {
+        hasher.add(m_BlendingEnabled);
+    }
+    return hasher.get();
+}
+
+void ShaderPass::SetDynamicStates(vk::CommandBuffer* vCmdBufferPtr) {
+    ZoneScoped;
+    if (m_DynamicStatesSupport.m_CullMode) {
+        vCmdBufferPtr->setCullModeEXT(m_CullMode);
+        vCmdBufferPtr->setFrontFaceEXT(m_FrontFaceMode);
+    }
+    if (m_DynamicStatesSupport.m_DepthTest) {
+        vCmdBufferPtr->setDepthTestEnableEXT(m_DepthTestEnabled && !m_BlendingEnabled);
+        vCmdBufferPtr->setDepthWriteEnableEXT(m_DepthWriteEnabled && !m_BlendingEnabled);
+    }
+    if (m_Tesselated && m_DynamicStatesSupport.m_PatchControlPoints) {
+        vCmdBufferPtr->setPatchControlPointsEXT(m_PatchControlPoints);
+    }
+    if (m_DynamicStatesSupport.m_PolygonMode) {
+        vCmdBufferPtr->setPolygonModeEXT(m_PolygonMode);
+    }
+    if (m_DynamicStatesSupport.m_ColorBlendEnable && m_CountColorBuffers) {
+        const std::vector<vk::Bool32> blendEnables(m_CountColorBuffers, m_BlendingEnabled ? VK_TRUE : VK_FALSE);
+        vCmdBufferPtr->setColorBlendEnableEXT(0U, blendEnables);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////
+//// SHADER CODE ////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+void ShaderPass::SetHeaderCode(const std::string& vHeaderCode) {
+    ZoneScoped;
+    m_HeaderCode = vHeaderCode;
+}
+
+void ShaderPass::SetVertexShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_VertexCode = vShaderCode;
+}
+
+void ShaderPass::SetFragmentShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_FragmentCode = vShaderCode;
+}
+
+void ShaderPass::SetGeometryShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_GeometryCode = vShaderCode;
+}
+
+void ShaderPass::SetTesselationEvaluationShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_TesselationEvaluationCode = vShaderCode;
+}
+
+void ShaderPass::SetTesselationControlShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_TesselationControlCode = vShaderCode;
+}
+
+void ShaderPass::SetComputeShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_ComputeCode = vShaderCode;
+}
+
+void ShaderPass::SetRayGenerationShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_RayGenerationCode = vShaderCode;
+}
+
+void ShaderPass::SetRayIntersectionShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_RayIntersectionCode = vShaderCode;
+}
+
+void ShaderPass::SetRayMissShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_RayMissCode = vShaderCode;
+}
+
+void ShaderPass::SetRayAnyHitShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_RayAnyHitCode = vShaderCode;
+}
+
+void ShaderPass::SetRayClosestHitShaderCode(const std::string& vShaderCode) {
+    ZoneScoped;
+    m_RayClosestHitCode = vShaderCode;
+}
+
+/////////////////////////////////////////////////////////////////////
+//// FBO CLEARING ///////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+void ShaderPass::NeedToClearFBOThisFrame() {
+    ZoneScoped;
+    m_ForceFBOClearing = true;
+}
+
+/////////////////////////////////////////////////////////////////////
+//// RESIZING ///////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////////////
+
+bool ShaderPass::DrawResizeWidget() {
+    ZoneScoped;
+    bool resize = false;
 
     if (ImGui::CollapsingHeader("Resizing")) {
         ImGui::Indent();
@@ -2167,38 +3187,179 @@ void ShaderPass::SetPushConstantRange(const vk::PushConstantRange& vPushConstant
     m_Internal_PushConstants = vPushConstantRange;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//// PRIVATE / PIPELINE ////////////////////////////////////////////////////////////////////////////////////
-////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-bool ShaderPass::CreateComputePipeline() {
+bool ShaderPass::PromoteUniformBlockToPushConstants(
+    const std::string& vBlockName, UniformBlockStd140* vUniformBlockPtr, const vk::ShaderStageFlags& vStages) {
     ZoneScoped;
-
-    if (m_ShaderCodes[vk::ShaderStageFlagBits::eCompute].empty())
+    if (vBlockName.empty() || vUniformBlockPtr == nullptr || !vStages) {
+        return false;
+    }
+    const auto blockSize = vUniformBlockPtr->GetDatasSize();
+    if (!blockSize || vUniformBlockPtr->IsUsingUniformArena()) {
         return false;
-    if (m_ShaderCodes[vk::ShaderStageFlagBits::eCompute]["main"][0].m_SPIRV.empty())
+    }
+    if (!m_MaxPushConstantsSize) {
+        auto corePtr = m_VulkanCore.lock();
+        assert(corePtr != nullptr);
+        m_MaxPushConstantsSize = corePtr->getPhysicalDevice().getProperties().limits.maxPushConstantsSize;
+    }
+    // glsl allow only one push_constant block by stage
+    if (m_Internal_PushConstants.size && (m_Internal_PushConstants.stageFlags & vStages)) {
+        return false;
+    }
+    // the block is placed after the internal range and the other blocks, so the ranges never overlap
+    uint32_t offset = m_Internal_PushConstants.size ? m_Internal_PushConstants.offset + m_Internal_PushConstants.size : 0U;
+    for (const auto& block : m_PushConstantBlocks) {
+        if (block.m_BlockName == vBlockName) {
+            continue;
+        }
+        if (block.m_Stages & vStages) {
+            return false;
+        }
+        offset = std::max(offset, block.m_Offset + (uint32_t)block.m_UniformBlockPtr->GetDatasSize());
+    }
+    offset = (offset + 15U) & ~15U;
+    if (offset + blockSize > m_MaxPushConstantsSize) {
         return false;
+    }
+    auto it = std::find_if(m_PushConstantBlocks.begin(), m_PushConstantBlocks.end(),  //
+        [&vBlockName](const PushConstantBlockStruct& vBlock) { return vBlock.m_BlockName == vBlockName; });
+    if (it == m_PushConstantBlocks.end()) {
+        it = m_PushConstantBlocks.insert(m_PushConstantBlocks.end(), PushConstantBlockStruct());
+    } else {
+        offset = it->m_Offset;  // the offset of a promoted block don't move, the compiled shaders use it
+    }
+    it->m_BlockName = vBlockName;
+    it->m_UniformBlockPtr = vUniformBlockPtr;
+    it->m_Stages = vStages;
+    it->m_Offset = offset;
+    vUniformBlockPtr->UsePushConstants();
+    LogVarDebugInfo("Debug : the uniform block %s of %u bytes is promoted to push constants at offset %u", vBlockName.c_str(), blockSize, offset);
+    return true;
+}
 
-    std::vector<vk::PushConstantRange> push_constants;
-    if (m_Internal_PushConstants.size) {
-        push_constants.push_back(m_Internal_PushConstants);
+void ShaderPass::AddPromotableUniformBlock(const std::string& vBlockName, UniformBlockStd140* vUniformBlockPtr, const vk::ShaderStageFlags& vStages) {
+    ZoneScoped;
+    if (vBlockName.empty() || vUniformBlockPtr == nullptr || !vStages) {
+        return;
+    }
+    auto it = std::find_if(m_PromotableUniformBlocks.begin(), m_PromotableUniformBlocks.end(),  //
+        [&vBlockName](const PushConstantBlockStruct& vBlock) { return vBlock.m_BlockName == vBlockName; });
+    if (it == m_PromotableUniformBlocks.end()) {
+        it = m_PromotableUniformBlocks.insert(m_PromotableUniformBlocks.end(), PushConstantBlockStruct());
     }
+    it->m_BlockName = vBlockName;
+    it->m_UniformBlockPtr = vUniformBlockPtr;
+    it->m_Stages = vStages;
+}
 
-    m_Pipelines[0].m_PipelineLayout = m_Device.createPipelineLayout(vk::PipelineLayoutCreateInfo(
-        vk::PipelineLayoutCreateFlags(), 1, &m_DescriptorSets[0].m_DescriptorSetLayout, (uint32_t)push_constants.size(), push_constants.data()));
+// the blocks are tried in the order of their registering, the first one who fit take the stages
+void ShaderPass::PromoteUniformBlocksIfPossible() {
+    ZoneScoped;
+    for (const auto& block : m_PromotableUniformBlocks) {
+        const auto it = std::find_if(m_PushConstantBlocks.begin(), m_PushConstantBlocks.end(),  //
+            [&block](const PushConstantBlockStruct& vBlock) { return vBlock.m_BlockName == block.m_BlockName; });
+        if (it == m_PushConstantBlocks.end()) {
+            PromoteUniformBlockToPushConstants(block.m_BlockName, block.m_UniformBlockPtr, block.m_Stages);
+        }
+    }
+}
+
+void ShaderPass::ClearPromotedUniformBlocks() {
+    ZoneScoped;
+    m_PushConstantBlocks.clear();
+}
 
-    auto cs = GaiApi::VulkanCore::sVulkanShader->CreateShaderModule(
-        (VkDevice)m_Device, m_ShaderCodes[vk::ShaderStageFlagBits::eCompute]["main"][0].m_SPIRV);
+void ShaderPass::PushPromotedUniformBlocks(vk::CommandBuffer* vCmdBufferPtr) {
+    ZoneScoped;
+    if (vCmdBufferPtr && m_Pipelines[0].m_PipelineLayout) {
+        for (const auto& block : m_PushConstantBlocks) {
+            if (block.m_UniformBlockPtr && block.m_UniformBlockPtr->GetDatasSize() && IsBlockUsed(block.m_BlockName)) {
+                vCmdBufferPtr->pushConstants(m_Pipelines[0].m_PipelineLayout, block.m_Stages, block.m_Offset,
+                    block.m_UniformBlockPtr->GetDatasSize(), block.m_UniformBlockPtr->GetDatas());
+            }
+        }
+    }
+}
 
-    m_ShaderCreateInfos = {vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eCompute, cs, "main")};
+std::vector<vk::PushConstantRange> ShaderPass::GetPushConstantRanges() const {
+    ZoneScoped;
+    std::vector<vk::PushConstantRange> res;
+    if (m_Internal_PushConstants.size) {
+        res.push_back(m_Internal_PushConstants);
+    }
+    for (const auto& block : m_PushConstantBlocks) {
+        if (block.m_UniformBlockPtr && block.m_UniformBlockPtr->GetDatasSize()) {
+            res.push_back(vk::PushConstantRange(block.m_Stages, block.m_Offset, block.m_UniformBlockPtr->GetDatasSize()));
+        }
+    }
+    return res;
+}
+
+// layout(std140, binding = 1) uniform UBO_Frag { float a; => layout(std140, push_constant) uniform UBO_Frag { layout(offset = 16) float a;
+// the std140 packing is kept since the datas are packed by UniformBlockStd140, the next members follow the first one
+std::string ShaderPass::RewritePromotedUniformBlocks(const std::string& vCode, const vk::ShaderStageFlagBits& vShaderType) const {
+    ZoneScoped;
+    std::string res = vCode;
+    for (const auto& block : m_PushConstantBlocks) {
+        if (!(block.m_Stages & vShaderType) || res.find(block.m_BlockName) == std::string::npos) {
+            continue;
+        }
+        const std::regex block_regex("layout\\s*\\(([^)]*)\\)\\s*uniform\\s+" + block.m_BlockName + "\\b");
+        std::smatch match;
+        if (std::regex_search(res, match, block_regex)) {
+            std::string qualifiers = "std140, push_constant";
+            std::stringstream ss(match[1].str());
+            std::string qualifier;
+            while (std::getline(ss, qualifier, ',')) {
+                qualifier.erase(0, qualifier.find_first_not_of(" \t\r\n"));
+                qualifier.erase(qualifier.find_last_not_of(" \t\r\n") + 1U);
+                if (qualifier.empty() || qualifier == "std140" || qualifier == "std430" ||  //
+                    qualifier.find("binding") == 0U || qualifier.find("set") == 0U) {
+                    continue;
+                }
+                qualifiers += ", " + qualifier;
+            }
+            std::string body = match.suffix().str();
+            if (block.m_Offset) {
+                const size_t bracePos = body.find('{');
+                const size_t memberPos = (bracePos == std::string::npos) ? std::string::npos : body.find_first_not_of(" \t\r\n", bracePos + 1U);
+                if (memberPos == std::string::npos) {
+                    LogVarDebugWarning("Debug : the first member of the promoted uniform block %s was not found", block.m_BlockName.c_str());
+                    continue;
+                }
+                body.insert(memberPos, "layout(offset = " + std::to_string(block.m_Offset) + ") ");
+            }
+            res = match.prefix().str() + "layout(" + qualifiers + ") uniform " + block.m_BlockName + body;
+        } else {
+            LogVarDebugWarning("Debug : the promoted uniform block %s was not found in the shader code", block.m_BlockName.c_str());
+        }
+    }
+    return res;
+}
 
-    vk::ComputePipelineCreateInfo computePipeInfo =
-        vk::ComputePipelineCreateInfo().setStage(m_ShaderCreateInfos[0]).setLayout(m_Pipelines[0].m_PipelineLayout);
-    m_Pipelines[0].m_Pipeline = m_Device.createComputePipeline(nullptr, computePipeInfo).value;
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE / PIPELINE ////////////////////////////////////////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-    GaiApi::VulkanCore::sVulkanShader->DestroyShaderModule((VkDevice)m_Device, cs);
+bool ShaderPass::CreateComputePipeline() {
+    ZoneScoped;
+    m_BuiltSpecializationConstants = m_SpecializationConstants;
+    m_BuiltStaticStatesKey = GetStaticStatesKey();
+    m_CurrentVariant = m_WantedVariant;
+    // at the first build, a base pipeline known by the manifest is prewarmed on a worker thread like his variants
+    if (m_AsyncPipelineCreation || (!m_PipelineManifestPrewarmed && IsBasePipelineInManifest())) {
+        return StartPipelineBuild(false);
+    }
+    return BuildComputePipeline(m_ShaderCodes, CapturePipelineBuildStates(), m_Pipelines[0], m_SpecializationConstants);
+}
 
-    return true;
+// can be called from a worker thread, for the background hot reload
+bool ShaderPass::BuildComputePipeline(const ShaderCodesContainer& vShaderCodes,
+    const PipelineBuildStatesStruct& vStates,
+    PipelineStruct& vOutPipeline,
+    const SpecializationConstantsContainer& vConstants) {
+    ZoneScoped;
+    return m_PipelineBuilder.BuildComputePipeline(GetShaderSpirvs(vShaderCodes), vStates, vOutPipeline, vConstants);
 }
 
 void ShaderPass::SetInputStateBeforePipelineCreation() {
@@ -2216,184 +3377,179 @@ void ShaderPass::SetInputStateBeforePipelineCreation() {
 
 bool ShaderPass::CreatePixelPipeline() {
     ZoneScoped;
-
-    if (!m_RenderPassPtr)
-        return false;
-    if (m_ShaderCodes[vk::ShaderStageFlagBits::eVertex]["main"].empty())
-        return false;
-    if (m_ShaderCodes[vk::ShaderStageFlagBits::eVertex]["main"][0].m_SPIRV.empty())
-        return false;
-    if (m_ShaderCodes[vk::ShaderStageFlagBits::eFragment]["main"].empty())
-        return false;
-    if (m_ShaderCodes[vk::ShaderStageFlagBits::eFragment]["main"][0].m_SPIRV.empty())
-        return false;
-
-    if (m_Tesselated) {
-        if (m_ShaderCodes[vk::ShaderStageFlagBits::eTessellationControl]["main"].empty())
-            return false;
-        if (m_ShaderCodes[vk::ShaderStageFlagBits::eTessellationControl]["main"][0].m_SPIRV.empty())
-            return false;
-        if (m_ShaderCodes[vk::ShaderStageFlagBits::eTessellationEvaluation]["main"].empty())
-            return false;
-        if (m_ShaderCodes[vk::ShaderStageFlagBits::eTessellationEvaluation]["main"][0].m_SPIRV.empty())
-            return false;
-    }
-
-    std::vector<vk::PushConstantRange> push_constants;
-    if (m_Internal_PushConstants.size) {
-        push_constants.push_back(m_Internal_PushConstants);
+    QueryDynamicStatesSupport();
+    m_BuiltSpecializationConstants = m_SpecializationConstants;
+    m_BuiltStaticStatesKey = GetStaticStatesKey();
+    m_CurrentVariant = m_WantedVariant;
+    // at the first build, a base pipeline known by the manifest is prewarmed on a worker thread like his variants
+    if (m_AsyncPipelineCreation || (!m_PipelineManifestPrewarmed && IsBasePipelineInManifest())) {
+        return StartPipelineBuild(true);
     }
+    return BuildPixelPipeline(m_ShaderCodes, CapturePipelineBuildStates(), m_Pipelines[0], m_SpecializationConstants);
+}
 
-    m_Pipelines[0].m_PipelineLayout = m_Device.createPipelineLayout(vk::PipelineLayoutCreateInfo(
-        vk::PipelineLayoutCreateFlags(), 1, &m_DescriptorSets[0].m_DescriptorSetLayout, (uint32_t)push_constants.size(), push_constants.data()));
-
-    auto vs =
-        GaiApi::VulkanCore::sVulkanShader->CreateShaderModule((VkDevice)m_Device, m_ShaderCodes[vk::ShaderStageFlagBits::eVertex]["main"][0].m_SPIRV);
-    auto fs = GaiApi::VulkanCore::sVulkanShader->CreateShaderModule(
-        (VkDevice)m_Device, m_ShaderCodes[vk::ShaderStageFlagBits::eFragment]["main"][0].m_SPIRV);
-    m_ShaderCreateInfos = {vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eVertex, vs, "main"),
-        vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eFragment, fs, "main")};
+// the fix functions, the renderpass and the layout inputs are copied here, so the builds on the worker threads
+// use the states of the launch even if the render thread change them during the build
+ShaderPass::PipelineBuildStatesStruct ShaderPass::CapturePipelineBuildStates() {
+    ZoneScoped;
+    PipelineBuildStatesStruct res;
 
-    vk::ShaderModule tc, te;
-    if (m_Tesselated) {
-        tc = GaiApi::VulkanCore::sVulkanShader->CreateShaderModule(
-            (VkDevice)m_Device, m_ShaderCodes[vk::ShaderStageFlagBits::eTessellationControl]["main"][0].m_SPIRV);
-        te = GaiApi::VulkanCore::sVulkanShader->CreateShaderModule(
-            (VkDevice)m_Device, m_ShaderCodes[vk::ShaderStageFlagBits::eTessellationEvaluation]["main"][0].m_SPIRV);
-        m_ShaderCreateInfos.push_back(
-            vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eTessellationControl, tc, "main"));
-        m_ShaderCreateInfos.push_back(
-            vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eTessellationEvaluation, te, "main"));
-    }
+    res.m_DescriptorSetLayout = m_DescriptorSets[0].m_DescriptorSetLayout;
+    res.m_IsLayoutReflected = m_DescriptorSets[0].m_IsReflected;
+    res.m_LayoutBindings = m_DescriptorSets[0].m_LayoutBindings;
+    res.m_PushConstants = GetPushConstantRanges();
+    res.m_PipelineLayoutKey = GetPipelineLayoutKey(res.m_PushConstants);
 
     // setup fix functions
     if (m_Tesselated) {
         m_BasePrimitiveTopology = vk::PrimitiveTopology::ePatchList;
     }
-
-    auto assemblyState = vk::PipelineInputAssemblyStateCreateInfo(vk::PipelineInputAssemblyStateCreateFlags(), m_BasePrimitiveTopology);
-
-    vk::PipelineTessellationStateCreateInfo* tesselationStatePtr = nullptr;
-    auto tesselationState = vk::PipelineTessellationStateCreateInfo(vk::PipelineTessellationStateCreateFlags(), m_PatchControlPoints);
-    if (m_Tesselated) {
-        tesselationStatePtr = &tesselationState;
+    SetInputStateBeforePipelineCreation();
+    const auto& inputState = m_InputState.state;
+    if (inputState.pVertexBindingDescriptions) {
+        res.m_VertexBindings.assign(
+            inputState.pVertexBindingDescriptions, inputState.pVertexBindingDescriptions + inputState.vertexBindingDescriptionCount);
+    }
+    if (inputState.pVertexAttributeDescriptions) {
+        res.m_VertexAttributes.assign(
+            inputState.pVertexAttributeDescriptions, inputState.pVertexAttributeDescriptions + inputState.vertexAttributeDescriptionCount);
     }
 
-    auto viewportState = vk::PipelineViewportStateCreateInfo(vk::PipelineViewportStateCreateFlags(), 1, &m_Viewport, 1, &m_RenderArea);
+    if (m_RenderPassPtr) {
+        res.m_RenderPass = *m_RenderPassPtr;
+    }
+    res.m_RenderPassKey = GetRenderPassCompatibilityKey();
+    const auto* renderingInfoPtr = GetPipelineRenderingCreateInfo();
+    if (renderingInfoPtr) {
+        res.m_UseRenderingInfo = true;
+        res.m_RenderingInfo = *renderingInfoPtr;
+        res.m_RenderingInfo.pNext = nullptr;
+        if (renderingInfoPtr->pColorAttachmentFormats) {
+            res.m_ColorAttachmentFormats.assign(
+                renderingInfoPtr->pColorAttachmentFormats, renderingInfoPtr->pColorAttachmentFormats + renderingInfoPtr->colorAttachmentCount);
+        }
+    }
 
-    auto rasterState = vk::PipelineRasterizationStateCreateInfo(vk::PipelineRasterizationStateCreateFlags(), VK_FALSE, VK_FALSE, m_PolygonMode,
-        m_CullMode, m_FrontFaceMode, VK_FALSE, 0, 0, 0, m_LineWidth.w);
+    res.m_StaticStatesKey = GetStaticStatesKey();
+    res.m_DynamicStatesSupport = m_DynamicStatesSupport;
+    res.m_UseGraphicsPipelineLibrary = m_UseGraphicsPipelineLibrary;
+    res.m_Tesselated = m_Tesselated;
+    res.m_PrimitiveTopology = m_BasePrimitiveTopology;
+    res.m_CanDynamicallyChangePrimitiveTopology = m_CanDynamicallyChangePrimitiveTopology;
+    res.m_PatchControlPoints = m_PatchControlPoints;
+    res.m_Viewport = m_Viewport;
+    res.m_RenderArea = m_RenderArea;
+    res.m_SampleCount = m_SampleCount;
+    res.m_CountColorBuffers = m_CountColorBuffers;
+    res.m_LineWidth = m_LineWidth.w;
+    res.m_PolygonMode = m_PolygonMode;
+    res.m_CullMode = m_CullMode;
+    res.m_FrontFaceMode = m_FrontFaceMode;
+    res.m_BlendingEnabled = m_BlendingEnabled;
+    res.m_DepthTestEnabled = m_DepthTestEnabled;
+    res.m_DepthWriteEnabled = m_DepthWriteEnabled;
 
-    auto multisampleState = vk::PipelineMultisampleStateCreateInfo(vk::PipelineMultisampleStateCreateFlags());
-    multisampleState.rasterizationSamples = m_SampleCount;
-    // multisampleState.sampleShadingEnable = VK_TRUE;
-    // multisampleState.minSampleShading = 0.2f;
+    return res;
+}
 
-    m_BlendAttachmentStates.clear();
-    vk::PipelineDepthStencilStateCreateInfo depthStencilState;
-    vk::PipelineColorBlendStateCreateInfo colorBlendState;
-    if (m_BlendingEnabled) {
-        for (uint32_t i = 0; i < m_CountColorBuffers; ++i) {
-            m_BlendAttachmentStates.emplace_back(VK_TRUE, vk::BlendFactor::eOne, vk::BlendFactor::eOne, vk::BlendOp::eAdd, vk::BlendFactor::eSrcAlpha,
-                vk::BlendFactor::eDstAlpha, vk::BlendOp::eAdd,
-                vk::ColorComponentFlags(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB |
-                                        vk::ColorComponentFlagBits::eA));
-        }
+// can be called from a worker thread, for the background hot reload
+bool ShaderPass::BuildPixelPipeline(const ShaderCodesContainer& vShaderCodes,
+    const PipelineBuildStatesStruct& vStates,
+    PipelineStruct& vOutPipeline,
+    const SpecializationConstantsContainer& vConstants) {
+    ZoneScoped;
+    return m_PipelineBuilder.BuildPixelPipeline(GetShaderSpirvs(vShaderCodes), vStates, vOutPipeline, vConstants);
+}
 
-        colorBlendState = vk::PipelineColorBlendStateCreateInfo(vk::PipelineColorBlendStateCreateFlags(), VK_FALSE, vk::LogicOp::eCopy,
-            static_cast<uint32_t>(m_BlendAttachmentStates.size()), m_BlendAttachmentStates.data());
+bool ShaderPass::CreateRtxPipeline() {
+    ZoneScoped;
+    EZ_TOOLS_DEBUG_BREAK;
 
-        depthStencilState =
-            vk::PipelineDepthStencilStateCreateInfo(vk::PipelineDepthStencilStateCreateFlags(), VK_FALSE, VK_FALSE, vk::CompareOp::eAlways);
-    }
+    return false;
+}
 
-    else {
-        for (uint32_t i = 0; i < m_CountColorBuffers; ++i) {
-            m_BlendAttachmentStates.emplace_back(VK_FALSE, vk::BlendFactor::eOne, vk::BlendFactor::eZero, vk::BlendOp::eAdd, vk::BlendFactor::eOne,
-                vk::BlendFactor::eZero, vk::BlendOp::eAdd,
-                vk::ColorComponentFlags(vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG | vk::ColorComponentFlagBits::eB |
-                                        vk::ColorComponentFlagBits::eA));
-        }
+void ShaderPass::DestroyPipeline() {
+    ZoneScoped;
 
-        colorBlendState = vk::PipelineColorBlendStateCreateInfo(vk::PipelineColorBlendStateCreateFlags(), VK_FALSE, vk::LogicOp::eClear,
-            static_cast<uint32_t>(m_BlendAttachmentStates.size()), m_BlendAttachmentStates.data());
+    WaitPipelineBuild();
+    WaitBackgroundReCompil();
+    WaitShaderVariantJobs();
+    DestroyShaderVariants(false);
 
-        depthStencilState = vk::PipelineDepthStencilStateCreateInfo(vk::PipelineDepthStencilStateCreateFlags(), VK_TRUE, VK_TRUE,
-            vk::CompareOp::eLessOrEqual, VK_FALSE, VK_FALSE, vk::StencilOpState(), vk::StencilOpState(), 0.0f, 0.0f);
+    for (auto& pip : m_Pipelines) {
+        DestroyPipelineStruct(pip);
     }
+    m_PipelineBuilder.Unit();  // the specialized and retired pipelines, and the links started by the workers
+    m_FailedStaticStatesKey = UINT64_MAX;
+}
 
-    auto dynamicStateList = std::vector<vk::DynamicState>{
-        vk::DynamicState::eViewport, vk::DynamicState::eScissor, vk::DynamicState::eLineWidth
-        //,vk::DynamicState::eCullMode
-        //,vk::DynamicState::eFrontFace
-    };
+void ShaderPass::DestroyPipelineStruct(PipelineStruct& vPipeline) {
+    ZoneScoped;
+    m_PipelineBuilder.DestroyPipelineStruct(vPipeline);
+}
 
-    if (!m_Tesselated &&  // tesselated so no other topology than patch_list can be used
-        m_CanDynamicallyChangePrimitiveTopology) {
-        dynamicStateList.push_back(vk::DynamicState::ePrimitiveTopologyEXT);
+// the spirv of the main entry point of the used stages, copied since the builds can be done on the worker threads
+VulkanPipelineBuilder::ShaderSpirvsContainer ShaderPass::GetShaderSpirvs(const ShaderCodesContainer& vShaderCodes) {
+    ZoneScoped;
+    VulkanPipelineBuilder::ShaderSpirvsContainer res;
+    for (const auto& stage : vShaderCodes) {
+        auto itEntry = stage.second.find("main");
+        if (itEntry != stage.second.end() && !itEntry->second.empty() && itEntry->second[0].m_Used && !itEntry->second[0].m_SPIRV.empty()) {
+            res[stage.first] = itEntry->second[0].m_SPIRV;
+        }
     }
+    return res;
+}
 
-    auto dynamicState = vk::PipelineDynamicStateCreateInfo(
-        vk::PipelineDynamicStateCreateFlags(), static_cast<uint32_t>(dynamicStateList.size()), dynamicStateList.data());
-
-    SetInputStateBeforePipelineCreation();
-
-    m_Pipelines[0].                                                                  //
-        m_Pipeline = m_Device                                                        //
-                         .createGraphicsPipeline(                                    //
-                             m_PipelineCache,                                        //
-                             vk::GraphicsPipelineCreateInfo(                         //
-                                 vk::PipelineCreateFlags(),                          //
-                                 static_cast<uint32_t>(m_ShaderCreateInfos.size()),  //
-                                 m_ShaderCreateInfos.data(),                         //
-                                 &m_InputState.state,                                //
-                                 &assemblyState,                                     //
-                                 tesselationStatePtr,                                //
-                                 &viewportState,                                     //
-                                 &rasterState,                                       //
-                                 &multisampleState,                                  //
-                                 &depthStencilState,                                 //
-                                 &colorBlendState,                                   //
-                                 &dynamicState,                                      //
-                                 m_Pipelines[0].m_PipelineLayout,                    //
-                                 *m_RenderPassPtr,                                   //
-                                 0                                                   //
-                                 )                                                   //
-                             )                                                       //
-                         .value;
-
-    GaiApi::VulkanCore::sVulkanShader->DestroyShaderModule((VkDevice)m_Device, vs);
-    GaiApi::VulkanCore::sVulkanShader->DestroyShaderModule((VkDevice)m_Device, fs);
-
-    if (m_Tesselated) {
-        GaiApi::VulkanCore::sVulkanShader->DestroyShaderModule((VkDevice)m_Device, tc);
-        GaiApi::VulkanCore::sVulkanShader->DestroyShaderModule((VkDevice)m_Device, te);
+// the layouts with the same set layout bindings and the same push constants are compatibles, so shared
+uint64_t ShaderPass::GetPipelineLayoutKey(const std::vector<vk::PushConstantRange>& vPushConstants) const {
+    ZoneScoped;
+    GaiApi::VulkanPipelineRegistry::Hasher hasher;
+    hasher.add(m_DescriptorSets[0].m_LayoutBindings.size());
+    for (const auto& binding : m_DescriptorSets[0].m_LayoutBindings) {
+        hasher.add(binding.binding).add(binding.descriptorType).add(binding.descriptorCount).add(binding.stageFlags);
+        for (uint32_t idx = 0U; binding.pImmutableSamplers && idx < binding.descriptorCount; ++idx) {
+            hasher.add((uint64_t)(VkSampler)binding.pImmutableSamplers[idx]);
+        }
     }
-
-    return true;
+    hasher.add(vPushConstants.size());
+    for (const auto& range : vPushConstants) {
+        hasher.add(range.stageFlags).add(range.offset).add(range.size);
+    }
+    return hasher.get();
 }
 
-bool ShaderPass::CreateRtxPipeline() {
+// only the renderpass created by the framebuffer of the pass has a known description
+uint64_t ShaderPass::GetRenderPassCompatibilityKey() const {
     ZoneScoped;
-    EZ_TOOLS_DEBUG_BREAK;
-
-    return false;
+    if (m_FrameBufferPtr && m_RenderPassPtr == m_FrameBufferPtr->GetRenderPass()) {
+        return m_FrameBufferPtr->GetRenderPassCompatibilityKey();
+    }
+    return 0U;
 }
 
-void ShaderPass::DestroyPipeline() {
+const vk::PipelineRenderingCreateInfoKHR* ShaderPass::GetPipelineRenderingCreateInfo() const {
     ZoneScoped;
+    if (m_FrameBufferPtr && m_RenderPassPtr == m_FrameBufferPtr->GetRenderPass()) {
+        return m_FrameBufferPtr->GetPipelineRenderingCreateInfo();
+    }
+    return nullptr;
+}
 
+// the pipelines of the pass who can be replaced by their optimized link, the specialized ones are found by m_PipelineBuilder
+ShaderPass::PipelineStruct* ShaderPass::FindPipelineStruct(const vk::Pipeline& vPipeline) {
+    ZoneScoped;
     for (auto& pip : m_Pipelines) {
-        if (pip.m_Pipeline)
-            m_Device.destroyPipeline(pip.m_Pipeline);
-        pip.m_Pipeline = vk::Pipeline{};
-        if (pip.m_PipelineLayout)
-            m_Device.destroyPipelineLayout(pip.m_PipelineLayout);
-        pip.m_PipelineLayout = vk::PipelineLayout{};
-    }
-    if (m_PipelineCache)
-        m_Device.destroyPipelineCache(m_PipelineCache);
-    m_PipelineCache = vk::PipelineCache{};
+        if (pip.m_Pipeline == vPipeline) {
+            return &pip;
+        }
+    }
+    for (auto& variant : m_ShaderVariants) {
+        if (variant.second.m_Pipeline.m_Pipeline == vPipeline) {
+            return &variant.second.m_Pipeline;
+        }
+    }
+    return nullptr;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
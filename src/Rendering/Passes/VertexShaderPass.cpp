@@ -47,8 +47,7 @@ void VertexShaderPass::DrawModel(vk::CommandBuffer* vCmdBufferPtr, const int& /*
         vCmdBufferPtr->setLineWidth(m_LineWidth.w);
         // vCmdBufferPtr->setPrimitiveTopologyEXT(m_BasePrimitiveTopology);
         vCmdBufferPtr->bindPipeline(vk::PipelineBindPoint::eGraphics, m_Pipelines[0].m_Pipeline);
-        vCmdBufferPtr->bindDescriptorSets(
-            vk::PipelineBindPoint::eGraphics, m_Pipelines[0].m_PipelineLayout, 0, m_DescriptorSets[0].m_DescriptorSet, nullptr);
+        BindDescriptorSet(vCmdBufferPtr, vk::PipelineBindPoint::eGraphics);
         vCmdBufferPtr->draw(m_CountVertexs.w, m_CountInstances.w, 0, 0);
     }
 }
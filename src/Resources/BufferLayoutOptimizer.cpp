@@ -0,0 +1,276 @@
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Resources/BufferLayoutOptimizer.h>
+
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <algorithm>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+uint32_t BufferLayoutOptimizer::GetBaseAlignement(uint32_t vSize) {
+    ZoneScoped;
+    uint32_t goodAlign = (uint32_t)std::pow(2, std::ceil(log(vSize) / log(2)));
+    return std::min(goodAlign, 16u);
+}
+
+std::string BufferLayoutOptimizer::GetGlslTypeFromSize(uint32_t vSize) {
+    ZoneScoped;
+    switch (vSize) {
+        case 4U: return "float";
+        case 8U: return "vec2";
+        case 12U: return "vec3";
+        case 16U: return "vec4";
+        case 64U: return "mat4";
+        default: break;
+    }
+    return {};
+}
+
+bool BufferLayoutOptimizer::GetMatrixSize(const std::string& vGlslType, uint32_t& vOutColumns, uint32_t& vOutRows, uint32_t& vOutScalarSize) {
+    size_t pos = 0U;
+    vOutScalarSize = 4U;
+    if (vGlslType.compare(0U, 1U, "d") == 0) {
+        vOutScalarSize = 8U;
+        pos = 1U;
+    }
+    if (vGlslType.compare(pos, 3U, "mat") != 0 || vGlslType.size() < pos + 4U) {
+        return false;
+    }
+    pos += 3U;
+    vOutColumns = (uint32_t)(vGlslType[pos] - '0');
+    vOutRows = vOutColumns;
+    if (vGlslType.size() == pos + 3U && vGlslType[pos + 1U] == 'x') {
+        vOutRows = (uint32_t)(vGlslType[pos + 2U] - '0');
+    } else if (vGlslType.size() != pos + 1U) {
+        return false;
+    }
+    return vOutColumns >= 2U && vOutColumns <= 4U && vOutRows >= 2U && vOutRows <= 4U;
+}
+
+BufferLayoutOptimizer::BufferLayoutOptimizer(LayoutStandard vStandard) : standard(vStandard) {
+}
+
+void BufferLayoutOptimizer::Clear() {
+    ZoneScoped;
+    members.clear();
+    chunkedMembers.clear();
+    declarationOrderSize = 0U;
+    optimizedSize = 0U;
+}
+
+bool BufferLayoutOptimizer::IsEmpty() const {
+    return members.empty();
+}
+
+bool BufferLayoutOptimizer::AddMember(const std::string& vKey, const char* vGlslType, const void* vValue, uint32_t vSizeInBytes, uint32_t vElementSize) {
+    ZoneScoped;
+    if (vKey.empty() || !vSizeInBytes) {
+        return false;
+    }
+    for (const auto& member : members) {
+        if (member.key == vKey) {
+            return false;
+        }
+    }
+    Member member;
+    member.key = vKey;
+    uint32_t elementSize = vSizeInBytes;
+    if (vElementSize && vElementSize < vSizeInBytes && !(vSizeInBytes % vElementSize)) {
+        member.arrayCount = vSizeInBytes / vElementSize;
+        elementSize = vElementSize;
+    }
+    member.glslType = vGlslType ? vGlslType : GetGlslTypeFromSize(elementSize);
+
+    // layout of one element, the columns of a matrix are placed like an array of vectors
+    uint32_t elementAlign = GetBaseAlignement(elementSize);
+    uint32_t elementLayoutSize = elementSize;
+    uint32_t columns = 0U, rows = 0U, scalarSize = 0U;
+    if (GetMatrixSize(member.glslType, columns, rows, scalarSize) && elementSize == columns * rows * scalarSize) {
+        const uint32_t columnSize = rows * scalarSize;
+        uint32_t columnStride = AlignOffset(columnSize, GetBaseAlignement(columnSize));
+        if (standard == LayoutStandard::STD140) {
+            columnStride = AlignOffset(columnStride, 16U);
+        }
+        member.chunkSize = columnSize;
+        member.chunkStride = columnStride;
+        elementAlign = std::min(columnStride, 16U);
+        elementLayoutSize = columnStride * columns;
+    }
+
+    if (member.arrayCount) {
+        uint32_t stride = AlignOffset(elementLayoutSize, elementAlign);
+        if (standard == LayoutStandard::STD140) {
+            stride = AlignOffset(stride, 16U);
+            elementAlign = 16U;
+        }
+        if (!member.chunkStride) {  // the columns of an array of matrices stay the chunks
+            member.chunkSize = elementSize;
+            member.chunkStride = stride;
+        }
+        member.size = stride * member.arrayCount;
+    } else {
+        member.size = elementLayoutSize;
+    }
+    member.align = elementAlign;
+
+    // the cpu datas already on the stride are copied as is
+    if (member.chunkSize == member.chunkStride || member.size == vSizeInBytes) {
+        member.chunkSize = 0U;
+        member.chunkStride = 0U;
+    }
+
+    member.value.resize(member.size);
+    if (vValue) {
+        if (member.chunkStride) {
+            const uint32_t count = std::min(vSizeInBytes / member.chunkSize, member.size / member.chunkStride);
+            CopyChunks((const uint8_t*)vValue, member.chunkSize, member.value.data(), member.chunkStride, member.chunkSize, count);
+        } else {
+            memcpy(member.value.data(), vValue, std::min(vSizeInBytes, member.size));
+        }
+    }
+    members.push_back(member);
+    return true;
+}
+
+std::vector<BufferLayoutOptimizer::Member> BufferLayoutOptimizer::Optimize(uint32_t vStartOffset, bool vReorder) {
+    ZoneScoped;
+    // size in registering order
+    uint32_t cursor = vStartOffset;
+    for (const auto& member : members) {
+        cursor = AlignOffset(cursor, member.align) + member.size;
+    }
+    declarationOrderSize = cursor - vStartOffset;
+
+    chunkedMembers.clear();
+    for (size_t idx = 0U; idx < members.size(); ++idx) {
+        if (members[idx].chunkStride) {
+            chunkedMembers[members[idx].key] = idx;
+        }
+    }
+
+    std::vector<Member> res;
+    if (!vReorder) {
+        res = members;
+        cursor = vStartOffset;
+        for (auto& member : res) {
+            member.offset = AlignOffset(cursor, member.align);
+            cursor = member.offset + member.size;
+        }
+        optimizedSize = declarationOrderSize;
+        return res;
+    }
+
+    // greedy placement : the less padding first, then the largest alignement, then the largest size
+    std::vector<Member> remaining = members;
+    cursor = vStartOffset;
+    while (!remaining.empty()) {
+        size_t best = 0U;
+        uint32_t bestPadding = UINT32_MAX;
+        for (size_t idx = 0U; idx < remaining.size(); ++idx) {
+            const auto& member = remaining[idx];
+            const uint32_t padding = AlignOffset(cursor, member.align) - cursor;
+            const auto& current = remaining[best];
+            if (padding < bestPadding ||  //
+                (padding == bestPadding && (member.align > current.align || (member.align == current.align && member.size > current.size)))) {
+                best = idx;
+                bestPadding = padding;
+            }
+        }
+        auto member = remaining[best];
+        member.offset = cursor + bestPadding;
+        cursor = member.offset + member.size;
+        res.push_back(member);
+        remaining.erase(remaining.begin() + best);
+    }
+    optimizedSize = cursor - vStartOffset;
+    return res;
+}
+
+uint32_t BufferLayoutOptimizer::GetDeclarationOrderSize() const {
+    return declarationOrderSize;
+}
+
+uint32_t BufferLayoutOptimizer::GetOptimizedSize() const {
+    return optimizedSize;
+}
+
+uint32_t BufferLayoutOptimizer::WriteValue(const std::string& vKey, const void* vValue, uint32_t vSizeInBytes, uint8_t* vDst) const {
+    const auto it = chunkedMembers.find(vKey);
+    if (it == chunkedMembers.end()) {
+        return 0U;
+    }
+    const auto& member = members[it->second];
+    const uint32_t count = std::min(vSizeInBytes / member.chunkSize, member.size / member.chunkStride);
+    if (!count) {
+        return 0U;
+    }
+    CopyChunks((const uint8_t*)vValue, member.chunkSize, vDst, member.chunkStride, member.chunkSize, count);
+    return (count - 1U) * member.chunkStride + member.chunkSize;
+}
+
+bool BufferLayoutOptimizer::ReadValue(const std::string& vKey, const uint8_t* vSrc, void* vValue, uint32_t vSizeInBytes) const {
+    const auto it = chunkedMembers.find(vKey);
+    if (it == chunkedMembers.end()) {
+        return false;
+    }
+    const auto& member = members[it->second];
+    const uint32_t count = std::min(vSizeInBytes / member.chunkSize, member.size / member.chunkStride);
+    if (!count) {
+        return false;
+    }
+    CopyChunks(vSrc, member.chunkStride, (uint8_t*)vValue, member.chunkSize, member.chunkSize, count);
+    return true;
+}
+
+std::string BufferLayoutOptimizer::GetGlslBlockDeclaration(const std::string& vLayoutQualifiers,
+    const std::string& vBlockName,
+    const std::string& vInstanceName,
+    const std::unordered_map<std::string, uint32_t>& vOffsets) const {
+    ZoneScoped;
+    std::vector<const Member*> sorted;
+    for (const auto& member : members) {
+        if (vOffsets.find(member.key) != vOffsets.end()) {
+            sorted.push_back(&member);
+        }
+    }
+    std::sort(sorted.begin(), sorted.end(), [&vOffsets](const Member* vA, const Member* vB) {  //
+        return vOffsets.at(vA->key) < vOffsets.at(vB->key);
+    });
+    std::stringstream res;
+    res << "layout(" << vLayoutQualifiers << ") " << (vLayoutQualifiers.find("std430") != std::string::npos ? "buffer " : "uniform ") << vBlockName
+        << " {\n";
+    for (const auto* member : sorted) {
+        if (member->glslType.empty()) {
+            res << "\t// " << member->key << " : " << member->size << " bytes at offset " << vOffsets.at(member->key) << ", unknown glsl type\n";
+        } else if (member->arrayCount) {
+            res << "\t" << member->glslType << " " << member->key << "[" << member->arrayCount << "]; // offset " << vOffsets.at(member->key) << "\n";
+        } else {
+            res << "\t" << member->glslType << " " << member->key << "; // offset " << vOffsets.at(member->key) << "\n";
+        }
+    }
+    res << "}";
+    if (!vInstanceName.empty()) {
+        res << " " << vInstanceName;
+    }
+    res << ";\n";
+    return res.str();
+}
+
+uint32_t BufferLayoutOptimizer::AlignOffset(uint32_t vOffset, uint32_t vAlign) {
+    return vAlign * (uint32_t)std::ceil((double)vOffset / (double)vAlign);
+}
+
+void BufferLayoutOptimizer::CopyChunks(const uint8_t* vSrc, uint32_t vSrcStride, uint8_t* vDst, uint32_t vDstStride, uint32_t vChunkSize, uint32_t vChunksCount) {
+    for (uint32_t idx = 0U; idx < vChunksCount; ++idx) {
+        memcpy(vDst + idx * vDstStride, vSrc + idx * vSrcStride, vChunkSize);
+    }
+}
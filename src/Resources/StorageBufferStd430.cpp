@@ -18,6 +18,7 @@ limitations under the License.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <Gaia/Resources/StorageBufferStd430.h>
+#include <Gaia/Resources/VulkanUniformArena.h>
 
 #ifdef PROFILER_INCLUDE
 #include <vulkan/vulkan.hpp>
@@ -36,9 +37,43 @@ StorageBufferStd430::~StorageBufferStd430() {
 
 bool StorageBufferStd430::Build() {
     ZoneScoped;
+    if (useLayoutOptimizer && !layoutWasOptimized) {
+        const auto startOffset = (uint32_t)datas.size();
+        const auto members = layoutOptimizer.Optimize(startOffset, true);
+        if (!members.empty()) {
+            datas.resize(startOffset + layoutOptimizer.GetOptimizedSize());
+            for (const auto& member : members) {
+                memcpy(datas.data() + member.offset, member.value.data(), member.size);
+                AddOffsetForKey(member.key, member.offset);
+            }
+            needRecreation = true;
+            SetDirty();
+            LogVarLightInfo("StorageBufferStd430 %s : %u bytes in declaration order, %u bytes after layout optimization (%u bytes of padding saved)",
+                layoutBlockName.c_str(), layoutOptimizer.GetDeclarationOrderSize(), layoutOptimizer.GetOptimizedSize(), GetLayoutSavedBytes());
+        }
+        layoutWasOptimized = true;
+    }
     return true;
 }
 
+void StorageBufferStd430::UseLayoutOptimizer(const std::string& vBlockName) {
+    ZoneScoped;
+    useLayoutOptimizer = true;
+    layoutBlockName = vBlockName;
+}
+
+uint32_t StorageBufferStd430::GetLayoutSavedBytes() const {
+    if (layoutOptimizer.GetDeclarationOrderSize() > layoutOptimizer.GetOptimizedSize()) {
+        return layoutOptimizer.GetDeclarationOrderSize() - layoutOptimizer.GetOptimizedSize();
+    }
+    return 0U;
+}
+
+std::string StorageBufferStd430::GetGlslBlockDeclaration(const std::string& vLayoutQualifiers, const std::string& vBlockName, const std::string& vInstanceName) {
+    ZoneScoped;
+    return layoutOptimizer.GetGlslBlockDeclaration(vLayoutQualifiers, vBlockName, vInstanceName, offsets);
+}
+
 void StorageBufferStd430::Unit() {
     ZoneScoped;
     DestroySBO();
@@ -49,12 +84,17 @@ void StorageBufferStd430::Clear() {
     ZoneScoped;
     datas.clear();
     offsets.clear();
+    layoutOptimizer.Clear();
+    layoutWasOptimized = false;
+    for (auto& ranges : frameDirtyRanges) {
+        ranges.Clear();
+    }
     isDirty = false;
 }
 
 void StorageBufferStd430::SetDirty() {
     ZoneScoped;
-    isDirty = true;
+    SetDirtyRange(0U, (uint32_t)datas.size());
 }
 
 bool StorageBufferStd430::IsDirty() {
@@ -85,9 +125,17 @@ void StorageBufferStd430::Upload(GaiApi::VulkanCoreWeak vVulkanCore, bool vOnlyI
     if (!vVulkanCore.expired()) {
         RecreateSBO(vVulkanCore);
 
-        if (!vOnlyIfDirty || (vOnlyIfDirty && isDirty)) {
+        if (!vOnlyIfDirty) {
+            SetDirty();
+        }
+        if (isDirty) {
             if (bufferObjectPtr && !customBufferInfo) {
-                VulkanRessource::upload(vVulkanCore, bufferObjectPtr, datas.data(), datas.size());
+                // with frame slots, the slots of the other frames in flight can be in use by the gpu
+                currentFrameSlot = GetFrameSlot(vVulkanCore);
+                const uint32_t slotOffset = currentFrameSlot * frameSlotSize;
+                VulkanRessource::uploadRanges(vVulkanCore, bufferObjectPtr, datas.data(), frameDirtyRanges[currentFrameSlot], slotOffset);
+                frameDirtyRanges[currentFrameSlot].Clear();  // not cleared by uploadRanges if VMA_MEMORY_USAGE_GPU_ONLY
+                descriptorBufferInfo.offset = slotOffset;
 
                 firstUploadWasDone = true;
                 isDirty = false;
@@ -98,6 +146,7 @@ void StorageBufferStd430::Upload(GaiApi::VulkanCoreWeak vVulkanCore, bool vOnlyI
 
 bool StorageBufferStd430::CreateSBO(GaiApi::VulkanCoreWeak vVulkanCore, VmaMemoryUsage vVmaMemoryUsage) {
     ZoneScoped;
+    Build();  // place the vars if the layout optimizer is used
     if (customBufferInfo) {
         if (!descriptorBufferInfo.buffer)  // si le buffer est vide alors on va l'init avec un buffer de taille 1
         {
@@ -114,12 +163,33 @@ bool StorageBufferStd430::CreateSBO(GaiApi::VulkanCoreWeak vVulkanCore, VmaMemor
     if (!datas.empty()) {
         needRecreation = false;
 
-        bufferObjectPtr = VulkanRessource::createStorageBufferObject(vVulkanCore, datas.size(), vVmaMemoryUsage, "StorageBufferStd430");
+        if (vVmaMemoryUsage != VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_TO_GPU) {
+            useFrameSlots = false;
+        }
+
+        frameSlotSize = (uint32_t)datas.size();
+        if (useFrameSlots) {
+            auto corePtr = vVulkanCore.lock();
+            assert(corePtr != nullptr);
+            const auto& limits = corePtr->getPhysicalDevice().getProperties().limits;
+            const auto& minAlign = (uint32_t)ez::maxi<vk::DeviceSize>(limits.minStorageBufferOffsetAlignment, 1U);
+            frameSlotSize = minAlign * (uint32_t)std::ceil((double)datas.size() / (double)minAlign);
+        }
+
+        bufferObjectPtr = VulkanRessource::createStorageBufferObject(
+            vVulkanCore, (uint64_t)frameSlotSize * GetFrameSlotsCount(), vVmaMemoryUsage, "StorageBufferStd430");
         if (bufferObjectPtr && bufferObjectPtr->buffer) {
             descriptorBufferInfo.buffer = bufferObjectPtr->buffer;
             descriptorBufferInfo.range = datas.size();
             descriptorBufferInfo.offset = 0;
 
+            // the last slot, so the first upload will be in slot 0
+            currentFrameSlot = GetFrameSlotsCount() - 1U;
+            // a new buffer, all slots must be fully uploaded
+            for (auto& ranges : frameDirtyRanges) {
+                ranges.Clear();
+            }
+
             Upload(vVulkanCore, false);
 
             return true;
@@ -190,6 +260,36 @@ bool StorageBufferStd430::RegisterByteSize(const std::string& vKey, uint32_t vSi
     return false;
 }
 
+uint32_t StorageBufferStd430::GetFrameSlotsCount() {
+    ZoneScoped;
+    return useFrameSlots ? sFrameSlotsCount : 1U;
+}
+
+// same frames as UniformBlockStd140::GetFrameSlot, a second upload in a frame write again in his slot
+uint32_t StorageBufferStd430::GetFrameSlot(GaiApi::VulkanCoreWeak vVulkanCore) {
+    ZoneScoped;
+    auto corePtr = vVulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto arenaPtr = corePtr->getUniformArena().lock();
+    if (arenaPtr) {
+        if (currentFrameSlotFrame == arenaPtr->GetFrameCounter()) {
+            return currentFrameSlot;
+        }
+        currentFrameSlotFrame = arenaPtr->GetFrameCounter();
+    }
+    return (currentFrameSlot + 1U) % GetFrameSlotsCount();
+}
+
+void StorageBufferStd430::SetDirtyRange(uint32_t vOffset, uint32_t vSizeInBytes) {
+    ZoneScoped;
+    if (vSizeInBytes > 0U) {
+        for (uint32_t i = 0U; i < GetFrameSlotsCount(); ++i) {
+            frameDirtyRanges[i].Add(vOffset, vSizeInBytes);
+        }
+        isDirty = true;
+    }
+}
+
 void StorageBufferStd430::AddOffsetForKey(const std::string& vKey, uint32_t vOffset) {
     ZoneScoped;
     offsets[vKey] = vOffset;
@@ -18,6 +18,9 @@ limitations under the License.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <Gaia/Resources/Texture2D.h>
+#include <Gaia/Resources/VulkanImageConverter.h>
+#include <Gaia/Resources/TextureContainer.h>
+#include <Gaia/Resources/TextureDiskCache.h>
 #include <ezlibs/ezLog.hpp>
 
 #ifdef STB_IMAGE_INCLUDE
@@ -128,6 +131,47 @@ bool Texture2D::loadImageWithMaxH(const std::string& inFile, const uint32_t& max
     return true;
 }
 
+bool Texture2D::loadImageNative(const std::string& inFile,
+    std::vector<uint8_t>& outBuffer,
+    uint32_t& outWidth,
+    uint32_t& outHeight,
+    uint32_t& outChannels,
+    uint32_t& outBytesPerComponent) {
+    ZoneScoped;
+
+#ifdef STB_IMAGE_INCLUDE
+    int w = 0, h = 0, chans = 0;
+    void* datas = nullptr;
+    if (stbi_is_hdr(inFile.c_str())) {
+        datas = stbi_loadf(inFile.c_str(), &w, &h, &chans, 0);
+        outBytesPerComponent = 4U;
+    } else if (stbi_is_16_bit(inFile.c_str())) {
+        datas = stbi_load_16(inFile.c_str(), &w, &h, &chans, 0);
+        outBytesPerComponent = 2U;
+    } else {
+        datas = stbi_load(inFile.c_str(), &w, &h, &chans, 0);
+        outBytesPerComponent = 1U;
+    }
+
+    if (!datas) {
+        return false;
+    }
+
+    outWidth = static_cast<uint32_t>(w);
+    outHeight = static_cast<uint32_t>(h);
+    outChannels = static_cast<uint32_t>(chans);
+
+    auto size = (size_t)outWidth * (size_t)outHeight * (size_t)outChannels * (size_t)outBytesPerComponent;
+    outBuffer.resize(size);
+    memcpy(outBuffer.data(), datas, size);
+    stbi_image_free(datas);
+
+    return true;
+#else
+    return false;
+#endif  // STB_IMAGE_INCLUDE
+}
+
 /*
 vk::DescriptorImageInfo Texture2D::GetImageInfoFromMemory(GaiApi::VulkanCoreWeak vVulkanCore, uint8_t* buffer, const uint32_t& width, const uint32_t&
 height, const uint32_t& channels)
@@ -180,14 +224,15 @@ height, const uint32_t& channels)
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Texture2DPtr Texture2D::CreateFromFile(GaiApi::VulkanCoreWeak vVulkanCore, std::string vFilePathName, const uint32_t& vMaxHeight) {
+Texture2DPtr Texture2D::CreateFromFile(
+    GaiApi::VulkanCoreWeak vVulkanCore, std::string vFilePathName, const uint32_t& vMaxHeight, const vk::Format& vFormat) {
     ZoneScoped;
 
     if (vVulkanCore.expired())
         return nullptr;
     auto res = std::make_shared<Texture2D>(vVulkanCore);
 
-    if (!res->LoadFile(vFilePathName, vk::Format::eR8G8B8A8Unorm, 1u, vMaxHeight)) {
+    if (!res->LoadFile(vFilePathName, vFormat, 1u, vMaxHeight)) {
         res.reset();
     }
 
@@ -273,6 +318,31 @@ bool Texture2D::LoadFile(const std::string& vFilePathName, const vk::Format& vFo
     if (!vFilePathName.empty()) {
         Destroy();
 
+        if (TextureContainer::IsContainerFile(vFilePathName)) {
+            return LoadContainerFile(vFilePathName);
+        }
+
+        // warm load, no decoding, resize or mips generation
+        auto corePtr = m_VulkanCore.lock();
+        assert(corePtr != nullptr);
+        auto diskCachePtr = corePtr->getTextureDiskCache().lock();
+        std::string cacheKey;
+        if (diskCachePtr) {
+            const auto loadOptions = "format=" + std::to_string((uint32_t)vFormat) + ";mips=" + std::to_string(vMipLevelCount) +  //
+                                     ";maxh=" + std::to_string(vMaxHeight);
+            cacheKey = diskCachePtr->GetKey(vFilePathName, loadOptions);
+            TextureContainer container;
+            if (diskCachePtr->Load(cacheKey, container) && LoadContainer(container)) {
+                return m_Loaded;
+            }
+        }
+
+        if (LoadFileOnGpu(vFilePathName, vFormat, vMipLevelCount, vMaxHeight)) {
+            StoreInDiskCache(cacheKey);
+            return m_Loaded;
+        }
+
+        // cpu fallback, expanded in rgba8
         uint32_t w;
         uint32_t h;
         uint32_t channels = 4;
@@ -290,7 +360,8 @@ bool Texture2D::LoadFile(const std::string& vFilePathName, const vk::Format& vFo
         if (w == 0 || h == 0)
             return false;
 
-        LoadMemory(image_data.data(), w, h, channels, vFormat, vMipLevelCount);
+        LoadMemory(image_data.data(), w, h, channels, (vFormat == vk::Format::eUndefined) ? vk::Format::eR8G8B8A8Unorm : vFormat, vMipLevelCount);
+        StoreInDiskCache(cacheKey);
     }
 
     return m_Loaded;
@@ -321,41 +392,45 @@ bool Texture2D::LoadMemory(uint8_t* buffer,
 
         m_ImageFormat = vFormat;
 
-        auto corePtr = m_VulkanCore.lock();
-        assert(corePtr != nullptr);
+        CreateViewAndSampler(vFormat);
 
-        vk::ImageViewCreateInfo imViewInfo = {};
-        imViewInfo.flags = vk::ImageViewCreateFlags();
-        imViewInfo.image = m_Texture2D->image;
-        imViewInfo.viewType = vk::ImageViewType::e2D;
-        imViewInfo.format = vFormat;
-        imViewInfo.components = vk::ComponentMapping();
-        imViewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_MipLevelCount, 0, 1);
-        m_TextureView = corePtr->getDevice().createImageView(imViewInfo);
+        m_Loaded = true;
+    }
 
-        vk::SamplerCreateInfo samplerInfo = {};
-        samplerInfo.flags = vk::SamplerCreateFlags();
-        samplerInfo.magFilter = vk::Filter::eLinear;
-        samplerInfo.minFilter = vk::Filter::eLinear;
-        samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
-        samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;  // U
-        samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;  // V
-        samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;  // W
-        samplerInfo.mipLodBias = 0.0f;
-        // samplerInfo.anisotropyEnable = false;
-        // samplerInfo.maxAnisotropy = 0.0f;
-        // samplerInfo.compareEnable = false;
-        // samplerInfo.compareOp = vk::CompareOp::eAlways;
-        samplerInfo.minLod = 0.0f;
-        samplerInfo.maxLod = static_cast<float>(m_MipLevelCount);
-        // samplerInfo.unnormalizedCoordinates = false;
-        m_Sampler = corePtr->getDevice().createSampler(samplerInfo);
+    return m_Loaded;
+}
 
-        m_DescriptorImageInfo.sampler = m_Sampler;
-        m_DescriptorImageInfo.imageView = m_TextureView;
-        m_DescriptorImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+bool Texture2D::LoadPackedMemory(const void* vBuffer,
+    const uint32_t& vWidth,
+    const uint32_t& vHeight,
+    const uint32_t& vChannels,
+    const uint32_t& vBytesPerComponent,
+    const ez::uvec2& vSize,
+    const vk::Format& vFormat,
+    const uint32_t& vMipLevelCount) {
+    ZoneScoped;
+
+    m_Loaded = false;
+
+    if (vBuffer) {
+        if (vSize.x == 0 || vSize.y == 0)
+            return false;
 
-        m_Ratio = (float)m_Width / (float)m_Height;
+        const uint32_t maxMipLevelCount = GetMiplevelCount(vSize.x, vSize.y);
+        const uint32_t mipLevelCount = ez::clamp(vMipLevelCount, 1u, maxMipLevelCount);
+
+        auto texturePtr = VulkanRessource::createTextureImage2DFromPacked(
+            m_VulkanCore, vSize.x, vSize.y, mipLevelCount, vFormat, vBuffer, vWidth, vHeight, vChannels, vBytesPerComponent, "Texture2D");
+        if (!texturePtr)
+            return false;
+
+        m_Texture2D = texturePtr;
+        m_Width = vSize.x;
+        m_Height = vSize.y;
+        m_MipLevelCount = mipLevelCount;
+        m_ImageFormat = vFormat;
+
+        CreateViewAndSampler(vFormat);
 
         m_Loaded = true;
     }
@@ -363,6 +438,142 @@ bool Texture2D::LoadMemory(uint8_t* buffer,
     return m_Loaded;
 }
 
+bool Texture2D::LoadContainerFile(const std::string& vFilePathName) {
+    ZoneScoped;
+
+    Destroy();
+
+    TextureContainer container;
+    if (!container.LoadFile(vFilePathName))
+        return false;
+
+    if (container.GetDepth() != 1U || container.GetFacesCount() != 1U || container.GetLayersCount() != 1U) {
+        LogVarError("the texture file %s is not a 2D texture", vFilePathName.c_str());
+        return false;
+    }
+
+    return LoadContainer(container);
+}
+
+bool Texture2D::LoadContainer(TextureContainer& vContainer) {
+    ZoneScoped;
+
+    m_Loaded = false;
+
+    auto texturePtr = VulkanRessource::createTextureImageFromContainer(m_VulkanCore, vContainer, "Texture2D");
+    if (!texturePtr)
+        return false;
+
+    m_Texture2D = texturePtr;
+    m_Width = vContainer.GetWidth();
+    m_Height = vContainer.GetHeight();
+    m_MipLevelCount = vContainer.GetLevelsCount();
+    m_ImageFormat = vContainer.GetFormat();
+
+    CreateViewAndSampler(m_ImageFormat);
+
+    m_Loaded = true;
+
+    return m_Loaded;
+}
+
+void Texture2D::StoreInDiskCache(const std::string& vCacheKey) {
+    ZoneScoped;
+
+    if (!m_Loaded || vCacheKey.empty())
+        return;
+
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    auto diskCachePtr = corePtr->getTextureDiskCache().lock();
+    if (!diskCachePtr)
+        return;
+
+    TextureContainer container;
+    if (container.Allocate(m_ImageFormat, m_Width, m_Height, 1U, 1U, 1U, m_MipLevelCount) &&
+        VulkanRessource::getDatasFromTextureImage(m_VulkanCore, m_Texture2D, container)) {
+        diskCachePtr->Store(vCacheKey, container);
+    }
+}
+
+bool Texture2D::LoadFileOnGpu(const std::string& vFilePathName, const vk::Format& vFormat, const uint32_t& vMipLevelCount, const uint32_t& vMaxHeight) {
+    ZoneScoped;
+
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    auto converterPtr = corePtr->getImageConverter().lock();
+    if (!converterPtr || (vFormat != vk::Format::eUndefined && !converterPtr->IsFormatSupported(vFormat)))
+        return false;
+
+    std::vector<uint8_t> image_data;
+    uint32_t w = 0U, h = 0U, channels = 0U, bytesPerComponent = 0U;
+    if (!loadImageNative(vFilePathName, image_data, w, h, channels, bytesPerComponent) || w == 0 || h == 0)
+        return false;
+
+    auto format = vFormat;
+    if (format == vk::Format::eUndefined) {
+        if (bytesPerComponent == 4U) {
+            format = vk::Format::eR32G32B32A32Sfloat;
+        } else if (bytesPerComponent == 2U) {
+            format = converterPtr->IsFormatSupported(vk::Format::eR16G16B16A16Unorm) ? vk::Format::eR16G16B16A16Unorm
+                                                                                       : vk::Format::eR16G16B16A16Sfloat;
+        } else {
+            format = vk::Format::eR8G8B8A8Unorm;
+        }
+    }
+
+    // same size as loadImageWithMaxH, the height is vMaxHeight and the ratio is kept
+    ez::uvec2 size(w, h);
+    if (vMaxHeight) {
+        size.x = ez::maxi(1U, (uint32_t)((float)vMaxHeight * (float)w / (float)h));
+        size.y = vMaxHeight;
+    }
+
+    return LoadPackedMemory(image_data.data(), w, h, channels, bytesPerComponent, size, format, vMipLevelCount);
+}
+
+void Texture2D::CreateViewAndSampler(const vk::Format& vFormat) {
+    ZoneScoped;
+
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    vk::ImageViewCreateInfo imViewInfo = {};
+    imViewInfo.flags = vk::ImageViewCreateFlags();
+    imViewInfo.image = m_Texture2D->image;
+    imViewInfo.viewType = vk::ImageViewType::e2D;
+    imViewInfo.format = vFormat;
+    imViewInfo.components = vk::ComponentMapping();
+    imViewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_MipLevelCount, 0, 1);
+    m_TextureView = corePtr->getDevice().createImageView(imViewInfo);
+
+    vk::SamplerCreateInfo samplerInfo = {};
+    samplerInfo.flags = vk::SamplerCreateFlags();
+    samplerInfo.magFilter = vk::Filter::eLinear;
+    samplerInfo.minFilter = vk::Filter::eLinear;
+    samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+    samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;  // U
+    samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;  // V
+    samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;  // W
+    samplerInfo.mipLodBias = 0.0f;
+    // samplerInfo.anisotropyEnable = false;
+    // samplerInfo.maxAnisotropy = 0.0f;
+    // samplerInfo.compareEnable = false;
+    // samplerInfo.compareOp = vk::CompareOp::eAlways;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(m_MipLevelCount);
+    // samplerInfo.unnormalizedCoordinates = false;
+    m_Sampler = corePtr->getDevice().createSampler(samplerInfo);
+
+    m_DescriptorImageInfo.sampler = m_Sampler;
+    m_DescriptorImageInfo.imageView = m_TextureView;
+    m_DescriptorImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    m_Ratio = (float)m_Width / (float)m_Height;
+}
+
 bool Texture2D::LoadEmptyTexture(const ez::uvec2& vSize, const vk::Format& vFormat) {
     ZoneScoped;
 
@@ -985,10 +1196,14 @@ bool Texture2D::SaveToTga(const std::string& vFilePathName, const bool& vFlipY,
 ///// MIP MAPPING /////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool Texture2D::UpdateMipMapping() {
+bool Texture2D::UpdateMipMapping(vk::CommandBuffer* vCmdBufferPtr) {
     if (!m_VulkanCore.expired() && m_Texture2D != nullptr) {
-        VulkanRessource::GenerateMipmaps(m_VulkanCore, m_Texture2D->image, m_ImageFormat, m_Width, m_Height, m_MipLevelCount);
-        return true;
+        const auto& layout = m_DescriptorImageInfo.imageLayout;
+        if (vCmdBufferPtr) {
+            return VulkanRessource::RecordMipmaps(
+                m_VulkanCore, *vCmdBufferPtr, m_Texture2D, m_ImageFormat, m_Width, m_Height, m_MipLevelCount, layout, layout);
+        }
+        return VulkanRessource::GenerateMipmaps(m_VulkanCore, m_Texture2D, m_ImageFormat, m_Width, m_Height, m_MipLevelCount, layout, layout);
     }
     return false;
 }
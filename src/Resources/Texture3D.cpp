@@ -18,6 +18,7 @@ limitations under the License.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <Gaia/Resources/Texture3D.h>
+#include <Gaia/Resources/TextureContainer.h>
 #include <ezlibs/ezLog.hpp>
 
 #ifdef PROFILER_INCLUDE
@@ -48,6 +49,20 @@ Texture3DPtr Texture3D::CreateEmptyTexture(GaiApi::VulkanCoreWeak vVulkanCore, e
     return res;
 }
 
+Texture3DPtr Texture3D::CreateFromFile(GaiApi::VulkanCoreWeak vVulkanCore, const std::string& vFilePathName) {
+    ZoneScoped;
+
+    if (vVulkanCore.expired())
+        return nullptr;
+    auto res = std::make_shared<Texture3D>(vVulkanCore);
+
+    if (!res->LoadContainerFile(vFilePathName)) {
+        res.reset();
+    }
+
+    return res;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -161,6 +176,63 @@ bool Texture3D::InitEmptyTexture(const ez::uvec3& vSize, const vk::Format& vForm
     return m_Loaded;
 }
 
+bool Texture3D::LoadContainerFile(const std::string& vFilePathName) {
+    ZoneScoped;
+
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    Destroy();
+
+    TextureContainer container;
+    if (!container.LoadFile(vFilePathName))
+        return false;
+
+    if (container.GetDepth() == 1U || container.GetFacesCount() != 1U || container.GetLayersCount() != 1U) {
+        LogVarError("the texture file %s is not a 3D texture", vFilePathName.c_str());
+        return false;
+    }
+
+    m_Texture3D = VulkanRessource::createTextureImageFromContainer(m_VulkanCore, container, "Texture3D");
+    if (!m_Texture3D)
+        return false;
+
+    m_Width = container.GetWidth();
+    m_Height = container.GetHeight();
+    m_Depth = container.GetDepth();
+    m_MipLevelCount = container.GetLevelsCount();
+    m_ImageFormat = container.GetFormat();
+
+    vk::ImageViewCreateInfo imViewInfo = {};
+    imViewInfo.flags = vk::ImageViewCreateFlags();
+    imViewInfo.image = m_Texture3D->image;
+    imViewInfo.viewType = vk::ImageViewType::e3D;
+    imViewInfo.format = m_ImageFormat;
+    imViewInfo.components = vk::ComponentMapping();
+    imViewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, m_MipLevelCount, 0, 1);
+    m_TextureView = corePtr->getDevice().createImageView(imViewInfo);
+
+    vk::SamplerCreateInfo samplerInfo = {};
+    samplerInfo.flags = vk::SamplerCreateFlags();
+    samplerInfo.magFilter = vk::Filter::eLinear;
+    samplerInfo.minFilter = vk::Filter::eLinear;
+    samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+    samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;  // U
+    samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;  // V
+    samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;  // W
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(m_MipLevelCount);
+    m_Sampler = corePtr->getDevice().createSampler(samplerInfo);
+
+    m_DescriptorImageInfo.sampler = m_Sampler;
+    m_DescriptorImageInfo.imageView = m_TextureView;
+    m_DescriptorImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    m_Loaded = true;
+
+    return m_Loaded;
+}
+
 void Texture3D::Destroy() {
     ZoneScoped;
 
@@ -0,0 +1,714 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Resources/TextureContainer.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace {
+
+const std::array<uint8_t, 12U> s_Ktx2Identifier = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+constexpr uint32_t s_DdsMagic = 0x20534444;  // "DDS "
+
+constexpr uint32_t MakeFourCC(const char vA, const char vB, const char vC, const char vD) {
+    return (uint32_t)(uint8_t)vA | ((uint32_t)(uint8_t)vB << 8) | ((uint32_t)(uint8_t)vC << 16) | ((uint32_t)(uint8_t)vD << 24);
+}
+
+template <typename T>
+T ReadValue(const uint8_t* vDatas, const size_t& vOffset) {
+    T res;
+    memcpy(&res, vDatas + vOffset, sizeof(T));
+    return res;
+}
+
+uint64_t AlignOffset(const uint64_t& vOffset, const uint64_t& vAlign) {
+    return (vOffset + vAlign - 1U) / vAlign * vAlign;
+}
+
+// saturate to UINT64_MAX, so a size built from a corrupted header is always too big
+uint64_t SaturatedMul(const uint64_t& vA, const uint64_t& vB) {
+    if (vA != 0U && vB > UINT64_MAX / vA) {
+        return UINT64_MAX;
+    }
+    return vA * vB;
+}
+
+uint64_t SaturatedAdd(const uint64_t& vA, const uint64_t& vB) {
+    if (vB > UINT64_MAX - vA) {
+        return UINT64_MAX;
+    }
+    return vA + vB;
+}
+
+vk::Format GetFormatFromDxgi(const uint32_t& vDxgiFormat) {
+    switch (vDxgiFormat) {
+        case 2U: return vk::Format::eR32G32B32A32Sfloat;
+        case 10U: return vk::Format::eR16G16B16A16Sfloat;
+        case 11U: return vk::Format::eR16G16B16A16Unorm;
+        case 16U: return vk::Format::eR32G32Sfloat;
+        case 24U: return vk::Format::eA2B10G10R10UnormPack32;
+        case 26U: return vk::Format::eB10G11R11UfloatPack32;
+        case 28U: return vk::Format::eR8G8B8A8Unorm;
+        case 29U: return vk::Format::eR8G8B8A8Srgb;
+        case 34U: return vk::Format::eR16G16Sfloat;
+        case 35U: return vk::Format::eR16G16Unorm;
+        case 41U: return vk::Format::eR32Sfloat;
+        case 49U: return vk::Format::eR8G8Unorm;
+        case 54U: return vk::Format::eR16Sfloat;
+        case 56U: return vk::Format::eR16Unorm;
+        case 61U: return vk::Format::eR8Unorm;
+        case 67U: return vk::Format::eE5B9G9R9UfloatPack32;
+        case 71U: return vk::Format::eBc1RgbaUnormBlock;
+        case 72U: return vk::Format::eBc1RgbaSrgbBlock;
+        case 74U: return vk::Format::eBc2UnormBlock;
+        case 75U: return vk::Format::eBc2SrgbBlock;
+        case 77U: return vk::Format::eBc3UnormBlock;
+        case 78U: return vk::Format::eBc3SrgbBlock;
+        case 80U: return vk::Format::eBc4UnormBlock;
+        case 81U: return vk::Format::eBc4SnormBlock;
+        case 83U: return vk::Format::eBc5UnormBlock;
+        case 84U: return vk::Format::eBc5SnormBlock;
+        case 87U: return vk::Format::eB8G8R8A8Unorm;
+        case 91U: return vk::Format::eB8G8R8A8Srgb;
+        case 95U: return vk::Format::eBc6HUfloatBlock;
+        case 96U: return vk::Format::eBc6HSfloatBlock;
+        case 98U: return vk::Format::eBc7UnormBlock;
+        case 99U: return vk::Format::eBc7SrgbBlock;
+        default: break;
+    }
+    return vk::Format::eUndefined;
+}
+
+// the pixel format of the dds files without the DX10 header
+vk::Format GetFormatFromDdsPixelFormat(const uint8_t* vPixelFormat) {
+    const auto flags = ReadValue<uint32_t>(vPixelFormat, 4U);
+    const auto fourCC = ReadValue<uint32_t>(vPixelFormat, 8U);
+    if (flags & 0x4U) {  // DDPF_FOURCC
+        switch (fourCC) {
+            case MakeFourCC('D', 'X', 'T', '1'): return vk::Format::eBc1RgbaUnormBlock;
+            case MakeFourCC('D', 'X', 'T', '2'):
+            case MakeFourCC('D', 'X', 'T', '3'): return vk::Format::eBc2UnormBlock;
+            case MakeFourCC('D', 'X', 'T', '4'):
+            case MakeFourCC('D', 'X', 'T', '5'): return vk::Format::eBc3UnormBlock;
+            case MakeFourCC('A', 'T', 'I', '1'):
+            case MakeFourCC('B', 'C', '4', 'U'): return vk::Format::eBc4UnormBlock;
+            case MakeFourCC('B', 'C', '4', 'S'): return vk::Format::eBc4SnormBlock;
+            case MakeFourCC('A', 'T', 'I', '2'):
+            case MakeFourCC('B', 'C', '5', 'U'): return vk::Format::eBc5UnormBlock;
+            case MakeFourCC('B', 'C', '5', 'S'): return vk::Format::eBc5SnormBlock;
+            case 113U: return vk::Format::eR16G16B16A16Sfloat;  // D3DFMT_A16B16G16R16F
+            case 116U: return vk::Format::eR32G32B32A32Sfloat;  // D3DFMT_A32B32G32R32F
+            default: break;
+        }
+    } else if ((flags & 0x40U) && ReadValue<uint32_t>(vPixelFormat, 12U) == 32U) {  // DDPF_RGB of 32 bits
+        const auto redMask = ReadValue<uint32_t>(vPixelFormat, 16U);
+        if (redMask == 0x000000FFU) {
+            return vk::Format::eR8G8B8A8Unorm;
+        } else if (redMask == 0x00FF0000U) {
+            return vk::Format::eB8G8R8A8Unorm;
+        }
+    }
+    return vk::Format::eUndefined;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// BC DECODING /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef std::array<std::array<uint8_t, 4U>, 16U> BlockTexels;
+
+// BC1 color block. in BC2 and BC3 the four colors mode is always used
+void DecodeColorBlock(const uint8_t* vBlock, const bool& vForceFourColors, BlockTexels& vOutTexels) {
+    const auto c0 = ReadValue<uint16_t>(vBlock, 0U);
+    const auto c1 = ReadValue<uint16_t>(vBlock, 2U);
+    const auto indices = ReadValue<uint32_t>(vBlock, 4U);
+    std::array<std::array<uint8_t, 4U>, 4U> colors;
+    for (size_t idx = 0U; idx < 2U; ++idx) {
+        const auto c = (idx == 0U) ? c0 : c1;
+        colors[idx][0] = (uint8_t)(((c >> 11) & 0x1F) * 255U / 31U);
+        colors[idx][1] = (uint8_t)(((c >> 5) & 0x3F) * 255U / 63U);
+        colors[idx][2] = (uint8_t)((c & 0x1F) * 255U / 31U);
+        colors[idx][3] = 255U;
+    }
+    if (c0 > c1 || vForceFourColors) {
+        for (size_t ch = 0U; ch < 3U; ++ch) {
+            colors[2][ch] = (uint8_t)((2U * colors[0][ch] + colors[1][ch]) / 3U);
+            colors[3][ch] = (uint8_t)((colors[0][ch] + 2U * colors[1][ch]) / 3U);
+        }
+        colors[2][3] = 255U;
+        colors[3][3] = 255U;
+    } else {
+        for (size_t ch = 0U; ch < 3U; ++ch) {
+            colors[2][ch] = (uint8_t)((colors[0][ch] + colors[1][ch]) / 2U);
+            colors[3][ch] = 0U;
+        }
+        colors[2][3] = 255U;
+        colors[3][3] = 0U;  // transparent black
+    }
+    for (size_t idx = 0U; idx < 16U; ++idx) {
+        vOutTexels[idx] = colors[(indices >> (idx * 2U)) & 0x3U];
+    }
+}
+
+// BC4 block, also the alpha of BC3 and the two channels of BC5
+void DecodeChannelBlock(const uint8_t* vBlock, const size_t& vChannel, BlockTexels& vOutTexels) {
+    const uint32_t a0 = vBlock[0];
+    const uint32_t a1 = vBlock[1];
+    std::array<uint8_t, 8U> values;
+    values[0] = (uint8_t)a0;
+    values[1] = (uint8_t)a1;
+    if (a0 > a1) {
+        for (uint32_t idx = 1U; idx < 7U; ++idx) {
+            values[idx + 1U] = (uint8_t)(((7U - idx) * a0 + idx * a1) / 7U);
+        }
+    } else {
+        for (uint32_t idx = 1U; idx < 5U; ++idx) {
+            values[idx + 1U] = (uint8_t)(((5U - idx) * a0 + idx * a1) / 5U);
+        }
+        values[6] = 0U;
+        values[7] = 255U;
+    }
+    uint64_t indices = 0U;
+    for (size_t idx = 0U; idx < 6U; ++idx) {
+        indices |= (uint64_t)vBlock[2U + idx] << (8U * idx);
+    }
+    for (size_t idx = 0U; idx < 16U; ++idx) {
+        vOutTexels[idx][vChannel] = values[(indices >> (idx * 3U)) & 0x7U];
+    }
+}
+
+// BC2 explicit alpha of 4 bits
+void DecodeExplicitAlphaBlock(const uint8_t* vBlock, BlockTexels& vOutTexels) {
+    const auto alphas = ReadValue<uint64_t>(vBlock, 0U);
+    for (size_t idx = 0U; idx < 16U; ++idx) {
+        vOutTexels[idx][3] = (uint8_t)(((alphas >> (idx * 4U)) & 0xFU) * 17U);
+    }
+}
+
+bool DecodeBlock(const vk::Format& vFormat, const uint8_t* vBlock, BlockTexels& vOutTexels) {
+    switch (vFormat) {
+        case vk::Format::eBc1RgbUnormBlock:
+        case vk::Format::eBc1RgbSrgbBlock:
+            DecodeColorBlock(vBlock, false, vOutTexels);
+            for (auto& texel : vOutTexels) {
+                texel[3] = 255U;
+            }
+            return true;
+        case vk::Format::eBc1RgbaUnormBlock:
+        case vk::Format::eBc1RgbaSrgbBlock: DecodeColorBlock(vBlock, false, vOutTexels); return true;
+        case vk::Format::eBc2UnormBlock:
+        case vk::Format::eBc2SrgbBlock:
+            DecodeColorBlock(vBlock + 8U, true, vOutTexels);
+            DecodeExplicitAlphaBlock(vBlock, vOutTexels);
+            return true;
+        case vk::Format::eBc3UnormBlock:
+        case vk::Format::eBc3SrgbBlock:
+            DecodeColorBlock(vBlock + 8U, true, vOutTexels);
+            DecodeChannelBlock(vBlock, 3U, vOutTexels);
+            return true;
+        case vk::Format::eBc4UnormBlock:
+            // sampled as (r, 0, 0, 1) like the hardware
+            for (auto& texel : vOutTexels) {
+                texel = {0U, 0U, 0U, 255U};
+            }
+            DecodeChannelBlock(vBlock, 0U, vOutTexels);
+            return true;
+        case vk::Format::eBc5UnormBlock:
+            for (auto& texel : vOutTexels) {
+                texel = {0U, 0U, 0U, 255U};
+            }
+            DecodeChannelBlock(vBlock, 0U, vOutTexels);
+            DecodeChannelBlock(vBlock + 8U, 1U, vOutTexels);
+            return true;
+        default: break;
+    }
+    return false;
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TextureContainer::IsContainerFile(const std::string& vFilePathName) {
+    ZoneScoped;
+    std::ifstream file(vFilePathName, std::ios::binary);
+    if (file.is_open()) {
+        std::array<uint8_t, 12U> magic = {};
+        file.read((char*)magic.data(), magic.size());
+        if (file.gcount() == (std::streamsize)magic.size()) {
+            return (magic == s_Ktx2Identifier || ReadValue<uint32_t>(magic.data(), 0U) == s_DdsMagic);
+        }
+    }
+    return false;
+}
+
+TextureContainer::FormatInfos TextureContainer::GetFormatInfos(const vk::Format& vFormat) {
+    FormatInfos res;
+    switch (vFormat) {
+        case vk::Format::eBc1RgbUnormBlock:
+        case vk::Format::eBc1RgbSrgbBlock:
+        case vk::Format::eBc1RgbaUnormBlock:
+        case vk::Format::eBc1RgbaSrgbBlock:
+        case vk::Format::eBc4UnormBlock:
+        case vk::Format::eBc4SnormBlock:
+        case vk::Format::eEtc2R8G8B8UnormBlock:
+        case vk::Format::eEtc2R8G8B8SrgbBlock:
+        case vk::Format::eEtc2R8G8B8A1UnormBlock:
+        case vk::Format::eEtc2R8G8B8A1SrgbBlock:
+        case vk::Format::eEacR11UnormBlock:
+        case vk::Format::eEacR11SnormBlock: res = {4U, 4U, 8U}; break;
+        case vk::Format::eBc2UnormBlock:
+        case vk::Format::eBc2SrgbBlock:
+        case vk::Format::eBc3UnormBlock:
+        case vk::Format::eBc3SrgbBlock:
+        case vk::Format::eBc5UnormBlock:
+        case vk::Format::eBc5SnormBlock:
+        case vk::Format::eBc6HUfloatBlock:
+        case vk::Format::eBc6HSfloatBlock:
+        case vk::Format::eBc7UnormBlock:
+        case vk::Format::eBc7SrgbBlock:
+        case vk::Format::eEtc2R8G8B8A8UnormBlock:
+        case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+        case vk::Format::eEacR11G11UnormBlock:
+        case vk::Format::eEacR11G11SnormBlock: res = {4U, 4U, 16U}; break;
+        case vk::Format::eR8Unorm:
+        case vk::Format::eR8Snorm:
+        case vk::Format::eR8Srgb: res.bytesPerBlock = 1U; break;
+        case vk::Format::eR8G8Unorm:
+        case vk::Format::eR8G8Snorm:
+        case vk::Format::eR16Unorm:
+        case vk::Format::eR16Sfloat: res.bytesPerBlock = 2U; break;
+        case vk::Format::eR8G8B8A8Unorm:
+        case vk::Format::eR8G8B8A8Snorm:
+        case vk::Format::eR8G8B8A8Srgb:
+        case vk::Format::eB8G8R8A8Unorm:
+        case vk::Format::eB8G8R8A8Srgb:
+        case vk::Format::eR16G16Unorm:
+        case vk::Format::eR16G16Sfloat:
+        case vk::Format::eR32Sfloat:
+        case vk::Format::eA2B10G10R10UnormPack32:
+        case vk::Format::eB10G11R11UfloatPack32:
+        case vk::Format::eE5B9G9R9UfloatPack32: res.bytesPerBlock = 4U; break;
+        case vk::Format::eR16G16B16A16Unorm:
+        case vk::Format::eR16G16B16A16Sfloat:
+        case vk::Format::eR32G32Sfloat: res.bytesPerBlock = 8U; break;
+        case vk::Format::eR32G32B32A32Sfloat: res.bytesPerBlock = 16U; break;
+        default: {
+            // ASTC, 16 bytes by block, the formats are ordered by block size, unorm then srgb
+            static const std::array<std::array<uint32_t, 2U>, 14U> s_AstcBlocks = {{
+                {4U, 4U}, {5U, 4U}, {5U, 5U}, {6U, 5U}, {6U, 6U}, {8U, 5U}, {8U, 6U},  //
+                {8U, 8U}, {10U, 5U}, {10U, 6U}, {10U, 8U}, {10U, 10U}, {12U, 10U}, {12U, 12U}  //
+            }};
+            const auto value = static_cast<uint32_t>(vFormat);
+            if (value >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && value <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) {
+                const auto& block = s_AstcBlocks[(value - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2U];
+                res = {block[0], block[1], 16U};
+            }
+        } break;
+    }
+    return res;
+}
+
+bool TextureContainer::IsBlockCompressed(const vk::Format& vFormat) {
+    return (GetFormatInfos(vFormat).blockWidth > 1U);
+}
+
+uint32_t TextureContainer::GetMaxLevelsCount(const uint32_t& vWidth, const uint32_t& vHeight, const uint32_t& vDepth) {
+    uint32_t maxSize = ez::maxi(ez::maxi(vWidth, vHeight), vDepth);
+    uint32_t res = 1U;
+    while (maxSize > 1U) {
+        maxSize >>= 1U;
+        ++res;
+    }
+    return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// LOAD ////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TextureContainer::LoadFile(const std::string& vFilePathName) {
+    ZoneScoped;
+    Clear();
+    std::ifstream file(vFilePathName, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        LogVarError("Fail to open the texture file %s", vFilePathName.c_str());
+        return false;
+    }
+    const auto size = (size_t)file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::vector<uint8_t> datas(size);
+    file.read((char*)datas.data(), size);
+    if (size >= s_Ktx2Identifier.size() && memcmp(datas.data(), s_Ktx2Identifier.data(), s_Ktx2Identifier.size()) == 0) {
+        return LoadKtx2FromMemory(datas.data(), datas.size());
+    } else if (size >= 4U && ReadValue<uint32_t>(datas.data(), 0U) == s_DdsMagic) {
+        return LoadDdsFromMemory(datas.data(), datas.size());
+    }
+    LogVarError("the file %s is not a KTX2 or DDS file", vFilePathName.c_str());
+    return false;
+}
+
+bool TextureContainer::LoadKtx2FromMemory(const uint8_t* vDatas, const size_t& vSize) {
+    ZoneScoped;
+    Clear();
+    // identifier (12) + header (36) + index (32)
+    constexpr size_t levelIndexOffset = 80U;
+    if (vDatas == nullptr || vSize < levelIndexOffset || memcmp(vDatas, s_Ktx2Identifier.data(), s_Ktx2Identifier.size()) != 0) {
+        LogVarError("%s", "not a KTX2 file");
+        return false;
+    }
+    const auto vkFormat = ReadValue<uint32_t>(vDatas, 12U);
+    const auto width = ReadValue<uint32_t>(vDatas, 20U);
+    const auto height = ReadValue<uint32_t>(vDatas, 24U);
+    const auto depth = ReadValue<uint32_t>(vDatas, 28U);
+    const auto layersCount = ReadValue<uint32_t>(vDatas, 32U);
+    const auto facesCount = ReadValue<uint32_t>(vDatas, 36U);
+    const auto levelsCount = ReadValue<uint32_t>(vDatas, 40U);
+    const auto supercompressionScheme = ReadValue<uint32_t>(vDatas, 44U);
+    if (supercompressionScheme != 0U) {
+        LogVarError("the KTX2 supercompression scheme %u is not supported", supercompressionScheme);
+        return false;
+    }
+    m_Format = static_cast<vk::Format>(vkFormat);
+    if (GetFormatInfos(m_Format).bytesPerBlock == 0U) {
+        LogVarError("the KTX2 format %s is not supported", vk::to_string(m_Format).c_str());
+        Clear();
+        return false;
+    }
+    if (width == 0U || (facesCount != 1U && facesCount != 6U)) {
+        LogVarError("%s", "the KTX2 header is not valid");
+        Clear();
+        return false;
+    }
+    m_Width = width;
+    m_Height = ez::maxi(height, 1U);
+    m_Depth = ez::maxi(depth, 1U);
+    m_LayersCount = ez::maxi(layersCount, 1U);
+    m_FacesCount = facesCount;
+    const uint32_t levels = ez::maxi(levelsCount, 1U);  // 0 mean the mips are to generate
+    if ((uint64_t)vSize < levelIndexOffset + (uint64_t)levels * 24U) {
+        LogVarError("%s", "the KTX2 level index is truncated");
+        Clear();
+        return false;
+    }
+    // the levels after the 1x1x1 mip are ignored, the index of all the levels is still checked above
+    const uint32_t usedLevels = ez::mini(levels, GetMaxLevelsCount(m_Width, m_Height, m_Depth));
+    if (!PrepareLevels(usedLevels, vSize)) {
+        LogVarError("%s", "the KTX2 datas are greater than the file");
+        Clear();
+        return false;
+    }
+    for (uint32_t idx = 0U; idx < usedLevels; ++idx) {
+        const auto byteOffset = ReadValue<uint64_t>(vDatas, levelIndexOffset + idx * 24U);
+        const auto byteLength = ReadValue<uint64_t>(vDatas, levelIndexOffset + idx * 24U + 8U);
+        const auto& level = m_Levels[idx];
+        if (byteLength != level.size || byteOffset > vSize || byteLength > vSize - byteOffset) {
+            LogVarError("the KTX2 level %u is not valid", idx);
+            Clear();
+            return false;
+        }
+        memcpy(m_Datas.data() + level.offset, vDatas + byteOffset, (size_t)byteLength);
+    }
+    return true;
+}
+
+bool TextureContainer::LoadDdsFromMemory(const uint8_t* vDatas, const size_t& vSize) {
+    ZoneScoped;
+    Clear();
+    // magic (4) + header (124)
+    if (vDatas == nullptr || vSize < 128U || ReadValue<uint32_t>(vDatas, 0U) != s_DdsMagic || ReadValue<uint32_t>(vDatas, 4U) != 124U) {
+        LogVarError("%s", "not a DDS file");
+        return false;
+    }
+    const auto flags = ReadValue<uint32_t>(vDatas, 8U);
+    const auto height = ReadValue<uint32_t>(vDatas, 12U);
+    const auto width = ReadValue<uint32_t>(vDatas, 16U);
+    const auto depth = ReadValue<uint32_t>(vDatas, 24U);
+    const auto mipMapCount = ReadValue<uint32_t>(vDatas, 28U);
+    const auto caps2 = ReadValue<uint32_t>(vDatas, 112U);
+    const uint8_t* pixelFormat = vDatas + 76U;
+
+    size_t dataOffset = 128U;
+    bool isVolume = ((caps2 & 0x200000U) != 0U);  // DDSCAPS2_VOLUME
+    bool isCube = ((caps2 & 0x200U) != 0U);       // DDSCAPS2_CUBEMAP
+    uint32_t layersCount = 1U;
+    const bool hasDx10Header = (ReadValue<uint32_t>(pixelFormat, 8U) == MakeFourCC('D', 'X', '1', '0'));
+    if (hasDx10Header) {
+        if (vSize < 148U) {
+            LogVarError("%s", "the DDS DX10 header is truncated");
+            return false;
+        }
+        m_Format = GetFormatFromDxgi(ReadValue<uint32_t>(vDatas, 128U));
+        isVolume = (ReadValue<uint32_t>(vDatas, 132U) == 4U);         // D3D10_RESOURCE_DIMENSION_TEXTURE3D
+        isCube = ((ReadValue<uint32_t>(vDatas, 136U) & 0x4U) != 0U);  // D3D10_RESOURCE_MISC_TEXTURECUBE
+        layersCount = ez::maxi(ReadValue<uint32_t>(vDatas, 140U), 1U);
+        dataOffset = 148U;
+    } else {
+        m_Format = GetFormatFromDdsPixelFormat(pixelFormat);
+    }
+    if (m_Format == vk::Format::eUndefined) {
+        LogVarError("%s", "the DDS pixel format is not supported");
+        return false;
+    }
+    if (!hasDx10Header && isCube && !isVolume && (caps2 & 0xFC00U) != 0xFC00U) {
+        LogVarError("%s", "the DDS cube maps without all the faces are not supported");
+        Clear();
+        return false;
+    }
+    if (width == 0U || height == 0U) {
+        LogVarError("%s", "the DDS header is not valid");
+        Clear();
+        return false;
+    }
+    m_Width = width;
+    m_Height = height;
+    m_Depth = isVolume ? ez::maxi(depth, 1U) : 1U;
+    m_LayersCount = layersCount;
+    m_FacesCount = (isCube && !isVolume) ? 6U : 1U;
+    uint32_t levels = (flags & 0x20000U) ? ez::maxi(mipMapCount, 1U) : 1U;  // DDSD_MIPMAPCOUNT
+    levels = ez::mini(levels, GetMaxLevelsCount(m_Width, m_Height, m_Depth));
+    if (!PrepareLevels(levels, vSize - dataOffset)) {
+        LogVarError("%s", "the DDS datas are greater than the file");
+        Clear();
+        return false;
+    }
+
+    // the dds order is image by image (layer then face), and in an image mip by mip
+    size_t cursor = dataOffset;
+    const uint64_t imagesCount = (uint64_t)m_LayersCount * m_FacesCount;
+    for (uint64_t image = 0U; image < imagesCount; ++image) {
+        for (uint32_t idx = 0U; idx < levels; ++idx) {
+            const auto& level = m_Levels[idx];
+            const auto imageSize = GetImageSize(level.width, level.height, level.depth);
+            if (imageSize > vSize - cursor) {
+                LogVarError("%s", "the DDS datas are truncated");
+                Clear();
+                return false;
+            }
+            memcpy(m_Datas.data() + level.offset + image * imageSize, vDatas + cursor, (size_t)imageSize);
+            cursor += (size_t)imageSize;
+        }
+    }
+    return true;
+}
+
+bool TextureContainer::Allocate(const vk::Format& vFormat,
+    const uint32_t& vWidth,
+    const uint32_t& vHeight,
+    const uint32_t& vDepth,
+    const uint32_t& vLayersCount,
+    const uint32_t& vFacesCount,
+    const uint32_t& vLevelsCount,
+    const uint64_t& vMaxDatasSize) {
+    ZoneScoped;
+    Clear();
+    if (GetFormatInfos(vFormat).bytesPerBlock == 0U || vWidth == 0U || vHeight == 0U) {
+        return false;
+    }
+    m_Format = vFormat;
+    m_Width = vWidth;
+    m_Height = vHeight;
+    m_Depth = ez::maxi(vDepth, 1U);
+    m_LayersCount = ez::maxi(vLayersCount, 1U);
+    m_FacesCount = ez::maxi(vFacesCount, 1U);
+    const uint32_t levels = ez::mini(ez::maxi(vLevelsCount, 1U), GetMaxLevelsCount(m_Width, m_Height, m_Depth));
+    if (!PrepareLevels(levels, vMaxDatasSize)) {
+        Clear();
+        return false;
+    }
+    return true;
+}
+
+void TextureContainer::Clear() {
+    m_Format = vk::Format::eUndefined;
+    m_Width = 0U;
+    m_Height = 0U;
+    m_Depth = 1U;
+    m_LayersCount = 1U;
+    m_FacesCount = 1U;
+    m_Levels.clear();
+    m_Datas.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// DECOMPRESSION ///////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TextureContainer::DecompressToRgba8() {
+    ZoneScoped;
+    BlockTexels texels = {};
+    const std::array<uint8_t, 16U> emptyBlock = {};
+    if (!IsLoaded() || !DecodeBlock(m_Format, emptyBlock.data(), texels)) {  // check if the format can be decoded
+        return false;
+    }
+    const bool isSrgb = (m_Format == vk::Format::eBc1RgbSrgbBlock || m_Format == vk::Format::eBc1RgbaSrgbBlock ||  //
+                         m_Format == vk::Format::eBc2SrgbBlock || m_Format == vk::Format::eBc3SrgbBlock);
+    const auto infos = GetFormatInfos(m_Format);
+
+    TextureContainer res;
+    res.m_Format = isSrgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+    res.m_Width = m_Width;
+    res.m_Height = m_Height;
+    res.m_Depth = m_Depth;
+    res.m_LayersCount = m_LayersCount;
+    res.m_FacesCount = m_FacesCount;
+    if (!res.PrepareLevels(GetLevelsCount(), UINT64_MAX)) {
+        return false;
+    }
+
+    const uint32_t imagesCount = m_LayersCount * m_FacesCount;
+    for (size_t idx = 0U; idx < m_Levels.size(); ++idx) {
+        const auto& level = m_Levels[idx];
+        const uint32_t blocksX = (level.width + infos.blockWidth - 1U) / infos.blockWidth;
+        const uint32_t blocksY = (level.height + infos.blockHeight - 1U) / infos.blockHeight;
+        const uint64_t srcSliceSize = (uint64_t)blocksX * blocksY * infos.bytesPerBlock;
+        const uint64_t dstSliceSize = (uint64_t)level.width * level.height * 4U;
+        for (uint64_t slice = 0U; slice < (uint64_t)imagesCount * level.depth; ++slice) {
+            const uint8_t* src = m_Datas.data() + level.offset + slice * srcSliceSize;
+            uint8_t* dst = res.m_Datas.data() + res.m_Levels[idx].offset + slice * dstSliceSize;
+            for (uint32_t by = 0U; by < blocksY; ++by) {
+                for (uint32_t bx = 0U; bx < blocksX; ++bx) {
+                    DecodeBlock(m_Format, src + ((uint64_t)by * blocksX + bx) * infos.bytesPerBlock, texels);
+                    for (uint32_t ty = 0U; ty < 4U; ++ty) {
+                        for (uint32_t tx = 0U; tx < 4U; ++tx) {
+                            const uint32_t x = bx * 4U + tx;
+                            const uint32_t y = by * 4U + ty;
+                            if (x < level.width && y < level.height) {
+                                memcpy(dst + ((uint64_t)y * level.width + x) * 4U, texels[ty * 4U + tx].data(), 4U);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    *this = std::move(res);
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// GETTERS /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TextureContainer::IsLoaded() const {
+    return (m_Format != vk::Format::eUndefined && !m_Levels.empty());
+}
+
+vk::Format TextureContainer::GetFormat() const {
+    return m_Format;
+}
+
+uint32_t TextureContainer::GetWidth() const {
+    return m_Width;
+}
+
+uint32_t TextureContainer::GetHeight() const {
+    return m_Height;
+}
+
+uint32_t TextureContainer::GetDepth() const {
+    return m_Depth;
+}
+
+uint32_t TextureContainer::GetLayersCount() const {
+    return m_LayersCount;
+}
+
+uint32_t TextureContainer::GetFacesCount() const {
+    return m_FacesCount;
+}
+
+uint32_t TextureContainer::GetLevelsCount() const {
+    return static_cast<uint32_t>(m_Levels.size());
+}
+
+const std::vector<TextureContainer::Level>& TextureContainer::GetLevels() const {
+    return m_Levels;
+}
+
+const std::vector<uint8_t>& TextureContainer::GetDatas() const {
+    return m_Datas;
+}
+
+uint8_t* TextureContainer::GetWritableDatas() {
+    return m_Datas.data();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TextureContainer::GetImageSize(const uint32_t& vWidth, const uint32_t& vHeight, const uint32_t& vDepth) const {
+    const auto infos = GetFormatInfos(m_Format);
+    const uint64_t blocksX = (vWidth + infos.blockWidth - 1U) / infos.blockWidth;
+    const uint64_t blocksY = (vHeight + infos.blockHeight - 1U) / infos.blockHeight;
+    return SaturatedMul(SaturatedMul(SaturatedMul(blocksX, blocksY), vDepth), infos.bytesPerBlock);
+}
+
+uint64_t TextureContainer::GetDatasSize(const uint32_t& vLevelsCount) const {
+    const uint64_t imagesCount = (uint64_t)m_LayersCount * m_FacesCount;
+    uint64_t offset = 0U;
+    for (uint32_t idx = 0U; idx < vLevelsCount; ++idx) {
+        const auto imageSize = GetImageSize(ez::maxi(m_Width >> idx, 1U), ez::maxi(m_Height >> idx, 1U), ez::maxi(m_Depth >> idx, 1U));
+        offset = SaturatedAdd(AlignOffset(offset, 16U), SaturatedMul(imageSize, imagesCount));
+        if (offset == UINT64_MAX) {
+            break;
+        }
+    }
+    return offset;
+}
+
+bool TextureContainer::PrepareLevels(const uint32_t& vLevelsCount, const uint64_t& vMaxDatasSize) {
+    // the shifts below are only defined for less than 32 levels
+    if (vLevelsCount == 0U || vLevelsCount > GetMaxLevelsCount(m_Width, m_Height, m_Depth)) {
+        return false;
+    }
+    const auto datasSize = GetDatasSize(vLevelsCount);
+    if (datasSize > vMaxDatasSize || datasSize > (uint64_t)SIZE_MAX) {
+        return false;
+    }
+    m_Levels.resize(vLevelsCount);
+    uint64_t offset = 0U;
+    for (uint32_t idx = 0U; idx < vLevelsCount; ++idx) {
+        auto& level = m_Levels[idx];
+        level.width = ez::maxi(m_Width >> idx, 1U);
+        level.height = ez::maxi(m_Height >> idx, 1U);
+        level.depth = ez::maxi(m_Depth >> idx, 1U);
+        level.offset = AlignOffset(offset, 16U);  // multiple of the block size and of 4 for vkCmdCopyBufferToImage
+        level.size = GetImageSize(level.width, level.height, level.depth) * m_LayersCount * m_FacesCount;
+        offset = level.offset + level.size;
+    }
+    m_Datas.resize((size_t)offset);
+    return true;
+}
@@ -18,8 +18,13 @@ limitations under the License.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <Gaia/Resources/TextureCube.h>
+#include <Gaia/Resources/TextureContainer.h>
+#include <Gaia/Resources/Texture2D.h>
+#include <Gaia/Core/VulkanCommandBuffer.h>
 #include <ezlibs/ezLog.hpp>
 
+#include <future>
+
 #ifdef STB_IMAGE_INCLUDE
 #include STB_IMAGE_INCLUDE
 #endif  // STB_IMAGE_INCLUDE
@@ -143,12 +148,59 @@ width, const uint32_t& height, const uint32_t& channels)
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-TextureCubePtr TextureCube::CreateFromFiles(GaiApi::VulkanCoreWeak vVulkanCore, std::array<std::string, 6U> vFilePathNames) {
+TextureCubePtr TextureCube::CreateFromFiles(
+    GaiApi::VulkanCoreWeak vVulkanCore, std::array<std::string, 6U> vFilePathNames, const uint32_t& vMipLevelCount) {
+    ZoneScoped;
+
+    auto res = std::make_shared<TextureCube>(vVulkanCore);
+
+    if (!res->LoadFiles(vFilePathNames, vk::Format::eR8G8B8A8Unorm, vMipLevelCount)) {
+        res.reset();
+    }
+
+    return res;
+}
+
+TextureCubePtr TextureCube::CreateFromFile(GaiApi::VulkanCoreWeak vVulkanCore, const std::string& vFilePathName) {
+    ZoneScoped;
+
+    if (vVulkanCore.expired())
+        return nullptr;
+    auto res = std::make_shared<TextureCube>(vVulkanCore);
+
+    if (!res->LoadContainerFile(vFilePathName)) {
+        res.reset();
+    }
+
+    return res;
+}
+
+TextureCubePtr TextureCube::CreateFromEquirectangularFile(
+    GaiApi::VulkanCoreWeak vVulkanCore, const std::string& vFilePathName, const uint32_t& vFaceSize, const bool& vConvolve) {
     ZoneScoped;
 
+    if (vVulkanCore.expired())
+        return nullptr;
+
+    // all the mips of the source are needed by the filtered importance sampling of the convolution
+    auto sourcePtr = std::make_shared<Texture2D>(vVulkanCore);
+    if (!sourcePtr->LoadFile(vFilePathName, vk::Format::eUndefined, UINT32_MAX))
+        return nullptr;
+
     auto res = std::make_shared<TextureCube>(vVulkanCore);
 
-    if (!res->LoadFiles(vFilePathNames)) {
+    auto cmd = VulkanCommandBuffer::beginSingleTimeCommands(vVulkanCore, true);
+    const bool isok = res->LoadFiltered(cmd,
+        sourcePtr->m_DescriptorImageInfo,
+        VulkanCubeFilter::SourceType::Equirectangular,
+        sourcePtr->m_Width,
+        vFaceSize,
+        vk::Format::eR16G16B16A16Sfloat,
+        vConvolve);
+    // the command is waited, so the source can be destroyed after
+    VulkanCommandBuffer::flushSingleTimeCommands(vVulkanCore, cmd, true);
+
+    if (!isok) {
         res.reset();
     }
 
@@ -241,20 +293,43 @@ bool TextureCube::LoadFiles(const std::array<std::string, 6U>& vFilePathNames, c
 
     if (isok) {
         Destroy();
-        std::array<std::vector<uint8_t>, 6U> buffers;
 
-        uint32_t channels = 4;
+        // the 6 faces are decoded in parallel
+        struct FaceImage {
+            std::vector<uint8_t> buffer;
+            uint32_t width = 0U;
+            uint32_t height = 0U;
+            uint32_t channels = 0U;
+            bool loaded = false;
+        };
+        std::array<std::future<FaceImage>, 6U> faceFutures;
         for (size_t idx = 0U; idx < 6U; ++idx) {
-            std::vector<uint8_t> image_data;
-            if (!loadImage(vFilePathNames[idx], image_data, m_Width, m_Height, channels))
-                return false;
-            { buffers[idx] = image_data; }
+            faceFutures[idx] = std::async(std::launch::async, [filePathName = vFilePathNames[idx]]() {
+                FaceImage face;
+                face.loaded = loadImage(filePathName, face.buffer, face.width, face.height, face.channels);
+                return face;
+            });
+        }
 
-            if (m_Width == 0 || m_Height == 0)
-                return false;
+        std::array<std::vector<uint8_t>, 6U> buffers;
+        for (size_t idx = 0U; idx < 6U; ++idx) {
+            auto face = faceFutures[idx].get();
+            if (!face.loaded || face.width == 0 || face.height == 0) {
+                isok = false;
+            } else if (idx == 0U) {
+                m_Width = face.width;
+                m_Height = face.height;
+            } else if (face.width != m_Width || face.height != m_Height) {
+                LogVarError("the size of the cube face %s is not the size of the first face", vFilePathNames[idx].c_str());
+                isok = false;
+            }
+            buffers[idx] = std::move(face.buffer);
         }
 
-        LoadMemories(buffers, m_Width, m_Height, channels, vFormat, vMipLevelCount);
+        // the faces are expanded in rgba8 by loadImage
+        if (isok) {
+            LoadMemories(buffers, m_Width, m_Height, 4U, vFormat, vMipLevelCount);
+        }
     }
 
     return m_Loaded;
@@ -268,8 +343,6 @@ bool TextureCube::LoadMemories(const std::array<std::vector<uint8_t>, 6U>& buffe
     const uint32_t& vMipLevelCount) {
     ZoneScoped;
 
-    auto corePtr = m_VulkanCore.lock();
-    assert(corePtr != nullptr);
     m_Loaded = false;
 
     if (width == 0 || height == 0 || channels == 0)
@@ -293,38 +366,9 @@ bool TextureCube::LoadMemories(const std::array<std::vector<uint8_t>, 6U>& buffe
 
         m_TextureCubePtr = VulkanRessource::createTextureImageCube(m_VulkanCore, m_Width, m_Height, m_MipLevelCount, vFormat, buffers, "TextureCube");
         if (m_TextureCubePtr) {
-            vk::ImageViewCreateInfo imViewInfo = {};
-            imViewInfo.flags = vk::ImageViewCreateFlags();
-            imViewInfo.image = m_TextureCubePtr->image;
-            imViewInfo.viewType = vk::ImageViewType::eCube;
-            imViewInfo.format = vFormat;
-            imViewInfo.components = vk::ComponentMapping();
-            imViewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, m_MipLevelCount, 0U, 6U);
-            m_TextureView = corePtr->getDevice().createImageView(imViewInfo);
-
-            vk::SamplerCreateInfo samplerInfo = {};
-            samplerInfo.flags = vk::SamplerCreateFlags();
-            samplerInfo.magFilter = vk::Filter::eLinear;
-            samplerInfo.minFilter = vk::Filter::eLinear;
-            samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
-            samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;  // U
-            samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;  // V
-            samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;  // W
-            samplerInfo.mipLodBias = 0.0f;
-            // samplerInfo.anisotropyEnable = false;
-            // samplerInfo.maxAnisotropy = 0.0f;
-            // samplerInfo.compareEnable = false;
-            // samplerInfo.compareOp = vk::CompareOp::eAlways;
-            samplerInfo.minLod = 0.0f;
-            samplerInfo.maxLod = static_cast<float>(m_MipLevelCount);
-            // samplerInfo.unnormalizedCoordinates = false;
-            m_Sampler = corePtr->getDevice().createSampler(samplerInfo);
-
-            m_DescriptorImageInfo.sampler = m_Sampler;
-            m_DescriptorImageInfo.imageView = m_TextureView;
-            m_DescriptorImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-
-            m_Ratio = (float)m_Width / (float)m_Height;
+            m_ImageFormat = vFormat;
+
+            CreateViewAndSampler(vFormat);
 
             m_Loaded = true;
         }
@@ -333,6 +377,131 @@ bool TextureCube::LoadMemories(const std::array<std::vector<uint8_t>, 6U>& buffe
     return m_Loaded;
 }
 
+bool TextureCube::LoadContainerFile(const std::string& vFilePathName) {
+    ZoneScoped;
+
+    Destroy();
+
+    TextureContainer container;
+    if (!container.LoadFile(vFilePathName))
+        return false;
+
+    if (container.GetFacesCount() != 6U || container.GetLayersCount() != 1U || container.GetDepth() != 1U) {
+        LogVarError("the texture file %s is not a cube map", vFilePathName.c_str());
+        return false;
+    }
+
+    m_TextureCubePtr = VulkanRessource::createTextureImageFromContainer(m_VulkanCore, container, "TextureCube");
+    if (!m_TextureCubePtr)
+        return false;
+
+    m_Width = container.GetWidth();
+    m_Height = container.GetHeight();
+    m_MipLevelCount = container.GetLevelsCount();
+    m_ImageFormat = container.GetFormat();
+
+    CreateViewAndSampler(m_ImageFormat);
+
+    m_Loaded = true;
+
+    return m_Loaded;
+}
+
+bool TextureCube::LoadFiltered(vk::CommandBuffer vCmd,
+    const vk::DescriptorImageInfo& vSource,
+    const VulkanCubeFilter::SourceType& vSourceType,
+    const uint32_t& vSourceSize,
+    const uint32_t& vFaceSize,
+    const vk::Format& vFormat,
+    const bool& vConvolve) {
+    ZoneScoped;
+
+    Destroy();
+
+    if (!vCmd || !vFaceSize)
+        return false;
+
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    auto filterPtr = corePtr->getCubeFilter().lock();
+    if (!filterPtr || !filterPtr->IsFormatSupported(vFormat)) {
+        LogVarError("the cube filter cant write the format %s", vk::to_string(vFormat).c_str());
+        return false;
+    }
+
+    m_Width = vFaceSize;
+    m_Height = vFaceSize;
+    m_MipLevelCount = GetMiplevelCount(m_Width, m_Height);
+
+    m_TextureCubePtr = VulkanRessource::createStorageTextureCube(m_VulkanCore, vFaceSize, m_MipLevelCount, vFormat, "TextureCube");
+    if (!m_TextureCubePtr)
+        return false;
+
+    if (!filterPtr->RecordCubeMap(vCmd,
+            vSource,
+            vSourceType,
+            vSourceSize,
+            m_TextureCubePtr->image,
+            vFormat,
+            vFaceSize,
+            m_MipLevelCount,
+            vConvolve,
+            vk::ImageLayout::eUndefined,
+            vk::ImageLayout::eShaderReadOnlyOptimal)) {
+        m_TextureCubePtr.reset();
+        return false;
+    }
+
+    m_ImageFormat = vFormat;
+
+    CreateViewAndSampler(m_ImageFormat);
+
+    m_Loaded = true;
+
+    return m_Loaded;
+}
+
+void TextureCube::CreateViewAndSampler(const vk::Format& vFormat) {
+    ZoneScoped;
+
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    vk::ImageViewCreateInfo imViewInfo = {};
+    imViewInfo.flags = vk::ImageViewCreateFlags();
+    imViewInfo.image = m_TextureCubePtr->image;
+    imViewInfo.viewType = vk::ImageViewType::eCube;
+    imViewInfo.format = vFormat;
+    imViewInfo.components = vk::ComponentMapping();
+    imViewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, m_MipLevelCount, 0U, 6U);
+    m_TextureView = corePtr->getDevice().createImageView(imViewInfo);
+
+    vk::SamplerCreateInfo samplerInfo = {};
+    samplerInfo.flags = vk::SamplerCreateFlags();
+    samplerInfo.magFilter = vk::Filter::eLinear;
+    samplerInfo.minFilter = vk::Filter::eLinear;
+    samplerInfo.mipmapMode = vk::SamplerMipmapMode::eLinear;
+    samplerInfo.addressModeU = vk::SamplerAddressMode::eClampToEdge;  // U
+    samplerInfo.addressModeV = vk::SamplerAddressMode::eClampToEdge;  // V
+    samplerInfo.addressModeW = vk::SamplerAddressMode::eClampToEdge;  // W
+    samplerInfo.mipLodBias = 0.0f;
+    // samplerInfo.anisotropyEnable = false;
+    // samplerInfo.maxAnisotropy = 0.0f;
+    // samplerInfo.compareEnable = false;
+    // samplerInfo.compareOp = vk::CompareOp::eAlways;
+    samplerInfo.minLod = 0.0f;
+    samplerInfo.maxLod = static_cast<float>(m_MipLevelCount);
+    // samplerInfo.unnormalizedCoordinates = false;
+    m_Sampler = corePtr->getDevice().createSampler(samplerInfo);
+
+    m_DescriptorImageInfo.sampler = m_Sampler;
+    m_DescriptorImageInfo.imageView = m_TextureView;
+    m_DescriptorImageInfo.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+
+    m_Ratio = (float)m_Width / (float)m_Height;
+}
+
 bool TextureCube::LoadEmptyTexture(const ez::uvec2& vSize, const vk::Format& vFormat) {
     ZoneScoped;
 
@@ -0,0 +1,256 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Resources/TextureDiskCache.h>
+#include <Gaia/Resources/TextureContainer.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <cstdio>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <filesystem>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr const char* s_EntryExtension = ".gtxc";
+constexpr uint64_t s_DatasAlignment = 16U;
+
+uint64_t HashKey(const std::string& vKey) {
+    uint64_t res = 14695981039346656037ULL;  // FNV-1a
+    for (const auto& c : vKey) {
+        res ^= (uint8_t)c;
+        res *= 1099511628211ULL;
+    }
+    return res;
+}
+
+template <typename T>
+void WriteValue(std::ofstream& vFile, const T& vValue) {
+    vFile.write((const char*)&vValue, sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(std::ifstream& vFile, T& vOutValue) {
+    vFile.read((char*)&vOutValue, sizeof(T));
+    return (vFile.gcount() == (std::streamsize)sizeof(T));
+}
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TextureDiskCachePtr TextureDiskCache::Create(const std::string& vDirectory) {
+    ZoneScoped;
+    auto res = std::make_shared<TextureDiskCache>();
+    if (!res->Init(vDirectory)) {
+        res.reset();
+    }
+    return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// INIT ////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TextureDiskCache::Init(const std::string& vDirectory) {
+    ZoneScoped;
+    if (vDirectory.empty()) {
+        return false;
+    }
+    std::error_code ec;
+    fs::create_directories(vDirectory, ec);
+    if (!fs::is_directory(vDirectory, ec)) {
+        LogVarError("Fail to create the texture cache directory %s", vDirectory.c_str());
+        return false;
+    }
+    m_Directory = vDirectory;
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// ENTRIES /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string TextureDiskCache::GetKey(const std::string& vSourceFilePathName, const std::string& vLoadOptions) const {
+    ZoneScoped;
+    std::error_code ec;
+    const auto path = fs::absolute(vSourceFilePathName, ec);
+    if (ec || !fs::is_regular_file(path, ec)) {
+        return {};
+    }
+    const auto size = fs::file_size(path, ec);
+    if (ec) {
+        return {};
+    }
+    const auto time = fs::last_write_time(path, ec);
+    if (ec) {
+        return {};
+    }
+    const auto ticks = (long long)time.time_since_epoch().count();
+    return path.generic_string() + "|" + std::to_string(ticks) + "|" + std::to_string(size) + "|" + vLoadOptions;
+}
+
+bool TextureDiskCache::Load(const std::string& vKey, TextureContainer& vOutContainer) {
+    ZoneScoped;
+    if (vKey.empty()) {
+        return false;
+    }
+    std::ifstream file(GetEntryFilePathName(vKey), std::ios::binary);
+    if (!file.is_open()) {
+        ++m_MissesCount;
+        return false;
+    }
+    uint32_t magic = 0U, version = 0U, keySize = 0U;
+    if (!ReadValue(file, magic) || magic != s_Magic || !ReadValue(file, version) || version != s_Version || !ReadValue(file, keySize) ||
+        keySize != vKey.size()) {
+        ++m_MissesCount;
+        return false;
+    }
+    std::string key(keySize, '\0');
+    file.read(&key[0], keySize);
+    if (key != vKey) {  // collision of the hash
+        ++m_MissesCount;
+        return false;
+    }
+    uint32_t format = 0U, width = 0U, height = 0U, depth = 0U, layers = 0U, faces = 0U, levels = 0U;
+    uint64_t datasSize = 0U;
+    if (!ReadValue(file, format) || !ReadValue(file, width) || !ReadValue(file, height) || !ReadValue(file, depth) || !ReadValue(file, layers) ||
+        !ReadValue(file, faces) || !ReadValue(file, levels) || !ReadValue(file, datasSize)) {
+        ++m_MissesCount;
+        return false;
+    }
+    // the header is checked against the real length of the file before anything is allocated
+    const auto datasOffset = (((uint64_t)file.tellg() + s_DatasAlignment - 1U) / s_DatasAlignment) * s_DatasAlignment;
+    file.seekg(0, std::ios::end);
+    const auto fileSize = (uint64_t)file.tellg();
+    if (datasOffset > fileSize || datasSize != fileSize - datasOffset || levels > TextureContainer::GetMaxLevelsCount(width, height, depth) ||
+        !vOutContainer.Allocate(static_cast<vk::Format>(format), width, height, depth, layers, faces, levels, datasSize) ||
+        vOutContainer.GetDatas().size() != datasSize) {
+        LogVarError("the texture cache entry of %s is not valid", vKey.c_str());
+        vOutContainer.Clear();
+        ++m_MissesCount;
+        return false;
+    }
+    file.seekg((std::streamoff)datasOffset, std::ios::beg);
+    file.read((char*)vOutContainer.GetWritableDatas(), (std::streamsize)datasSize);
+    if (file.gcount() != (std::streamsize)datasSize) {
+        LogVarError("the texture cache entry of %s is truncated", vKey.c_str());
+        vOutContainer.Clear();
+        ++m_MissesCount;
+        return false;
+    }
+    ++m_HitsCount;
+    return true;
+}
+
+bool TextureDiskCache::Store(const std::string& vKey, const TextureContainer& vContainer) const {
+    ZoneScoped;
+    if (vKey.empty() || !vContainer.IsLoaded()) {
+        return false;
+    }
+    const auto filePathName = GetEntryFilePathName(vKey);
+    // written in a temporary file then renamed, so an entry is never read partially written
+    // the temporary file is unique, two threads can store the same entry at the same time
+    static std::atomic<uint64_t> s_TmpFilesCounter = {0U};
+    const auto tmpFilePathName = filePathName + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "." +
+        std::to_string(++s_TmpFilesCounter) + ".tmp";
+    {
+        std::ofstream file(tmpFilePathName, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            LogVarError("Fail to write the texture cache file %s", tmpFilePathName.c_str());
+            return false;
+        }
+        const auto& datas = vContainer.GetDatas();
+        WriteValue(file, s_Magic);
+        WriteValue(file, s_Version);
+        WriteValue(file, (uint32_t)vKey.size());
+        file.write(vKey.data(), vKey.size());
+        WriteValue(file, static_cast<uint32_t>(vContainer.GetFormat()));
+        WriteValue(file, vContainer.GetWidth());
+        WriteValue(file, vContainer.GetHeight());
+        WriteValue(file, vContainer.GetDepth());
+        WriteValue(file, vContainer.GetLayersCount());
+        WriteValue(file, vContainer.GetFacesCount());
+        WriteValue(file, vContainer.GetLevelsCount());
+        WriteValue(file, (uint64_t)datas.size());
+        const auto headerSize = (uint64_t)file.tellp();
+        const auto datasOffset = ((headerSize + s_DatasAlignment - 1U) / s_DatasAlignment) * s_DatasAlignment;
+        const char padding[s_DatasAlignment] = {};
+        file.write(padding, (std::streamsize)(datasOffset - headerSize));
+        file.write((const char*)datas.data(), (std::streamsize)datas.size());
+        if (!file.good()) {
+            LogVarError("Fail to write the texture cache file %s", tmpFilePathName.c_str());
+            file.close();
+            std::remove(tmpFilePathName.c_str());
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmpFilePathName, filePathName, ec);
+    if (ec) {
+        std::remove(tmpFilePathName.c_str());
+        return false;
+    }
+    return true;
+}
+
+void TextureDiskCache::Clear() const {
+    ZoneScoped;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(m_Directory, ec)) {
+        if (entry.path().extension() == s_EntryExtension) {
+            fs::remove(entry.path(), ec);
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// GETTERS /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t TextureDiskCache::GetHitsCount() const {
+    return m_HitsCount;
+}
+
+uint32_t TextureDiskCache::GetMissesCount() const {
+    return m_MissesCount;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::string TextureDiskCache::GetEntryFilePathName(const std::string& vKey) const {
+    char hash[17] = {};
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)HashKey(vKey));
+    return (fs::path(m_Directory) / (std::string(hash) + s_EntryExtension)).string();
+}
@@ -2,6 +2,7 @@
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <Gaia/Resources/UniformBlockStd140.h>
+#include <Gaia/Resources/VulkanUniformArena.h>
 
 #ifdef PROFILER_INCLUDE
 #include <vulkan/vulkan.hpp>
@@ -20,9 +21,42 @@ UniformBlockStd140::~UniformBlockStd140() {
 
 bool UniformBlockStd140::Build() {
     ZoneScoped;
+    if (useLayoutOptimizer && !layoutWasOptimized) {
+        const auto startOffset = (uint32_t)datas.size();
+        const auto members = layoutOptimizer.Optimize(startOffset, true);
+        if (!members.empty()) {
+            datas.resize(startOffset + layoutOptimizer.GetOptimizedSize());
+            for (const auto& member : members) {
+                memcpy(datas.data() + member.offset, member.value.data(), member.size);
+                AddOffsetForKey(member.key, member.offset);
+            }
+            SetDirty();
+            LogVarLightInfo("UniformBlockStd140 %s : %u bytes in declaration order, %u bytes after layout optimization (%u bytes of padding saved)",
+                layoutBlockName.c_str(), layoutOptimizer.GetDeclarationOrderSize(), layoutOptimizer.GetOptimizedSize(), GetLayoutSavedBytes());
+        }
+        layoutWasOptimized = true;
+    }
     return true;
 }
 
+void UniformBlockStd140::UseLayoutOptimizer(const std::string& vBlockName) {
+    ZoneScoped;
+    useLayoutOptimizer = true;
+    layoutBlockName = vBlockName;
+}
+
+uint32_t UniformBlockStd140::GetLayoutSavedBytes() const {
+    if (layoutOptimizer.GetDeclarationOrderSize() > layoutOptimizer.GetOptimizedSize()) {
+        return layoutOptimizer.GetDeclarationOrderSize() - layoutOptimizer.GetOptimizedSize();
+    }
+    return 0U;
+}
+
+std::string UniformBlockStd140::GetGlslBlockDeclaration(const std::string& vLayoutQualifiers, const std::string& vBlockName, const std::string& vInstanceName) {
+    ZoneScoped;
+    return layoutOptimizer.GetGlslBlockDeclaration(vLayoutQualifiers, vBlockName, vInstanceName, offsets);
+}
+
 void UniformBlockStd140::Unit() {
     ZoneScoped;
     DestroyUBO();
@@ -34,12 +68,17 @@ void UniformBlockStd140::Clear() {
     descriptorBufferInfo = vk::DescriptorBufferInfo{VK_NULL_HANDLE, 0, VK_WHOLE_SIZE};
     datas.clear();
     offsets.clear();
+    layoutOptimizer.Clear();
+    layoutWasOptimized = false;
+    for (auto& ranges : frameDirtyRanges) {
+        ranges.Clear();
+    }
     isDirty = false;
 }
 
 void UniformBlockStd140::SetDirty() {
     ZoneScoped;
-    isDirty = true;
+    SetDirtyRange(0U, (uint32_t)datas.size());
 }
 
 void UniformBlockStd140::UseCustomBufferInfo() {
@@ -55,11 +94,73 @@ void UniformBlockStd140::SetCustomBufferInfo(vk::DescriptorBufferInfo* vBufferOb
     }
 }
 
+void UniformBlockStd140::UseUniformArena() {
+    ZoneScoped;
+    useUniformArena = true;
+}
+
+bool UniformBlockStd140::IsUsingUniformArena() const {
+    return useUniformArena;
+}
+
+void UniformBlockStd140::UsePushConstants() {
+    ZoneScoped;
+    usePushConstants = true;
+}
+
+bool UniformBlockStd140::IsUsingPushConstants() const {
+    return usePushConstants;
+}
+
+const uint8_t* UniformBlockStd140::GetDatas() const {
+    return datas.data();
+}
+
+uint32_t UniformBlockStd140::GetDatasSize() const {
+    return (uint32_t)datas.size();
+}
+
 void UniformBlockStd140::Upload(GaiApi::VulkanCoreWeak vVulkanCore, bool vOnlyIfDirty) {
     ZoneScoped;
-    if (!vOnlyIfDirty || (vOnlyIfDirty && isDirty)) {
+    if (usePushConstants) {
+        // nothing to upload, the datas are pushed at record time
+        for (auto& ranges : frameDirtyRanges) {
+            ranges.Clear();
+        }
+        isDirty = false;
+        return;
+    }
+    if (useUniformArena) {
+        // the arena region is reseted each frame, so the block must be pushed at least one time by frame
+        auto arenaPtr = uniformArena.lock();
+        if (arenaPtr && !customBufferInfo) {
+            if (!vOnlyIfDirty || isDirty || uniformArenaFrameCounter != arenaPtr->GetFrameCounter()) {
+                if (arenaPtr->Push(datas.data(), (uint32_t)datas.size(), dynamicOffset)) {
+                    descriptorBufferInfo.buffer = arenaPtr->GetBuffer();
+                } else if (!UploadInArenaFallbackBuffer(vVulkanCore)) {
+                    return;  // stay dirty, the offset of the previous frame must not be used with the reseted arena
+                }
+                uniformArenaFrameCounter = arenaPtr->GetFrameCounter();
+                for (auto& ranges : frameDirtyRanges) {
+                    ranges.Clear();
+                }
+                isDirty = false;
+            }
+        }
+        return;
+    }
+    if (!vOnlyIfDirty) {
+        SetDirty();
+    }
+    if (isDirty) {
         if (bufferObjectPtr && !customBufferInfo) {
-            VulkanRessource::upload(vVulkanCore, bufferObjectPtr, datas.data(), datas.size());
+            // the slots of the other frames in flight can be in use by the gpu
+            currentFrameSlot = GetFrameSlot(vVulkanCore);
+            const uint32_t slotOffset = currentFrameSlot * frameSlotSize;
+            VulkanRessource::uploadRanges(vVulkanCore, bufferObjectPtr, datas.data(), frameDirtyRanges[currentFrameSlot], slotOffset);
+            // the descriptor point on the pointer of descriptorBufferInfo
+            // so the new offset will be used at the next descriptor update
+            descriptorBufferInfo.offset = slotOffset;
         }
         isDirty = false;
     }
@@ -67,6 +168,7 @@ void UniformBlockStd140::Upload(GaiApi::VulkanCoreWeak vVulkanCore, bool vOnlyIf
 
 bool UniformBlockStd140::CreateUBO(GaiApi::VulkanCoreWeak vVulkanCore) {
     ZoneScoped;
+    Build();  // place the vars if the layout optimizer is used
     if (customBufferInfo) {
         if (!descriptorBufferInfo.buffer)  // si le buffer est vide alors on va l'init avec un buffer de taille 1
         {
@@ -80,12 +182,46 @@ bool UniformBlockStd140::CreateUBO(GaiApi::VulkanCoreWeak vVulkanCore) {
             return true;
         }
     }
+    if (!datas.empty() && usePushConstants) {
+        // no buffer, the block is a push constant block
+        descriptorBufferInfo = vk::DescriptorBufferInfo{VK_NULL_HANDLE, 0, VK_WHOLE_SIZE};
+        return true;
+    }
+    if (!datas.empty() && useUniformArena) {
+        auto corePtr = vVulkanCore.lock();
+        assert(corePtr != nullptr);
+        uniformArena = corePtr->getUniformArena();
+        auto arenaPtr = uniformArena.lock();
+        if (arenaPtr) {
+            // the buffer and the range never change, only the dynamic offset
+            descriptorBufferInfo.buffer = arenaPtr->GetBuffer();
+            descriptorBufferInfo.range = datas.size();
+            descriptorBufferInfo.offset = 0;
+            uniformArenaFrameCounter = UINT64_MAX;
+            SetDirty();
+            return true;
+        }
+        LogVarDebugInfo("Debug : CreateUBO() Fail, the uniform arena is not available !");
+        return false;
+    }
     if (!datas.empty()) {
-        bufferObjectPtr = VulkanRessource::createUniformBufferObject(vVulkanCore, datas.size(), "UniformBlockStd140");
+        auto corePtr = vVulkanCore.lock();
+        assert(corePtr != nullptr);
+        const auto& limits = corePtr->getPhysicalDevice().getProperties().limits;
+        const auto& minAlign = (uint32_t)ez::maxi<vk::DeviceSize>(limits.minUniformBufferOffsetAlignment, 1U);
+        frameSlotSize = minAlign * (uint32_t)std::ceil((double)datas.size() / (double)minAlign);
+        bufferObjectPtr = VulkanRessource::createUniformBufferObject(vVulkanCore, frameSlotSize * sFrameSlotsCount, "UniformBlockStd140");
         if (bufferObjectPtr) {
             descriptorBufferInfo.buffer = bufferObjectPtr->buffer;
             descriptorBufferInfo.range = datas.size();
             descriptorBufferInfo.offset = 0;
+            // the last slot, so the first upload will be in slot 0
+            currentFrameSlot = sFrameSlotsCount - 1U;
+            // a new buffer, all slots must be fully uploaded
+            for (auto& ranges : frameDirtyRanges) {
+                ranges.Clear();
+            }
+            SetDirty();
             return true;
         }
     } else {
@@ -94,6 +230,52 @@ bool UniformBlockStd140::CreateUBO(GaiApi::VulkanCoreWeak vVulkanCore) {
     return false;
 }
 
+// the descriptor is a UNIFORM_BUFFER_DYNAMIC, so only his buffer change (at the next descriptor update)
+// and the dynamic offset point on the slot. the arena is used again at the next frame
+bool UniformBlockStd140::UploadInArenaFallbackBuffer(GaiApi::VulkanCoreWeak vVulkanCore) {
+    ZoneScoped;
+    if (!bufferObjectPtr) {
+        auto corePtr = vVulkanCore.lock();
+        assert(corePtr != nullptr);
+        const auto& limits = corePtr->getPhysicalDevice().getProperties().limits;
+        const auto& minAlign = (uint32_t)ez::maxi<vk::DeviceSize>(limits.minUniformBufferOffsetAlignment, 1U);
+        frameSlotSize = minAlign * (uint32_t)std::ceil((double)datas.size() / (double)minAlign);
+        bufferObjectPtr = VulkanRessource::createUniformBufferObject(vVulkanCore, frameSlotSize * sFrameSlotsCount, "UniformBlockStd140");
+        if (!bufferObjectPtr) {
+            LogVarError("%s", "the uniform arena is full and the fallback buffer of the block cant be created");
+            return false;
+        }
+        currentFrameSlot = sFrameSlotsCount - 1U;
+        LogVarDebugWarning("Debug : the uniform arena is full, the block use his own buffer for this frame");
+    }
+    // the slot can have been written frames ago, so all the datas are written
+    currentFrameSlot = GetFrameSlot(vVulkanCore);
+    const uint32_t slotOffset = currentFrameSlot * frameSlotSize;
+    VulkanDirtyRanges ranges;
+    ranges.Add(0U, datas.size());
+    VulkanRessource::uploadRanges(vVulkanCore, bufferObjectPtr, datas.data(), ranges, slotOffset);
+    descriptorBufferInfo.buffer = bufferObjectPtr->buffer;
+    dynamicOffset = slotOffset;
+    return true;
+}
+
+// the frame is the one started by VulkanUniformArena::BeginFrame with the swapchain frame index
+// the first upload of a frame write in the next slot, the two other ones can be read by the frames in flight
+// the next uploads of the same frame write again in this slot, so they never reach a slot in use
+uint32_t UniformBlockStd140::GetFrameSlot(GaiApi::VulkanCoreWeak vVulkanCore) {
+    ZoneScoped;
+    auto corePtr = vVulkanCore.lock();
+    assert(corePtr != nullptr);
+    auto arenaPtr = corePtr->getUniformArena().lock();
+    if (arenaPtr) {
+        if (currentFrameSlotFrame == arenaPtr->GetFrameCounter()) {
+            return currentFrameSlot;
+        }
+        currentFrameSlotFrame = arenaPtr->GetFrameCounter();
+    }
+    return (currentFrameSlot + 1U) % sFrameSlotsCount;
+}
+
 void UniformBlockStd140::DestroyUBO() {
     ZoneScoped;
     bufferObjectPtr.reset();
@@ -103,7 +285,11 @@ bool UniformBlockStd140::RecreateUBO(GaiApi::VulkanCoreWeak vVulkanCore) {
     ZoneScoped;
     bool res = false;
     if (!customBufferInfo) {
-        if (bufferObjectPtr) {
+        if (usePushConstants) {
+            res = true;
+        } else if (useUniformArena) {
+            res = CreateUBO(vVulkanCore);
+        } else if (bufferObjectPtr) {
             DestroyUBO();
             CreateUBO(vVulkanCore);
 
@@ -147,6 +333,16 @@ bool UniformBlockStd140::RegisterByteSize(const std::string& vKey, uint32_t vSiz
     return false;
 }
 
+void UniformBlockStd140::SetDirtyRange(uint32_t vOffset, uint32_t vSizeInBytes) {
+    ZoneScoped;
+    if (vSizeInBytes > 0U) {
+        for (auto& ranges : frameDirtyRanges) {
+            ranges.Add(vOffset, vSizeInBytes);
+        }
+        isDirty = true;
+    }
+}
+
 void UniformBlockStd140::AddOffsetForKey(const std::string& vKey, uint32_t vOffset) {
     ZoneScoped;
     offsets[vKey] = vOffset;
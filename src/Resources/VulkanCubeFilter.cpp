@@ -0,0 +1,485 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Resources/VulkanCubeFilter.h>
+#include <Gaia/Resources/VulkanMipGenerator.h>
+#include <Gaia/Core/VulkanCore.h>
+#include <Gaia/Core/VulkanDevice.h>
+#include <Gaia/Shader/VulkanShader.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <sstream>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace GaiApi {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanCubeFilterPtr VulkanCubeFilter::Create(VulkanCoreWeak vVulkanCore) {
+    ZoneScoped;
+    auto res = std::make_shared<VulkanCubeFilter>(vVulkanCore);
+    if (!res->Init()) {
+        res.reset();
+    }
+    return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTOR /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanCubeFilter::VulkanCubeFilter(VulkanCoreWeak vVulkanCore) : m_VulkanCore(vVulkanCore) {
+    ZoneScoped;
+}
+
+VulkanCubeFilter::~VulkanCubeFilter() {
+    ZoneScoped;
+    Unit();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// INIT / UNIT /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanCubeFilter::Init() {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    m_Device = corePtr->getDevice();
+
+    auto devicePtr = corePtr->getFrameworkDevice().lock();
+    if (devicePtr) {
+        m_ExtendedFormatsSupported = (devicePtr->m_PhysDeviceFeatures.shaderStorageImageExtendedFormats == VK_TRUE);
+    }
+
+    // binding 0 : source, binding 1 : mip written, binding 2 : previous mip for the box filter
+    const std::array<vk::DescriptorSetLayoutBinding, 3U> bindings = {
+        vk::DescriptorSetLayoutBinding(0U, vk::DescriptorType::eCombinedImageSampler, 1U, vk::ShaderStageFlagBits::eCompute),
+        vk::DescriptorSetLayoutBinding(1U, vk::DescriptorType::eStorageImage, 1U, vk::ShaderStageFlagBits::eCompute),
+        vk::DescriptorSetLayoutBinding(2U, vk::DescriptorType::eStorageImage, 1U, vk::ShaderStageFlagBits::eCompute),
+    };
+    m_DescriptorSetLayout = m_Device.createDescriptorSetLayout(
+        vk::DescriptorSetLayoutCreateInfo(vk::DescriptorSetLayoutCreateFlags(), static_cast<uint32_t>(bindings.size()), bindings.data()));
+
+    const vk::PushConstantRange pushConstantRange(vk::ShaderStageFlagBits::eCompute, 0U, sizeof(PushConstants));
+    m_PipelineLayout =
+        m_Device.createPipelineLayout(vk::PipelineLayoutCreateInfo(vk::PipelineLayoutCreateFlags(), 1U, &m_DescriptorSetLayout, 1U, &pushConstantRange));
+
+    for (auto& slot : m_FrameSlots) {
+        slot.descriptorPools.push_back(CreateDescriptorPool());
+        slot.dispatchsCount = 0U;
+    }
+    m_FrameSlot = 0U;
+
+    return (m_DescriptorSetLayout && m_PipelineLayout);
+}
+
+void VulkanCubeFilter::Unit() {
+    ZoneScoped;
+    if (m_Device) {
+        for (auto& slot : m_FrameSlots) {
+            for (auto& view : slot.imageViews) {
+                m_Device.destroyImageView(view);
+            }
+            slot.imageViews.clear();
+            for (auto& pool : slot.descriptorPools) {
+                m_Device.destroyDescriptorPool(pool);
+            }
+            slot.descriptorPools.clear();
+        }
+        for (auto& pipeline : m_Pipelines) {
+            if (pipeline.second) {
+                m_Device.destroyPipeline(pipeline.second);
+            }
+        }
+        m_Pipelines.clear();
+        if (m_PipelineLayout) {
+            m_Device.destroyPipelineLayout(m_PipelineLayout);
+            m_PipelineLayout = nullptr;
+        }
+        if (m_DescriptorSetLayout) {
+            m_Device.destroyDescriptorSetLayout(m_DescriptorSetLayout);
+            m_DescriptorSetLayout = nullptr;
+        }
+        m_Device = nullptr;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// FRAME ///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanCubeFilter::BeginFrame(const uint32_t& vFrameSlot) {
+    ZoneScoped;
+    m_FrameSlot = vFrameSlot % VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT;
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    for (auto& view : slot.imageViews) {
+        m_Device.destroyImageView(view);
+    }
+    slot.imageViews.clear();
+    if (!slot.descriptorPools.empty()) {
+        // the pools added for the records out of the frames are not kept
+        for (size_t idx = 1U; idx < slot.descriptorPools.size(); ++idx) {
+            m_Device.destroyDescriptorPool(slot.descriptorPools[idx]);
+        }
+        slot.descriptorPools.resize(1U);
+        m_Device.resetDescriptorPool(slot.descriptorPools[0]);
+    }
+    slot.dispatchsCount = 0U;
+}
+
+vk::DescriptorPool VulkanCubeFilter::CreateDescriptorPool() const {
+    ZoneScoped;
+    const std::array<vk::DescriptorPoolSize, 2U> poolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, s_DescriptorSetsByPool),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, s_DescriptorSetsByPool * 2U),
+    };
+    return m_Device.createDescriptorPool(
+        vk::DescriptorPoolCreateInfo(vk::DescriptorPoolCreateFlags(), s_DescriptorSetsByPool, static_cast<uint32_t>(poolSizes.size()), poolSizes.data()));
+}
+
+// without BeginFrame (records out of the frames, like the loads at the startup), the slot get a new pool when he is full
+// rather than refusing the records, the pools are released at the next BeginFrame of the slot
+vk::DescriptorSet VulkanCubeFilter::AllocateTransientDescriptorSet() {
+    ZoneScoped;
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    if (slot.descriptorPools.empty() || slot.dispatchsCount == s_DescriptorSetsByPool) {
+        slot.descriptorPools.push_back(CreateDescriptorPool());
+        slot.dispatchsCount = 0U;
+    }
+    ++slot.dispatchsCount;
+    return m_Device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(slot.descriptorPools.back(), 1U, &m_DescriptorSetLayout))[0];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// RECORD //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanCubeFilter::IsFormatSupported(const vk::Format& vFormat) const {
+    ZoneScoped;
+    bool extended = false;
+    const auto glslFormat = VulkanMipGenerator::GetGlslImageFormat(vFormat, &extended);
+    // the texels are filtered, so the integer formats are excluded
+    if (glslFormat.empty() || glslFormat.back() == 'i' || (extended && !m_ExtendedFormatsSupported)) {
+        return false;
+    }
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    const auto formatProperties = corePtr->getPhysicalDevice().getFormatProperties(vFormat);
+    return static_cast<bool>(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eStorageImage);
+}
+
+bool VulkanCubeFilter::RecordCubeMap(vk::CommandBuffer vCmd,
+    const vk::DescriptorImageInfo& vSource,
+    const SourceType& vSourceType,
+    const uint32_t& vSourceSize,
+    vk::Image vCube,
+    const vk::Format& vFormat,
+    const uint32_t& vFaceSize,
+    const uint32_t& vMipLevelsCount,
+    const bool& vConvolve,
+    const vk::ImageLayout& vOldLayout,
+    const vk::ImageLayout& vNewLayout,
+    const uint32_t& vSamplesCount) {
+    ZoneScoped;
+    if (!vCmd || !vCube || !vSource.imageView || !vSource.sampler || !vSourceSize || !vFaceSize || !vMipLevelsCount) {
+        return false;
+    }
+
+    const auto projectKind = (vSourceType == SourceType::Equirectangular) ? ShaderKind::ProjectEquirectangular : ShaderKind::ProjectCube;
+    auto projectPipeline = GetPipeline(vFormat, projectKind);
+    if (!projectPipeline) {
+        return false;
+    }
+    vk::Pipeline downsamplePipeline = nullptr;
+    if (!vConvolve && vMipLevelsCount > 1U) {
+        downsamplePipeline = GetPipeline(vFormat, ShaderKind::Downsample);
+        if (!downsamplePipeline) {
+            return false;
+        }
+    }
+
+    // one dispatch by mip
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    std::vector<vk::ImageView> views(vMipLevelsCount);
+    for (uint32_t mip = 0U; mip < vMipLevelsCount; ++mip) {
+        views[mip] = CreateTransientMipView(vCube, vFormat, mip);
+    }
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.image = vCube;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, vMipLevelsCount, 0U, 6U);
+
+    // the content of the cube is fully overwritten, but the writes of the source are waited too
+    barrier.oldLayout = vOldLayout;
+    barrier.newLayout = vk::ImageLayout::eGeneral;
+    barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+    vCmd.pipelineBarrier(
+        vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), {}, {}, barrier);
+
+    uint32_t size = vFaceSize;
+    uint32_t previousSize = vFaceSize;
+    for (uint32_t mip = 0U; mip < vMipLevelsCount; ++mip) {
+        const bool isDownsample = (mip > 0U && !vConvolve);
+
+        const auto descriptorSet = AllocateTransientDescriptorSet();
+
+        // the bindings not used by the shader of the mip must be valid
+        const std::array<vk::DescriptorImageInfo, 2U> storageInfos = {
+            vk::DescriptorImageInfo(nullptr, views[mip], vk::ImageLayout::eGeneral),
+            vk::DescriptorImageInfo(nullptr, views[isDownsample ? mip - 1U : mip], vk::ImageLayout::eGeneral),
+        };
+        const std::array<vk::WriteDescriptorSet, 3U> writes = {
+            vk::WriteDescriptorSet(descriptorSet, 0U, 0U, 1U, vk::DescriptorType::eCombinedImageSampler, &vSource),
+            vk::WriteDescriptorSet(descriptorSet, 1U, 0U, 1U, vk::DescriptorType::eStorageImage, &storageInfos[0]),
+            vk::WriteDescriptorSet(descriptorSet, 2U, 0U, 1U, vk::DescriptorType::eStorageImage, &storageInfos[1]),
+        };
+        m_Device.updateDescriptorSets(writes, nullptr);
+
+        PushConstants pushConstants = {};
+        pushConstants.dstSize = (int32_t)size;
+        pushConstants.srcSize = (int32_t)(isDownsample ? previousSize : vSourceSize);
+        pushConstants.roughness = (vConvolve && vMipLevelsCount > 1U) ? (float)mip / (float)(vMipLevelsCount - 1U) : 0.0f;
+        pushConstants.samplesCount = (int32_t)ez::maxi(vSamplesCount, 1U);
+
+        vCmd.bindPipeline(vk::PipelineBindPoint::eCompute, isDownsample ? downsamplePipeline : projectPipeline);
+        vCmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_PipelineLayout, 0U, descriptorSet, nullptr);
+        vCmd.pushConstants(m_PipelineLayout, vk::ShaderStageFlagBits::eCompute, 0U, sizeof(PushConstants), &pushConstants);
+        vCmd.dispatch((size + 7U) / 8U, (size + 7U) / 8U, 6U);
+
+        if (!vConvolve && mip + 1U < vMipLevelsCount) {
+            // the mip written is the source of the next dispatch
+            const vk::MemoryBarrier memoryBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead);
+            vCmd.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), memoryBarrier, {}, {});
+        }
+
+        previousSize = size;
+        size = ez::maxi(size / 2U, 1U);
+    }
+
+    barrier.oldLayout = vk::ImageLayout::eGeneral;
+    barrier.newLayout = vNewLayout;
+    barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+    vCmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags(),
+        {},
+        {},
+        barrier);
+
+    slot.imageViews.insert(slot.imageViews.end(), views.begin(), views.end());
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+vk::Pipeline VulkanCubeFilter::GetPipeline(const vk::Format& vFormat, const ShaderKind& vShaderKind) {
+    ZoneScoped;
+    const auto key = std::make_pair(vFormat, vShaderKind);
+    auto it = m_Pipelines.find(key);
+    if (it != m_Pipelines.end()) {
+        return it->second;
+    }
+
+    vk::Pipeline pipeline = nullptr;
+    if (IsFormatSupported(vFormat) && VulkanCore::sVulkanShader) {
+        std::string code;
+        std::string name = "VulkanCubeFilter_";
+        switch (vShaderKind) {
+            case ShaderKind::ProjectEquirectangular:
+                code = GetProjectShaderCode(vFormat, SourceType::Equirectangular);
+                name += "Equirectangular_";
+                break;
+            case ShaderKind::ProjectCube:
+                code = GetProjectShaderCode(vFormat, SourceType::Cube);
+                name += "Cube_";
+                break;
+            case ShaderKind::Downsample:
+                code = GetDownsampleShaderCode(vFormat);
+                name += "Downsample_";
+                break;
+        }
+        const auto spirv = VulkanCore::sVulkanShader->CompileGLSLString(code, "comp", name + VulkanMipGenerator::GetGlslImageFormat(vFormat));
+        if (!spirv.empty()) {
+            auto shaderModule = VulkanCore::sVulkanShader->CreateShaderModule(m_Device, spirv);
+            if (shaderModule) {
+                const auto stage = vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eCompute, shaderModule, "main");
+                pipeline = m_Device.createComputePipeline(nullptr, vk::ComputePipelineCreateInfo(vk::PipelineCreateFlags(), stage, m_PipelineLayout)).value;
+                VulkanCore::sVulkanShader->DestroyShaderModule(m_Device, shaderModule);
+            }
+        }
+    }
+    if (!pipeline) {
+        LogVarError("the cube filter cant write the cube maps of the format %s", vk::to_string(vFormat).c_str());
+    }
+
+    // a failed pipeline is not retried at each call
+    m_Pipelines[key] = pipeline;
+    return pipeline;
+}
+
+std::string VulkanCubeFilter::GetProjectShaderCode(const vk::Format& vFormat, const SourceType& vSourceType) const {
+    ZoneScoped;
+    const bool isEquirectangular = (vSourceType == SourceType::Equirectangular);
+
+    std::stringstream code;
+    code << "#version 450\n";
+    code << "layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;\n";
+    code << "layout(set = 0, binding = 0) uniform " << (isEquirectangular ? "sampler2D" : "samplerCube") << " u_Src;\n";
+    code << "layout(set = 0, binding = 1, " << VulkanMipGenerator::GetGlslImageFormat(vFormat) << ") uniform writeonly image2DArray u_Dst;\n";
+    code << "layout(push_constant) uniform PushConstants {\n";
+    code << "\tint dstSize;\n";
+    code << "\tint srcSize;\n";
+    code << "\tfloat roughness;\n";
+    code << "\tint samplesCount;\n";
+    code << "} pc;\n";
+    code << "const float PI = 3.14159265359;\n";
+    // direction of a texel, faces in the vulkan order +X, -X, +Y, -Y, +Z, -Z
+    code << "vec3 getDirection(ivec3 coord) {\n";
+    code << "\tconst vec2 uv = (vec2(coord.xy) + 0.5) / float(pc.dstSize) * 2.0 - 1.0;\n";
+    code << "\tswitch (coord.z) {\n";
+    code << "\t\tcase 0: return normalize(vec3(1.0, -uv.y, -uv.x));\n";
+    code << "\t\tcase 1: return normalize(vec3(-1.0, -uv.y, uv.x));\n";
+    code << "\t\tcase 2: return normalize(vec3(uv.x, 1.0, uv.y));\n";
+    code << "\t\tcase 3: return normalize(vec3(uv.x, -1.0, -uv.y));\n";
+    code << "\t\tcase 4: return normalize(vec3(uv.x, -uv.y, 1.0));\n";
+    code << "\t}\n";
+    code << "\treturn normalize(vec3(-uv.x, -uv.y, -1.0));\n";
+    code << "}\n";
+    code << "vec3 sampleSrc(vec3 dir, float lod) {\n";
+    if (isEquirectangular) {
+        code << "\tconst vec2 uv = vec2(atan(dir.z, dir.x) / (2.0 * PI) + 0.5, acos(clamp(dir.y, -1.0, 1.0)) / PI);\n";
+        code << "\treturn textureLod(u_Src, uv, lod).rgb;\n";
+    } else {
+        code << "\treturn textureLod(u_Src, dir, lod).rgb;\n";
+    }
+    code << "}\n";
+    code << "vec2 hammersley(uint i, uint n) {\n";
+    code << "\treturn vec2(float(i) / float(n), float(bitfieldReverse(i)) * 2.3283064365386963e-10);\n";
+    code << "}\n";
+    code << "vec3 importanceSampleGGX(vec2 xi, vec3 n, float a) {\n";
+    code << "\tconst float phi = 2.0 * PI * xi.x;\n";
+    code << "\tconst float cosTheta = sqrt((1.0 - xi.y) / (1.0 + (a * a - 1.0) * xi.y));\n";
+    code << "\tconst float sinTheta = sqrt(1.0 - cosTheta * cosTheta);\n";
+    code << "\tconst vec3 up = abs(n.z) < 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(1.0, 0.0, 0.0);\n";
+    code << "\tconst vec3 tangentX = normalize(cross(up, n));\n";
+    code << "\tconst vec3 tangentY = cross(n, tangentX);\n";
+    code << "\treturn normalize(tangentX * (cos(phi) * sinTheta) + tangentY * (sin(phi) * sinTheta) + n * cosTheta);\n";
+    code << "}\n";
+    code << "void main() {\n";
+    code << "\tconst ivec3 coord = ivec3(gl_GlobalInvocationID);\n";
+    code << "\tif (any(greaterThanEqual(coord.xy, ivec2(pc.dstSize)))) {\n";
+    code << "\t\treturn;\n";
+    code << "\t}\n";
+    code << "\tconst vec3 n = getDirection(coord);\n";
+    code << "\tif (pc.roughness <= 0.0) {\n";
+    code << "\t\timageStore(u_Dst, coord, vec4(sampleSrc(n, 0.0), 1.0));\n";
+    code << "\t\treturn;\n";
+    code << "\t}\n";
+    // the view and the reflection are the normal. the lod of a sample is given by the ratio of
+    // the solid angle of the sample (1 / (pdf * samplesCount)) and of a texel of the source
+    code << "\tconst float a = pc.roughness * pc.roughness;\n";
+    code << "\tconst float a2 = a * a;\n";
+    if (isEquirectangular) {
+        code << "\tconst float saTexel = 4.0 * PI / (float(pc.srcSize) * float(pc.srcSize) * 0.5);\n";
+    } else {
+        code << "\tconst float saTexel = 4.0 * PI / (6.0 * float(pc.srcSize) * float(pc.srcSize));\n";
+    }
+    code << "\tconst uint samplesCount = uint(pc.samplesCount);\n";
+    code << "\tvec3 sum = vec3(0.0);\n";
+    code << "\tfloat weight = 0.0;\n";
+    code << "\tfor (uint i = 0u; i < samplesCount; ++i) {\n";
+    code << "\t\tconst vec3 h = importanceSampleGGX(hammersley(i, samplesCount), n, a);\n";
+    code << "\t\tconst float NdotH = max(dot(n, h), 0.0);\n";
+    code << "\t\tconst vec3 l = normalize(2.0 * NdotH * h - n);\n";
+    code << "\t\tconst float NdotL = dot(n, l);\n";
+    code << "\t\tif (NdotL > 0.0) {\n";
+    code << "\t\t\tconst float d = NdotH * NdotH * (a2 - 1.0) + 1.0;\n";
+    code << "\t\t\tconst float pdf = a2 / (PI * d * d) * 0.25;\n";
+    code << "\t\t\tconst float saSample = 1.0 / (float(samplesCount) * pdf + 0.0001);\n";
+    code << "\t\t\tconst float lod = max(0.5 * log2(saSample / saTexel) + 1.0, 0.0);\n";
+    code << "\t\t\tsum += sampleSrc(l, lod) * NdotL;\n";
+    code << "\t\t\tweight += NdotL;\n";
+    code << "\t\t}\n";
+    code << "\t}\n";
+    code << "\timageStore(u_Dst, coord, vec4(sum / max(weight, 0.0001), 1.0));\n";
+    code << "}\n";
+    return code.str();
+}
+
+std::string VulkanCubeFilter::GetDownsampleShaderCode(const vk::Format& vFormat) const {
+    ZoneScoped;
+    const auto glslFormat = VulkanMipGenerator::GetGlslImageFormat(vFormat);
+
+    std::stringstream code;
+    code << "#version 450\n";
+    code << "layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;\n";
+    code << "layout(set = 0, binding = 1, " << glslFormat << ") uniform writeonly image2DArray u_Dst;\n";
+    code << "layout(set = 0, binding = 2, " << glslFormat << ") uniform readonly image2DArray u_SrcMip;\n";
+    code << "layout(push_constant) uniform PushConstants {\n";
+    code << "\tint dstSize;\n";
+    code << "\tint srcSize;\n";
+    code << "\tfloat roughness;\n";
+    code << "\tint samplesCount;\n";
+    code << "} pc;\n";
+    code << "vec4 loadSrc(ivec2 p, int face) {\n";
+    code << "\treturn imageLoad(u_SrcMip, ivec3(min(p, ivec2(pc.srcSize - 1)), face));\n";
+    code << "}\n";
+    code << "void main() {\n";
+    code << "\tconst ivec3 coord = ivec3(gl_GlobalInvocationID);\n";
+    code << "\tif (any(greaterThanEqual(coord.xy, ivec2(pc.dstSize)))) {\n";
+    code << "\t\treturn;\n";
+    code << "\t}\n";
+    code << "\tconst ivec2 src = coord.xy * 2;\n";
+    code << "\tconst vec4 texel = loadSrc(src, coord.z) + loadSrc(src + ivec2(1, 0), coord.z) + ";
+    code << "loadSrc(src + ivec2(0, 1), coord.z) + loadSrc(src + ivec2(1, 1), coord.z);\n";
+    code << "\timageStore(u_Dst, coord, texel * 0.25);\n";
+    code << "}\n";
+    return code.str();
+}
+
+vk::ImageView VulkanCubeFilter::CreateTransientMipView(vk::Image vImage, const vk::Format& vFormat, const uint32_t& vMipLevel) {
+    ZoneScoped;
+    // the six faces of the mip, as an array for the storage access
+    vk::ImageViewCreateInfo viewInfo;
+    viewInfo.image = vImage;
+    viewInfo.viewType = vk::ImageViewType::e2DArray;
+    viewInfo.format = vFormat;
+    viewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, vMipLevel, 1U, 0U, 6U);
+    return m_Device.createImageView(viewInfo);
+}
+
+}  // namespace GaiApi
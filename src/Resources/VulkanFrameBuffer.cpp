@@ -50,13 +50,16 @@ bool VulkanFrameBuffer::Init(GaiApi::VulkanCoreWeak vVulkanCore,
     bool vNeedToClear,
     ez::fvec4 vClearColor,
     vk::Format vFormat,
-    vk::SampleCountFlagBits vSampleCount) {
+    vk::SampleCountFlagBits vSampleCount,
+    bool vUseDynamicRendering) {
     ZoneScoped;
 
     bool res = false;
 
     m_VulkanCore = vVulkanCore;
     needToClear = vNeedToClear;
+    dynamicRendering = vUseDynamicRendering;
+    layoutsInitialized = false;
 
     if (vCountColorBuffers > 0 && vCountColorBuffers <= 8) {
         ez::uvec2 size = ez::clamp(vSize, 1u, 8192u);
@@ -153,6 +156,10 @@ bool VulkanFrameBuffer::Init(GaiApi::VulkanCoreWeak vVulkanCore,
                 ++attIndex;
             }
 
+            if (dynamicRendering) {
+                return true;
+            }
+
             if (vCreateRenderPass) {
                 std::vector<vk::SubpassDescription> subpasses;
                 {
@@ -293,7 +300,10 @@ void VulkanFrameBuffer::Unit() {
     auto corePtr = m_VulkanCore.lock();
     assert(corePtr != nullptr);
     auto logDevice = corePtr->getDevice();
-    logDevice.destroyFramebuffer(framebuffer);
+    if (framebuffer) {
+        logDevice.destroyFramebuffer(framebuffer);
+        framebuffer = nullptr;
+    }
 }
 
 VulkanFrameBufferAttachment* VulkanFrameBuffer::GetDepthAttachment() {
@@ -215,10 +215,13 @@ void VulkanFrameBufferAttachment::Unit() {
 ///// MIP MAPPING /////////////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool VulkanFrameBufferAttachment::UpdateMipMapping() {
+bool VulkanFrameBufferAttachment::UpdateMipMapping(vk::CommandBuffer* vCmdBufferPtr) {
     if (!m_VulkanCore.expired() && attachmentPtr != nullptr) {
-        VulkanRessource::GenerateMipmaps(m_VulkanCore, attachmentPtr->image, format, width, height, mipLevelCount);
-        return true;
+        const auto& layout = attachmentDescriptorInfo.imageLayout;
+        if (vCmdBufferPtr) {
+            return VulkanRessource::RecordMipmaps(m_VulkanCore, *vCmdBufferPtr, attachmentPtr, format, width, height, mipLevelCount, layout, layout);
+        }
+        return VulkanRessource::GenerateMipmaps(m_VulkanCore, attachmentPtr, format, width, height, mipLevelCount, layout, layout);
     }
     return false;
 }
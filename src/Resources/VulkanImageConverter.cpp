@@ -0,0 +1,369 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Resources/VulkanImageConverter.h>
+#include <Gaia/Resources/VulkanMipGenerator.h>
+#include <Gaia/Core/VulkanCore.h>
+#include <Gaia/Core/VulkanDevice.h>
+#include <Gaia/Shader/VulkanShader.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <sstream>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace GaiApi {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanImageConverterPtr VulkanImageConverter::Create(VulkanCoreWeak vVulkanCore) {
+    ZoneScoped;
+    auto res = std::make_shared<VulkanImageConverter>(vVulkanCore);
+    if (!res->Init()) {
+        res.reset();
+    }
+    return res;
+}
+
+uint64_t VulkanImageConverter::GetSourceBufferSize(const SourceLayout& vLayout) {
+    const uint64_t size = (uint64_t)vLayout.width * (uint64_t)vLayout.height * (uint64_t)vLayout.channels * (uint64_t)vLayout.bytesPerComponent;
+    return (size + 3U) & ~3ULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTOR /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanImageConverter::VulkanImageConverter(VulkanCoreWeak vVulkanCore) : m_VulkanCore(vVulkanCore) {
+    ZoneScoped;
+}
+
+VulkanImageConverter::~VulkanImageConverter() {
+    ZoneScoped;
+    Unit();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// INIT / UNIT /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanImageConverter::Init() {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    m_Device = corePtr->getDevice();
+    m_MaxStorageBufferRange = corePtr->getPhysicalDevice().getProperties().limits.maxStorageBufferRange;
+
+    auto devicePtr = corePtr->getFrameworkDevice().lock();
+    if (devicePtr) {
+        m_ExtendedFormatsSupported = (devicePtr->m_PhysDeviceFeatures.shaderStorageImageExtendedFormats == VK_TRUE);
+    }
+
+    // binding 0 : packed source texels, binding 1 : mip 0 of the destination
+    const std::array<vk::DescriptorSetLayoutBinding, 2U> bindings = {
+        vk::DescriptorSetLayoutBinding(0U, vk::DescriptorType::eStorageBuffer, 1U, vk::ShaderStageFlagBits::eCompute),
+        vk::DescriptorSetLayoutBinding(1U, vk::DescriptorType::eStorageImage, 1U, vk::ShaderStageFlagBits::eCompute),
+    };
+    m_DescriptorSetLayout = m_Device.createDescriptorSetLayout(
+        vk::DescriptorSetLayoutCreateInfo(vk::DescriptorSetLayoutCreateFlags(), static_cast<uint32_t>(bindings.size()), bindings.data()));
+
+    const vk::PushConstantRange pushConstantRange(vk::ShaderStageFlagBits::eCompute, 0U, sizeof(PushConstants));
+    m_PipelineLayout =
+        m_Device.createPipelineLayout(vk::PipelineLayoutCreateInfo(vk::PipelineLayoutCreateFlags(), 1U, &m_DescriptorSetLayout, 1U, &pushConstantRange));
+
+    for (auto& slot : m_FrameSlots) {
+        slot.descriptorPools.push_back(CreateDescriptorPool());
+        slot.dispatchsCount = 0U;
+    }
+    m_FrameSlot = 0U;
+
+    return (m_DescriptorSetLayout && m_PipelineLayout);
+}
+
+void VulkanImageConverter::Unit() {
+    ZoneScoped;
+    if (m_Device) {
+        for (auto& slot : m_FrameSlots) {
+            for (auto& view : slot.imageViews) {
+                m_Device.destroyImageView(view);
+            }
+            slot.imageViews.clear();
+            for (auto& pool : slot.descriptorPools) {
+                m_Device.destroyDescriptorPool(pool);
+            }
+            slot.descriptorPools.clear();
+        }
+        for (auto& pipeline : m_Pipelines) {
+            if (pipeline.second) {
+                m_Device.destroyPipeline(pipeline.second);
+            }
+        }
+        m_Pipelines.clear();
+        if (m_PipelineLayout) {
+            m_Device.destroyPipelineLayout(m_PipelineLayout);
+            m_PipelineLayout = nullptr;
+        }
+        if (m_DescriptorSetLayout) {
+            m_Device.destroyDescriptorSetLayout(m_DescriptorSetLayout);
+            m_DescriptorSetLayout = nullptr;
+        }
+        m_Device = nullptr;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// FRAME ///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanImageConverter::BeginFrame(const uint32_t& vFrameSlot) {
+    ZoneScoped;
+    m_FrameSlot = vFrameSlot % VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT;
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    for (auto& view : slot.imageViews) {
+        m_Device.destroyImageView(view);
+    }
+    slot.imageViews.clear();
+    if (!slot.descriptorPools.empty()) {
+        // the pools added for the records out of the frames are not kept
+        for (size_t idx = 1U; idx < slot.descriptorPools.size(); ++idx) {
+            m_Device.destroyDescriptorPool(slot.descriptorPools[idx]);
+        }
+        slot.descriptorPools.resize(1U);
+        m_Device.resetDescriptorPool(slot.descriptorPools[0]);
+    }
+    slot.dispatchsCount = 0U;
+}
+
+vk::DescriptorPool VulkanImageConverter::CreateDescriptorPool() const {
+    ZoneScoped;
+    const std::array<vk::DescriptorPoolSize, 2U> poolSizes = {
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, s_DescriptorSetsByPool),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, s_DescriptorSetsByPool),
+    };
+    return m_Device.createDescriptorPool(vk::DescriptorPoolCreateInfo(
+        vk::DescriptorPoolCreateFlags(), s_DescriptorSetsByPool, static_cast<uint32_t>(poolSizes.size()), poolSizes.data()));
+}
+
+// without BeginFrame (records out of the frames, like the loads at the startup), the slot get a new pool when he is full
+// rather than refusing the records, the pools are released at the next BeginFrame of the slot
+vk::DescriptorSet VulkanImageConverter::AllocateTransientDescriptorSet() {
+    ZoneScoped;
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    if (slot.descriptorPools.empty() || slot.dispatchsCount == s_DescriptorSetsByPool) {
+        slot.descriptorPools.push_back(CreateDescriptorPool());
+        slot.dispatchsCount = 0U;
+    }
+    ++slot.dispatchsCount;
+    return m_Device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(slot.descriptorPools.back(), 1U, &m_DescriptorSetLayout))[0];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// RECORD //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanImageConverter::IsFormatSupported(const vk::Format& vFormat) const {
+    ZoneScoped;
+    bool extended = false;
+    const auto glslFormat = VulkanMipGenerator::GetGlslImageFormat(vFormat, &extended);
+    if (glslFormat.empty() || glslFormat.back() == 'i' || (extended && !m_ExtendedFormatsSupported)) {
+        return false;
+    }
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    const auto formatProperties = corePtr->getPhysicalDevice().getFormatProperties(vFormat);
+    return static_cast<bool>(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eStorageImage);
+}
+
+bool VulkanImageConverter::CanConvert(const SourceLayout& vSrcLayout, const vk::Format& vDstFormat) const {
+    ZoneScoped;
+    if (!vSrcLayout.width || !vSrcLayout.height || vSrcLayout.channels < 1U || vSrcLayout.channels > 4U) {
+        return false;
+    }
+    if (vSrcLayout.bytesPerComponent != 1U && vSrcLayout.bytesPerComponent != 2U && vSrcLayout.bytesPerComponent != 4U) {
+        return false;
+    }
+    if (GetSourceBufferSize(vSrcLayout) > m_MaxStorageBufferRange) {
+        return false;
+    }
+    return IsFormatSupported(vDstFormat);
+}
+
+bool VulkanImageConverter::RecordConversion(vk::CommandBuffer vCmd,
+    vk::Buffer vSrcBuffer,
+    const SourceLayout& vSrcLayout,
+    vk::Image vDstImage,
+    const vk::Format& vDstFormat,
+    const uint32_t& vDstWidth,
+    const uint32_t& vDstHeight) {
+    ZoneScoped;
+    if (!vCmd || !vSrcBuffer || !vDstImage || !vDstWidth || !vDstHeight) {
+        return false;
+    }
+    if (!CanConvert(vSrcLayout, vDstFormat)) {
+        LogVarError("the image converter cant convert %u channels of %u bytes (%ux%u) to the format %s", vSrcLayout.channels,
+            vSrcLayout.bytesPerComponent, vSrcLayout.width, vSrcLayout.height, vk::to_string(vDstFormat).c_str());
+        return false;
+    }
+
+    auto pipeline = GetPipeline(vDstFormat, vSrcLayout.bytesPerComponent);
+    if (!pipeline) {
+        return false;
+    }
+
+    vk::ImageViewCreateInfo viewInfo;
+    viewInfo.image = vDstImage;
+    viewInfo.viewType = vk::ImageViewType::e2D;
+    viewInfo.format = vDstFormat;
+    viewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, 1U, 0U, 1U);
+    const auto view = m_Device.createImageView(viewInfo);
+    m_FrameSlots[m_FrameSlot].imageViews.push_back(view);
+
+    const auto descriptorSet = AllocateTransientDescriptorSet();
+
+    const vk::DescriptorBufferInfo bufferInfo(vSrcBuffer, 0U, GetSourceBufferSize(vSrcLayout));
+    const vk::DescriptorImageInfo imageInfo(nullptr, view, vk::ImageLayout::eGeneral);
+    const std::array<vk::WriteDescriptorSet, 2U> writes = {
+        vk::WriteDescriptorSet(descriptorSet, 0U, 0U, 1U, vk::DescriptorType::eStorageBuffer, nullptr, &bufferInfo),
+        vk::WriteDescriptorSet(descriptorSet, 1U, 0U, 1U, vk::DescriptorType::eStorageImage, &imageInfo),
+    };
+    m_Device.updateDescriptorSets(writes, nullptr);
+
+    PushConstants pushConstants = {};
+    pushConstants.srcSize[0] = (int32_t)vSrcLayout.width;
+    pushConstants.srcSize[1] = (int32_t)vSrcLayout.height;
+    pushConstants.dstSize[0] = (int32_t)vDstWidth;
+    pushConstants.dstSize[1] = (int32_t)vDstHeight;
+    pushConstants.channels = (int32_t)vSrcLayout.channels;
+
+    vCmd.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+    vCmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_PipelineLayout, 0U, descriptorSet, nullptr);
+    vCmd.pushConstants(m_PipelineLayout, vk::ShaderStageFlagBits::eCompute, 0U, sizeof(PushConstants), &pushConstants);
+    vCmd.dispatch((vDstWidth + 7U) / 8U, (vDstHeight + 7U) / 8U, 1U);
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+vk::Pipeline VulkanImageConverter::GetPipeline(const vk::Format& vFormat, const uint32_t& vBytesPerComponent) {
+    ZoneScoped;
+    const auto key = std::make_pair(vFormat, vBytesPerComponent);
+    auto it = m_Pipelines.find(key);
+    if (it != m_Pipelines.end()) {
+        return it->second;
+    }
+
+    vk::Pipeline pipeline = nullptr;
+    if (IsFormatSupported(vFormat) && VulkanCore::sVulkanShader) {
+        const auto spirv = VulkanCore::sVulkanShader->CompileGLSLString(GetShaderCode(vFormat, vBytesPerComponent), "comp",
+            "VulkanImageConverter_" + VulkanMipGenerator::GetGlslImageFormat(vFormat) + "_" + std::to_string(vBytesPerComponent));
+        if (!spirv.empty()) {
+            auto shaderModule = VulkanCore::sVulkanShader->CreateShaderModule(m_Device, spirv);
+            if (shaderModule) {
+                const auto stage =
+                    vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eCompute, shaderModule, "main");
+                pipeline =
+                    m_Device.createComputePipeline(nullptr, vk::ComputePipelineCreateInfo(vk::PipelineCreateFlags(), stage, m_PipelineLayout)).value;
+                VulkanCore::sVulkanShader->DestroyShaderModule(m_Device, shaderModule);
+            }
+        }
+    }
+    if (!pipeline) {
+        LogVarError("the image converter cant convert to the format %s", vk::to_string(vFormat).c_str());
+    }
+
+    // a failed format is not retried at each call
+    m_Pipelines[key] = pipeline;
+    return pipeline;
+}
+
+std::string VulkanImageConverter::GetShaderCode(const vk::Format& vFormat, const uint32_t& vBytesPerComponent) const {
+    ZoneScoped;
+    std::stringstream code;
+    code << "#version 450\n";
+    code << "layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;\n";
+    code << "layout(std430, set = 0, binding = 0) readonly buffer SrcBuffer { uint datas[]; } u_Src;\n";
+    code << "layout(set = 0, binding = 1, " << VulkanMipGenerator::GetGlslImageFormat(vFormat) << ") uniform writeonly image2D u_Dst;\n";
+    code << "layout(push_constant) uniform PushConstants {\n";
+    code << "\tivec2 srcSize;\n";
+    code << "\tivec2 dstSize;\n";
+    code << "\tint channels;\n";
+    code << "} pc;\n";
+    code << "float loadComponent(uint idx) {\n";
+    if (vBytesPerComponent == 1U) {
+        code << "\treturn float((u_Src.datas[idx >> 2] >> ((idx & 3u) * 8u)) & 0xFFu) / 255.0;\n";
+    } else if (vBytesPerComponent == 2U) {
+        code << "\treturn float((u_Src.datas[idx >> 1] >> ((idx & 1u) * 16u)) & 0xFFFFu) / 65535.0;\n";
+    } else {
+        code << "\treturn uintBitsToFloat(u_Src.datas[idx]);\n";
+    }
+    code << "}\n";
+    // grey => rgb, no alpha => opaque
+    code << "vec4 loadTexel(ivec2 p) {\n";
+    code << "\tp = clamp(p, ivec2(0), pc.srcSize - 1);\n";
+    code << "\tconst uint base = uint(p.y * pc.srcSize.x + p.x) * uint(pc.channels);\n";
+    code << "\tconst float r = loadComponent(base);\n";
+    code << "\tif (pc.channels == 1) return vec4(r, r, r, 1.0);\n";
+    code << "\tconst float g = loadComponent(base + 1u);\n";
+    code << "\tif (pc.channels == 2) return vec4(r, r, r, g);\n";
+    code << "\tconst float b = loadComponent(base + 2u);\n";
+    code << "\tif (pc.channels == 3) return vec4(r, g, b, 1.0);\n";
+    code << "\treturn vec4(r, g, b, loadComponent(base + 3u));\n";
+    code << "}\n";
+    code << "void main() {\n";
+    code << "\tconst ivec2 coord = ivec2(gl_GlobalInvocationID.xy);\n";
+    code << "\tif (any(greaterThanEqual(coord, pc.dstSize))) return;\n";
+    code << "\tvec4 texel = vec4(0.0);\n";
+    code << "\tconst vec2 scale = vec2(pc.srcSize) / vec2(pc.dstSize);\n";
+    code << "\tif (pc.srcSize == pc.dstSize) {\n";
+    code << "\t\ttexel = loadTexel(coord);\n";
+    code << "\t} else if (scale.x <= 1.0 && scale.y <= 1.0) {\n";
+    // magnification, bilinear
+    code << "\t\tconst vec2 pos = (vec2(coord) + 0.5) * scale - 0.5;\n";
+    code << "\t\tconst ivec2 p = ivec2(floor(pos));\n";
+    code << "\t\tconst vec2 f = pos - vec2(p);\n";
+    code << "\t\ttexel = mix(mix(loadTexel(p), loadTexel(p + ivec2(1, 0)), f.x), mix(loadTexel(p + ivec2(0, 1)), loadTexel(p + ivec2(1, 1)), f.x), f.y);\n";
+    code << "\t} else {\n";
+    // minification, box filter of the footprint of the texel, 8x8 samples max
+    code << "\t\tconst ivec2 count = clamp(ivec2(ceil(scale)), ivec2(1), ivec2(8));\n";
+    code << "\t\tconst vec2 stepSize = scale / vec2(count);\n";
+    code << "\t\tconst vec2 start = vec2(coord) * scale;\n";
+    code << "\t\tfor (int y = 0; y < count.y; ++y) {\n";
+    code << "\t\t\tfor (int x = 0; x < count.x; ++x) {\n";
+    code << "\t\t\t\ttexel += loadTexel(ivec2(start + (vec2(x, y) + 0.5) * stepSize));\n";
+    code << "\t\t\t}\n";
+    code << "\t\t}\n";
+    code << "\t\ttexel /= float(count.x * count.y);\n";
+    code << "\t}\n";
+    code << "\timageStore(u_Dst, coord, texel);\n";
+    code << "}\n";
+    return code.str();
+}
+
+}  // namespace GaiApi
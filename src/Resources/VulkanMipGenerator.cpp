@@ -0,0 +1,440 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Resources/VulkanMipGenerator.h>
+#include <Gaia/Core/VulkanCore.h>
+#include <Gaia/Core/VulkanDevice.h>
+#include <Gaia/Shader/VulkanShader.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <sstream>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace GaiApi {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanMipGeneratorPtr VulkanMipGenerator::Create(VulkanCoreWeak vVulkanCore) {
+    ZoneScoped;
+    auto res = std::make_shared<VulkanMipGenerator>(vVulkanCore);
+    if (!res->Init()) {
+        res.reset();
+    }
+    return res;
+}
+
+std::string VulkanMipGenerator::GetGlslImageFormat(const vk::Format& vFormat, bool* vIsExtended) {
+    ZoneScoped;
+    bool extended = false;
+    std::string res;
+    switch (vFormat) {
+        // formats always supported as storage images in the shaders
+        case vk::Format::eR32G32B32A32Sfloat: res = "rgba32f"; break;
+        case vk::Format::eR16G16B16A16Sfloat: res = "rgba16f"; break;
+        case vk::Format::eR32Sfloat: res = "r32f"; break;
+        case vk::Format::eR8G8B8A8Unorm: res = "rgba8"; break;
+        case vk::Format::eR8G8B8A8Snorm: res = "rgba8_snorm"; break;
+        case vk::Format::eR32G32B32A32Uint: res = "rgba32ui"; break;
+        case vk::Format::eR16G16B16A16Uint: res = "rgba16ui"; break;
+        case vk::Format::eR8G8B8A8Uint: res = "rgba8ui"; break;
+        case vk::Format::eR32Uint: res = "r32ui"; break;
+        case vk::Format::eR32G32B32A32Sint: res = "rgba32i"; break;
+        case vk::Format::eR16G16B16A16Sint: res = "rgba16i"; break;
+        case vk::Format::eR8G8B8A8Sint: res = "rgba8i"; break;
+        case vk::Format::eR32Sint: res = "r32i"; break;
+        // formats of the feature shaderStorageImageExtendedFormats
+        case vk::Format::eR32G32Sfloat: res = "rg32f"; extended = true; break;
+        case vk::Format::eR16G16Sfloat: res = "rg16f"; extended = true; break;
+        case vk::Format::eR16Sfloat: res = "r16f"; extended = true; break;
+        case vk::Format::eB10G11R11UfloatPack32: res = "r11f_g11f_b10f"; extended = true; break;
+        case vk::Format::eA2B10G10R10UnormPack32: res = "rgb10_a2"; extended = true; break;
+        case vk::Format::eR16G16B16A16Unorm: res = "rgba16"; extended = true; break;
+        case vk::Format::eR16G16Unorm: res = "rg16"; extended = true; break;
+        case vk::Format::eR8G8Unorm: res = "rg8"; extended = true; break;
+        case vk::Format::eR16Unorm: res = "r16"; extended = true; break;
+        case vk::Format::eR8Unorm: res = "r8"; extended = true; break;
+        case vk::Format::eR16G16B16A16Snorm: res = "rgba16_snorm"; extended = true; break;
+        case vk::Format::eR32G32Uint: res = "rg32ui"; extended = true; break;
+        case vk::Format::eR32G32Sint: res = "rg32i"; extended = true; break;
+        default: break;
+    }
+    if (vIsExtended) {
+        *vIsExtended = extended;
+    }
+    return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTOR /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanMipGenerator::VulkanMipGenerator(VulkanCoreWeak vVulkanCore) : m_VulkanCore(vVulkanCore) {
+    ZoneScoped;
+}
+
+VulkanMipGenerator::~VulkanMipGenerator() {
+    ZoneScoped;
+    Unit();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// INIT / UNIT /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanMipGenerator::Init() {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    m_Device = corePtr->getDevice();
+
+    auto devicePtr = corePtr->getFrameworkDevice().lock();
+    if (devicePtr) {
+        m_ExtendedFormatsSupported = (devicePtr->m_PhysDeviceFeatures.shaderStorageImageExtendedFormats == VK_TRUE);
+    }
+
+    // binding 0 : source mip, binding 1 : first mip written, binding 2 : second mip written
+    std::array<vk::DescriptorSetLayoutBinding, 3U> bindings;
+    for (uint32_t idx = 0U; idx < 3U; ++idx) {
+        bindings[idx] = vk::DescriptorSetLayoutBinding(idx, vk::DescriptorType::eStorageImage, 1U, vk::ShaderStageFlagBits::eCompute);
+    }
+    m_DescriptorSetLayout = m_Device.createDescriptorSetLayout(
+        vk::DescriptorSetLayoutCreateInfo(vk::DescriptorSetLayoutCreateFlags(), static_cast<uint32_t>(bindings.size()), bindings.data()));
+
+    const vk::PushConstantRange pushConstantRange(vk::ShaderStageFlagBits::eCompute, 0U, sizeof(PushConstants));
+    m_PipelineLayout =
+        m_Device.createPipelineLayout(vk::PipelineLayoutCreateInfo(vk::PipelineLayoutCreateFlags(), 1U, &m_DescriptorSetLayout, 1U, &pushConstantRange));
+
+    for (auto& slot : m_FrameSlots) {
+        slot.descriptorPools.push_back(CreateDescriptorPool());
+        slot.dispatchsCount = 0U;
+    }
+    m_FrameSlot = 0U;
+
+    return (m_DescriptorSetLayout && m_PipelineLayout);
+}
+
+void VulkanMipGenerator::Unit() {
+    ZoneScoped;
+    if (m_Device) {
+        for (auto& slot : m_FrameSlots) {
+            for (auto& view : slot.imageViews) {
+                m_Device.destroyImageView(view);
+            }
+            slot.imageViews.clear();
+            for (auto& pool : slot.descriptorPools) {
+                m_Device.destroyDescriptorPool(pool);
+            }
+            slot.descriptorPools.clear();
+        }
+        for (auto& pipeline : m_Pipelines) {
+            if (pipeline.second) {
+                m_Device.destroyPipeline(pipeline.second);
+            }
+        }
+        m_Pipelines.clear();
+        if (m_PipelineLayout) {
+            m_Device.destroyPipelineLayout(m_PipelineLayout);
+            m_PipelineLayout = nullptr;
+        }
+        if (m_DescriptorSetLayout) {
+            m_Device.destroyDescriptorSetLayout(m_DescriptorSetLayout);
+            m_DescriptorSetLayout = nullptr;
+        }
+        m_Device = nullptr;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// FRAME ///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanMipGenerator::BeginFrame(const uint32_t& vFrameSlot) {
+    ZoneScoped;
+    m_FrameSlot = vFrameSlot % VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT;
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    for (auto& view : slot.imageViews) {
+        m_Device.destroyImageView(view);
+    }
+    slot.imageViews.clear();
+    if (!slot.descriptorPools.empty()) {
+        // the pools added for the records out of the frames are not kept
+        for (size_t idx = 1U; idx < slot.descriptorPools.size(); ++idx) {
+            m_Device.destroyDescriptorPool(slot.descriptorPools[idx]);
+        }
+        slot.descriptorPools.resize(1U);
+        m_Device.resetDescriptorPool(slot.descriptorPools[0]);
+    }
+    slot.dispatchsCount = 0U;
+}
+
+vk::DescriptorPool VulkanMipGenerator::CreateDescriptorPool() const {
+    ZoneScoped;
+    const vk::DescriptorPoolSize poolSize(vk::DescriptorType::eStorageImage, s_DescriptorSetsByPool * 3U);
+    return m_Device.createDescriptorPool(vk::DescriptorPoolCreateInfo(vk::DescriptorPoolCreateFlags(), s_DescriptorSetsByPool, 1U, &poolSize));
+}
+
+// without BeginFrame (records out of the frames, like the loads at the startup), the slot get a new pool when he is full
+// rather than refusing the records, the pools are released at the next BeginFrame of the slot
+vk::DescriptorSet VulkanMipGenerator::AllocateTransientDescriptorSet() {
+    ZoneScoped;
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    if (slot.descriptorPools.empty() || slot.dispatchsCount == s_DescriptorSetsByPool) {
+        slot.descriptorPools.push_back(CreateDescriptorPool());
+        slot.dispatchsCount = 0U;
+    }
+    ++slot.dispatchsCount;
+    return m_Device.allocateDescriptorSets(vk::DescriptorSetAllocateInfo(slot.descriptorPools.back(), 1U, &m_DescriptorSetLayout))[0];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// RECORD //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanMipGenerator::IsFormatSupported(const vk::Format& vFormat) const {
+    ZoneScoped;
+    bool extended = false;
+    if (GetGlslImageFormat(vFormat, &extended).empty() || (extended && !m_ExtendedFormatsSupported)) {
+        return false;
+    }
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+    const auto formatProperties = corePtr->getPhysicalDevice().getFormatProperties(vFormat);
+    return static_cast<bool>(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eStorageImage);
+}
+
+bool VulkanMipGenerator::RecordMipmaps(vk::CommandBuffer vCmd,
+    vk::Image vImage,
+    const vk::Format& vFormat,
+    const uint32_t& vWidth,
+    const uint32_t& vHeight,
+    const uint32_t& vMipLevelsCount,
+    const vk::ImageLayout& vOldLayout,
+    const vk::ImageLayout& vNewLayout) {
+    ZoneScoped;
+    if (vMipLevelsCount < 2U) {
+        return true;
+    }
+    if (!vCmd || !vImage || !vWidth || !vHeight) {
+        return false;
+    }
+
+    auto pipeline = GetPipeline(vFormat);
+    if (!pipeline) {
+        return false;
+    }
+
+    // two mips by dispatch
+    auto& slot = m_FrameSlots[m_FrameSlot];
+    std::vector<vk::ImageView> views(vMipLevelsCount);
+    for (uint32_t mip = 0U; mip < vMipLevelsCount; ++mip) {
+        views[mip] = CreateTransientMipView(vImage, vFormat, mip);
+    }
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.image = vImage;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, vMipLevelsCount, 0U, 1U);
+
+    // the mip 0 can have been written by a render pass, a compute or a transfer
+    barrier.oldLayout = vOldLayout;
+    barrier.newLayout = vk::ImageLayout::eGeneral;
+    barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite;
+    vCmd.pipelineBarrier(
+        vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), {}, {}, barrier);
+
+    vCmd.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline);
+
+    uint32_t srcMip = 0U;
+    uint32_t srcWidth = vWidth;
+    uint32_t srcHeight = vHeight;
+    while (srcMip + 1U < vMipLevelsCount) {
+        const uint32_t levelsCount = ez::mini(2U, vMipLevelsCount - 1U - srcMip);
+        const uint32_t dst0Width = ez::maxi(srcWidth / 2U, 1U);
+        const uint32_t dst0Height = ez::maxi(srcHeight / 2U, 1U);
+        const uint32_t dst1Width = ez::maxi(dst0Width / 2U, 1U);
+        const uint32_t dst1Height = ez::maxi(dst0Height / 2U, 1U);
+
+        const auto descriptorSet = AllocateTransientDescriptorSet();
+
+        // when only one mip is written, the second binding is not used by the shader but must be valid
+        const std::array<vk::DescriptorImageInfo, 3U> imageInfos = {
+            vk::DescriptorImageInfo(nullptr, views[srcMip], vk::ImageLayout::eGeneral),
+            vk::DescriptorImageInfo(nullptr, views[srcMip + 1U], vk::ImageLayout::eGeneral),
+            vk::DescriptorImageInfo(nullptr, views[srcMip + levelsCount], vk::ImageLayout::eGeneral),
+        };
+        std::array<vk::WriteDescriptorSet, 3U> writes;
+        for (uint32_t idx = 0U; idx < 3U; ++idx) {
+            writes[idx] = vk::WriteDescriptorSet(descriptorSet, idx, 0U, 1U, vk::DescriptorType::eStorageImage, &imageInfos[idx]);
+        }
+        m_Device.updateDescriptorSets(writes, nullptr);
+
+        PushConstants pushConstants = {};
+        pushConstants.srcSize[0] = (int32_t)srcWidth;
+        pushConstants.srcSize[1] = (int32_t)srcHeight;
+        pushConstants.dst0Size[0] = (int32_t)dst0Width;
+        pushConstants.dst0Size[1] = (int32_t)dst0Height;
+        pushConstants.dst1Size[0] = (int32_t)dst1Width;
+        pushConstants.dst1Size[1] = (int32_t)dst1Height;
+        pushConstants.levelsCount = (int32_t)levelsCount;
+
+        vCmd.bindDescriptorSets(vk::PipelineBindPoint::eCompute, m_PipelineLayout, 0U, descriptorSet, nullptr);
+        vCmd.pushConstants(m_PipelineLayout, vk::ShaderStageFlagBits::eCompute, 0U, sizeof(PushConstants), &pushConstants);
+        vCmd.dispatch((dst0Width + 7U) / 8U, (dst0Height + 7U) / 8U, 1U);
+
+        srcMip += levelsCount;
+        srcWidth = (levelsCount > 1U) ? dst1Width : dst0Width;
+        srcHeight = (levelsCount > 1U) ? dst1Height : dst0Height;
+
+        if (srcMip + 1U < vMipLevelsCount) {
+            // the last mip written is the source of the next dispatch
+            const vk::MemoryBarrier memoryBarrier(vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead);
+            vCmd.pipelineBarrier(
+                vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), memoryBarrier, {}, {});
+        }
+    }
+
+    barrier.oldLayout = vk::ImageLayout::eGeneral;
+    barrier.newLayout = vNewLayout;
+    barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+    vCmd.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+        vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags(),
+        {},
+        {},
+        barrier);
+
+    slot.imageViews.insert(slot.imageViews.end(), views.begin(), views.end());
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// PRIVATE /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+vk::Pipeline VulkanMipGenerator::GetPipeline(const vk::Format& vFormat) {
+    ZoneScoped;
+    auto it = m_Pipelines.find(vFormat);
+    if (it != m_Pipelines.end()) {
+        return it->second;
+    }
+
+    vk::Pipeline pipeline = nullptr;
+    if (IsFormatSupported(vFormat) && VulkanCore::sVulkanShader) {
+        const auto spirv = VulkanCore::sVulkanShader->CompileGLSLString(
+            GetShaderCode(vFormat), "comp", "VulkanMipGenerator_" + GetGlslImageFormat(vFormat));
+        if (!spirv.empty()) {
+            auto shaderModule = VulkanCore::sVulkanShader->CreateShaderModule(m_Device, spirv);
+            if (shaderModule) {
+                const auto stage = vk::PipelineShaderStageCreateInfo(vk::PipelineShaderStageCreateFlags(), vk::ShaderStageFlagBits::eCompute, shaderModule, "main");
+                pipeline = m_Device.createComputePipeline(nullptr, vk::ComputePipelineCreateInfo(vk::PipelineCreateFlags(), stage, m_PipelineLayout)).value;
+                VulkanCore::sVulkanShader->DestroyShaderModule(m_Device, shaderModule);
+            }
+        }
+    }
+    if (!pipeline) {
+        LogVarError("the mip generator cant generate the mips of the format %s", vk::to_string(vFormat).c_str());
+    }
+
+    // a failed format is not retried at each call
+    m_Pipelines[vFormat] = pipeline;
+    return pipeline;
+}
+
+std::string VulkanMipGenerator::GetShaderCode(const vk::Format& vFormat) const {
+    ZoneScoped;
+    const auto glslFormat = GetGlslImageFormat(vFormat);
+    const bool isUint = (glslFormat.size() > 2U && glslFormat.compare(glslFormat.size() - 2U, 2U, "ui") == 0);
+    const bool isSint = (!isUint && glslFormat.back() == 'i');
+    const std::string imageType = isUint ? "uimage2D" : (isSint ? "iimage2D" : "image2D");
+    const std::string texelType = isUint ? "uvec4" : (isSint ? "ivec4" : "vec4");
+
+    std::stringstream code;
+    code << "#version 450\n";
+    code << "layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;\n";
+    code << "layout(set = 0, binding = 0, " << glslFormat << ") uniform readonly " << imageType << " u_Src;\n";
+    code << "layout(set = 0, binding = 1, " << glslFormat << ") uniform writeonly " << imageType << " u_Dst0;\n";
+    code << "layout(set = 0, binding = 2, " << glslFormat << ") uniform writeonly " << imageType << " u_Dst1;\n";
+    code << "layout(push_constant) uniform PushConstants {\n";
+    code << "\tivec2 srcSize;\n";
+    code << "\tivec2 dst0Size;\n";
+    code << "\tivec2 dst1Size;\n";
+    code << "\tint levelsCount;\n";
+    code << "} pc;\n";
+    code << "shared " << texelType << " s_Texels[8][8];\n";
+    if (isUint || isSint) {
+        // no overflow of the sum for the 32 bits integers
+        code << texelType << " average(" << texelType << " a, " << texelType << " b, " << texelType << " c, " << texelType << " d) {\n";
+        code << "\treturn (a >> 2) + (b >> 2) + (c >> 2) + (d >> 2) + (((a & 3) + (b & 3) + (c & 3) + (d & 3)) >> 2);\n";
+        code << "}\n";
+    } else {
+        code << "vec4 average(vec4 a, vec4 b, vec4 c, vec4 d) {\n";
+        code << "\treturn (a + b + c + d) * 0.25;\n";
+        code << "}\n";
+    }
+    code << texelType << " loadSrc(ivec2 p) {\n";
+    code << "\treturn imageLoad(u_Src, min(p, pc.srcSize - 1));\n";
+    code << "}\n";
+    code << "void main() {\n";
+    code << "\tconst ivec2 local = ivec2(gl_LocalInvocationID.xy);\n";
+    code << "\tconst ivec2 coord = ivec2(gl_GlobalInvocationID.xy);\n";
+    // the invocations out of the mip take the texel of the edge, so the second mip is clamped too
+    code << "\tconst ivec2 src = min(coord, pc.dst0Size - 1) * 2;\n";
+    code << "\tconst " << texelType << " texel = average(loadSrc(src), loadSrc(src + ivec2(1, 0)), loadSrc(src + ivec2(0, 1)), loadSrc(src + ivec2(1, 1)));\n";
+    code << "\tif (all(lessThan(coord, pc.dst0Size))) {\n";
+    code << "\t\timageStore(u_Dst0, coord, texel);\n";
+    code << "\t}\n";
+    code << "\tif (pc.levelsCount > 1) {\n";
+    code << "\t\ts_Texels[local.y][local.x] = texel;\n";
+    code << "\t\tbarrier();\n";
+    code << "\t\tif (all(equal(local & 1, ivec2(0)))) {\n";
+    code << "\t\t\tconst ivec2 coord1 = coord >> 1;\n";
+    code << "\t\t\tif (all(lessThan(coord1, pc.dst1Size))) {\n";
+    code << "\t\t\t\timageStore(u_Dst1, coord1, average(s_Texels[local.y][local.x], s_Texels[local.y][local.x + 1], ";
+    code << "s_Texels[local.y + 1][local.x], s_Texels[local.y + 1][local.x + 1]));\n";
+    code << "\t\t\t}\n";
+    code << "\t\t}\n";
+    code << "\t}\n";
+    code << "}\n";
+    return code.str();
+}
+
+vk::ImageView VulkanMipGenerator::CreateTransientMipView(vk::Image vImage, const vk::Format& vFormat, const uint32_t& vMipLevel) {
+    ZoneScoped;
+    vk::ImageViewCreateInfo viewInfo;
+    viewInfo.image = vImage;
+    viewInfo.viewType = vk::ImageViewType::e2D;
+    viewInfo.format = vFormat;
+    viewInfo.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, vMipLevel, 1U, 0U, 1U);
+    return m_Device.createImageView(viewInfo);
+}
+
+}  // namespace GaiApi
@@ -21,9 +21,14 @@ limitations under the License.
 
 #include <Gaia/Core/VulkanCore.h>
 #include <Gaia/Core/VulkanCommandBuffer.h>
+#include <Gaia/Resources/VulkanMipGenerator.h>
+#include <Gaia/Resources/VulkanImageConverter.h>
+#include <Gaia/Resources/TextureContainer.h>
 
 #include <ezlibs/ezLog.hpp>
 
+#include <algorithm>
+
 #ifdef PROFILER_INCLUDE
 #include <vulkan/vulkan.hpp>
 #include PROFILER_INCLUDE
@@ -47,6 +52,42 @@ void VulkanBufferObject::UnmapMemory() {
     }
 }
 
+void VulkanDirtyRanges::Add(size_t vOffset, size_t vSize) {
+    if (vSize) {
+        m_Ranges.push_back({vOffset, vSize});
+        m_IsCoalesced = (m_Ranges.size() == 1U);
+    }
+}
+
+void VulkanDirtyRanges::Clear() {
+    m_Ranges.clear();
+    m_IsCoalesced = true;
+}
+
+bool VulkanDirtyRanges::IsEmpty() const {
+    return m_Ranges.empty();
+}
+
+const std::vector<VulkanBufferRange>& VulkanDirtyRanges::GetCoalescedRanges() {
+    ZoneScoped;
+    if (!m_IsCoalesced) {
+        std::sort(m_Ranges.begin(), m_Ranges.end(), [](const VulkanBufferRange& a, const VulkanBufferRange& b) { return a.offset < b.offset; });
+        size_t idx = 0U;
+        for (size_t i = 1U; i < m_Ranges.size(); ++i) {
+            auto& last = m_Ranges[idx];
+            const auto& cur = m_Ranges[i];
+            if (cur.offset <= last.offset + last.size) {  // overlapping or contiguous
+                last.size = std::max(last.size, cur.offset + cur.size - last.offset);
+            } else {
+                m_Ranges[++idx] = cur;
+            }
+        }
+        m_Ranges.resize(idx + 1U);
+        m_IsCoalesced = true;
+    }
+    return m_Ranges;
+}
+
 namespace GaiApi {
 
 //////////////////////////////////////////////////////////////////////////////////
@@ -104,6 +145,7 @@ VulkanImageObjectPtr VulkanRessource::createSharedImageObject(
 
     VulkanCore::check_error(vmaCreateImage(
         GaiApi::VulkanCore::sAllocator, (VkImageCreateInfo*)&image_info, &alloc_info, (VkImage*)&ret->image, &ret->alloc_meta, nullptr));
+    ret->image_usage = image_info.usage;
     if (vDebugLabel != nullptr) {
         vmaSetAllocationName(GaiApi::VulkanCore::sAllocator, ret->alloc_meta, vDebugLabel);
     }
@@ -173,11 +215,20 @@ VulkanImageObjectPtr VulkanRessource::createTextureImage2D(GaiApi::VulkanCoreWea
         VmaAllocationCreateInfo image_alloc_info = {};
         image_alloc_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY;
         auto familyQueueIndex = corePtr->getQueue(vk::QueueFlagBits::eGraphics).familyQueueIndex;
+        vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
+        if (mipLevelCount > 1) {
+            // the mips of the formats without linear blitting (ex : float32) are generated by the compute mip generator
+            const auto formatProperties = corePtr->getPhysicalDevice().getFormatProperties(format);
+            auto mipGeneratorPtr = corePtr->getMipGenerator().lock();
+            if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) &&  //
+                mipGeneratorPtr && mipGeneratorPtr->IsFormatSupported(format)) {
+                usage |= vk::ImageUsageFlagBits::eStorage;
+            }
+        }
         auto texturePtr = createSharedImageObject(vVulkanCore,
             vk::ImageCreateInfo(vk::ImageCreateFlags(), vk::ImageType::e2D, format, vk::Extent3D(vk::Extent2D(width, height), 1), mipLevelCount, 1u,
-                vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
-                vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-                vk::SharingMode::eExclusive, 1, &familyQueueIndex, vk::ImageLayout::eUndefined),
+                vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, usage, vk::SharingMode::eExclusive, 1, &familyQueueIndex,
+                vk::ImageLayout::eUndefined),
             image_alloc_info, vDebugLabel);
         if (texturePtr) {
             vk::BufferImageCopy copyParams(0u, 0u, 0u, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0u, 0u, 1), vk::Offset3D(0, 0, 0),
@@ -188,7 +239,7 @@ VulkanImageObjectPtr VulkanRessource::createTextureImage2D(GaiApi::VulkanCoreWea
                 vVulkanCore, texturePtr->image, format, mipLevelCount, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
             copy(vVulkanCore, texturePtr->image, stagebufferPtr->buffer, copyParams);
             if (mipLevelCount > 1) {
-                GenerateMipmaps(vVulkanCore, texturePtr->image, format, width, height, mipLevelCount);
+                GenerateMipmaps(vVulkanCore, texturePtr, format, width, height, mipLevelCount);
             } else {
                 transitionImageLayout(vVulkanCore, texturePtr->image, format, mipLevelCount, vk::ImageLayout::eTransferDstOptimal,
                     vk::ImageLayout::eShaderReadOnlyOptimal);
@@ -202,6 +253,99 @@ VulkanImageObjectPtr VulkanRessource::createTextureImage2D(GaiApi::VulkanCoreWea
     return nullptr;
 }
 
+VulkanImageObjectPtr VulkanRessource::createTextureImage2DFromPacked(GaiApi::VulkanCoreWeak vVulkanCore,
+    uint32_t width,
+    uint32_t height,
+    uint32_t mipLevelCount,
+    vk::Format format,
+    const void* hostdata_ptr,
+    uint32_t srcWidth,
+    uint32_t srcHeight,
+    uint32_t srcChannels,
+    uint32_t srcBytesPerComponent,
+    const char* vDebugLabel) {
+    ZoneScoped;
+
+    mipLevelCount = ez::maxi(mipLevelCount, 1u);
+
+    auto corePtr = vVulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    GaiApi::VulkanImageConverter::SourceLayout srcLayout;
+    srcLayout.width = srcWidth;
+    srcLayout.height = srcHeight;
+    srcLayout.channels = srcChannels;
+    srcLayout.bytesPerComponent = srcBytesPerComponent;
+
+    auto converterPtr = corePtr->getImageConverter().lock();
+    if (hostdata_ptr == nullptr || !width || !height || !converterPtr || !converterPtr->CanConvert(srcLayout, format)) {
+        return nullptr;
+    }
+
+    // the staging is the storage buffer read by the converter
+    vk::BufferCreateInfo stagingBufferInfo = {};
+    VmaAllocationCreateInfo stagingAllocInfo = {};
+    stagingBufferInfo.size = GaiApi::VulkanImageConverter::GetSourceBufferSize(srcLayout);
+    stagingBufferInfo.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+    stagingAllocInfo.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_TO_GPU;
+    auto stagebufferPtr = createSharedBufferObject(vVulkanCore, stagingBufferInfo, stagingAllocInfo, vDebugLabel);
+    if (!stagebufferPtr) {
+        return nullptr;
+    }
+    const size_t packedSize = (size_t)srcWidth * (size_t)srcHeight * (size_t)srcChannels * (size_t)srcBytesPerComponent;
+    upload(vVulkanCore, stagebufferPtr, const_cast<void*>(hostdata_ptr), packedSize);
+
+    VmaAllocationCreateInfo image_alloc_info = {};
+    image_alloc_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY;
+    auto familyQueueIndex = corePtr->getQueue(vk::QueueFlagBits::eGraphics).familyQueueIndex;
+    auto texturePtr = createSharedImageObject(vVulkanCore,
+        vk::ImageCreateInfo(vk::ImageCreateFlags(), vk::ImageType::e2D, format, vk::Extent3D(vk::Extent2D(width, height), 1), mipLevelCount, 1u,
+            vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+            vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc |
+                vk::ImageUsageFlagBits::eTransferDst,
+            vk::SharingMode::eExclusive, 1, &familyQueueIndex, vk::ImageLayout::eUndefined),
+        image_alloc_info, vDebugLabel);
+    if (!texturePtr) {
+        return nullptr;
+    }
+
+    vk::CommandBuffer commandBuffer = VulkanCommandBuffer::beginSingleTimeCommands(vVulkanCore, true);
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.image = texturePtr->image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, mipLevelCount, 0U, 1U);
+    barrier.oldLayout = vk::ImageLayout::eUndefined;
+    barrier.newLayout = vk::ImageLayout::eGeneral;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderWrite;
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), {}, {}, barrier);
+
+    bool res = converterPtr->RecordConversion(commandBuffer, stagebufferPtr->buffer, srcLayout, texturePtr->image, format, width, height);
+    if (res) {
+        if (mipLevelCount > 1) {
+            res = RecordMipmaps(vVulkanCore, commandBuffer, texturePtr, format, width, height, mipLevelCount, vk::ImageLayout::eGeneral,
+                vk::ImageLayout::eShaderReadOnlyOptimal);
+        } else {
+            barrier.oldLayout = vk::ImageLayout::eGeneral;
+            barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+            barrier.srcAccessMask = vk::AccessFlagBits::eShaderWrite;
+            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader, vk::DependencyFlags(), {}, {}, barrier);
+        }
+    }
+
+    VulkanCommandBuffer::flushSingleTimeCommands(vVulkanCore, commandBuffer, true);
+
+    if (!res) {
+        texturePtr.reset();
+    }
+
+    return texturePtr;
+}
+
 VulkanImageObjectPtr VulkanRessource::createTextureImage3D(GaiApi::VulkanCoreWeak vVulkanCore,
     uint32_t width,
     uint32_t height,
@@ -292,7 +436,7 @@ VulkanImageObjectPtr VulkanRessource::createTextureImageCube(GaiApi::VulkanCoreW
     uint32_t height,
     uint32_t mipLevelCount,
     vk::Format format,
-    std::array<std::vector<uint8_t>, 6U> hostdatas,
+    const std::array<std::vector<uint8_t>, 6U>& hostdatas,
     const char* vDebugLabel) {
     ZoneScoped;
 
@@ -344,8 +488,8 @@ VulkanImageObjectPtr VulkanRessource::createTextureImageCube(GaiApi::VulkanCoreW
     if (stagebufferPtr) {
         uint32_t off = 0U;
         const uint32_t& siz = width * height * channels * elem_size;
-        for (auto& datas : hostdatas) {
-            upload(vVulkanCore, stagebufferPtr, datas.data(), siz, off);
+        for (const auto& datas : hostdatas) {
+            upload(vVulkanCore, stagebufferPtr, (void*)datas.data(), siz, off);
             off += siz;
         }
 
@@ -365,17 +509,105 @@ VulkanImageObjectPtr VulkanRessource::createTextureImageCube(GaiApi::VulkanCoreW
             vk::BufferImageCopy copyParams(0u, 0u, 0u, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0u, 0u, 6U), vk::Offset3D(0, 0, 0),
                 vk::Extent3D(width, height, 1));
 
-            // on va copier que le mip level 0, on fera les autre dans GenerateMipmaps juste apres ce block
-            transitionImageLayout(
-                vVulkanCore, texturePtr->image, format, mipLevelCount, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, 6U);
-            copy(vVulkanCore, texturePtr->image, stagebufferPtr->buffer, copyParams);
+            // the 6 faces are copied in one region, then the mips of the 6 faces are generated together
+            // all in one command buffer, so only one submit and one wait
+            vk::ImageMemoryBarrier barrier = {};
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = texturePtr->image;
+            barrier.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, mipLevelCount, 0U, 6U);
+            barrier.oldLayout = vk::ImageLayout::eUndefined;
+            barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+            barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+
+            auto cmd = VulkanCommandBuffer::beginSingleTimeCommands(vVulkanCore, true);
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {}, barrier);
+            cmd.copyBufferToImage(stagebufferPtr->buffer, texturePtr->image, vk::ImageLayout::eTransferDstOptimal, copyParams);
+            bool mipsDone = false;
             if (mipLevelCount > 1) {
-                // todo for 6 images
-                // GenerateMipmaps(vVulkanCore, texturePtr->image, format, width, height, mipLevelCount);
-            } else {
-                transitionImageLayout(vVulkanCore, texturePtr->image, format, mipLevelCount, vk::ImageLayout::eTransferDstOptimal,
+                mipsDone = RecordMipmaps(vVulkanCore, cmd, texturePtr, format, width, height, mipLevelCount, vk::ImageLayout::eTransferDstOptimal,
                     vk::ImageLayout::eShaderReadOnlyOptimal, 6U);
             }
+            if (!mipsDone) {
+                barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+                barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+                barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+                barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+                cmd.pipelineBarrier(
+                    vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags(), {}, {}, barrier);
+            }
+            VulkanCommandBuffer::flushSingleTimeCommands(vVulkanCore, cmd, true);
+
+            return texturePtr;
+        }
+    }
+    return nullptr;
+}
+
+VulkanImageObjectPtr VulkanRessource::createTextureImageFromContainer(
+    GaiApi::VulkanCoreWeak vVulkanCore, TextureContainer& vContainer, const char* vDebugLabel) {
+    ZoneScoped;
+    if (!vContainer.IsLoaded()) {
+        return nullptr;
+    }
+
+    auto corePtr = vVulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    const auto isSampleable = [&corePtr](const vk::Format& vFormat) {
+        const auto props = corePtr->getPhysicalDevice().getFormatProperties(vFormat);
+        return static_cast<bool>(props.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImage);
+    };
+    if (!isSampleable(vContainer.GetFormat())) {
+        const auto format = vContainer.GetFormat();
+        if (!vContainer.DecompressToRgba8() || !isSampleable(vContainer.GetFormat())) {
+            LogVarError("the format %s is not supported by the device and cant be decompressed", vk::to_string(format).c_str());
+            return nullptr;
+        }
+        LogVarDebugInfo("Debug : the format %s is not supported by the device, the texture was decompressed to %s",  //
+            vk::to_string(format).c_str(), vk::to_string(vContainer.GetFormat()).c_str());
+    }
+
+    const auto format = vContainer.GetFormat();
+    const auto& levels = vContainer.GetLevels();
+    const uint32_t levelsCount = vContainer.GetLevelsCount();
+    const uint32_t arrayLayers = vContainer.GetLayersCount() * vContainer.GetFacesCount();
+    const bool is3D = (vContainer.GetDepth() > 1U);
+    const bool isCube = (vContainer.GetFacesCount() == 6U);
+
+    vk::BufferCreateInfo stagingBufferInfo = {};
+    VmaAllocationCreateInfo stagingAllocInfo = {};
+    stagingBufferInfo.size = vContainer.GetDatas().size();
+    stagingBufferInfo.usage = vk::BufferUsageFlagBits::eTransferSrc;
+    stagingAllocInfo.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_TO_GPU;
+    auto stagebufferPtr = createSharedBufferObject(vVulkanCore, stagingBufferInfo, stagingAllocInfo, vDebugLabel);
+    if (stagebufferPtr) {
+        upload(vVulkanCore, stagebufferPtr, (void*)vContainer.GetDatas().data(), stagingBufferInfo.size);
+
+        VmaAllocationCreateInfo image_alloc_info = {};
+        image_alloc_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY;
+        auto familyQueueIndex = corePtr->getQueue(vk::QueueFlagBits::eGraphics).familyQueueIndex;
+        auto texturePtr = createSharedImageObject(vVulkanCore,
+            vk::ImageCreateInfo(isCube ? vk::ImageCreateFlagBits::eCubeCompatible : vk::ImageCreateFlags(), is3D ? vk::ImageType::e3D : vk::ImageType::e2D,
+                format, vk::Extent3D(vContainer.GetWidth(), vContainer.GetHeight(), vContainer.GetDepth()), levelsCount, arrayLayers,
+                vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+                vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+                vk::SharingMode::eExclusive, 1, &familyQueueIndex, vk::ImageLayout::eUndefined),
+            image_alloc_info, vDebugLabel);
+        if (texturePtr) {
+            // one copy by level, the layers and faces of a level are contiguous in the container
+            std::vector<vk::BufferImageCopy> copyParams;
+            for (uint32_t idx = 0U; idx < levelsCount; ++idx) {
+                const auto& level = levels[idx];
+                copyParams.emplace_back(level.offset, 0u, 0u, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, idx, 0u, arrayLayers),
+                    vk::Offset3D(0, 0, 0), vk::Extent3D(level.width, level.height, level.depth));
+            }
+
+            transitionImageLayout(
+                vVulkanCore, texturePtr->image, format, levelsCount, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, arrayLayers);
+            copy(vVulkanCore, texturePtr->image, stagebufferPtr->buffer, copyParams);
+            transitionImageLayout(vVulkanCore, texturePtr->image, format, levelsCount, vk::ImageLayout::eTransferDstOptimal,
+                vk::ImageLayout::eShaderReadOnlyOptimal, arrayLayers);
 
             return texturePtr;
         }
@@ -400,6 +632,56 @@ void VulkanRessource::getDatasFromTextureImage2D(VulkanCoreWeak vVulkanCore,
     ZoneScoped;
 }
 
+bool VulkanRessource::getDatasFromTextureImage(
+    GaiApi::VulkanCoreWeak vVulkanCore, const VulkanImageObjectPtr& vImagePtr, TextureContainer& vContainer) {
+    ZoneScoped;
+    if (!vImagePtr || !vContainer.IsLoaded() || !(vImagePtr->image_usage & vk::ImageUsageFlagBits::eTransferSrc)) {
+        return false;
+    }
+
+    vk::BufferCreateInfo readbackBufferInfo = {};
+    VmaAllocationCreateInfo readbackAllocInfo = {};
+    readbackBufferInfo.size = vContainer.GetDatas().size();
+    readbackBufferInfo.usage = vk::BufferUsageFlagBits::eTransferDst;
+    readbackAllocInfo.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_TO_CPU;
+    auto readbackBufferPtr = createSharedBufferObject(vVulkanCore, readbackBufferInfo, readbackAllocInfo, "ReadbackBuffer");
+    if (!readbackBufferPtr) {
+        return false;
+    }
+
+    const uint32_t levelsCount = vContainer.GetLevelsCount();
+    const uint32_t arrayLayers = vContainer.GetLayersCount() * vContainer.GetFacesCount();
+    std::vector<vk::BufferImageCopy> copyParams;
+    for (uint32_t idx = 0U; idx < levelsCount; ++idx) {
+        const auto& level = vContainer.GetLevels()[idx];
+        copyParams.emplace_back(level.offset, 0u, 0u, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, idx, 0u, arrayLayers),
+            vk::Offset3D(0, 0, 0), vk::Extent3D(level.width, level.height, level.depth));
+    }
+
+    vk::ImageMemoryBarrier barrier = {};
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = vImagePtr->image;
+    barrier.subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0U, levelsCount, 0U, arrayLayers);
+
+    auto cmd = VulkanCommandBuffer::beginSingleTimeCommands(vVulkanCore, true);
+    barrier.oldLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+    barrier.srcAccessMask = vk::AccessFlagBits::eShaderRead;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {}, barrier);
+    cmd.copyImageToBuffer(vImagePtr->image, vk::ImageLayout::eTransferSrcOptimal, readbackBufferPtr->buffer, copyParams);
+    barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+    barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+    cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, vk::DependencyFlags(), {}, {}, barrier);
+    VulkanCommandBuffer::flushSingleTimeCommands(vVulkanCore, cmd, true);
+
+    VulkanCore::check_error(vmaInvalidateAllocation(VulkanCore::sAllocator, readbackBufferPtr->alloc_meta, 0U, VK_WHOLE_SIZE));
+    return download(vVulkanCore, readbackBufferPtr, vContainer.GetWritableDatas(), vContainer.GetDatas().size());
+}
+
 VulkanImageObjectPtr VulkanRessource::createColorAttachment2D(GaiApi::VulkanCoreWeak vVulkanCore,
     uint32_t width,
     uint32_t height,
@@ -435,6 +717,15 @@ VulkanImageObjectPtr VulkanRessource::createColorAttachment2D(GaiApi::VulkanCore
         //| vk::ImageUsageFlagBits::eAttachmentFeedbackLoopEXT  //
         //| vk::ImageUsageFlagBits::eStorage                    //
         ;
+    if (mipLevelCount > 1U) {
+        // the mips are generated by the compute mip generator when possible, else by blits (see RecordMipmaps)
+        auto mipGeneratorPtr = corePtr->getMipGenerator().lock();
+        if (mipGeneratorPtr && mipGeneratorPtr->IsFormatSupported(format)) {
+            imageInfo.usage |= vk::ImageUsageFlagBits::eStorage;
+        } else {
+            imageInfo.usage |= vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+        }
+    }
 
     if (familyIndices.size() > 1)
         imageInfo.sharingMode = vk::SharingMode::eConcurrent;
@@ -506,6 +797,49 @@ VulkanImageObjectPtr VulkanRessource::createComputeTarget2D(GaiApi::VulkanCoreWe
     return vkoPtr;
 }
 
+VulkanImageObjectPtr VulkanRessource::createStorageTextureCube(GaiApi::VulkanCoreWeak vVulkanCore,
+    uint32_t faceSize,
+    uint32_t mipLevelCount,
+    vk::Format format,
+    const char* vDebugLabel) {
+    ZoneScoped;
+
+    mipLevelCount = ez::maxi(mipLevelCount, 1u);
+
+    auto corePtr = vVulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    auto graphicQueue = corePtr->getQueue(vk::QueueFlagBits::eGraphics);
+    auto computeQueue = corePtr->getQueue(vk::QueueFlagBits::eCompute);
+    std::vector<uint32_t> familyIndices = {graphicQueue.familyQueueIndex};
+    if (computeQueue.familyQueueIndex != graphicQueue.familyQueueIndex)
+        familyIndices.push_back(computeQueue.familyQueueIndex);
+
+    vk::ImageCreateInfo imageInfo = {};
+    imageInfo.flags = vk::ImageCreateFlagBits::eCubeCompatible;
+    imageInfo.imageType = vk::ImageType::e2D;
+    imageInfo.format = format;
+    imageInfo.extent = vk::Extent3D(faceSize, faceSize, 1);
+    imageInfo.mipLevels = mipLevelCount;
+    imageInfo.arrayLayers = 6U;
+    imageInfo.samples = vk::SampleCountFlagBits::e1;
+    imageInfo.tiling = vk::ImageTiling::eOptimal;
+    imageInfo.usage = vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled |  //
+        vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+    if (familyIndices.size() > 1)
+        imageInfo.sharingMode = vk::SharingMode::eConcurrent;
+    else
+        imageInfo.sharingMode = vk::SharingMode::eExclusive;
+    imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(familyIndices.size());
+    imageInfo.pQueueFamilyIndices = familyIndices.data();
+    imageInfo.initialLayout = vk::ImageLayout::eUndefined;
+
+    VmaAllocationCreateInfo image_alloc_info = {};
+    image_alloc_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY;
+
+    return VulkanRessource::createSharedImageObject(vVulkanCore, imageInfo, image_alloc_info, vDebugLabel);
+}
+
 VulkanImageObjectPtr VulkanRessource::createDepthAttachment(GaiApi::VulkanCoreWeak vVulkanCore,
     uint32_t width,
     uint32_t height,
@@ -544,90 +878,137 @@ VulkanImageObjectPtr VulkanRessource::createDepthAttachment(GaiApi::VulkanCoreWe
     return VulkanRessource::createSharedImageObject(vVulkanCore, imageInfo, image_alloc_info, vDebugLabel);
 }
 
-void VulkanRessource::GenerateMipmaps(
-    GaiApi::VulkanCoreWeak vVulkanCore, vk::Image image, vk::Format imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels) {
+bool VulkanRessource::GenerateMipmaps(GaiApi::VulkanCoreWeak vVulkanCore,
+    const VulkanImageObjectPtr& vImagePtr,
+    vk::Format imageFormat,
+    int32_t texWidth,
+    int32_t texHeight,
+    uint32_t mipLevels,
+    vk::ImageLayout vOldLayout,
+    vk::ImageLayout vNewLayout,
+    uint32_t vLayersCount) {
     ZoneScoped;
-
-    if (mipLevels > 1) {
-        auto corePtr = vVulkanCore.lock();
-        assert(corePtr != nullptr);
-
-        corePtr->getDevice().waitIdle();
-        auto physDevice = corePtr->getPhysicalDevice();
-
-        // Check if image format supports linear blitting
-        vk::FormatProperties formatProperties = physDevice.getFormatProperties(imageFormat);
-
-        if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
-            throw std::runtime_error("texture image format does not support linear blitting!");
-        }
-
+    bool res = true;
+    if (mipLevels > 1 && vImagePtr != nullptr) {
         vk::CommandBuffer commandBuffer = VulkanCommandBuffer::beginSingleTimeCommands(vVulkanCore, true);
+        res = RecordMipmaps(vVulkanCore, commandBuffer, vImagePtr, imageFormat, texWidth, texHeight, mipLevels, vOldLayout, vNewLayout, vLayersCount);
+        VulkanCommandBuffer::flushSingleTimeCommands(vVulkanCore, commandBuffer, true);
+    }
+    return res;
+}
 
-        vk::ImageMemoryBarrier barrier;
-        barrier.image = image;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.subresourceRange.levelCount = 1;
-
-        int32_t mipWidth = texWidth;
-        int32_t mipHeight = texHeight;
+bool VulkanRessource::RecordMipmaps(GaiApi::VulkanCoreWeak vVulkanCore,
+    vk::CommandBuffer vCmd,
+    const VulkanImageObjectPtr& vImagePtr,
+    vk::Format imageFormat,
+    int32_t texWidth,
+    int32_t texHeight,
+    uint32_t mipLevels,
+    vk::ImageLayout vOldLayout,
+    vk::ImageLayout vNewLayout,
+    uint32_t vLayersCount) {
+    ZoneScoped;
 
-        for (uint32_t i = 1; i < mipLevels; ++i) {
-            barrier.subresourceRange.baseMipLevel = i - 1;
-            barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-            barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
-            barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
-
-            commandBuffer.pipelineBarrier(
-                vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {}, barrier);
-
-            VkImageBlit blit{};
-            blit.srcOffsets[0] = {0, 0, 0};
-            blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
-            blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.srcSubresource.mipLevel = i - 1;
-            blit.srcSubresource.baseArrayLayer = 0;
-            blit.srcSubresource.layerCount = 1;
-            blit.dstOffsets[0] = {0, 0, 0};
-            blit.dstOffsets[1] = {mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1};
-            blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.dstSubresource.mipLevel = i;
-            blit.dstSubresource.baseArrayLayer = 0;
-            blit.dstSubresource.layerCount = 1;
-
-            VULKAN_HPP_DEFAULT_DISPATCHER.vkCmdBlitImage((VkCommandBuffer)commandBuffer, (VkImage)image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                (VkImage)image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
-
-            barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
-            barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
-            barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
-            barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+    if (mipLevels < 2) {
+        return true;
+    }
+    if (!vCmd || vImagePtr == nullptr) {
+        return false;
+    }
 
-            commandBuffer.pipelineBarrier(
-                vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags(), {}, {}, barrier);
+    auto corePtr = vVulkanCore.lock();
+    assert(corePtr != nullptr);
 
-            if (mipWidth > 1)
-                mipWidth /= 2;
-            if (mipHeight > 1)
-                mipHeight /= 2;
+    // compute path, no need of the linear filtering. the mip generator use 2D views, so one layer only
+    if ((vImagePtr->image_usage & vk::ImageUsageFlagBits::eStorage) && vLayersCount == 1U) {
+        auto mipGeneratorPtr = corePtr->getMipGenerator().lock();
+        if (mipGeneratorPtr && mipGeneratorPtr->IsFormatSupported(imageFormat)) {
+            return mipGeneratorPtr->RecordMipmaps(
+                vCmd, vImagePtr->image, imageFormat, (uint32_t)texWidth, (uint32_t)texHeight, mipLevels, vOldLayout, vNewLayout);
         }
+    }
 
-        barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    // blit path
+    const auto formatProperties = corePtr->getPhysicalDevice().getFormatProperties(imageFormat);
+    const auto transferUsages = vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst;
+    if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear) ||
+        (vImagePtr->image_usage & transferUsages) != transferUsages) {
+        LogVarError("the mips of the format %s cant be generated (no storage usage or no linear blitting)", vk::to_string(imageFormat).c_str());
+        return false;
+    }
+
+    vk::ImageMemoryBarrier barrier;
+    barrier.image = vImagePtr->image;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = vk::ImageAspectFlagBits::eColor;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = vLayersCount;
+
+    // all the mips in transfer dst
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = mipLevels;
+    barrier.oldLayout = vOldLayout;
+    barrier.newLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.srcAccessMask = vk::AccessFlagBits::eMemoryWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eTransferWrite;
+    vCmd.pipelineBarrier(vk::PipelineStageFlagBits::eAllCommands, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {}, barrier);
+
+    barrier.subresourceRange.levelCount = 1;
+
+    int32_t mipWidth = texWidth;
+    int32_t mipHeight = texHeight;
+
+    for (uint32_t i = 1; i < mipLevels; ++i) {
+        barrier.subresourceRange.baseMipLevel = i - 1;
         barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
-        barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
         barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+
+        vCmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), {}, {}, barrier);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[0] = {0, 0, 0};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.srcSubresource.mipLevel = i - 1;
+        blit.srcSubresource.baseArrayLayer = 0;
+        blit.srcSubresource.layerCount = vLayersCount;
+        blit.dstOffsets[0] = {0, 0, 0};
+        blit.dstOffsets[1] = {mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1};
+        blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        blit.dstSubresource.mipLevel = i;
+        blit.dstSubresource.baseArrayLayer = 0;
+        blit.dstSubresource.layerCount = vLayersCount;
+
+        VULKAN_HPP_DEFAULT_DISPATCHER.vkCmdBlitImage((VkCommandBuffer)vCmd, (VkImage)vImagePtr->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            (VkImage)vImagePtr->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+        barrier.newLayout = vNewLayout;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
         barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
 
-        commandBuffer.pipelineBarrier(
-            vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, vk::DependencyFlags(), {}, {}, barrier);
+        vCmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+            vk::DependencyFlags(), {}, {}, barrier);
 
-        VulkanCommandBuffer::flushSingleTimeCommands(vVulkanCore, commandBuffer, true);
+        if (mipWidth > 1)
+            mipWidth /= 2;
+        if (mipHeight > 1)
+            mipHeight /= 2;
     }
+
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.newLayout = vNewLayout;
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+
+    vCmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader,
+        vk::DependencyFlags(), {}, {}, barrier);
+
+    return true;
 }
 
 void VulkanRessource::transitionImageLayout(GaiApi::VulkanCoreWeak vVulkanCore,
@@ -778,6 +1159,13 @@ bool VulkanRessource::upload(
             return false;
         }
 
+        // persistently mapped, no need to map/unmap
+        if (dstHostVisiblePtr->mapped_data) {
+            memcpy((uint8_t*)dstHostVisiblePtr->mapped_data + dst_offset, src_host, size_bytes);
+            VulkanCore::check_error(vmaFlushAllocation(GaiApi::VulkanCore::sAllocator, dstHostVisiblePtr->alloc_meta, dst_offset, size_bytes));
+            return true;
+        }
+
         void* dst = nullptr;
         auto result = (vk::Result)vmaMapMemory(GaiApi::VulkanCore::sAllocator, dstHostVisiblePtr->alloc_meta, &dst);
         VulkanCore::check_error(result);
@@ -790,6 +1178,50 @@ bool VulkanRessource::upload(
     return false;
 }
 
+bool VulkanRessource::uploadRanges(
+    VulkanCoreWeak vVulkanCore, VulkanBufferObjectPtr dstHostVisiblePtr, const uint8_t* src_host, VulkanDirtyRanges& vRanges, size_t dst_offset) {
+    ZoneScoped;
+
+    if (!vVulkanCore.expired() && dstHostVisiblePtr && src_host && !vRanges.IsEmpty()) {
+        if (dstHostVisiblePtr->alloc_usage == VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_ONLY) {
+            LogVarDebugInfo("Debug : upload not done because it is VMA_MEMORY_USAGE_GPU_ONLY");
+            return false;
+        }
+
+        void* dst = dstHostVisiblePtr->mapped_data;
+        if (!dst) {
+            auto result = (vk::Result)vmaMapMemory(GaiApi::VulkanCore::sAllocator, dstHostVisiblePtr->alloc_meta, &dst);
+            VulkanCore::check_error(result);
+            if (result != vk::Result::eSuccess) {
+                return false;
+            }
+        }
+
+        const auto& ranges = vRanges.GetCoalescedRanges();
+        std::vector<VmaAllocation> allocs(ranges.size(), dstHostVisiblePtr->alloc_meta);
+        std::vector<VkDeviceSize> offsets(ranges.size());
+        std::vector<VkDeviceSize> sizes(ranges.size());
+        for (size_t i = 0U; i < ranges.size(); ++i) {
+            const auto& range = ranges[i];
+            memcpy((uint8_t*)dst + dst_offset + range.offset, src_host + range.offset, range.size);
+            offsets[i] = dst_offset + range.offset;
+            sizes[i] = range.size;
+        }
+
+        // one flush for all ranges, is a no-op on host coherent memory
+        VulkanCore::check_error(vmaFlushAllocations(
+            GaiApi::VulkanCore::sAllocator, (uint32_t)allocs.size(), allocs.data(), offsets.data(), sizes.data()));
+
+        if (!dstHostVisiblePtr->mapped_data) {
+            vmaUnmapMemory(GaiApi::VulkanCore::sAllocator, dstHostVisiblePtr->alloc_meta);
+        }
+
+        vRanges.Clear();
+        return true;
+    }
+    return false;
+}
+
 bool VulkanRessource::download(GaiApi::VulkanCoreWeak vVulkanCore, VulkanBufferObjectPtr srcHostVisiblePtr, void* dst_host, size_t size_bytes) {
     ZoneScoped;
 
@@ -832,9 +1264,13 @@ VulkanBufferObjectPtr VulkanRessource::createSharedBufferObject(
     if (dataPtr) {
         dataPtr->alloc_usage = alloc_info.usage;
         dataPtr->buffer_usage = bufferinfo.usage;
+        VmaAllocationInfo vma_alloc_info = {};
         VulkanCore::check_error(vmaCreateBuffer(GaiApi::VulkanCore::sAllocator, (VkBufferCreateInfo*)&bufferinfo, &alloc_info,
-            (VkBuffer*)&dataPtr->buffer, &dataPtr->alloc_meta, nullptr));
+            (VkBuffer*)&dataPtr->buffer, &dataPtr->alloc_meta, &vma_alloc_info));
         if (dataPtr && dataPtr->buffer) {
+            if (alloc_info.flags & VMA_ALLOCATION_CREATE_MAPPED_BIT) {
+                dataPtr->mapped_data = vma_alloc_info.pMappedData;
+            }
             if (vDebugLabel != nullptr) {
                 vmaSetAllocationName(GaiApi::VulkanCore::sAllocator, dataPtr->alloc_meta, vDebugLabel);
             }
@@ -857,6 +1293,7 @@ VulkanBufferObjectPtr VulkanRessource::createUniformBufferObject(GaiApi::VulkanC
     sbo_create_info.size = vSize;
     sbo_create_info.usage = vk::BufferUsageFlagBits::eUniformBuffer;
     sbo_alloc_info.usage = VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_TO_GPU;
+    sbo_alloc_info.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;  // persistent mapping, avoid a map/unmap per upload
 
     return createSharedBufferObject(vVulkanCore, sbo_create_info, sbo_alloc_info, vDebugLabel);
 }
@@ -903,6 +1340,7 @@ VulkanBufferObjectPtr VulkanRessource::createStorageBufferObject(
 
     if (vMemoryUsage == VmaMemoryUsage::VMA_MEMORY_USAGE_CPU_TO_GPU) {
         storageBufferInfo.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst;
+        storageAllocInfo.flags = VMA_ALLOCATION_CREATE_MAPPED_BIT;  // persistent mapping, avoid a map/unmap per upload
         return createSharedBufferObject(vVulkanCore, storageBufferInfo, storageAllocInfo, vDebugLabel);
     } else if (vMemoryUsage == VmaMemoryUsage::VMA_MEMORY_USAGE_GPU_TO_CPU) {
         storageBufferInfo.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferSrc;
@@ -0,0 +1,165 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Resources/VulkanUniformArena.h>
+#include <Gaia/Core/VulkanCore.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <cstring>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace GaiApi {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanUniformArenaPtr VulkanUniformArena::Create(VulkanCoreWeak vVulkanCore, const uint64_t& vFrameSizeInBytes) {
+    ZoneScoped;
+    auto res = std::make_shared<VulkanUniformArena>(vVulkanCore);
+    if (!res->Init(vFrameSizeInBytes)) {
+        res.reset();
+    }
+    return res;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// CONSTRUCTOR /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+VulkanUniformArena::VulkanUniformArena(VulkanCoreWeak vVulkanCore) : m_VulkanCore(vVulkanCore) {
+    ZoneScoped;
+}
+
+VulkanUniformArena::~VulkanUniformArena() {
+    ZoneScoped;
+    Unit();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// INIT / UNIT /////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool VulkanUniformArena::Init(const uint64_t& vFrameSizeInBytes) {
+    ZoneScoped;
+    auto corePtr = m_VulkanCore.lock();
+    assert(corePtr != nullptr);
+
+    const auto& limits = corePtr->getPhysicalDevice().getProperties().limits;
+    m_Alignment = ez::maxi<uint64_t>(limits.minUniformBufferOffsetAlignment, 1U);
+    m_FrameSize = m_Alignment * ((vFrameSizeInBytes + m_Alignment - 1U) / m_Alignment);
+
+    m_BufferObjectPtr =
+        VulkanRessource::createUniformBufferObject(m_VulkanCore, m_FrameSize * VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT, "VulkanUniformArena");
+    if (m_BufferObjectPtr && m_BufferObjectPtr->mapped_data) {
+        m_FrameSlot = 0U;
+        m_Head = 0U;
+        m_FlushedHead = 0U;
+        return true;
+    }
+
+    LogVarError("Fail to create the uniform arena of %u bytes", (uint32_t)(m_FrameSize * VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT));
+    m_BufferObjectPtr.reset();
+    return false;
+}
+
+void VulkanUniformArena::Unit() {
+    ZoneScoped;
+    m_BufferObjectPtr.reset();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// FRAME ///////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void VulkanUniformArena::BeginFrame(const uint32_t& vFrameSlot) {
+    ZoneScoped;
+    Flush();
+    m_FrameSlot = vFrameSlot % VulkanSwapChain::SWAPCHAIN_IMAGES_COUNT;
+    m_Head = 0U;
+    m_FlushedHead = 0U;
+    ++m_FrameCounter;
+}
+
+bool VulkanUniformArena::Push(const void* vDatas, const uint32_t& vSizeInBytes, uint32_t& vOutDynamicOffset) {
+    ZoneScoped;
+    if (m_BufferObjectPtr && vDatas && vSizeInBytes) {
+        const uint64_t start = m_Alignment * ((m_Head + m_Alignment - 1U) / m_Alignment);
+        if (start + vSizeInBytes > m_FrameSize) {
+            if (!m_OverflowWasLogged) {
+                LogVarError("the uniform arena is full (%u bytes by frame), a bigger size is needed", (uint32_t)m_FrameSize);
+                m_OverflowWasLogged = true;
+            }
+            return false;
+        }
+        const uint64_t offset = m_FrameSlot * m_FrameSize + start;
+        memcpy((uint8_t*)m_BufferObjectPtr->mapped_data + offset, vDatas, vSizeInBytes);
+        m_Head = start + vSizeInBytes;
+        m_PeakUsedSize = ez::maxi(m_PeakUsedSize, m_Head);
+        vOutDynamicOffset = (uint32_t)offset;
+        return true;
+    }
+    return false;
+}
+
+void VulkanUniformArena::Flush() {
+    ZoneScoped;
+    if (m_BufferObjectPtr && m_Head > m_FlushedHead) {
+        const uint64_t regionOffset = m_FrameSlot * m_FrameSize;
+        VulkanCore::check_error(
+            vmaFlushAllocation(VulkanCore::sAllocator, m_BufferObjectPtr->alloc_meta, regionOffset + m_FlushedHead, m_Head - m_FlushedHead));
+        m_FlushedHead = m_Head;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//// GETTERS /////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+vk::Buffer VulkanUniformArena::GetBuffer() const {
+    if (m_BufferObjectPtr) {
+        return m_BufferObjectPtr->buffer;
+    }
+    return nullptr;
+}
+
+uint64_t VulkanUniformArena::GetFrameCounter() const {
+    return m_FrameCounter;
+}
+
+uint64_t VulkanUniformArena::GetUsedSize() const {
+    return m_Head;
+}
+
+uint64_t VulkanUniformArena::GetPeakUsedSize() const {
+    return m_PeakUsedSize;
+}
+
+uint64_t VulkanUniformArena::GetFrameSize() const {
+    return m_FrameSize;
+}
+
+}  // namespace GaiApi
@@ -18,6 +18,7 @@ limitations under the License.
 // PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
 
 #include <Gaia/Shader/IRUniformsLocator.h>
+#include <Gaia/Shader/VulkanShader.h>
 
 #ifdef PROFILER_INCLUDE
 #include <vulkan/vulkan.hpp>
@@ -49,17 +50,47 @@ bool TIRUniformsLocator::visitBinary(glslang::TVisit /* visit */, glslang::TInte
                 std::string newName = symbol->getName().c_str();  // "anon@0"
                 usedUniforms[name] = true;
             }
+            if (qualifier.storage == glslang::TStorageQualifier::EvqUniform || qualifier.storage == glslang::TStorageQualifier::EvqBuffer) {
+                // the block name, like UBO_Frag
+                usedBindings.emplace(symbol->getType().getTypeName().c_str());
+            }
         }
     }
 
     return true;
 }
 
+bool TIRUniformsLocator::visitAggregate(glslang::TVisit /* visit */, glslang::TIntermAggregate* vNode) {
+    ZoneScoped;
+    if (vNode->getOp() != glslang::EOpLinkerObjects) {
+        return true;
+    }
+    // the declared samplers are in usedUniforms, but the bindings not reached by the code are not in usedBindings
+    inLinkerObjects = true;
+    for (auto* child : vNode->getSequence()) {
+        auto symbol = child->getAsSymbolNode();
+        if (symbol) {
+            visitSymbol(symbol);
+        }
+    }
+    inLinkerObjects = false;
+    return false;
+}
+
 void TIRUniformsLocator::visitSymbol(glslang::TIntermSymbol* vNode) {
     ZoneScoped;
 
     using namespace glslang;
 
+    // the binding of all the ressources reached by the code (blocks, samplers, images, acceleration structures..)
+    auto qualifier = vNode->getQualifier();
+    if (!inLinkerObjects &&
+        (qualifier.storage == glslang::TStorageQualifier::EvqUniform || qualifier.storage == glslang::TStorageQualifier::EvqBuffer) &&
+        qualifier.hasBinding()) {
+        const uint32_t setIndex = qualifier.hasSet() ? (uint32_t)qualifier.layoutSet : 0U;
+        usedBindings.emplace(VulkanShader::GetBindingKey(setIndex, (uint32_t)qualifier.layoutBinding));
+    }
+
     // on va recuper les noms de samplers
     if (vNode->getBasicType() == TBasicType::EbtSampler) {
         auto qualifier = vNode->getQualifier();
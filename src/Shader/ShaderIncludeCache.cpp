@@ -0,0 +1,148 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Shader/ShaderIncludeCache.h>
+
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+static bool LoadFile(const std::string& vFilePathName, std::string& vOutContent) {
+    std::ifstream file(vFilePathName, std::ios_base::binary);
+    if (file.is_open()) {
+        vOutContent.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return true;
+    }
+    return false;
+}
+
+std::string ShaderIncludeCache::NormalizePath(const std::string& vFilePathName) {
+    ZoneScoped;
+    std::string res = vFilePathName;
+    std::replace(res.begin(), res.end(), '\\', '/');
+    while (res.size() > 2U && res[0] == '.' && res[1] == '/') {
+        res = res.substr(2U);
+    }
+    return res;
+}
+
+std::string ShaderIncludeCache::GetUnitName(const std::string& vShaderName, const std::string& vShaderSuffix) {
+    return vShaderName + "." + vShaderSuffix;
+}
+
+std::string ShaderIncludeCache::GetCompileKey(const std::string& vUnitName, const std::string& vDefines, const std::string& vOptions) {
+    if (vDefines.empty() && vOptions.empty()) {
+        return vUnitName;
+    }
+    return vUnitName + "|" + vDefines + "|" + vOptions;
+}
+
+bool ShaderIncludeCache::GetFileContent(const std::string& vFilePathName, std::string& vOutContent, size_t* vOutHash) {
+    ZoneScoped;
+    const auto path = NormalizePath(vFilePathName);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Files.find(path);
+    if (it == m_Files.end()) {
+        FileStruct file;
+        if (!LoadFile(path, file.content)) {
+            return false;  // the non existence is not cached, the include search try many paths
+        }
+        file.hash = std::hash<std::string>()(file.content);
+        it = m_Files.emplace(path, file).first;
+    }
+    vOutContent = it->second.content;
+    if (vOutHash) {
+        *vOutHash = it->second.hash;
+    }
+    return true;
+}
+
+void ShaderIncludeCache::SetFileContent(const std::string& vFilePathName, const std::string& vContent) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto& file = m_Files[NormalizePath(vFilePathName)];
+    file.content = vContent;
+    file.hash = std::hash<std::string>()(vContent);
+}
+
+std::set<std::string> ShaderIncludeCache::UpdateFiles(const std::set<std::string>& vFilePathNames) {
+    ZoneScoped;
+    std::set<std::string> res;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const auto& filePathName : vFilePathNames) {
+        const auto path = NormalizePath(filePathName);
+        auto it = m_Files.find(path);
+        if (it != m_Files.end()) {  // a file not in the cache is not used by a shader
+            std::string content;
+            if (LoadFile(path, content)) {
+                const auto hash = std::hash<std::string>()(content);
+                if (hash != it->second.hash) {
+                    it->second.content = content;
+                    it->second.hash = hash;
+                    res.emplace(path);
+                }
+            }
+        }
+    }
+    return res;
+}
+
+void ShaderIncludeCache::SetDependencies(const std::string& vCompileKey, const DependenciesContainer& vDependencies) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Dependencies[vCompileKey] = vDependencies;
+}
+
+ShaderIncludeCache::DependenciesContainer ShaderIncludeCache::GetDependencies(const std::string& vCompileKey) const {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    const auto it = m_Dependencies.find(vCompileKey);
+    if (it != m_Dependencies.end()) {
+        return it->second;
+    }
+    return {};
+}
+
+bool ShaderIncludeCache::IsOutdated(const DependenciesContainer& vDependencies) const {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const auto& dep : vDependencies) {
+        const auto it = m_Files.find(dep.first);
+        if (it != m_Files.end() && it->second.hash != dep.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ShaderIncludeCache::Clear() {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Files.clear();
+    m_Dependencies.clear();
+}
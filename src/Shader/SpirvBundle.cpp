@@ -0,0 +1,311 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Shader/SpirvBundle.h>
+#include <ezlibs/ezLog.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <sstream>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////
+//// SERIALIZATION ///////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+class BundleWriter {
+public:
+    std::vector<uint8_t> datas;
+
+public:
+    void writeU32(const uint32_t& vValue) {
+        writeBytes(&vValue, sizeof(vValue));
+    }
+    void writeU64(const uint64_t& vValue) {
+        writeBytes(&vValue, sizeof(vValue));
+    }
+    void writeString(const std::string& vString) {
+        writeU32((uint32_t)vString.size());
+        writeBytes(vString.data(), vString.size());
+    }
+    void writeBytes(const void* vDatas, const size_t& vSize) {
+        const auto* ptr = (const uint8_t*)vDatas;
+        datas.insert(datas.end(), ptr, ptr + vSize);
+    }
+};
+
+// all the reads are checked, a truncated or corrupted bundle is rejected
+class BundleReader {
+private:
+    const uint8_t* m_Datas = nullptr;
+    size_t m_Size = 0U;
+    size_t m_Pos = 0U;
+
+public:
+    BundleReader(const uint8_t* vDatas, const size_t& vSize) : m_Datas(vDatas), m_Size(vSize) {}
+    bool readU32(uint32_t& vOutValue) {
+        return readBytes(&vOutValue, sizeof(vOutValue));
+    }
+    bool readU64(uint64_t& vOutValue) {
+        return readBytes(&vOutValue, sizeof(vOutValue));
+    }
+    bool readString(std::string& vOutString) {
+        uint32_t len = 0U;
+        if (!readU32(len) || len > m_Size - m_Pos) {
+            return false;
+        }
+        vOutString.assign((const char*)m_Datas + m_Pos, len);
+        m_Pos += len;
+        return true;
+    }
+    bool readBytes(void* vOutDatas, const size_t& vSize) {
+        if (vSize > m_Size - m_Pos) {
+            return false;
+        }
+        memcpy(vOutDatas, m_Datas + m_Pos, vSize);
+        m_Pos += vSize;
+        return true;
+    }
+    size_t remaining() const {
+        return m_Size - m_Pos;
+    }
+};
+
+}  // namespace
+
+//////////////////////////////////////////////////////////////////////////////////
+//// STATIC //////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+SpirvBundlePtr SpirvBundle::Create() {
+    ZoneScoped;
+    return std::make_shared<SpirvBundle>();
+}
+
+uint64_t SpirvBundle::HashString(const std::string& vString) {
+    ZoneScoped;
+    uint64_t hash = 14695981039346656037ULL;
+    for (const auto& c : vString) {
+        hash ^= (uint8_t)c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string SpirvBundle::NormalizeDefines(const std::string& vDefines) {
+    ZoneScoped;
+    std::set<std::string> defines;
+    std::stringstream ss(vDefines);
+    std::string define;
+    while (std::getline(ss, define, ';')) {
+        if (!define.empty()) {
+            defines.insert(define);
+        }
+    }
+    std::string res;
+    for (const auto& it : defines) {
+        res += it + ";";
+    }
+    return res;
+}
+
+std::string SpirvBundle::GetKey(const KeySource& vKeySource, const std::string& vShaderSuffix, const std::string& vEntryPoint, const uint8_t& vOptimizationMode) {
+    ZoneScoped;
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%016llx:%016llx:%016llx", (unsigned long long)HashString(vKeySource.source),
+        (unsigned long long)HashString(NormalizeDefines(vKeySource.defines)), (unsigned long long)HashString(vKeySource.options));
+    return vShaderSuffix + ":" + vEntryPoint + ":" + std::to_string(vOptimizationMode) + ":" + std::string(buffer);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//// LOAD / SAVE /////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+bool SpirvBundle::LoadFromFile(const std::string& vFilePathName) {
+    ZoneScoped;
+    std::ifstream file(vFilePathName, std::ios::binary);
+    if (!file.is_open()) {
+        LogVarError("Fail to open the spirv bundle %s", vFilePathName.c_str());
+        return false;
+    }
+    // one read of the whole file, the entries are parsed from memory
+    const std::vector<uint8_t> datas((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!LoadFromMemory(datas.data(), datas.size())) {
+        LogVarError("The spirv bundle %s is invalid", vFilePathName.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool SpirvBundle::LoadFromMemory(const uint8_t* vDatas, const size_t& vSize) {
+    ZoneScoped;
+    if (vDatas == nullptr || !vSize) {
+        return false;
+    }
+    BundleReader reader(vDatas, vSize);
+    uint32_t magic = 0U, version = 0U, count = 0U;
+    if (!reader.readU32(magic) || magic != s_Magic) {
+        return false;
+    }
+    if (!reader.readU32(version) || version != s_Version) {
+        LogVarError("the spirv bundle version %u is not supported (%u expected)", version, s_Version);
+        return false;
+    }
+    if (!reader.readU32(count)) {
+        return false;
+    }
+
+    // the entries are added only if all the bundle is valid
+    std::unordered_map<std::string, Entry> entries;
+    for (uint32_t idx = 0U; idx < count; ++idx) {
+        std::string key;
+        Entry entry;
+        uint32_t wordsCount = 0U;
+        if (!reader.readString(key) || !reader.readU32(wordsCount) || wordsCount > reader.remaining() / sizeof(unsigned int)) {
+            return false;
+        }
+        entry.spirv.resize(wordsCount);
+        if (!reader.readBytes(entry.spirv.data(), wordsCount * sizeof(unsigned int))) {
+            return false;
+        }
+        uint32_t uniformsCount = 0U;
+        if (!reader.readU32(uniformsCount)) {
+            return false;
+        }
+        for (uint32_t u = 0U; u < uniformsCount; ++u) {
+            std::string name;
+            uint32_t used = 0U;
+            if (!reader.readString(name) || !reader.readU32(used)) {
+                return false;
+            }
+            entry.usedUniforms[name] = (used != 0U);
+        }
+        uint32_t bindingsCount = 0U;
+        if (!reader.readU32(bindingsCount)) {
+            return false;
+        }
+        for (uint32_t b = 0U; b < bindingsCount; ++b) {
+            std::string name;
+            if (!reader.readString(name)) {
+                return false;
+            }
+            entry.usedBindings.emplace(name);
+        }
+        uint32_t includesCount = 0U;
+        if (!reader.readU32(includesCount)) {
+            return false;
+        }
+        for (uint32_t i = 0U; i < includesCount; ++i) {
+            std::string path;
+            uint64_t hash = 0U;
+            if (!reader.readString(path) || !reader.readU64(hash)) {
+                return false;
+            }
+            entry.includes[path] = hash;
+        }
+        entries[key] = entry;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (auto& entry : entries) {
+        m_Entries[entry.first] = std::move(entry.second);
+    }
+    return true;
+}
+
+bool SpirvBundle::SaveToFile(const std::string& vFilePathName) const {
+    ZoneScoped;
+    BundleWriter writer;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        writer.writeU32(s_Magic);
+        writer.writeU32(s_Version);
+        writer.writeU32((uint32_t)m_Entries.size());
+        for (const auto& entry : m_Entries) {
+            writer.writeString(entry.first);
+            writer.writeU32((uint32_t)entry.second.spirv.size());
+            writer.writeBytes(entry.second.spirv.data(), entry.second.spirv.size() * sizeof(unsigned int));
+            writer.writeU32((uint32_t)entry.second.usedUniforms.size());
+            for (const auto& used : entry.second.usedUniforms) {
+                writer.writeString(used.first);
+                writer.writeU32(used.second ? 1U : 0U);
+            }
+            writer.writeU32((uint32_t)entry.second.usedBindings.size());
+            for (const auto& binding : entry.second.usedBindings) {
+                writer.writeString(binding);
+            }
+            writer.writeU32((uint32_t)entry.second.includes.size());
+            for (const auto& include : entry.second.includes) {
+                writer.writeString(include.first);
+                writer.writeU64(include.second);
+            }
+        }
+    }
+    std::ofstream file(vFilePathName, std::ios::binary);
+    if (!file.is_open()) {
+        LogVarError("Fail to write the spirv bundle %s", vFilePathName.c_str());
+        return false;
+    }
+    file.write((const char*)writer.datas.data(), writer.datas.size());
+    return file.good();
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//// ENTRIES /////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+
+void SpirvBundle::AddEntry(const std::string& vKey, const Entry& vEntry) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries[vKey] = vEntry;
+}
+
+bool SpirvBundle::GetEntry(const std::string& vKey, Entry& vOutEntry) const {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Entries.find(vKey);
+    if (it != m_Entries.end()) {
+        vOutEntry = it->second;
+        return true;
+    }
+    return false;
+}
+
+size_t SpirvBundle::GetEntriesCount() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Entries.size();
+}
+
+void SpirvBundle::Clear() {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Entries.clear();
+}
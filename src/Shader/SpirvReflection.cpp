@@ -0,0 +1,448 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#include <Gaia/Shader/SpirvReflection.h>
+#include <SPIRV/spirv.hpp>
+
+#include <set>
+#include <algorithm>
+#include <unordered_map>
+
+#ifdef PROFILER_INCLUDE
+#include <vulkan/vulkan.hpp>
+#include PROFILER_INCLUDE
+#endif
+#ifndef ZoneScoped
+#define ZoneScoped
+#endif
+
+namespace {
+
+struct TypeInfo {
+    spv::Op op = spv::OpNop;
+    std::vector<uint32_t> operands;  // words after the result id
+};
+
+struct DecorationInfo {
+    std::unordered_map<uint32_t, uint32_t> values;  // decoration => first literal (or 1)
+    bool has(const spv::Decoration& vDecoration) const {
+        return values.find((uint32_t)vDecoration) != values.end();
+    }
+    uint32_t get(const spv::Decoration& vDecoration) const {
+        auto it = values.find((uint32_t)vDecoration);
+        return (it != values.end()) ? it->second : 0U;
+    }
+};
+
+// the result of the reading of all the instructions
+struct SpirvModule {
+    uint32_t version = 0U;
+    std::unordered_map<uint32_t, std::string> names;
+    std::unordered_map<uint32_t, std::map<uint32_t, std::string>> memberNames;
+    std::unordered_map<uint32_t, DecorationInfo> decorations;
+    std::unordered_map<uint32_t, std::map<uint32_t, DecorationInfo>> memberDecorations;
+    std::unordered_map<uint32_t, TypeInfo> types;
+    std::unordered_map<uint32_t, uint32_t> constants;                 // id => first word
+    std::vector<std::pair<uint32_t, std::pair<uint32_t, uint32_t>>> variables;  // id => (pointer type, storage class)
+    std::set<uint32_t> interfaceIds;
+    vk::ShaderStageFlags stages;
+};
+
+std::string ReadString(const uint32_t* vWords, const size_t& vCount, size_t& vOutWordsUsed) {
+    std::string res;
+    vOutWordsUsed = 0U;
+    for (size_t w = 0U; w < vCount; ++w) {
+        ++vOutWordsUsed;
+        for (uint32_t b = 0U; b < 4U; ++b) {
+            const char c = (char)((vWords[w] >> (b * 8U)) & 0xFF);
+            if (c == 0) {
+                return res;
+            }
+            res += c;
+        }
+    }
+    return res;
+}
+
+vk::ShaderStageFlags GetStageFlags(const uint32_t& vExecutionModel) {
+    switch (vExecutionModel) {
+        case spv::ExecutionModelVertex: return vk::ShaderStageFlagBits::eVertex;
+        case spv::ExecutionModelTessellationControl: return vk::ShaderStageFlagBits::eTessellationControl;
+        case spv::ExecutionModelTessellationEvaluation: return vk::ShaderStageFlagBits::eTessellationEvaluation;
+        case spv::ExecutionModelGeometry: return vk::ShaderStageFlagBits::eGeometry;
+        case spv::ExecutionModelFragment: return vk::ShaderStageFlagBits::eFragment;
+        case spv::ExecutionModelGLCompute: return vk::ShaderStageFlagBits::eCompute;
+        case spv::ExecutionModelTaskEXT: return vk::ShaderStageFlagBits::eTaskEXT;
+        case spv::ExecutionModelMeshEXT: return vk::ShaderStageFlagBits::eMeshEXT;
+        case spv::ExecutionModelRayGenerationKHR: return vk::ShaderStageFlagBits::eRaygenKHR;
+        case spv::ExecutionModelIntersectionKHR: return vk::ShaderStageFlagBits::eIntersectionKHR;
+        case spv::ExecutionModelAnyHitKHR: return vk::ShaderStageFlagBits::eAnyHitKHR;
+        case spv::ExecutionModelClosestHitKHR: return vk::ShaderStageFlagBits::eClosestHitKHR;
+        case spv::ExecutionModelMissKHR: return vk::ShaderStageFlagBits::eMissKHR;
+        case spv::ExecutionModelCallableKHR: return vk::ShaderStageFlagBits::eCallableKHR;
+        default: break;
+    }
+    return {};
+}
+
+// size of a type in bytes. the matrix stride is a decoration of the struct member, so given by the caller
+uint32_t GetTypeSize(const SpirvModule& vModule, const uint32_t& vTypeId, const uint32_t& vMatrixStride) {
+    auto it = vModule.types.find(vTypeId);
+    if (it == vModule.types.end()) {
+        return 0U;
+    }
+    const auto& type = it->second;
+    switch (type.op) {
+        case spv::OpTypeBool: return 4U;
+        case spv::OpTypeInt:
+        case spv::OpTypeFloat: return type.operands.empty() ? 0U : type.operands[0] / 8U;
+        case spv::OpTypeVector:
+            return (type.operands.size() < 2U) ? 0U : GetTypeSize(vModule, type.operands[0], 0U) * type.operands[1];
+        case spv::OpTypeMatrix: {
+            if (type.operands.size() < 2U) {
+                return 0U;
+            }
+            const uint32_t columnSize = vMatrixStride ? vMatrixStride : GetTypeSize(vModule, type.operands[0], 0U);
+            return columnSize * type.operands[1];
+        }
+        case spv::OpTypeArray: {
+            if (type.operands.size() < 2U) {
+                return 0U;
+            }
+            auto itLen = vModule.constants.find(type.operands[1]);
+            const uint32_t len = (itLen != vModule.constants.end()) ? itLen->second : 0U;
+            uint32_t stride = 0U;
+            auto itDeco = vModule.decorations.find(vTypeId);
+            if (itDeco != vModule.decorations.end()) {
+                stride = itDeco->second.get(spv::DecorationArrayStride);
+            }
+            if (!stride) {
+                stride = GetTypeSize(vModule, type.operands[0], vMatrixStride);
+            }
+            return stride * len;
+        }
+        case spv::OpTypeRuntimeArray: return 0U;
+        case spv::OpTypeStruct: {
+            uint32_t size = 0U;
+            auto itMembers = vModule.memberDecorations.find(vTypeId);
+            for (uint32_t m = 0U; m < (uint32_t)type.operands.size(); ++m) {
+                uint32_t offset = 0U, matrixStride = 0U;
+                if (itMembers != vModule.memberDecorations.end()) {
+                    auto itMember = itMembers->second.find(m);
+                    if (itMember != itMembers->second.end()) {
+                        offset = itMember->second.get(spv::DecorationOffset);
+                        matrixStride = itMember->second.get(spv::DecorationMatrixStride);
+                    }
+                }
+                size = std::max(size, offset + GetTypeSize(vModule, type.operands[m], matrixStride));
+            }
+            return size;
+        }
+        default: break;
+    }
+    return 0U;
+}
+
+std::vector<SpirvReflection::MemberInfo> GetStructMembers(const SpirvModule& vModule, const uint32_t& vStructId, uint32_t& vOutSize) {
+    std::vector<SpirvReflection::MemberInfo> res;
+    vOutSize = GetTypeSize(vModule, vStructId, 0U);
+    auto it = vModule.types.find(vStructId);
+    if (it == vModule.types.end() || it->second.op != spv::OpTypeStruct) {
+        return res;
+    }
+    auto itNames = vModule.memberNames.find(vStructId);
+    auto itMembers = vModule.memberDecorations.find(vStructId);
+    for (uint32_t m = 0U; m < (uint32_t)it->second.operands.size(); ++m) {
+        SpirvReflection::MemberInfo member;
+        uint32_t matrixStride = 0U;
+        if (itNames != vModule.memberNames.end()) {
+            auto itName = itNames->second.find(m);
+            if (itName != itNames->second.end()) {
+                member.name = itName->second;
+            }
+        }
+        if (itMembers != vModule.memberDecorations.end()) {
+            auto itMember = itMembers->second.find(m);
+            if (itMember != itMembers->second.end()) {
+                member.offset = itMember->second.get(spv::DecorationOffset);
+                matrixStride = itMember->second.get(spv::DecorationMatrixStride);
+            }
+        }
+        member.size = GetTypeSize(vModule, it->second.operands[m], matrixStride);
+        res.push_back(member);
+    }
+    return res;
+}
+
+}  // namespace
+
+bool SpirvReflection::Reflect(const std::vector<unsigned int>& vSpirv, ReflectionDatas& vOutDatas) {
+    ZoneScoped;
+    vOutDatas = ReflectionDatas();
+    if (vSpirv.size() < 5U || vSpirv[0] != spv::MagicNumber) {
+        return false;
+    }
+
+    SpirvModule module;
+    module.version = vSpirv[1];
+
+    // one pass on the instructions
+    size_t pos = 5U;
+    while (pos < vSpirv.size()) {
+        const uint32_t wordCount = vSpirv[pos] >> 16U;
+        const uint32_t opCode = vSpirv[pos] & 0xFFFFU;
+        if (!wordCount || pos + wordCount > vSpirv.size()) {
+            return false;
+        }
+        const uint32_t* ops = vSpirv.data() + pos + 1U;  // operands
+        const size_t opsCount = wordCount - 1U;
+        size_t used = 0U;
+        switch (opCode) {
+            case spv::OpName:
+                if (opsCount >= 1U) {
+                    module.names[ops[0]] = ReadString(ops + 1, opsCount - 1U, used);
+                }
+                break;
+            case spv::OpMemberName:
+                if (opsCount >= 2U) {
+                    module.memberNames[ops[0]][ops[1]] = ReadString(ops + 2, opsCount - 2U, used);
+                }
+                break;
+            case spv::OpEntryPoint:
+                if (opsCount >= 2U) {
+                    module.stages |= GetStageFlags(ops[0]);
+                    ReadString(ops + 2, opsCount - 2U, used);
+                    for (size_t idx = 2U + used; idx < opsCount; ++idx) {
+                        module.interfaceIds.emplace(ops[idx]);
+                    }
+                }
+                break;
+            case spv::OpExecutionMode:
+                if (opsCount >= 5U && ops[1] == spv::ExecutionModeLocalSize) {
+                    vOutDatas.localSize = {ops[2], ops[3], ops[4]};
+                }
+                break;
+            case spv::OpExecutionModeId:
+                if (opsCount >= 5U && ops[1] == spv::ExecutionModeLocalSizeId) {
+                    vOutDatas.localSizeIds = {ops[2], ops[3], ops[4]};  // constants ids, resolved after
+                    vOutDatas.localSizeFromIds = true;
+                }
+                break;
+            case spv::OpDecorate:
+                if (opsCount >= 2U) {
+                    module.decorations[ops[0]].values[ops[1]] = (opsCount >= 3U) ? ops[2] : 1U;
+                }
+                break;
+            case spv::OpMemberDecorate:
+                if (opsCount >= 3U) {
+                    module.memberDecorations[ops[0]][ops[1]].values[ops[2]] = (opsCount >= 4U) ? ops[3] : 1U;
+                }
+                break;
+            case spv::OpTypeBool:
+            case spv::OpTypeInt:
+            case spv::OpTypeFloat:
+            case spv::OpTypeVector:
+            case spv::OpTypeMatrix:
+            case spv::OpTypeImage:
+            case spv::OpTypeSampler:
+            case spv::OpTypeSampledImage:
+            case spv::OpTypeArray:
+            case spv::OpTypeRuntimeArray:
+            case spv::OpTypeStruct:
+            case spv::OpTypePointer:
+            case spv::OpTypeAccelerationStructureKHR:
+                if (opsCount >= 1U) {
+                    TypeInfo type;
+                    type.op = (spv::Op)opCode;
+                    type.operands.assign(ops + 1, ops + opsCount);
+                    module.types[ops[0]] = type;
+                }
+                break;
+            case spv::OpConstant:
+            case spv::OpSpecConstant:
+                if (opsCount >= 3U) {
+                    module.constants[ops[1]] = ops[2];
+                }
+                break;
+            case spv::OpVariable:
+                if (opsCount >= 3U) {
+                    module.variables.push_back(std::make_pair(ops[1], std::make_pair(ops[0], ops[2])));
+                }
+                break;
+            default: break;
+        }
+        pos += wordCount;
+    }
+
+    vOutDatas.stages = module.stages;
+
+    // before spirv 1.4, the interface of the entry point contain only the inputs and outputs
+    const bool canSayUsed = (module.version >= 0x00010400U);
+
+    for (const auto& variable : module.variables) {
+        const uint32_t varId = variable.first;
+        const uint32_t storageClass = variable.second.second;
+        if (storageClass != spv::StorageClassUniformConstant && storageClass != spv::StorageClassUniform &&
+            storageClass != spv::StorageClassStorageBuffer && storageClass != spv::StorageClassPushConstant) {
+            continue;
+        }
+        auto itPointer = module.types.find(variable.second.first);
+        if (itPointer == module.types.end() || itPointer->second.op != spv::OpTypePointer || itPointer->second.operands.size() < 2U) {
+            continue;
+        }
+
+        // unwrap the arrays of descriptors
+        uint32_t typeId = itPointer->second.operands[1];
+        uint32_t count = 1U;
+        auto itType = module.types.find(typeId);
+        while (itType != module.types.end() && (itType->second.op == spv::OpTypeArray || itType->second.op == spv::OpTypeRuntimeArray)) {
+            if (itType->second.op == spv::OpTypeRuntimeArray) {
+                count = 0U;
+            } else if (itType->second.operands.size() >= 2U) {
+                auto itLen = module.constants.find(itType->second.operands[1]);
+                count *= (itLen != module.constants.end()) ? itLen->second : 1U;
+            }
+            typeId = itType->second.operands[0];
+            itType = module.types.find(typeId);
+        }
+        if (itType == module.types.end()) {
+            continue;
+        }
+
+        const auto itVarName = module.names.find(varId);
+        const auto itTypeName = module.names.find(typeId);
+        const std::string varName = (itVarName != module.names.end()) ? itVarName->second : std::string();
+        const std::string typeName = (itTypeName != module.names.end()) ? itTypeName->second : std::string();
+
+        if (storageClass == spv::StorageClassPushConstant) {
+            PushConstantInfo push;
+            push.name = typeName.empty() ? varName : typeName;
+            push.stages = module.stages;
+            push.members = GetStructMembers(module, typeId, push.size);
+            vOutDatas.pushConstants.push_back(push);
+            continue;
+        }
+
+        BindingInfo info;
+        info.name = varName;
+        info.typeName = typeName;
+        info.count = count;
+        info.stages = module.stages;
+        info.used = !canSayUsed || (module.interfaceIds.find(varId) != module.interfaceIds.end());
+        auto itDeco = module.decorations.find(varId);
+        if (itDeco != module.decorations.end()) {
+            info.set = itDeco->second.get(spv::DecorationDescriptorSet);
+            info.binding = itDeco->second.get(spv::DecorationBinding);
+        }
+
+        const auto& type = itType->second;
+        bool known = true;
+        if (storageClass == spv::StorageClassUniformConstant) {
+            switch (type.op) {
+                case spv::OpTypeSampledImage: info.type = vk::DescriptorType::eCombinedImageSampler; break;
+                case spv::OpTypeSampler: info.type = vk::DescriptorType::eSampler; break;
+                case spv::OpTypeAccelerationStructureKHR: info.type = vk::DescriptorType::eAccelerationStructureKHR; break;
+                case spv::OpTypeImage: {
+                    // operands : sampled type, dim, depth, arrayed, ms, sampled, format
+                    const uint32_t dim = (type.operands.size() > 1U) ? type.operands[1] : 0U;
+                    const uint32_t sampled = (type.operands.size() > 5U) ? type.operands[5] : 0U;
+                    if (dim == spv::DimSubpassData) {
+                        info.type = vk::DescriptorType::eInputAttachment;
+                    } else if (dim == spv::DimBuffer) {
+                        info.type = (sampled == 2U) ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+                    } else {
+                        info.type = (sampled == 2U) ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+                    }
+                    break;
+                }
+                default: known = false; break;
+            }
+        } else {
+            auto itTypeDeco = module.decorations.find(typeId);
+            const bool isBufferBlock = (itTypeDeco != module.decorations.end()) && itTypeDeco->second.has(spv::DecorationBufferBlock);
+            if (storageClass == spv::StorageClassStorageBuffer || isBufferBlock) {
+                info.type = vk::DescriptorType::eStorageBuffer;
+            } else {
+                info.type = vk::DescriptorType::eUniformBuffer;  // or eUniformBufferDynamic, only known by the writes (see GetLayoutBindings)
+            }
+            info.members = GetStructMembers(module, typeId, info.blockSize);
+        }
+        if (known) {
+            vOutDatas.bindings.push_back(info);
+        }
+    }
+
+    // spec constants names, and resolve of the LocalSizeId to the spec ids
+    for (const auto& deco : module.decorations) {
+        if (deco.second.has(spv::DecorationSpecId)) {
+            auto itName = module.names.find(deco.first);
+            vOutDatas.specializationConstants[deco.second.get(spv::DecorationSpecId)] =
+                (itName != module.names.end()) ? itName->second : std::string();
+        }
+    }
+    if (vOutDatas.localSizeFromIds) {
+        for (auto& id : vOutDatas.localSizeIds) {
+            auto itDeco = module.decorations.find(id);
+            auto itConst = module.constants.find(id);
+            vOutDatas.localSize[&id - vOutDatas.localSizeIds.data()] = (itConst != module.constants.end()) ? itConst->second : 1U;
+            id = (itDeco != module.decorations.end() && itDeco->second.has(spv::DecorationSpecId)) ? itDeco->second.get(spv::DecorationSpecId) : 0U;
+        }
+    }
+
+    vOutDatas.valid = true;
+    return true;
+}
+
+std::vector<vk::DescriptorSetLayoutBinding> SpirvReflection::GetLayoutBindings(
+    const std::vector<const ReflectionDatas*>& vStages, const uint32_t& vSetIndex, const std::map<uint32_t, vk::DescriptorType>* vDynamicTypesPtr) {
+    ZoneScoped;
+    std::map<uint32_t, vk::DescriptorSetLayoutBinding> bindings;
+    for (const auto* stagePtr : vStages) {
+        if (stagePtr == nullptr || !stagePtr->valid) {
+            continue;
+        }
+        for (const auto& info : stagePtr->bindings) {
+            if (info.set != vSetIndex) {
+                continue;
+            }
+            auto it = bindings.find(info.binding);
+            if (it == bindings.end()) {
+                // a runtime array need a count, one by default
+                bindings[info.binding] = vk::DescriptorSetLayoutBinding(info.binding, info.type, std::max(info.count, 1U), info.stages);
+            } else {
+                it->second.stageFlags |= info.stages;
+            }
+        }
+    }
+    std::vector<vk::DescriptorSetLayoutBinding> res;
+    for (auto& binding : bindings) {
+        if (vDynamicTypesPtr) {
+            auto itDyn = vDynamicTypesPtr->find(binding.first);
+            if (itDyn != vDynamicTypesPtr->end()) {
+                if ((binding.second.descriptorType == vk::DescriptorType::eUniformBuffer && itDyn->second == vk::DescriptorType::eUniformBufferDynamic) ||
+                    (binding.second.descriptorType == vk::DescriptorType::eStorageBuffer && itDyn->second == vk::DescriptorType::eStorageBufferDynamic)) {
+                    binding.second.descriptorType = itDyn->second;
+                }
+            }
+        }
+        res.push_back(binding.second);
+    }
+    return res;
+}
@@ -21,6 +21,7 @@ limitations under the License.
 
 #include <SPIRV/GLSL.std.450.h>
 #include <SPIRV/GlslangToSpv.h>
+#include <SPIRV/SPVRemapper.h>
 #include <StandAlone/DirStackFileIncluder.h>
 #include <Gaia/Shader/ResourceLimits.h>
 #include <glslang/Include/ShHandle.h>
@@ -29,6 +30,7 @@ limitations under the License.
 #include <ezlibs/ezLog.hpp>
 #include <ezlibs/ezFile.hpp>
 #include <Gaia/Shader/IRUniformsLocator.h>
+#include <Gaia/Shader/ShaderIncludeCache.h>
 
 #include <cstdio>     // printf, fprintf
 #include <cstdlib>    // abort
@@ -37,6 +39,7 @@ limitations under the License.
 #include <algorithm>  // std::min, std::max
 #include <fstream>    // std::ifstream
 #include <chrono>     // timer
+#include <cstring>    // memcpy
 
 #ifdef PROFILER_INCLUDE
 #include <vulkan/vulkan.hpp>
@@ -82,6 +85,7 @@ bool VulkanShader::Init() {
 
 void VulkanShader::Unit() {
     ZoneScoped;
+    m_OptimizedSpirvs.clear();
 
     glslang::FinalizeProcess();
 }
@@ -170,6 +174,45 @@ std::string GetFullShaderStageString(const EShLanguage& stage) {
     return "";
 }
 
+// a DirStackFileIncluder reading the files through the include cache
+// and recording the include closure of the compiled unit with the content hashes
+class CachedFileIncluder : public DirStackFileIncluder {
+private:
+    ShaderIncludeCache& m_IncludeCache;
+    ShaderIncludeCache::DependenciesContainer m_Dependencies;
+
+public:
+    explicit CachedFileIncluder(ShaderIncludeCache& vIncludeCache) : m_IncludeCache(vIncludeCache) {
+    }
+    const ShaderIncludeCache::DependenciesContainer& GetDependencies() const {
+        return m_Dependencies;
+    }
+
+protected:
+    IncludeResult* readLocalPath(const char* headerName, const char* includerName, int depth) override {
+        ZoneScoped;
+        // same search than DirStackFileIncluder
+        directoryStack.resize(depth + externalLocalDirectoryCount);
+        if (depth == 1)
+            directoryStack.back() = getDirectory(includerName);
+        for (auto it = directoryStack.rbegin(); it != directoryStack.rend(); ++it) {
+            std::string path = *it + '/' + headerName;
+            std::replace(path.begin(), path.end(), '\\', '/');
+            std::string content;
+            size_t hash = 0U;
+            if (m_IncludeCache.GetFileContent(path, content, &hash)) {
+                directoryStack.push_back(getDirectory(path));
+                includedFiles.insert(path);
+                m_Dependencies[ShaderIncludeCache::NormalizePath(path)] = hash;
+                char* datas = new tUserDataElement[content.size()];
+                memcpy(datas, content.data(), content.size());
+                return new IncludeResult(path, datas, content.size(), datas);
+            }
+        }
+        return nullptr;
+    }
+};
+
 // TODO: Multithread, manage SpirV that doesn't need recompiling (only recompile when dirty)
 const std::vector<unsigned int> VulkanShader::CompileGLSLFile(const std::string& filename,
     const ShaderEntryPoint& vEntryPoint,
@@ -180,18 +223,13 @@ const std::vector<unsigned int> VulkanShader::CompileGLSLFile(const std::string&
 
     std::vector<unsigned int> SpirV;
 
-    // Load GLSL into a string
-    std::ifstream file(filename);
-
-    if (!file.is_open()) {
+    // Load GLSL into a string, from the include cache
+    std::string InputGLSL;
+    if (!m_IncludeCache.GetFileContent(filename, InputGLSL)) {
         LogVarError("Debug : Failed to load shader %s", filename.c_str());
         return SpirV;
     }
 
-    std::string InputGLSL((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-
-    file.close();
-
     if (!InputGLSL.empty()) {
         if (vShaderCode)
             *vShaderCode = InputGLSL;
@@ -208,9 +246,15 @@ const std::vector<unsigned int> VulkanShader::CompileGLSLString(const std::strin
     const ShaderEntryPoint& vEntryPoint,
     ShaderMessagingFunction vMessagingFunction,
     std::string* vShaderCode,
-    std::unordered_map<std::string, bool>* vUsedUniforms) {
+    std::unordered_map<std::string, bool>* vUsedUniforms,
+    SpirvOptimizationMode vOptimizationMode,
+    const SpirvBundle::KeySource* vBundleKeySource,
+    std::set<std::string>* vUsedBindings) {
     ZoneScoped;
 
+    // the hot reload can compile from a worker thread
+    std::lock_guard<std::mutex> lock(m_CompilationMutex);
+
     // LogVarDebugInfo("Debug : ==== VulkanShader::CompileGLSLString (%s) =====", vShaderSuffix.c_str());
 
     m_Error.clear();
@@ -218,6 +262,10 @@ const std::vector<unsigned int> VulkanShader::CompileGLSLString(const std::strin
 
     std::vector<unsigned int> SpirV;
 
+    if (vOptimizationMode == SpirvOptimizationMode::SPIRV_OPTIMIZATION_DEFAULT) {
+        vOptimizationMode = m_OptimizationMode;
+    }
+
     std::string InputGLSL = vCode;
 
     EShLanguage shaderType = GetShaderStage(vShaderSuffix);
@@ -228,6 +276,24 @@ const std::vector<unsigned int> VulkanShader::CompileGLSLString(const std::strin
         if (vShaderCode)
             *vShaderCode = InputGLSL;
 
+        // the dependencies are stored by compile key while m_CompilationMutex is locked
+        // so the closure of a variant is not replaced by the one of another variant of the same file
+        const auto compileKey = GetCompileKey(vOriginalFileName, vShaderSuffix, vBundleKeySource);
+
+        std::string bundleKey;
+        if (m_SpirvBundlePtr) {
+            SpirvBundle::KeySource keySource;
+            if (vBundleKeySource != nullptr) {
+                keySource = *vBundleKeySource;
+            } else {
+                keySource.source = InputGLSL;
+            }
+            bundleKey = SpirvBundle::GetKey(keySource, vShaderSuffix, vEntryPoint, (uint8_t)vOptimizationMode);
+            if (!m_SpirvBundleRecording && LoadFromSpirvBundle(bundleKey, compileKey, vUsedUniforms, vUsedBindings, SpirV)) {
+                return SpirV;
+            }
+        }
+
         // Set up Vulkan/SpirV Environment
         int ClientInputSemanticsVersion = 100;  // maps to, say, #define VULKAN 100
         // glslang::EShTargetClientVersion VulkanClientVersion = glslang::EShTargetVulkan_1_0;  // would map to, say, Vulkan 1.0
@@ -254,13 +320,19 @@ const std::vector<unsigned int> VulkanShader::CompileGLSLString(const std::strin
 
         const int DefaultVersion = 110;  // 110 for desktop, 100 for es
 
-        DirStackFileIncluder Includer;
+        CachedFileIncluder Includer(m_IncludeCache);
 
         std::string PreprocessedGLSL;
 
         std::string shaderTypeString = GetFullShaderStageString(shaderType);
 
-        if (!Shader.preprocess(&glslang::DefaultTBuiltInResource, DefaultVersion, ENoProfile, false, false, messages, &PreprocessedGLSL, Includer)) {
+        const bool preprocessed =
+            Shader.preprocess(&glslang::DefaultTBuiltInResource, DefaultVersion, ENoProfile, false, false, messages, &PreprocessedGLSL, Includer);
+
+        // even if the preprocessing failed, a fix in an include must trigger a recompilation
+        m_IncludeCache.SetDependencies(compileKey, Includer.GetDependencies());
+
+        if (!preprocessed) {
             LogVarError("Debug Preprocessing : GLSL stage %s Preprocessing Failed for : %s", vShaderSuffix.c_str(), vOriginalFileName.c_str());
 
             std::string log = Shader.getInfoLog();
@@ -418,16 +490,23 @@ const std::vector<unsigned int> VulkanShader::CompileGLSLString(const std::strin
 #endif
         }
 
-        if (vUsedUniforms) {
-            auto usedUniforms = CollectUniformInfosFromIR(*Shader.getIntermediate());
-            for (auto u : usedUniforms) {
-                (*vUsedUniforms)[u.first] |= u.second;
+        std::unordered_map<std::string, bool> usedUniforms;
+        std::set<std::string> usedBindings;
+        if (vUsedUniforms || vUsedBindings || m_SpirvBundleRecording) {
+            usedUniforms = CollectUniformInfosFromIR(*Shader.getIntermediate(), &usedBindings);
+            if (vUsedUniforms) {
+                for (auto u : usedUniforms) {
+                    (*vUsedUniforms)[u.first] |= u.second;
+                }
+            }
+            if (vUsedBindings) {
+                vUsedBindings->insert(usedBindings.begin(), usedBindings.end());
             }
         }
 
         spv::SpvBuildLogger logger;
         glslang::SpvOptions spvOptions;
-        spvOptions.optimizeSize = true;
+        spvOptions.disableOptimizer = true;  // the raw spirv is optimized after by OptimizeSpirv
 #ifdef _DEBUG
         spvOptions.generateDebugInfo = true;
 #else
@@ -442,6 +521,12 @@ const std::vector<unsigned int> VulkanShader::CompileGLSLString(const std::strin
             std::string allmsgs = logger.getAllMessages();
             std::cout << allmsgs << std::endl;
         }
+
+        SpirV = OptimizeSpirv(SpirV, vOptimizationMode);
+
+        if (m_SpirvBundlePtr && m_SpirvBundleRecording && !SpirV.empty()) {
+            AddToSpirvBundle(bundleKey, SpirV, usedUniforms, usedBindings, Includer.GetDependencies());
+        }
     }
 
     if (SpirV.empty()) {
@@ -463,6 +548,8 @@ void VulkanShader::ParseGLSLString(const std::string& vCode,
     TraverserFunction vTraverser) {
     ZoneScoped;
 
+    std::lock_guard<std::mutex> lock(m_CompilationMutex);
+
     std::string InputGLSL = vCode;
 
     EShLanguage shaderType = GetShaderStage(vShaderSuffix);
@@ -491,7 +578,7 @@ void VulkanShader::ParseGLSLString(const std::string& vCode,
 
         const int DefaultVersion = 110;  // 110 for desktop, 100 for es
 
-        DirStackFileIncluder Includer;
+        CachedFileIncluder Includer(m_IncludeCache);
 
         std::string PreprocessedGLSL;
 
@@ -628,7 +715,7 @@ void VulkanShader::DestroyShaderModule(vk::Device vLogicalDevice, vk::ShaderModu
     }
 }
 
-std::unordered_map<std::string, bool> VulkanShader::CollectUniformInfosFromIR(const glslang::TIntermediate& intermediate) {
+std::unordered_map<std::string, bool> VulkanShader::CollectUniformInfosFromIR(const glslang::TIntermediate& intermediate, std::set<std::string>* vOutUsedBindings) {
     ZoneScoped;
 
     std::unordered_map<std::string, bool> res;
@@ -641,6 +728,180 @@ std::unordered_map<std::string, bool> VulkanShader::CollectUniformInfosFromIR(co
     TIRUniformsLocator it;
     root->traverse(&it);
     res = it.usedUniforms;
+    if (vOutUsedBindings) {
+        *vOutUsedBindings = it.usedBindings;
+    }
 
     return res;
 }
+
+void VulkanShader::SetOptimizationMode(const SpirvOptimizationMode& vMode) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_CompilationMutex);
+    if (vMode != SpirvOptimizationMode::SPIRV_OPTIMIZATION_DEFAULT) {
+        m_OptimizationMode = vMode;
+    }
+}
+
+SpirvOptimizationMode VulkanShader::GetOptimizationMode() const {
+    return m_OptimizationMode;
+}
+
+static void LogSpirvRemapError(const std::string& vMsg) {
+    LogVarError("Spirv optimization error : %s", vMsg.c_str());
+}
+
+// the spirv-tools optimizer is not built (ENABLE_OPT is OFF in cmake/glslang.cmake)
+// so the remapper of glslang is used, he only do a dead code elimination of functions, variables and types
+// and a load/store optimization, not the performance passes of spirv-opt (inlining, constant folding, etc..)
+// the source debug infos are stripped for the size mode
+// the STRIP of the remapper is not used, he remove the names needed by SpirvReflection and the used uniforms
+std::vector<unsigned int> VulkanShader::OptimizeSpirv(const std::vector<unsigned int>& vRawSpirv, const SpirvOptimizationMode& vMode) {
+    ZoneScoped;
+    if (vRawSpirv.empty() || vMode == SpirvOptimizationMode::SPIRV_OPTIMIZATION_NONE || vMode == SpirvOptimizationMode::SPIRV_OPTIMIZATION_DEFAULT) {
+        return vRawSpirv;
+    }
+
+    const auto hash = std::hash<std::string>()(std::string((const char*)vRawSpirv.data(), vRawSpirv.size() * sizeof(unsigned int)));
+    const auto key = std::make_tuple(hash, vRawSpirv.size(), vMode);
+    auto it = m_OptimizedSpirvs.find(key);
+    if (it != m_OptimizedSpirvs.end() && it->second.raw == vRawSpirv) {
+        return it->second.optimized;
+    }
+
+    const uint32_t options = spv::spirvbin_t::DCE_ALL | spv::spirvbin_t::OPT_LOADSTORE;
+
+    // the default error handler of the remapper exit the app
+    // the handler is process wide and capture a local, so the guard put back the logger even if remap throw
+    struct RemapErrorHandlerGuard {
+        ~RemapErrorHandlerGuard() { spv::spirvbin_t::registerErrorHandler(LogSpirvRemapError); }
+    };
+    bool remapFailed = false;
+    std::vector<std::uint32_t> optimized(vRawSpirv.begin(), vRawSpirv.end());
+    {
+        RemapErrorHandlerGuard guard;
+        spv::spirvbin_t::registerErrorHandler([&remapFailed](const std::string& vMsg) {
+            LogSpirvRemapError(vMsg);
+            remapFailed = true;
+        });
+        spv::spirvbin_t().remap(optimized, options);
+    }
+
+    if (remapFailed || optimized.empty()) {
+        return vRawSpirv;  // the raw spirv is always valid
+    }
+
+    if (vMode == SpirvOptimizationMode::SPIRV_OPTIMIZATION_SIZE) {
+        StripSourceDebugInfos(optimized);
+    }
+
+    if (m_OptimizedSpirvs.size() > 256U) {  // hot reload can produce many versions
+        m_OptimizedSpirvs.clear();
+    }
+    std::vector<unsigned int> res(optimized.begin(), optimized.end());
+    m_OptimizedSpirvs[key] = OptimizedSpirvStruct{vRawSpirv, res};
+    return res;
+}
+
+// remove the source, the lines and the processes infos, the OpName / OpMemberName are kept
+void VulkanShader::StripSourceDebugInfos(std::vector<std::uint32_t>& vSpirv) {
+    ZoneScoped;
+    static constexpr size_t s_HeaderWordsCount = 5U;
+    if (vSpirv.size() <= s_HeaderWordsCount) {
+        return;
+    }
+    std::vector<std::uint32_t> res(vSpirv.begin(), vSpirv.begin() + s_HeaderWordsCount);
+    size_t idx = s_HeaderWordsCount;
+    while (idx < vSpirv.size()) {
+        const uint32_t wordsCount = vSpirv[idx] >> spv::WordCountShift;
+        const auto opCode = (spv::Op)(vSpirv[idx] & spv::OpCodeMask);
+        if (!wordsCount || idx + wordsCount > vSpirv.size()) {
+            return;  // invalid, the spirv is kept as is
+        }
+        if (opCode != spv::OpSourceContinued && opCode != spv::OpSource && opCode != spv::OpSourceExtension &&  //
+            opCode != spv::OpLine && opCode != spv::OpNoLine && opCode != spv::OpModuleProcessed) {
+            res.insert(res.end(), vSpirv.begin() + idx, vSpirv.begin() + idx + wordsCount);
+        }
+        idx += wordsCount;
+    }
+    vSpirv = res;
+}
+
+void VulkanShader::SetSpirvBundle(SpirvBundlePtr vSpirvBundlePtr, const bool& vRecording) {
+    ZoneScoped;
+    std::lock_guard<std::mutex> lock(m_CompilationMutex);
+    m_SpirvBundlePtr = vSpirvBundlePtr;
+    m_SpirvBundleRecording = vRecording;
+}
+
+SpirvBundlePtr VulkanShader::GetSpirvBundle() const {
+    return m_SpirvBundlePtr;
+}
+
+// the includes are read through the include cache, so an unchanged include is read only once for all the bundle entries
+bool VulkanShader::LoadFromSpirvBundle(const std::string& vKey,
+    const std::string& vCompileKey,
+    std::unordered_map<std::string, bool>* vUsedUniforms,
+    std::set<std::string>* vUsedBindings,
+    std::vector<unsigned int>& vOutSpirv) {
+    ZoneScoped;
+    SpirvBundle::Entry entry;
+    if (!m_SpirvBundlePtr->GetEntry(vKey, entry) || entry.spirv.empty()) {
+        return false;
+    }
+    ShaderIncludeCache::DependenciesContainer dependencies;
+    for (const auto& include : entry.includes) {
+        std::string content;
+        size_t hash = 0U;
+        if (!m_IncludeCache.GetFileContent(include.first, content, &hash) || SpirvBundle::HashString(content) != include.second) {
+            return false;  // include changed, glslang is needed
+        }
+        dependencies[include.first] = hash;
+    }
+    m_IncludeCache.SetDependencies(vCompileKey, dependencies);
+    if (vUsedUniforms) {
+        for (const auto& used : entry.usedUniforms) {
+            (*vUsedUniforms)[used.first] |= used.second;
+        }
+    }
+    if (vUsedBindings) {
+        vUsedBindings->insert(entry.usedBindings.begin(), entry.usedBindings.end());
+    }
+    vOutSpirv = entry.spirv;
+    return true;
+}
+
+void VulkanShader::AddToSpirvBundle(const std::string& vKey,
+    const std::vector<unsigned int>& vSpirv,
+    const std::unordered_map<std::string, bool>& vUsedUniforms,
+    const std::set<std::string>& vUsedBindings,
+    const ShaderIncludeCache::DependenciesContainer& vDependencies) {
+    ZoneScoped;
+    SpirvBundle::Entry entry;
+    entry.spirv = vSpirv;
+    entry.usedUniforms = vUsedUniforms;
+    entry.usedBindings = vUsedBindings;
+    for (const auto& dep : vDependencies) {
+        std::string content;
+        if (m_IncludeCache.GetFileContent(dep.first, content)) {
+            entry.includes[dep.first] = SpirvBundle::HashString(content);
+        }
+    }
+    m_SpirvBundlePtr->AddEntry(vKey, entry);
+}
+
+std::string VulkanShader::GetCompileKey(const std::string& vOriginalFileName, const std::string& vShaderSuffix, const SpirvBundle::KeySource* vBundleKeySource) {
+    const auto unitName = ShaderIncludeCache::GetUnitName(vOriginalFileName, vShaderSuffix);
+    if (vBundleKeySource == nullptr) {
+        return unitName;
+    }
+    return ShaderIncludeCache::GetCompileKey(unitName, SpirvBundle::NormalizeDefines(vBundleKeySource->defines), vBundleKeySource->options);
+}
+
+ShaderIncludeCache& VulkanShader::GetIncludeCache() {
+    return m_IncludeCache;
+}
+
+std::string VulkanShader::GetBindingKey(const uint32_t& vDescriptorSetIndex, const uint32_t& vBindingPoint) {
+    return "@" + std::to_string(vDescriptorSetIndex) + ":" + std::to_string(vBindingPoint);
+}
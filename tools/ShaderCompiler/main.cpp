@@ -0,0 +1,175 @@
+/*
+Copyright 2022-2023 Stephane Cuillerdier (aka aiekick)
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+// This is an independent project of an individual developer. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+/*
+offline compiler of the shaders in a spirv bundle (see SpirvBundle.h)
+
+usage : GaiaShaderCompiler -o bundle.spvb [-O none|dce|size] [-e entryPoint] [-D "NAME=VALUE;NAME2"]... files...
+the stage is deduced from the file suffix (vert, frag, geom, comp, ...)
+each -D option add a variant, the defines are inserted after the #version line
+without -D, only the files as is are compiled
+the key of an entry is computed from the file code and the defines (see SpirvBundle::KeySource)
+so for a variant of a ShaderPass, the defines are the enabled keywords : -D "KEYWORD1;KEYWORD2"
+the passes with promoted uniform blocks are compiled at runtime (the rewritten code is not produced here)
+must be run from the working dir of the app, since the includes are stored with their path
+*/
+
+#include <Gaia/Shader/VulkanShader.h>
+#include <Gaia/Shader/SpirvBundle.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <sstream>
+
+static std::string GetFileSuffix(const std::string& vFilePathName) {
+    const size_t pos = vFilePathName.rfind('.');
+    return (pos == std::string::npos) ? "" : vFilePathName.substr(pos + 1);
+}
+
+static std::string GetFileName(const std::string& vFilePathName) {
+    size_t start = vFilePathName.find_last_of("/\\");
+    start = (start == std::string::npos) ? 0U : start + 1U;
+    const size_t end = vFilePathName.rfind('.');
+    return vFilePathName.substr(start, (end == std::string::npos || end < start) ? std::string::npos : end - start);
+}
+
+// "NAME=VALUE;NAME2" => "#define NAME VALUE\n#define NAME2\n" inserted after the #version line
+static std::string ApplyVariant(const std::string& vCode, const std::string& vVariant) {
+    if (vVariant.empty()) {
+        return vCode;
+    }
+    std::string defines;
+    std::stringstream ss(vVariant);
+    std::string define;
+    while (std::getline(ss, define, ';')) {
+        if (!define.empty()) {
+            const size_t eq = define.find('=');
+            if (eq == std::string::npos) {
+                defines += "#define " + define + "\n";
+            } else {
+                defines += "#define " + define.substr(0, eq) + " " + define.substr(eq + 1) + "\n";
+            }
+        }
+    }
+    size_t insertPos = 0U;
+    const size_t versionPos = vCode.find("#version");
+    if (versionPos != std::string::npos) {
+        const size_t eol = vCode.find('\n', versionPos);
+        insertPos = (eol == std::string::npos) ? vCode.size() : eol + 1U;
+    }
+    auto res = vCode;
+    res.insert(insertPos, defines);
+    return res;
+}
+
+static void PrintUsage() {
+    printf("usage : GaiaShaderCompiler -o bundle.spvb [-O none|dce|size] [-e entryPoint] [-D \"NAME=VALUE;NAME2\"]... files...\n");
+}
+
+int main(int argc, char** argv) {
+    std::string outputFile;
+    std::string entryPoint = "main";
+    SpirvOptimizationMode mode = SpirvOptimizationMode::SPIRV_OPTIMIZATION_NONE;
+    std::vector<std::string> variants;
+    std::vector<std::string> files;
+
+    for (int idx = 1; idx < argc; ++idx) {
+        const std::string arg = argv[idx];
+        const bool hasValue = (idx + 1 < argc);
+        if (arg == "-o" && hasValue) {
+            outputFile = argv[++idx];
+        } else if (arg == "-e" && hasValue) {
+            entryPoint = argv[++idx];
+        } else if (arg == "-D" && hasValue) {
+            variants.push_back(argv[++idx]);
+        } else if (arg == "-O" && hasValue) {
+            const std::string value = argv[++idx];
+            if (value == "none") {
+                mode = SpirvOptimizationMode::SPIRV_OPTIMIZATION_NONE;
+            } else if (value == "dce") {
+                mode = SpirvOptimizationMode::SPIRV_OPTIMIZATION_DCE;
+            } else if (value == "size") {
+                mode = SpirvOptimizationMode::SPIRV_OPTIMIZATION_SIZE;
+            } else {
+                PrintUsage();
+                return 1;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            PrintUsage();
+            return 1;
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    if (outputFile.empty() || files.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    if (variants.empty()) {
+        variants.push_back({});  // the files as is
+    }
+
+    auto shaderPtr = VulkanShader::Create();
+    if (shaderPtr == nullptr) {
+        printf("Fail to init glslang\n");
+        return 1;
+    }
+
+    auto bundlePtr = SpirvBundle::Create();
+    shaderPtr->SetOptimizationMode(mode);
+    shaderPtr->SetSpirvBundle(bundlePtr, true);
+
+    int errorsCount = 0;
+    for (const auto& file : files) {
+        std::string code;
+        if (!shaderPtr->GetIncludeCache().GetFileContent(file, code)) {
+            printf("Fail to read %s\n", file.c_str());
+            ++errorsCount;
+            continue;
+        }
+        const auto suffix = GetFileSuffix(file);
+        const auto name = GetFileName(file);
+        for (const auto& variant : variants) {
+            SpirvBundle::KeySource keySource;
+            keySource.source = code;
+            keySource.defines = variant;
+            const auto spirv = shaderPtr->CompileGLSLString(
+                ApplyVariant(code, variant), suffix, name, entryPoint, nullptr, nullptr, nullptr, SpirvOptimizationMode::SPIRV_OPTIMIZATION_DEFAULT, &keySource);
+            if (spirv.empty()) {
+                printf("Fail to compile %s (variant \"%s\")\n", file.c_str(), variant.c_str());
+                ++errorsCount;
+            }
+        }
+    }
+
+    shaderPtr->SetSpirvBundle(nullptr);
+    shaderPtr->Unit();
+
+    if (!bundlePtr->SaveToFile(outputFile)) {
+        printf("Fail to write %s\n", outputFile.c_str());
+        return 1;
+    }
+
+    printf("%u spirv written in %s, %i errors\n", (uint32_t)bundlePtr->GetEntriesCount(), outputFile.c_str(), errorsCount);
+    return errorsCount ? 1 : 0;
+}